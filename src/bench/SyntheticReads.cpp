@@ -0,0 +1,247 @@
+// File: SyntheticReads.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Implementation of the synthetic reads.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+// system includes
+#include <fstream>
+#include <sstream>
+#include <string>
+
+// local includes
+#include "SyntheticReads.h"
+#include "SeqUtils.h"
+#include "Exception.h"
+
+void defaultSyntheticParams(SyntheticParams& params)
+{
+    params.seed = 42;
+    params.numFamilies = 4;
+    params.arraysPerFamily = 2;
+    params.minSpacers = 10;
+    params.maxSpacers = 40;
+    params.minDRLength = 28;
+    params.maxDRLength = 37;
+    params.minSpacerLength = 30;
+    params.maxSpacerLength = 40;
+    params.flankLength = 300;
+    params.readLength = 150;
+    params.coverage = 20;
+    params.errorRate = 0.001;
+    params.backgroundReads = 200000;
+}
+
+SyntheticReads::SyntheticReads(const SyntheticParams& params)
+{
+    mParams = params;
+    mState = (params.seed == 0) ? 1 : params.seed;
+    mNumReads = 0;
+    mNumCrisprReads = 0;
+    // the first few numbers from a small seed are small too
+    for (int i = 0; i < 16; ++i)
+    {
+        next();
+    }
+
+    //-----
+    // the repeats, then the arrays of each family
+    //
+    for (int family = 0; family < mParams.numFamilies; ++family)
+    {
+        mRepeats.push_back(randomSequence(between(mParams.minDRLength, mParams.maxDRLength)));
+    }
+    for (int family = 0; family < mParams.numFamilies; ++family)
+    {
+        for (int a = 0; a < mParams.arraysPerFamily; ++a)
+        {
+            std::string array = randomSequence(mParams.flankLength) + mRepeats[family];
+            int num_spacers = between(mParams.minSpacers, mParams.maxSpacers);
+            for (int s = 0; s < num_spacers; ++s)
+            {
+                std::string spacer = randomSequence(between(mParams.minSpacerLength, mParams.maxSpacerLength));
+                mSpacers.push_back(spacer);
+                array += spacer + mRepeats[family];
+            }
+            array += randomSequence(mParams.flankLength);
+            mArrays.push_back(array);
+            mArrayFamilies.push_back(family);
+        }
+    }
+}
+
+unsigned int SyntheticReads::next(void)
+{
+    mState ^= mState << 13;
+    mState ^= mState >> 17;
+    mState ^= mState << 5;
+    return mState;
+}
+
+int SyntheticReads::between(int low, int high)
+{
+    if (high <= low)
+    {
+        return low;
+    }
+    return low + static_cast<int>(next() % static_cast<unsigned int>(high - low + 1));
+}
+
+std::string SyntheticReads::randomSequence(int length)
+{
+    const char bases[4] = {'A', 'C', 'G', 'T'};
+    std::string seq(length, 'A');
+    for (int i = 0; i < length; ++i)
+    {
+        seq[i] = bases[next() >> 30];
+    }
+    return seq;
+}
+
+void SyntheticReads::write(const std::string& fileName)
+{
+    std::ofstream out(fileName.c_str());
+    if (! out.good())
+    {
+        std::stringstream ss;
+        ss<<"Could not write the synthetic reads to "<<fileName;
+        throw crispr::exception(__FILE__,
+                                __LINE__,
+                                __PRETTY_FUNCTION__,
+                                ss);
+    }
+
+    //-----
+    // the reads left to take from each array, the background reads are
+    // mixed in by choosing each read in proportion to what is left
+    //
+    std::vector<long> array_reads;
+    long crispr_reads = 0;
+    for (size_t i = 0; i < mArrays.size(); ++i)
+    {
+        long num = static_cast<long>(mParams.coverage * mArrays[i].length() / mParams.readLength + 0.5);
+        array_reads.push_back(num);
+        crispr_reads += num;
+    }
+    long background_reads = mParams.backgroundReads;
+    mNumCrisprReads = crispr_reads;
+    mNumReads = crispr_reads + background_reads;
+
+    const char bases[4] = {'A', 'C', 'G', 'T'};
+    std::string quality(mParams.readLength, 'I');
+    for (long r = 0; r < mNumReads; ++r)
+    {
+        long left = crispr_reads + background_reads;
+        long pick = static_cast<long>(next() / 4294967296.0 * left);
+        std::string seq;
+        std::string source;
+        if (pick < crispr_reads)
+        {
+            size_t a = 0;
+            while (pick >= array_reads[a])
+            {
+                pick -= array_reads[a];
+                ++a;
+            }
+            array_reads[a]--;
+            crispr_reads--;
+            const std::string& array = mArrays[a];
+            int start = between(0, static_cast<int>(array.length()) - mParams.readLength);
+            seq = array.substr(start, mParams.readLength);
+            bool reverse = (next() & 1);
+            if (reverse)
+            {
+                seq = reverseComplement(seq);
+            }
+            std::stringstream ss;
+            ss<<"family="<<mArrayFamilies[a]<<" array="<<a<<" start="<<start<<" strand="<<((reverse) ? '-' : '+');
+            source = ss.str();
+        }
+        else
+        {
+            background_reads--;
+            seq = randomSequence(mParams.readLength);
+            source = "background";
+        }
+
+        std::string qual = quality.substr(0, seq.length());
+        for (size_t i = 0; i < seq.length(); ++i)
+        {
+            if (next() / 4294967296.0 < mParams.errorRate)
+            {
+                // one of the other three bases
+                char base = bases[next() >> 30];
+                while (base == seq[i])
+                {
+                    base = bases[next() >> 30];
+                }
+                seq[i] = base;
+                qual[i] = '5';
+            }
+        }
+        out<<"@synthetic_"<<r<<" "<<source<<"\n"<<seq<<"\n+\n"<<qual<<"\n";
+    }
+    out.close();
+    if (out.fail())
+    {
+        std::stringstream ss;
+        ss<<"Could not write the synthetic reads to "<<fileName;
+        throw crispr::exception(__FILE__,
+                                __LINE__,
+                                __PRETTY_FUNCTION__,
+                                ss);
+    }
+}
+
+void SyntheticReads::writeTruth(const std::string& fileName)
+{
+    std::ofstream out(fileName.c_str());
+    if (! out.good())
+    {
+        std::stringstream ss;
+        ss<<"Could not write the planted sequences to "<<fileName;
+        throw crispr::exception(__FILE__,
+                                __LINE__,
+                                __PRETTY_FUNCTION__,
+                                ss);
+    }
+    for (size_t i = 0; i < mRepeats.size(); ++i)
+    {
+        out<<">DR_"<<i<<"\n"<<mRepeats[i]<<"\n";
+    }
+    for (size_t i = 0; i < mSpacers.size(); ++i)
+    {
+        out<<">SP_"<<i<<"\n"<<mSpacers[i]<<"\n";
+    }
+}
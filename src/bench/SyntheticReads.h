@@ -0,0 +1,104 @@
+// File: SyntheticReads.h
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Makes a metagenome-like fastq file with CRISPR arrays planted in it
+// for the benchmarks. Each DR family has its own random repeat and a
+// number of arrays, each array its own spacers and some random flanking
+// sequence. Reads are taken from both strands of the arrays at the
+// requested coverage, mixed in with random background reads and given
+// substitution errors. Everything comes from the seed, the same
+// settings always make the same file on any machine.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+#ifndef SyntheticReads_h
+#define SyntheticReads_h
+
+// system includes
+#include <string>
+#include <vector>
+
+// local includes
+#include "Types.h"
+
+typedef struct {
+    unsigned int seed;
+    int numFamilies;                                        // DR families, each with its own repeat
+    int arraysPerFamily;
+    int minSpacers;                                         // per array
+    int maxSpacers;
+    int minDRLength;
+    int maxDRLength;
+    int minSpacerLength;
+    int maxSpacerLength;
+    int flankLength;                                        // random sequence either side of each array
+    int readLength;
+    double coverage;                                        // of each array
+    double errorRate;                                       // substitutions per base
+    long backgroundReads;                                   // reads without a CRISPR
+} SyntheticParams;
+
+// the settings 'make bench' uses
+void defaultSyntheticParams(SyntheticParams& params);
+
+class SyntheticReads
+{
+    public:
+        SyntheticReads(const SyntheticParams& params);
+        ~SyntheticReads(void) {}
+
+        void write(const std::string& fileName);            // the fastq file, throws if it can't be written
+        void writeTruth(const std::string& fileName);       // the planted repeats and spacers as fasta
+
+        inline const Vecstr& repeats(void) const { return mRepeats; }
+        inline const Vecstr& spacers(void) const { return mSpacers; }
+        inline long numReads(void) const { return mNumReads; }
+        inline long numCrisprReads(void) const { return mNumCrisprReads; }
+
+    private:
+        unsigned int next(void);                            // xorshift, the same everywhere unlike rand()
+        int between(int low, int high);                     // inclusive
+        std::string randomSequence(int length);
+
+        // members
+        SyntheticParams mParams;
+        unsigned int mState;
+        Vecstr mRepeats;                                    // one per family
+        Vecstr mSpacers;                                    // every planted spacer
+        Vecstr mArrays;                                     // flank, the array and flank again
+        std::vector<int> mArrayFamilies;                    // which repeat each array uses
+        long mNumReads;                                     // set by write()
+        long mNumCrisprReads;
+};
+
+#endif //SyntheticReads_h
@@ -0,0 +1,430 @@
+// File: bench_crass.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// End to end benchmark. A synthetic metagenome with planted CRISPR
+// arrays is written and crass is run over it. The time and peak memory
+// of each stage of doWork, the run's counters, the reads per second and
+// how many of the planted repeats and spacers came out in the crispr
+// file are written as JSON (bench_crass.json unless --json is given).
+// The settings are seeded so runs of different versions see the same
+// reads:
+//
+//     bench-crass --background 5000000 --coverage 50 --threads 8
+//
+// --writeReads FILE only writes the reads, and the planted sequences
+// to FILE.truth.fa, for running crass by hand.
+//
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+// system includes
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <getopt.h>
+#include <unistd.h>
+#include <dirent.h>
+
+// local includes
+#include "SyntheticReads.h"
+#include "WorkHorse.h"
+#include "Metrics.h"
+#include "streamreader.h"
+#include "SeqUtils.h"
+#include "LoggerSimp.h"
+#include "Exception.h"
+#include "crassDefines.h"
+
+#define BENCH_DIR_TEMPLATE          "bench_crass_XXXXXX"
+#define BENCH_JSON_FILE             "bench_crass.json"
+#define BENCH_SPACER_SLOP           4                       // a spacer can be this much shorter or longer when its repeat is
+
+static struct option bench_options[] = {
+    {"seed", required_argument, NULL, 0},
+    {"families", required_argument, NULL, 0},
+    {"arrays", required_argument, NULL, 0},
+    {"minSpacers", required_argument, NULL, 0},
+    {"maxSpacers", required_argument, NULL, 0},
+    {"coverage", required_argument, NULL, 0},
+    {"errorRate", required_argument, NULL, 0},
+    {"background", required_argument, NULL, 0},
+    {"readLength", required_argument, NULL, 0},
+    {"threads", required_argument, NULL, 0},
+    {"json", required_argument, NULL, 0},
+    {"writeReads", required_argument, NULL, 0},
+    {"keep", no_argument, NULL, 0},
+    {"help", no_argument, NULL, 'h'},
+    {NULL, no_argument, NULL, 0}
+};
+
+static void usage(void)
+{
+    SyntheticParams params;
+    defaultSyntheticParams(params);
+    std::cout<<"Usage: bench-crass [options]"<<std::endl;
+    std::cout<<"--seed        <INT>   Seed for the synthetic reads [Default: "<<params.seed<<"]"<<std::endl;
+    std::cout<<"--families    <INT>   Number of DR families [Default: "<<params.numFamilies<<"]"<<std::endl;
+    std::cout<<"--arrays      <INT>   Arrays in each family [Default: "<<params.arraysPerFamily<<"]"<<std::endl;
+    std::cout<<"--minSpacers  <INT>   Fewest spacers in an array [Default: "<<params.minSpacers<<"]"<<std::endl;
+    std::cout<<"--maxSpacers  <INT>   Most spacers in an array [Default: "<<params.maxSpacers<<"]"<<std::endl;
+    std::cout<<"--coverage    <REAL>  Read coverage of each array [Default: "<<params.coverage<<"]"<<std::endl;
+    std::cout<<"--errorRate   <REAL>  Substitutions per base [Default: "<<params.errorRate<<"]"<<std::endl;
+    std::cout<<"--background  <INT>   Reads without a CRISPR [Default: "<<params.backgroundReads<<"]"<<std::endl;
+    std::cout<<"--readLength  <INT>   [Default: "<<params.readLength<<"]"<<std::endl;
+    std::cout<<"--threads     <INT>   Threads crass uses [Default: "<<CRASS_DEF_NUM_THREADS<<"]"<<std::endl;
+    std::cout<<"--json        <FILE>  Where the report goes [Default: "<<BENCH_JSON_FILE<<"]"<<std::endl;
+    std::cout<<"--writeReads  <FILE>  Only write the reads, and the planted sequences to FILE.truth.fa"<<std::endl;
+    std::cout<<"--keep                Keep the reads and the crass output"<<std::endl;
+}
+
+//-----
+// everything crass finds, read back out of the crispr file
+//
+struct BenchOutput {
+    Vecstr repeats;
+    Vecstr spacers;
+    int groups;
+};
+
+static void collectData(crispr::xml::base& xmlObj, xercesc::DOMElement * parent, Vecstr& sequences)
+{
+    for (xercesc::DOMElement * element = parent->getFirstElementChild(); element != NULL; element = element->getNextElementSibling())
+    {
+        char * c_seq = tc(element->getAttribute(xmlObj.attr_Seq()));
+        sequences.push_back(c_seq);
+        xr(&c_seq);
+    }
+}
+
+static bool collectGroup(xercesc::DOMElement * group, crispr::xml::base& xmlObj, void * context)
+{
+    BenchOutput * output = static_cast<BenchOutput *>(context);
+    output->groups++;
+    for (xercesc::DOMElement * element = group->getFirstElementChild(); element != NULL; element = element->getNextElementSibling())
+    {
+        if (! xercesc::XMLString::equals(element->getTagName(), xmlObj.tag_Data()))
+        {
+            continue;
+        }
+        for (xercesc::DOMElement * data = element->getFirstElementChild(); data != NULL; data = data->getNextElementSibling())
+        {
+            if (xercesc::XMLString::equals(data->getTagName(), xmlObj.tag_Drs()))
+            {
+                collectData(xmlObj, data, output->repeats);
+            }
+            else if (xercesc::XMLString::equals(data->getTagName(), xmlObj.tag_Spacers()))
+            {
+                collectData(xmlObj, data, output->spacers);
+            }
+        }
+    }
+    return true;
+}
+
+// crass may put the ends of the repeat a base or two away from where
+// they were planted, which moves the ends of every spacer as well
+static bool similar(const std::string& planted, const std::string& found)
+{
+    int diff = static_cast<int>(planted.length()) - static_cast<int>(found.length());
+    if (diff > BENCH_SPACER_SLOP || diff < -BENCH_SPACER_SLOP)
+    {
+        return false;
+    }
+    std::string found_rc = reverseComplement(found);
+    if (diff >= 0)
+    {
+        return planted.find(found) != std::string::npos || planted.find(found_rc) != std::string::npos;
+    }
+    return found.find(planted) != std::string::npos || found_rc.find(planted) != std::string::npos;
+}
+
+static int recalled(const Vecstr& planted, const Vecstr& found)
+{
+    int count = 0;
+    Vecstr::const_iterator planted_iter;
+    for (planted_iter = planted.begin(); planted_iter != planted.end(); ++planted_iter)
+    {
+        Vecstr::const_iterator found_iter;
+        for (found_iter = found.begin(); found_iter != found.end(); ++found_iter)
+        {
+            if (similar(*planted_iter, *found_iter))
+            {
+                count++;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+// crass only writes files into its output directory
+static void removeDirectory(const std::string& dirName)
+{
+    DIR * dir = opendir(dirName.c_str());
+    if (dir != NULL)
+    {
+        struct dirent * entry;
+        while ((entry = readdir(dir)) != NULL)
+        {
+            if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+            {
+                remove((dirName + entry->d_name).c_str());
+            }
+        }
+        closedir(dir);
+    }
+    if (rmdir(dirName.c_str()) != 0)
+    {
+        std::cerr<<"[WARNING]: "<<dirName<<" could not be removed"<<std::endl;
+    }
+}
+
+static void setOptions(options& opts, int numThreads, const std::string& outputDir)
+{
+    // the same as crass with no options
+    opts.logLevel              = 0;
+    opts.reportStats           = CRASS_DEF_STATS_REPORT;
+    opts.lowDRsize             = CRASS_DEF_MIN_DR_SIZE;
+    opts.highDRsize            = CRASS_DEF_MAX_DR_SIZE;
+    opts.lowSpacerSize         = CRASS_DEF_MIN_SPACER_SIZE;
+    opts.highSpacerSize        = CRASS_DEF_MAX_SPACER_SIZE;
+    opts.output_fastq          = outputDir;
+    opts.delim                 = CRASS_DEF_STATS_REPORT_DELIM;
+    opts.kmer_clust_size       = CRASS_DEF_K_CLUST_MIN;
+    opts.searchWindowLength    = CRASS_DEF_OPTIMAL_SEARCH_WINDOW_LENGTH;
+    opts.minNumRepeats         = CRASS_DEF_DEFAULT_MIN_NUM_REPEATS;
+    opts.logToScreen           = false;
+    opts.coverageBins          = CRASS_DEF_NUM_OF_BINS;
+    opts.graphColourType       = CRASS_DEF_GRAPH_COLOUR;
+    opts.longDescription       = CRASS_DEF_SPACER_LONG_DESC;
+    opts.showSingles           = CRASS_DEF_SPACER_SHOW_SINGLES;
+    opts.cNodeKmerLength       = CRASS_DEF_NODE_KMER_SIZE;
+#ifdef DEBUG
+    opts.noDebugGraph          = true;
+#endif
+#ifdef SEARCH_SINGLETON
+    opts.searchChecker         = "";
+#endif
+#ifdef RENDERING
+    opts.layoutAlgorithm       = DEFAULT_RENDERING_ALGORITHM;
+    opts.noRendering           = true;
+#else
+    opts.layoutAlgorithm       = "unset";
+#endif
+    opts.covCutoff             = CRASS_DEF_COVCUTOFF;
+    opts.numThreads            = numThreads;
+    opts.singlePass            = CRASS_DEF_SINGLE_PASS;
+    opts.searchEngine          = CRASS_DEF_SEARCH_ENGINE;
+    opts.checkpoint            = CRASS_DEF_CHECKPOINT;
+    opts.resume                = CRASS_DEF_RESUME;
+    opts.drLibrary             = "";
+    opts.knownRepeats          = "";
+    opts.subsample             = CRASS_DEF_SUBSAMPLE;
+    opts.metrics               = "";
+}
+
+int main(int argc, char ** argv)
+{
+    SyntheticParams params;
+    defaultSyntheticParams(params);
+    int num_threads = CRASS_DEF_NUM_THREADS;
+    std::string json_file = BENCH_JSON_FILE;
+    std::string reads_file;
+    bool keep = false;
+
+    int c;
+    int index;
+    while ((c = getopt_long(argc, argv, "h", bench_options, &index)) != -1)
+    {
+        if (c != 0)
+        {
+            usage();
+            return (c == 'h') ? 0 : 1;
+        }
+        std::string name = bench_options[index].name;
+        if (name == "seed") params.seed = static_cast<unsigned int>(strtoul(optarg, NULL, 10));
+        else if (name == "families") params.numFamilies = atoi(optarg);
+        else if (name == "arrays") params.arraysPerFamily = atoi(optarg);
+        else if (name == "minSpacers") params.minSpacers = atoi(optarg);
+        else if (name == "maxSpacers") params.maxSpacers = atoi(optarg);
+        else if (name == "coverage") params.coverage = atof(optarg);
+        else if (name == "errorRate") params.errorRate = atof(optarg);
+        else if (name == "background") params.backgroundReads = atol(optarg);
+        else if (name == "readLength") params.readLength = atoi(optarg);
+        else if (name == "threads") num_threads = atoi(optarg);
+        else if (name == "json") json_file = optarg;
+        else if (name == "writeReads") reads_file = optarg;
+        else if (name == "keep") keep = true;
+    }
+
+    SyntheticReads synthetic(params);
+    try {
+        if (! reads_file.empty())
+        {
+            synthetic.write(reads_file);
+            synthetic.writeTruth(reads_file + ".truth.fa");
+            std::cout<<"["<<PACKAGE_NAME<<"_bench]: "<<synthetic.numReads()<<" reads, "<<synthetic.numCrisprReads()<<" from "<<synthetic.spacers().size()<<" planted spacers, written to "<<reads_file<<std::endl;
+            return 0;
+        }
+    } catch (crispr::exception& e) {
+        std::cerr<<e.what()<<std::endl;
+        return 1;
+    }
+
+    //-----
+    // write the reads and run crass over them
+    //
+    char dir_template[] = BENCH_DIR_TEMPLATE;
+    if (mkdtemp(dir_template) == NULL)
+    {
+        std::cerr<<"[ERROR]: could not make a directory for the benchmark"<<std::endl;
+        return 1;
+    }
+    std::string output_dir = std::string(dir_template) + "/";
+    std::string fastq = output_dir + "synthetic.fq";
+    double start = Metrics::now();
+    try {
+        synthetic.write(fastq);
+    } catch (crispr::exception& e) {
+        std::cerr<<e.what()<<std::endl;
+        return 1;
+    }
+    double generate_seconds = Metrics::now() - start;
+    std::cout<<"["<<PACKAGE_NAME<<"_bench]: "<<synthetic.numReads()<<" reads, "<<synthetic.numCrisprReads()<<" from "<<synthetic.spacers().size()<<" planted spacers"<<std::endl;
+
+    options opts;
+    setOptions(opts, num_threads, output_dir);
+    intialiseGlobalLogger("", 0);
+    Vecstr seq_files;
+    seq_files.push_back(fastq);
+    WorkHorse * horse = new WorkHorse(&opts, "bench", "bench-crass");
+    int error_code;
+    try {
+        error_code = horse->doWork(seq_files);
+    } catch (crispr::exception& e) {
+        std::cerr<<e.what()<<std::endl;
+        error_code = 1;
+    }
+    Metrics metrics = horse->metrics();
+    delete horse;
+
+    BenchOutput output;
+    output.groups = 0;
+    std::string crispr_file = output_dir + PACKAGE_NAME + CRASS_DEF_CRISPR_EXT;
+    if (error_code == 0)
+    {
+        try {
+            crispr::xml::streamreader reader;
+            reader.parse(crispr_file.c_str(), collectGroup, &output);
+        } catch (crispr::xml_exception& e) {
+            std::cerr<<e.what()<<std::endl;
+            error_code = 1;
+        }
+    }
+
+    //-----
+    // the report
+    //
+    double total_seconds = metrics.totalSeconds();
+    double search_seconds = 0;
+    std::vector<PhaseMetrics>::const_iterator phase_iter;
+    for (phase_iter = metrics.phases().begin(); phase_iter != metrics.phases().end(); ++phase_iter)
+    {
+        if (phase_iter->name == "parseSeqFiles")
+        {
+            search_seconds = phase_iter->seconds;
+        }
+    }
+    int repeats_recalled = recalled(synthetic.repeats(), output.repeats);
+    int spacers_recalled = recalled(synthetic.spacers(), output.spacers);
+
+    std::stringstream json;
+    json<<"{"<<std::endl;
+    json<<"  \"version\": \""<<PACKAGE_VERSION<<"\","<<std::endl;
+    json<<"  \"exitCode\": "<<error_code<<","<<std::endl;
+    json<<"  \"settings\": {\"seed\": "<<params.seed
+        <<", \"families\": "<<params.numFamilies
+        <<", \"arraysPerFamily\": "<<params.arraysPerFamily
+        <<", \"minSpacers\": "<<params.minSpacers
+        <<", \"maxSpacers\": "<<params.maxSpacers
+        <<", \"coverage\": "<<params.coverage
+        <<", \"errorRate\": "<<params.errorRate
+        <<", \"backgroundReads\": "<<params.backgroundReads
+        <<", \"readLength\": "<<params.readLength
+        <<", \"threads\": "<<num_threads<<"},"<<std::endl;
+    json<<"  \"reads\": "<<synthetic.numReads()<<","<<std::endl;
+    json<<"  \"crisprReads\": "<<synthetic.numCrisprReads()<<","<<std::endl;
+    json<<"  \"generateSeconds\": "<<generate_seconds<<","<<std::endl;
+    json<<"  \"phases\": ["<<std::endl;
+    for (phase_iter = metrics.phases().begin(); phase_iter != metrics.phases().end(); ++phase_iter)
+    {
+        json<<"    {\"name\": \""<<phase_iter->name<<"\", \"seconds\": "<<phase_iter->seconds<<", \"peakRSSKB\": "<<phase_iter->peakRSS<<"}";
+        json<<((phase_iter + 1 == metrics.phases().end()) ? "" : ",")<<std::endl;
+    }
+    json<<"  ],"<<std::endl;
+    json<<"  \"totalSeconds\": "<<total_seconds<<","<<std::endl;
+    json<<"  \"readsPerSecond\": "<<((total_seconds > 0) ? synthetic.numReads() / total_seconds : 0)<<","<<std::endl;
+    json<<"  \"searchReadsPerSecond\": "<<((search_seconds > 0) ? synthetic.numReads() / search_seconds : 0)<<","<<std::endl;
+    json<<"  \"peakRSSKB\": "<<metrics.peakRSS()<<","<<std::endl;
+    json<<"  \"counters\": {";
+    std::vector<MetricsCounter>::const_iterator counter_iter;
+    for (counter_iter = metrics.counters().begin(); counter_iter != metrics.counters().end(); ++counter_iter)
+    {
+        json<<((counter_iter == metrics.counters().begin()) ? "" : ", ")<<"\""<<counter_iter->first<<"\": "<<counter_iter->second;
+    }
+    json<<"},"<<std::endl;
+    json<<"  \"groups\": "<<output.groups<<","<<std::endl;
+    json<<"  \"plantedRepeats\": "<<synthetic.repeats().size()<<","<<std::endl;
+    json<<"  \"recalledRepeats\": "<<repeats_recalled<<","<<std::endl;
+    json<<"  \"plantedSpacers\": "<<synthetic.spacers().size()<<","<<std::endl;
+    json<<"  \"recalledSpacers\": "<<spacers_recalled<<","<<std::endl;
+    json<<"  \"spacerRecall\": "<<((synthetic.spacers().empty()) ? 1.0 : static_cast<double>(spacers_recalled) / synthetic.spacers().size())<<std::endl;
+    json<<"}"<<std::endl;
+
+    std::ofstream json_out(json_file.c_str());
+    json_out<<json.str();
+    json_out.close();
+    std::cout<<std::endl<<json.str();
+
+    if (keep)
+    {
+        std::cout<<"["<<PACKAGE_NAME<<"_bench]: The reads and the crass output are in "<<output_dir<<std::endl;
+    }
+    else
+    {
+        removeDirectory(output_dir);
+    }
+    return (error_code == 0) ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+// File: bench_mappedreader.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Benchmark for the first pass over an uncompressed fastq file. A
+// synthetic file of the requested size (in MB, 256 by default) is
+// written, where one read in a hundred has a CRISPR in it. It is then
+// read with kseq, copying every read into a ReadHolder the way the
+// search used to, and out of a memory map, where only the reads with a
+// repeated search window are copied. Both search every copied read and
+// the reads per second of each are reported. Make the file bigger than
+// the page cache to see what the disk can do:
+//
+//     bench-mappedreader 51200
+//
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+// system includes
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <sys/time.h>
+
+// local includes
+#include "libcrispr.h"
+#include "MappedReader.h"
+#include "GzipReader.h"
+#include "ReadBatch.h"
+#include "kseq.h"
+#include "LoggerSimp.h"
+#include "crassDefines.h"
+
+#define BENCH_FILE_NAME             "bench_mappedreader.fq"
+#define BENCH_DEFAULT_MB            256
+#define BENCH_READ_LENGTH           150
+#define BENCH_CRISPR_EVERY          100
+
+static std::string randomSequence(int length)
+{
+    const char bases[4] = {'A', 'C', 'G', 'T'};
+    std::string seq(length, 'A');
+    for (int i = 0; i < length; i++)
+    {
+        seq[i] = bases[rand() % 4];
+    }
+    return seq;
+}
+
+// wall clock, the kseq reader decodes on a thread of its own
+static double seconds(void)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec + now.tv_usec / 1000000.0;
+}
+
+struct BenchCounts {
+    long reads;
+    long copied;
+    long found;
+};
+
+static void search(const ReadView& read, const options& opts, KmerRepeatFinder& kmerFinder, BenchCounts& counts)
+{
+    ReadHolder tmp_holder;
+    fillReadHolder(read, tmp_holder);
+    counts.copied++;
+    if (searchCore(tmp_holder, opts, kmerFinder))
+    {
+        counts.found++;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    long target_mb = (argc > 1) ? atol(argv[1]) : BENCH_DEFAULT_MB;
+
+    options opts;
+    opts.logLevel = 0;
+    opts.lowDRsize = CRASS_DEF_MIN_DR_SIZE;
+    opts.highDRsize = CRASS_DEF_MAX_DR_SIZE;
+    opts.lowSpacerSize = CRASS_DEF_MIN_SPACER_SIZE;
+    opts.highSpacerSize = CRASS_DEF_MAX_SPACER_SIZE;
+    opts.searchWindowLength = CRASS_DEF_OPTIMAL_SEARCH_WINDOW_LENGTH;
+    opts.minNumRepeats = CRASS_DEF_DEFAULT_MIN_NUM_REPEATS;
+    opts.numThreads = 1;
+    opts.searchEngine = CRT_ENGINE;
+    opts.subsample = CRASS_DEF_SUBSAMPLE;
+    intialiseGlobalLogger("", 0);
+
+    //-----
+    // write the synthetic file
+    //
+    srand(42);
+    long num_reads = 0;
+    {
+        std::string dr = "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC";
+        std::string quality(BENCH_READ_LENGTH, 'I');
+        std::ofstream out(BENCH_FILE_NAME);
+        while (static_cast<long>(out.tellp()) < target_mb * 1024 * 1024)
+        {
+            std::string seq;
+            if (num_reads % BENCH_CRISPR_EVERY == 0)
+            {
+                seq = dr + randomSequence(27) + dr + randomSequence(27) + dr;
+                seq += randomSequence(BENCH_READ_LENGTH - static_cast<int>(seq.length()));
+            }
+            else
+            {
+                seq = randomSequence(BENCH_READ_LENGTH);
+            }
+            out << "@HWI-ST1234:8:1101:" << rand() << ":" << num_reads << " 1:N:0\n" << seq << "\n+\n" << quality << "\n";
+            num_reads++;
+        }
+    }
+    std::cout<<"["<<PACKAGE_NAME<<"_bench]: "<<target_mb<<" MB fastq file with "<<num_reads<<" reads"<<std::endl;
+
+    int retval = 0;
+    KmerRepeatFinder kmer_finder;
+    ReadView read;
+
+    //-----
+    // every read copied out of kseq
+    //
+    BenchCounts kseq_counts = {0, 0, 0};
+    double start = seconds();
+    GzipReader reader;
+    reader.open(BENCH_FILE_NAME);
+    kseq_t * seq = kseq_init(&reader);
+    while (kseq_read(seq) >= 0)
+    {
+        read.assign(seq);
+        kseq_counts.reads++;
+        search(read, opts, kmer_finder, kseq_counts);
+    }
+    kseq_destroy(seq);
+    reader.close();
+    double kseq_seconds = seconds() - start;
+    std::cout<<"kseq:   "<<kseq_seconds<<" sec, "<<kseq_counts.reads / kseq_seconds<<" reads/sec, "<<kseq_counts.copied<<" reads copied, "<<kseq_counts.found<<" found"<<std::endl;
+
+    //-----
+    // only the reads worth searching copied out of the map
+    //
+    BenchCounts mapped_counts = {0, 0, 0};
+    start = seconds();
+    MappedReader mapped;
+    if (! mapped.open(BENCH_FILE_NAME))
+    {
+        std::cerr<<"[ERROR]: could not map "<<BENCH_FILE_NAME<<std::endl;
+        remove(BENCH_FILE_NAME);
+        return 1;
+    }
+    while (mapped.next(read))
+    {
+        mapped_counts.reads++;
+        if (hasRepeatedWindow(read.mSeq, static_cast<unsigned int>(read.mSeqLength), opts))
+        {
+            search(read, opts, kmer_finder, mapped_counts);
+        }
+    }
+    mapped.close();
+    double mapped_seconds = seconds() - start;
+    std::cout<<"mapped: "<<mapped_seconds<<" sec, "<<mapped_counts.reads / mapped_seconds<<" reads/sec, "<<mapped_counts.copied<<" reads copied, "<<mapped_counts.found<<" found"<<std::endl;
+
+    if (kseq_counts.reads != num_reads || mapped_counts.reads != num_reads || kseq_counts.found != mapped_counts.found)
+    {
+        std::cerr<<"[ERROR]: the two readers saw different files"<<std::endl;
+        retval = 1;
+    }
+    remove(BENCH_FILE_NAME);
+    return retval;
+}
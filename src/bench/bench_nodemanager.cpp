@@ -0,0 +1,148 @@
+// File: bench_nodemanager.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+//
+// OVERVIEW:
+//
+// Benchmark for building and tearing down the spacer graph of one
+// large group. Reads are cut from a long random CRISPR with a sprinkle
+// of sequencing errors in the spacers so that there are plenty of
+// nodes and spacers, made in a ReadHolderPool and added to a
+// NodeManager. The time to build the graph, to clean it and to delete
+// the NodeManager and the reads are reported separately.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+// system includes
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+#include <ctime>
+
+// local includes
+#include "NodeManager.h"
+#include "ReadHolder.h"
+#include "Types.h"
+#include "LoggerSimp.h"
+#include "crassDefines.h"
+
+#define BENCH_NUM_READS         200000
+#define BENCH_NUM_SPACERS       20000
+#define BENCH_SPACER_LENGTH     34
+#define BENCH_SPACERS_PER_READ  3
+#define BENCH_ERROR_RATE        100                         // one read in this many has a spacer with an error
+
+static double secondsSince(clock_t start)
+{
+    return static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char ** argv)
+{
+    intialiseGlobalLogger("", 0);
+    options opts;
+    opts.cNodeKmerLength = CRASS_DEF_NODE_KMER_SIZE;
+
+    //-----
+    // one long array of unique spacers, every read is a window of it
+    //
+    srand(42);
+    const char bases[4] = {'A', 'C', 'G', 'T'};
+    std::string repeat = "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC";
+    std::vector<std::string> spacers(BENCH_NUM_SPACERS);
+    for (size_t i = 0; i < spacers.size(); ++i)
+    {
+        spacers[i].resize(BENCH_SPACER_LENGTH);
+        for (size_t k = 0; k < spacers[i].length(); ++k)
+        {
+            spacers[i][k] = bases[rand() % 4];
+        }
+    }
+
+    ReadHolderPool read_pool;
+    ReadList reads;
+    reads.reserve(BENCH_NUM_READS);
+    for (int i = 0; i < BENCH_NUM_READS; ++i)
+    {
+        size_t first = rand() % (BENCH_NUM_SPACERS - BENCH_SPACERS_PER_READ);
+        std::string seq;
+        std::vector<unsigned int> repeat_starts;
+        for (size_t s = first; s < first + BENCH_SPACERS_PER_READ; ++s)
+        {
+            repeat_starts.push_back(static_cast<unsigned int>(seq.length()));
+            seq += repeat;
+            std::string spacer = spacers[s];
+            if (i % BENCH_ERROR_RATE == 0)
+            {
+                spacer[rand() % spacer.length()] = bases[rand() % 4];
+            }
+            seq += spacer;
+        }
+        repeat_starts.push_back(static_cast<unsigned int>(seq.length()));
+        seq += repeat;
+        std::stringstream header;
+        header<<"read_"<<i;
+        ReadHolder * holder = read_pool.construct(seq, header.str());
+        std::vector<unsigned int>::iterator start_iter;
+        for (start_iter = repeat_starts.begin(); start_iter != repeat_starts.end(); ++start_iter)
+        {
+            holder->startStopsAdd(*start_iter, *start_iter + static_cast<unsigned int>(repeat.length()) - 1);
+        }
+        holder->pack();
+        reads.push_back(holder);
+    }
+
+    clock_t start = clock();
+    NodeManager * manager = new NodeManager(repeat, &opts);
+    ReadListIterator read_iter;
+    for (read_iter = reads.begin(); read_iter != reads.end(); ++read_iter)
+    {
+        manager->addReadHolder(*read_iter);
+    }
+    double build_seconds = secondsSince(start);
+
+    start = clock();
+    manager->cleanGraph();
+    double clean_seconds = secondsSince(start);
+
+    start = clock();
+    delete manager;
+    reads.clear();
+    read_pool.clear();
+    double teardown_seconds = secondsSince(start);
+
+    std::cout<<"["<<PACKAGE_NAME<<"_bench]: spacer graph of one group, "<<BENCH_NUM_READS<<" reads"<<std::endl;
+    std::cout<<"build:    "<<build_seconds<<" sec"<<std::endl;
+    std::cout<<"clean:    "<<clean_seconds<<" sec"<<std::endl;
+    std::cout<<"teardown: "<<teardown_seconds<<" sec"<<std::endl;
+    return 0;
+}
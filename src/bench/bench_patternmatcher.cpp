@@ -0,0 +1,207 @@
+// File: bench_patternmatcher.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Microbenchmark for the Boyer-Moore search done in searchCore. Every
+// search window of a set of random reads is searched the old way
+// (substr copies and a bad character table allocated per search) and
+// the new way (views into the read and a table on the stack) and the
+// number of windows searched per second is reported for both.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+// system includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+
+// local includes
+#include "PatternMatcher.h"
+#include "crassDefines.h"
+
+#define BENCH_NUM_READS     20000
+#define BENCH_READ_LENGTH   150
+#define BENCH_ROUNDS        5
+
+// the search as it was before the precomputed tables, kept here so that
+// the two can be compared in the same binary
+static std::vector<int> legacyBmpLast(const std::string &pattern)
+{
+    std::vector<int> bmpLast(128);
+    for(size_t i = 0; i < 128; i++){
+        bmpLast[i] = -1;
+    }
+    for(size_t i = 0; i < pattern.size(); i++){
+        bmpLast[pattern[i]] = (int)i;
+    }
+    return bmpLast;
+}
+
+static int legacyBmpSearch(const std::string &text, const std::string &pattern)
+{
+    size_t textSize = text.size();
+    size_t patternSize = pattern.size();
+    if(textSize == 0 || patternSize == 0 || patternSize > textSize){
+        return -1;
+    }
+    std::vector<int> bmpLast = legacyBmpLast(pattern);
+    size_t tIdx = patternSize - 1;
+    size_t pIdx = patternSize - 1;
+    while(tIdx < textSize)
+    {
+        if(pattern[pIdx] == text[tIdx])
+        {
+            if(pIdx == 0)
+            {
+                return (int)tIdx;
+            }
+            tIdx--;
+            pIdx--;
+        }
+        else
+        {
+            int lastOccur = bmpLast[text[tIdx]];
+            tIdx = tIdx + patternSize - std::min<int>((int)pIdx, 1 + lastOccur);
+            pIdx = patternSize - 1;
+        }
+    }
+    return -1;
+}
+
+// walk the windows the same way searchCore does
+static long long searchWindows(std::vector<std::string>& reads, bool legacy, unsigned long long& numWindows)
+{
+    unsigned int window_length = CRASS_DEF_OPTIMAL_SEARCH_WINDOW_LENGTH;
+    unsigned int skips = CRASS_DEF_MIN_DR_SIZE - (2 * window_length - 1);
+    if (skips < 1)
+    {
+        skips = 1;
+    }
+    long long checksum = 0;
+    BmpTable bmp_last;
+    PatternMatcher::clearBmpLast(bmp_last);
+    std::vector<std::string>::iterator read_iter;
+    for (read_iter = reads.begin(); read_iter != reads.end(); ++read_iter)
+    {
+        const std::string& read = *read_iter;
+        unsigned int seq_length = static_cast<unsigned int>(read.length());
+        int search_end = seq_length - CRASS_DEF_MIN_DR_SIZE - CRASS_DEF_MIN_SPACER_SIZE - window_length - 1;
+        for (int j = 0; j <= search_end; j += skips)
+        {
+            unsigned int begin_search = j + CRASS_DEF_MIN_DR_SIZE + CRASS_DEF_MIN_SPACER_SIZE;
+            unsigned int end_search = j + CRASS_DEF_MAX_DR_SIZE + CRASS_DEF_MAX_SPACER_SIZE + window_length;
+            if (end_search >= seq_length)
+            {
+                end_search = seq_length - 1;
+            }
+            int position;
+            if (legacy)
+            {
+                std::string text = read.substr(begin_search, (end_search - begin_search));
+                std::string pattern = read.substr(j, window_length);
+                position = legacyBmpSearch(text, pattern);
+            }
+            else
+            {
+                PatternMatcher::setBmpLast(read.data() + j, window_length, bmp_last);
+                position = PatternMatcher::bmpSearch(read.data() + begin_search,
+                                                     end_search - begin_search,
+                                                     read.data() + j,
+                                                     window_length,
+                                                     bmp_last);
+                PatternMatcher::unsetBmpLast(read.data() + j, window_length, bmp_last);
+            }
+            checksum += position;
+            numWindows++;
+        }
+    }
+    return checksum;
+}
+
+static double timeSearch(std::vector<std::string>& reads, bool legacy, long long& checksum)
+{
+    unsigned long long num_windows = 0;
+    clock_t start = clock();
+    for (int round = 0; round < BENCH_ROUNDS; ++round)
+    {
+        checksum = searchWindows(reads, legacy, num_windows);
+    }
+    double seconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+    return (seconds > 0) ? num_windows / seconds : 0;
+}
+
+int main(int argc, char ** argv)
+{
+    //-----
+    // random reads with a repeat planted in every fourth one so that
+    // both the hit and the miss paths are timed
+    //
+    srand(42);
+    const char bases[4] = {'A', 'C', 'G', 'T'};
+    std::string repeat = "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC";
+    std::vector<std::string> reads(BENCH_NUM_READS);
+    for (size_t i = 0; i < reads.size(); ++i)
+    {
+        std::string& read = reads[i];
+        read.resize(BENCH_READ_LENGTH);
+        for (size_t k = 0; k < read.length(); ++k)
+        {
+            read[k] = bases[rand() % 4];
+        }
+        if (i % 4 == 0)
+        {
+            read.replace(10, repeat.length(), repeat);
+            read.replace(10 + repeat.length() + 34, repeat.length(), repeat);
+        }
+    }
+
+    long long legacy_checksum = 0;
+    long long checksum = 0;
+    double legacy_rate = timeSearch(reads, true, legacy_checksum);
+    double rate = timeSearch(reads, false, checksum);
+
+    std::cout<<"["<<PACKAGE_NAME<<"_bench]: Boyer-Moore search windows"<<std::endl;
+    std::cout<<"substr + per-search table: "<<legacy_rate<<" windows/sec"<<std::endl;
+    std::cout<<"views + precomputed table: "<<rate<<" windows/sec"<<std::endl;
+    if (legacy_rate > 0)
+    {
+        std::cout<<"speedup: "<<rate / legacy_rate<<"x"<<std::endl;
+    }
+    if (legacy_checksum != checksum)
+    {
+        std::cerr<<"[ERROR]: the two searches gave different results"<<std::endl;
+        return 1;
+    }
+    return 0;
+}
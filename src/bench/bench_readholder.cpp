@@ -0,0 +1,147 @@
+// File: bench_readholder.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Memory benchmark for the reads kept in the ReadMap. A million reads
+// shaped like the ones recruited by the search (150bp, quality scores
+// and three repeats each) are loaded into readholders, once with the
+// sequence kept as a string and once packed, each in its own process so
+// that the peak resident set size of the two can be reported.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+// system includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// local includes
+#include "ReadHolder.h"
+#include "crassDefines.h"
+
+#define BENCH_NUM_READS     1000000
+#define BENCH_READ_LENGTH   150
+
+static void loadReads(bool packed)
+{
+    srand(42);
+    const char bases[4] = {'A', 'C', 'G', 'T'};
+    std::string repeat = "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC";
+    std::string quality(BENCH_READ_LENGTH, 'I');
+    std::vector<ReadHolder *> reads;
+    reads.reserve(BENCH_NUM_READS);
+    std::string seq(BENCH_READ_LENGTH, 'A');
+    for (int i = 0; i < BENCH_NUM_READS; ++i)
+    {
+        for (size_t k = 0; k < seq.length(); ++k)
+        {
+            seq[k] = bases[rand() % 4];
+        }
+        // the odd N so that the sparse list gets used
+        if (i % 10 == 0)
+        {
+            seq[rand() % BENCH_READ_LENGTH] = 'N';
+        }
+        unsigned int start = 5;
+        for (int r = 0; r < 3; ++r)
+        {
+            seq.replace(start, repeat.length(), repeat);
+            start += static_cast<unsigned int>(repeat.length()) + 20;
+        }
+        ReadHolder * holder = new ReadHolder(seq.c_str(), "HWI-D00456:77:C70WLANXX:1:1101:10963:2182", "", quality.c_str());
+        start = 5;
+        for (int r = 0; r < 3; ++r)
+        {
+            holder->startStopsAdd(start, start + static_cast<unsigned int>(repeat.length()) - 1);
+            start += static_cast<unsigned int>(repeat.length()) + 20;
+        }
+        if (packed)
+        {
+            holder->pack();
+        }
+        reads.push_back(holder);
+    }
+    // touch every read so the work can't be skipped
+    size_t checksum = 0;
+    std::vector<ReadHolder *>::iterator read_iter;
+    for (read_iter = reads.begin(); read_iter != reads.end(); ++read_iter)
+    {
+        checksum += (*read_iter)->repeatStringAt(2).length();
+    }
+    if (checksum != static_cast<size_t>(BENCH_NUM_READS) * repeat.length())
+    {
+        exit(1);
+    }
+    exit(0);
+}
+
+// peak RSS of a child that loads the reads, in kilobytes
+static long measure(bool packed)
+{
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        loadReads(packed);
+    }
+    else if (pid < 0)
+    {
+        return -1;
+    }
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid || ! WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        return -1;
+    }
+    return usage.ru_maxrss;
+}
+
+int main(int argc, char ** argv)
+{
+    long unpacked_rss = measure(false);
+    long packed_rss = measure(true);
+    if (unpacked_rss < 0 || packed_rss < 0)
+    {
+        std::cerr<<"[ERROR]: could not load the reads"<<std::endl;
+        return 1;
+    }
+    std::cout<<"["<<PACKAGE_NAME<<"_bench]: peak RSS per million recruited reads"<<std::endl;
+    std::cout<<"string sequence: "<<unpacked_rss / 1024<<" MB"<<std::endl;
+    std::cout<<"packed sequence: "<<packed_rss / 1024<<" MB"<<std::endl;
+    std::cout<<"saving: "<<100.0 * (unpacked_rss - packed_rss) / unpacked_rss<<"%"<<std::endl;
+    return 0;
+}
@@ -0,0 +1,149 @@
+// File: bench_repeats.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Microbenchmark for removeRedundantRepeats. A synthetic group of 10k
+// DR variants is reduced with the old pairwise substring search and
+// with the Aho-Corasick automaton, both times are reported and the two
+// results must be the same.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+// system includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+
+// local includes
+#include "libcrispr.h"
+#include "SeqUtils.h"
+#include "crassDefines.h"
+
+#define BENCH_NUM_VARIANTS  10000
+#define BENCH_FLANK_LENGTH  6
+
+static bool legacyLengthAssending(const std::string& a, const std::string& b)
+{
+    return a.length() < b.length();
+}
+
+static bool legacyIsNotEmpty(const std::string& a)
+{
+    return !a.empty();
+}
+
+// every pair compared, the way removeRedundantRepeats worked before the
+// automaton, kept here so that the two can be compared in the same binary
+static void legacyRemoveRedundantRepeats(std::vector<std::string>& repeatVector)
+{
+    std::sort(repeatVector.begin(), repeatVector.end(), legacyLengthAssending);
+    std::vector<std::string>::iterator iter;
+    for (iter = repeatVector.begin(); iter != repeatVector.end(); iter++)
+    {
+        if (iter->empty())
+        {
+            continue;
+        }
+        std::vector<std::string>::iterator iter2;
+        for (iter2 = iter + 1; iter2 != repeatVector.end(); iter2++)
+        {
+            if (iter2->empty())
+            {
+                continue;
+            }
+            if (std::string::npos != iter2->find(*iter) ||
+                std::string::npos != iter2->find(reverseComplement(*iter)))
+            {
+                iter2->clear();
+            }
+        }
+    }
+    std::vector<std::string>::iterator empty_iter = std::partition(repeatVector.begin(), repeatVector.end(), legacyIsNotEmpty);
+    repeatVector.erase(empty_iter, repeatVector.end());
+}
+
+int main(int argc, char ** argv)
+{
+    //-----
+    // one big group: variants of a repeat with a few bases of the
+    // neighbouring sequence on either end, the odd sequencing error and
+    // some of them reverse complemented, the way they come out of the search
+    //
+    srand(42);
+    const char bases[4] = {'A', 'C', 'G', 'T'};
+    std::string repeat = "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC";
+    std::string left_flank = "TTGACAGCTAGC";
+    std::string right_flank = "AATGCGTACCTG";
+    std::vector<std::string> variants(BENCH_NUM_VARIANTS);
+    for (size_t i = 0; i < variants.size(); ++i)
+    {
+        int left = rand() % BENCH_FLANK_LENGTH;
+        int right = rand() % BENCH_FLANK_LENGTH;
+        std::string& variant = variants[i];
+        variant = left_flank.substr(left_flank.length() - left) + repeat + right_flank.substr(0, right);
+        int errors = rand() % 3;
+        for (int k = 0; k < errors; ++k)
+        {
+            variant[rand() % variant.length()] = bases[rand() % 4];
+        }
+        if (rand() % 3 == 0)
+        {
+            variant = reverseComplement(variant);
+        }
+    }
+
+    std::vector<std::string> legacy_result = variants;
+    clock_t start = clock();
+    legacyRemoveRedundantRepeats(legacy_result);
+    double legacy_seconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+
+    std::vector<std::string> result = variants;
+    start = clock();
+    removeRedundantRepeats(result);
+    double seconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+
+    std::cout<<"["<<PACKAGE_NAME<<"_bench]: redundant repeats in a group of "<<variants.size()<<" variants, "<<result.size()<<" kept"<<std::endl;
+    std::cout<<"pairwise substring search: "<<legacy_seconds<<" sec"<<std::endl;
+    std::cout<<"aho-corasick automaton: "<<seconds<<" sec"<<std::endl;
+    if (seconds > 0)
+    {
+        std::cout<<"speedup: "<<legacy_seconds / seconds<<"x"<<std::endl;
+    }
+    if (legacy_result != result)
+    {
+        std::cerr<<"[ERROR]: the two methods kept different repeats"<<std::endl;
+        return 1;
+    }
+    return 0;
+}
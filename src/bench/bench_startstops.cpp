@@ -0,0 +1,211 @@
+// File: bench_startstops.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Cost per read of ReadHolder::updateStartStops, which runs once for every
+// read of a group while the group is refined and looks for partial repeats
+// at both ends of the read with smithWaterman. The same read ends are also
+// aligned with a copy of the old full matrix version so the two can be
+// compared in the same binary.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+// system includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <ctime>
+
+// local includes
+#include "ReadHolder.h"
+#include "SmithWaterman.h"
+#include "crassDefines.h"
+
+#define BENCH_NUM_READS     100000
+#define BENCH_READ_LENGTH   150
+#define BENCH_SPACER_LENGTH 34
+
+// the double precision matrix with a pointer for every cell, the way the
+// partial repeats were found before
+static void legacySmithWaterman(const std::string& seqA, const std::string& seqB, int aStartSearch, int aSearchLen, int * aStart, int * aEnd)
+{
+    int length_seq_B = static_cast<int>(seqB.length());
+    double ** matrix = new double*[aSearchLen+1];
+    int ** I_i = new int*[aSearchLen+1];
+    int ** I_j = new int*[aSearchLen+1];
+    for (int i = 0; i <= aSearchLen; i++)
+    {
+        matrix[i] = new double[length_seq_B+1];
+        I_i[i] = new int[length_seq_B+1];
+        I_j[i] = new int[length_seq_B+1];
+        for (int j = 0; j <= length_seq_B; j++)
+        {
+            matrix[i][j] = 0;
+        }
+    }
+    double matrix_max = -1;
+    int i_max = 0, j_max = 0;
+    for (int i = 1; i <= aSearchLen; i++)
+    {
+        for (int j = 1; j <= length_seq_B; j++)
+        {
+            int index = -1;
+            matrix[i][j] = findMax(matrix[i-1][j-1] + SW_SIM_SCORE(seqA[i-1 + aStartSearch], seqB[j-1]),
+                                   matrix[i-1][j] + SW_GAP,
+                                   matrix[i][j-1] + SW_GAP,
+                                   0,
+                                   &index);
+            if (matrix[i][j] > matrix_max)
+            {
+                matrix_max = matrix[i][j];
+                i_max = i;
+                j_max = j;
+            }
+            int next_i[4] = {i-1, i-1, i, i};
+            int next_j[4] = {j-1, j, j-1, j};
+            I_i[i][j] = next_i[index];
+            I_j[i][j] = next_j[index];
+        }
+    }
+    int current_i = i_max;
+    int current_j = j_max;
+    int next_i = I_i[current_i][current_j];
+    int next_j = I_j[current_i][current_j];
+    while ((next_j != 0) && (next_i != 0) && ((current_i != next_i) || (current_j != next_j)))
+    {
+        current_i = next_i;
+        current_j = next_j;
+        next_i = I_i[current_i][current_j];
+        next_j = I_j[current_i][current_j];
+    }
+    current_i = (current_i > 0) ? current_i - 1 : 0;
+    *aStart = current_i + aStartSearch;
+    *aEnd = (*aStart) + i_max - current_i - 1;
+    for (int i = 0; i <= aSearchLen; i++)
+    {
+        delete [] matrix[i];
+        delete [] I_i[i];
+        delete [] I_j[i];
+    }
+    delete [] matrix;
+    delete [] I_i;
+    delete [] I_j;
+}
+
+int main(int argc, char ** argv)
+{
+    //-----
+    // reads with two whole repeats and a bit of a repeat on either end,
+    // laid out the way they are when a group gets refined
+    //
+    srand(42);
+    const char bases[4] = {'A', 'C', 'G', 'T'};
+    std::string repeat = "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC";
+    options opts;
+    opts.lowSpacerSize = CRASS_DEF_MIN_SPACER_SIZE;
+
+    std::vector<ReadHolder *> reads;
+    reads.reserve(BENCH_NUM_READS);
+    std::string seq(BENCH_READ_LENGTH, 'A');
+    for (int i = 0; i < BENCH_NUM_READS; ++i)
+    {
+        for (size_t k = 0; k < seq.length(); ++k)
+        {
+            seq[k] = bases[rand() % 4];
+        }
+        int front_part = 4 + rand() % 20;
+        seq.replace(0, front_part, repeat.substr(repeat.length() - front_part));
+        unsigned int first_start = front_part + BENCH_SPACER_LENGTH;
+        unsigned int start = first_start;
+        for (int r = 0; r < 2; ++r)
+        {
+            seq.replace(start, repeat.length(), repeat);
+            start += static_cast<unsigned int>(repeat.length()) + BENCH_SPACER_LENGTH;
+        }
+        ReadHolder * holder = new ReadHolder(seq, "HWI-D00456:77:C70WLANXX:1:1101:10963:2182");
+        start = first_start;
+        for (int r = 0; r < 2; ++r)
+        {
+            holder->startStopsAdd(start, start + static_cast<unsigned int>(repeat.length()) - 1);
+            start += static_cast<unsigned int>(repeat.length()) + BENCH_SPACER_LENGTH;
+        }
+        reads.push_back(holder);
+    }
+
+    // the windows at the ends of each read that get searched
+    clock_t begin = clock();
+    long legacy_checksum = 0;
+    std::vector<ReadHolder *>::iterator read_iter;
+    for (read_iter = reads.begin(); read_iter != reads.end(); ++read_iter)
+    {
+        const std::string& read = (*read_iter)->getSeqRef();
+        int first_start = static_cast<int>((*read_iter)->front());
+        int last_end = static_cast<int>((*read_iter)->back());
+        int part_s, part_e;
+        if (first_start > static_cast<int>(opts.lowSpacerSize))
+        {
+            legacySmithWaterman(read, repeat, 0, first_start - opts.lowSpacerSize, &part_s, &part_e);
+            legacy_checksum += part_e;
+        }
+        int end_dist = static_cast<int>(read.length()) - last_end;
+        if (end_dist > static_cast<int>(opts.lowSpacerSize))
+        {
+            legacySmithWaterman(read, repeat, last_end + opts.lowSpacerSize, end_dist - opts.lowSpacerSize, &part_s, &part_e);
+            legacy_checksum += part_e;
+        }
+    }
+    double legacy_seconds = static_cast<double>(clock() - begin) / CLOCKS_PER_SEC;
+
+    begin = clock();
+    size_t num_partials = 0;
+    for (read_iter = reads.begin(); read_iter != reads.end(); ++read_iter)
+    {
+        size_t before = (*read_iter)->numRepeats();
+        (*read_iter)->updateStartStops(0, &repeat, &opts);
+        num_partials += (*read_iter)->numRepeats() - before;
+    }
+    double seconds = static_cast<double>(clock() - begin) / CLOCKS_PER_SEC;
+
+    std::cout<<"["<<PACKAGE_NAME<<"_bench]: partial repeats in "<<reads.size()<<" reads, "<<num_partials<<" found"<<std::endl;
+    std::cout<<"full matrix alignments only: "<<1e6 * legacy_seconds / reads.size()<<" usec per read"<<std::endl;
+    std::cout<<"updateStartStops: "<<1e6 * seconds / reads.size()<<" usec per read"<<std::endl;
+    for (read_iter = reads.begin(); read_iter != reads.end(); ++read_iter)
+    {
+        delete *read_iter;
+    }
+    if (num_partials == 0 || legacy_checksum == 0)
+    {
+        std::cerr<<"[ERROR]: no partial repeats were found"<<std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,251 @@
+// File: bench_streamreader.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Benchmark for reading big crispr files. A synthetic file of the
+// requested size (in MB, 64 by default) is written with the
+// streamwriter, then read group by group with the streamreader and in
+// one go with the DOM reader. The time and the peak memory after each
+// are reported. The DOM read can be left out with --no-dom, which is
+// the only way to run this on files of several GB:
+//
+//     bench-streamreader 4096 --no-dom
+//
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+// system includes
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <sys/resource.h>
+
+// local includes
+#include "streamwriter.h"
+#include "streamreader.h"
+#include "reader.h"
+#include "StlExt.h"
+
+#define BENCH_FILE_NAME             "bench_streamreader.crispr"
+#define BENCH_DEFAULT_MB            64
+#define BENCH_SPACERS_PER_GROUP     60
+#define BENCH_READS_PER_SPACER      8
+
+static std::string randomSequence(int length)
+{
+    const char bases[4] = {'A', 'C', 'G', 'T'};
+    std::string seq(length, 'A');
+    for (int i = 0; i < length; i++)
+    {
+        seq[i] = bases[rand() % 4];
+    }
+    return seq;
+}
+
+// one group the way crass writes them out
+static void writeGroup(crispr::xml::streamwriter& xml_out, int groupNumber)
+{
+    std::string dr = randomSequence(32);
+    xml_out.addGroup("G" + to_string(groupNumber), dr);
+    xml_out.startElement(xml_out.tag_Data());
+    int num_reads = BENCH_SPACERS_PER_GROUP * BENCH_READS_PER_SPACER;
+    xml_out.startElement(xml_out.tag_Sources());
+    for (int i = 1; i <= num_reads; i++)
+    {
+        xml_out.addSource("HWI-ST1234:8:1101:" + to_string(rand()) + ":" + to_string(rand()) + "/1", "SO" + to_string(i));
+    }
+    xml_out.endElement();
+    xml_out.startElement(xml_out.tag_Drs());
+    xml_out.addDirectRepeat("DR1", dr);
+    xml_out.endElement();
+    xml_out.startElement(xml_out.tag_Spacers());
+    for (int i = 1; i <= BENCH_SPACERS_PER_GROUP; i++)
+    {
+        xml_out.addSpacer(randomSequence(30 + rand() % 10), "SP" + to_string(i), to_string(BENCH_READS_PER_SPACER));
+        for (int j = 0; j < BENCH_READS_PER_SPACER; j++)
+        {
+            xml_out.addSpacerSource("SO" + to_string((i - 1) * BENCH_READS_PER_SPACER + j + 1));
+        }
+        xml_out.endElement();
+    }
+    xml_out.endElement();
+    xml_out.endElement();
+    xml_out.startElement(xml_out.tag_Metadata());
+    xml_out.startElement(xml_out.tag_Program());
+    xml_out.addTextElement(xml_out.tag_Name(), "crass");
+    xml_out.addTextElement(xml_out.tag_Version(), "1.0");
+    xml_out.addTextElement(xml_out.tag_Command(), "crass reads.fq");
+    xml_out.endElement();
+    xml_out.addFileToMetadata("sequence", "/tmp/Group_" + to_string(groupNumber) + ".fa");
+    xml_out.endElement();
+    xml_out.startElement(xml_out.tag_Assembly());
+    xml_out.addContig("C1");
+    for (int i = 1; i <= BENCH_SPACERS_PER_GROUP; i++)
+    {
+        xml_out.addSpacerToContig("SP" + to_string(i));
+        if (i > 1)
+        {
+            xml_out.startElement(xml_out.tag_Bspacers());
+            xml_out.addSpacer(xml_out.tag_Bs(), "SP" + to_string(i - 1), "DR1", "0");
+            xml_out.endElement();
+        }
+        if (i < BENCH_SPACERS_PER_GROUP)
+        {
+            xml_out.startElement(xml_out.tag_Fspacers());
+            xml_out.addSpacer(xml_out.tag_Fs(), "SP" + to_string(i + 1), "DR1", "0");
+            xml_out.endElement();
+        }
+        xml_out.endElement();
+    }
+    xml_out.endElement();
+    xml_out.endElement();
+    xml_out.endElement();
+}
+
+struct BenchCounts {
+    int groups;
+    int spacers;
+};
+
+static int countSpacers(xercesc::DOMElement * group, crispr::xml::base& xmlObj)
+{
+    int spacers = 0;
+    for (xercesc::DOMElement * data = group->getFirstElementChild(); data != NULL; data = data->getNextElementSibling())
+    {
+        if (xercesc::XMLString::equals(data->getTagName(), xmlObj.tag_Data()))
+        {
+            for (xercesc::DOMElement * child = data->getFirstElementChild(); child != NULL; child = child->getNextElementSibling())
+            {
+                if (xercesc::XMLString::equals(child->getTagName(), xmlObj.tag_Spacers()))
+                {
+                    spacers += static_cast<int>(child->getChildElementCount());
+                }
+            }
+        }
+    }
+    return spacers;
+}
+
+static bool countGroup(xercesc::DOMElement * group, crispr::xml::base& xmlObj, void * context)
+{
+    BenchCounts * counts = static_cast<BenchCounts *>(context);
+    counts->groups++;
+    counts->spacers += countSpacers(group, xmlObj);
+    return true;
+}
+
+static long peakMemoryMB(void)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024;
+}
+
+int main(int argc, char ** argv)
+{
+    long target_mb = BENCH_DEFAULT_MB;
+    bool do_dom = true;
+    for (int i = 1; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "--no-dom"))
+        {
+            do_dom = false;
+        }
+        else
+        {
+            target_mb = atol(argv[i]);
+        }
+    }
+
+    //-----
+    // write the synthetic file
+    //
+    srand(42);
+    clock_t start = clock();
+    int num_groups = 0;
+    {
+        crispr::xml::streamwriter xml_out;
+        std::ofstream out(BENCH_FILE_NAME);
+        xml_out.createDocument(&out, "crispr", "1.1");
+        while (static_cast<long>(out.tellp()) < target_mb * 1024 * 1024)
+        {
+            writeGroup(xml_out, ++num_groups);
+        }
+        xml_out.finishDocument();
+    }
+    double write_seconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+    std::cout<<"["<<PACKAGE_NAME<<"_bench]: "<<target_mb<<" MB crispr file with "<<num_groups<<" groups"<<std::endl;
+    std::cout<<"streamwriter: "<<write_seconds<<" sec"<<std::endl;
+
+    int retval = 0;
+    try
+    {
+        crispr::xml::streamreader stream_reader;
+        BenchCounts counts = {0, 0};
+        start = clock();
+        stream_reader.parse(BENCH_FILE_NAME, countGroup, &counts);
+        double seconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+        std::cout<<"streamreader: "<<seconds<<" sec, "<<counts.groups<<" groups, "<<counts.spacers<<" spacers, peak memory "<<peakMemoryMB()<<" MB"<<std::endl;
+        if (counts.groups != num_groups || counts.spacers != num_groups * BENCH_SPACERS_PER_GROUP)
+        {
+            std::cerr<<"[ERROR]: the streamreader did not see every group"<<std::endl;
+            retval = 1;
+        }
+
+        if (do_dom)
+        {
+            crispr::xml::reader dom_reader;
+            BenchCounts dom_counts = {0, 0};
+            start = clock();
+            xercesc::DOMDocument * doc = dom_reader.setFileParser(BENCH_FILE_NAME);
+            for (xercesc::DOMElement * group = doc->getDocumentElement()->getFirstElementChild(); group != NULL; group = group->getNextElementSibling())
+            {
+                countGroup(group, dom_reader, &dom_counts);
+            }
+            seconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+            std::cout<<"DOM reader: "<<seconds<<" sec, "<<dom_counts.groups<<" groups, "<<dom_counts.spacers<<" spacers, peak memory "<<peakMemoryMB()<<" MB"<<std::endl;
+            if (dom_counts.groups != counts.groups || dom_counts.spacers != counts.spacers)
+            {
+                std::cerr<<"[ERROR]: the two readers saw different files"<<std::endl;
+                retval = 1;
+            }
+        }
+    }
+    catch (crispr::exception& e)
+    {
+        std::cerr<<e.what()<<std::endl;
+        retval = 1;
+    }
+    remove(BENCH_FILE_NAME);
+    return retval;
+}
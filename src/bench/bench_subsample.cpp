@@ -0,0 +1,201 @@
+// File: bench_subsample.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Recall of the subsample mode. Each file is searched in full and then
+// with only a fraction of its reads searched, the repeats found are
+// made non-redundant and the rest of the reads recruited by the
+// singleton finder as a normal run would. The reads, direct repeat
+// copies and time of each are reported against the full run. The
+// bundled test data is used unless files are given:
+//
+//     bench-subsample reads_1.fq.gz reads_2.fq.gz
+//
+// The repeats aren't clustered first as createNonRedundantSet does, so
+// the redundant ones are removed from all of them at once.
+//
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+// system includes
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <ctime>
+#include <sys/time.h>
+
+// local includes
+#include "libcrispr.h"
+#include "SeqUtils.h"
+#include "LoggerSimp.h"
+#include "crassDefines.h"
+
+#ifndef BENCH_DATA_DIR
+#define BENCH_DATA_DIR              "../../test"
+#endif
+
+static const double benchFractions[] = {0, 0.5, 0.25, 0.1, 0.05, 0.01};
+
+static double seconds(void)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec + now.tv_usec / 1000000.0;
+}
+
+struct BenchRun {
+    double subsample;
+    double seconds;
+    size_t searched;                                        // reads found by the search
+    size_t patterns;                                        // non-redundant, both strands
+    std::set<std::string> reads;                            // every read recruited
+    size_t copies;                                          // direct repeats in those reads
+};
+
+static void run(const char * fileName, options& opts, BenchRun& result)
+{
+    ReadMap reads;
+    ReadHolderPool pool;
+    StringCheck string_check;
+    lookupTable patterns_hash, reads_found;
+    time_t start_time;
+    time(&start_time);
+
+    double start = seconds();
+    searchFile(fileName, opts, &reads, &pool, &string_check, patterns_hash, reads_found, start_time, NULL, NULL, NULL);
+    result.searched = reads_found.size();
+
+    Vecstr non_redundant;
+    lookupTable::iterator pattern_iter;
+    for (pattern_iter = patterns_hash.begin(); pattern_iter != patterns_hash.end(); ++pattern_iter)
+    {
+        non_redundant.push_back(pattern_iter->first);
+    }
+    removeRedundantRepeats(non_redundant);
+    size_t num_repeats = non_redundant.size();
+    for (size_t i = 0; i < num_repeats; ++i)
+    {
+        non_redundant.push_back(reverseComplement(non_redundant[i]));
+    }
+    result.patterns = non_redundant.size();
+    if (! non_redundant.empty())
+    {
+        findSingletons(fileName, opts, &non_redundant, reads_found, &reads, &pool, &string_check, start_time);
+    }
+    result.seconds = seconds() - start;
+
+    result.copies = 0;
+    ReadMapIterator reads_iter;
+    for (reads_iter = reads.begin(); reads_iter != reads.end(); ++reads_iter)
+    {
+        ReadListIterator list_iter;
+        for (list_iter = reads_iter->second->begin(); list_iter != reads_iter->second->end(); ++list_iter)
+        {
+            result.reads.insert((*list_iter)->getHeader());
+            result.copies += (*list_iter)->numRepeats();
+            pool.destroy(*list_iter);
+        }
+        delete reads_iter->second;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        files.push_back(argv[i]);
+    }
+    if (files.empty())
+    {
+        files.push_back(BENCH_DATA_DIR "/Ill100.fx.gz");
+        files.push_back(BENCH_DATA_DIR "/CN_gDC.fa.gz");
+    }
+
+    options opts;
+    opts.logLevel = 0;
+    opts.lowDRsize = CRASS_DEF_MIN_DR_SIZE;
+    opts.highDRsize = CRASS_DEF_MAX_DR_SIZE;
+    opts.lowSpacerSize = CRASS_DEF_MIN_SPACER_SIZE;
+    opts.highSpacerSize = CRASS_DEF_MAX_SPACER_SIZE;
+    opts.searchWindowLength = CRASS_DEF_OPTIMAL_SEARCH_WINDOW_LENGTH;
+    opts.minNumRepeats = CRASS_DEF_DEFAULT_MIN_NUM_REPEATS;
+    opts.numThreads = 1;
+    opts.searchEngine = CRT_ENGINE;
+    intialiseGlobalLogger("", 0);
+
+    // the search prints its progress, so the table is kept until the end
+    std::stringstream report;
+    report<<std::fixed<<std::setprecision(3);
+    std::vector<std::string>::iterator file_iter;
+    for (file_iter = files.begin(); file_iter != files.end(); ++file_iter)
+    {
+        report<<*file_iter<<std::endl;
+        report<<"subsample  searched  patterns   reads  recall  missed   extra  copies  recall    sec"<<std::endl;
+        BenchRun full;
+        for (size_t i = 0; i < sizeof(benchFractions) / sizeof(double); ++i)
+        {
+            BenchRun result;
+            result.subsample = benchFractions[i];
+            opts.subsample = result.subsample;
+            run(file_iter->c_str(), opts, result);
+            if (i == 0)
+            {
+                full = result;
+            }
+            // reads the full run found that this one didn't, and the
+            // other way around
+            size_t missed = 0;
+            std::set<std::string>::iterator header_iter;
+            for (header_iter = full.reads.begin(); header_iter != full.reads.end(); ++header_iter)
+            {
+                if (result.reads.find(*header_iter) == result.reads.end())
+                {
+                    missed++;
+                }
+            }
+            size_t extra = result.reads.size() + missed - full.reads.size();
+            report<<std::setw(9)<<result.subsample
+                  <<std::setw(10)<<result.searched
+                  <<std::setw(10)<<result.patterns
+                  <<std::setw(8)<<result.reads.size()
+                  <<std::setw(8)<<((full.reads.empty()) ? 1.0 : static_cast<double>(result.reads.size()) / full.reads.size())
+                  <<std::setw(8)<<missed
+                  <<std::setw(8)<<extra
+                  <<std::setw(8)<<result.copies
+                  <<std::setw(8)<<((full.copies == 0) ? 1.0 : static_cast<double>(result.copies) / full.copies)
+                  <<std::setw(7)<<result.seconds<<std::endl;
+        }
+    }
+    std::cout<<std::endl<<report.str();
+    return 0;
+}
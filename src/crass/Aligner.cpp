@@ -33,10 +33,12 @@
  */
 #include <cstdlib>
 #include <iostream>
+#include <algorithm>
 #include "Exception.h"
 #include "Aligner.h"
 #include "LoggerSimp.h"
 #include "SeqUtils.h"
+#include "TaskPool.h"
 
 const unsigned char Aligner::seq_nt4_table[256] = {
     4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
@@ -93,6 +95,79 @@ void Aligner::alignSlave(StringToken& slaveDRToken) {
 #endif
     AlignerFlag_t flags;
     int offset = getOffsetAgainstMaster(slaveDR, flags);
+    placeSlave(slaveDRToken, slaveDR, offset, flags);
+}
+
+typedef struct _slave_batch_payload {
+    Aligner * aligner;
+    size_t numTasks;
+    std::vector<std::string> * slaves;
+    std::vector<int> * offsets;
+    std::vector<AlignerFlag_t> * flags;
+} SlaveBatchPayload;
+
+void Aligner::alignSlaveBatch(size_t task, void * context) {
+    //-----
+    // The first alignment of a slave only needs the two sequences, so
+    // these can be done on any thread. Anything that changes the reads,
+    // the string check or the array is left for placeSlave
+    //
+    SlaveBatchPayload * payload = static_cast<SlaveBatchPayload *>(context);
+    AlignerScratch& scratch = *(payload->aligner->AL_scratch[task]);
+    for (size_t i = task; i < payload->slaves->size(); i += payload->numTasks) {
+        (*(payload->offsets))[i] = payload->aligner->getOffsetAgainstMaster((*(payload->slaves))[i], 
+                                                                             (*(payload->flags))[i], 
+                                                                             scratch);
+    }
+}
+
+void Aligner::alignSlaves(DR_Cluster& drTokens, int numThreads) {
+    
+    std::vector<DR_Cluster::iterator> slave_iters;
+    std::vector<std::string> slaves;
+    DR_ClusterIterator dr_iter;
+    for (dr_iter = drTokens.begin(); dr_iter != drTokens.end(); dr_iter++) {
+        // we've already done the master DR
+        if (AL_masterDRToken == *dr_iter) {
+            continue;
+        }
+        slave_iters.push_back(dr_iter);
+        slaves.push_back(mStringCheck->getString(*dr_iter));
+    }
+    if (slaves.empty()) {
+        return;
+    }
+    
+    SlaveBatchPayload payload;
+    payload.aligner = this;
+    payload.numTasks = (numThreads > 1) ? std::min(static_cast<size_t>(numThreads), slaves.size()) : 1;
+    payload.slaves = &slaves;
+    std::vector<int> offsets(slaves.size(), 0);
+    std::vector<AlignerFlag_t> flags(slaves.size());
+    payload.offsets = &offsets;
+    payload.flags = &flags;
+    
+    // make the scratch here, the threads can't add to the list
+    for (size_t i = 0; i < payload.numTasks; ++i) {
+        getScratch(i);
+    }
+    runTasks(payload.numTasks, numThreads, alignSlaveBatch, &payload);
+    
+    // now the reads go into the array in the same order as alignSlave
+    for (size_t i = 0; i < slaves.size(); ++i) {
+        StringToken& slave_token = *(slave_iters[i]);
+        AL_Offsets[slave_token] = -1;
+#ifdef DEBUG
+        logInfo("aligning slave" << slaves[i] << " ("<<slave_token<<")", 6)
+#endif
+        placeSlave(slave_token, slaves[i], offsets[i], flags[i]);
+    }
+}
+
+void Aligner::placeSlave(StringToken& slaveDRToken, 
+                         std::string& slaveDR, 
+                         int offset, 
+                         AlignerFlag_t& flags) {
     
     if (flags[score_equal]) {
 #ifdef DEBUG
@@ -260,52 +335,68 @@ void Aligner::prepareSlaveForAlignment(std::string& slaveDR,
     prepareSequenceForAlignment(revcomp_slave_dr, slaveTransformedReverse);
 }
 
+AlignerScratch * Aligner::getScratch(size_t i) {
+    while (AL_scratch.size() <= i) {
+        AlignerScratch * scratch = new AlignerScratch();
+        scratch->master.assign(AL_masterDR, AL_masterDR + AL_masterDRLength + 1);
+        AL_scratch.push_back(scratch);
+    }
+    return AL_scratch[i];
+}
+
+void Aligner::clearScratch(void) {
+    std::vector<AlignerScratch *>::iterator scratch_iter;
+    for (scratch_iter = AL_scratch.begin(); scratch_iter != AL_scratch.end(); ++scratch_iter) {
+        delete *scratch_iter;
+    }
+    AL_scratch.clear();
+}
+
+void Aligner::prepareSlaveForAlignment(std::string& slaveDR, AlignerScratch& scratch) {
+    
+    scratch.forward.resize(slaveDR.length() + 1);
+    scratch.reverse.resize(slaveDR.length() + 1);
+    prepareSlaveForAlignment(slaveDR, &(scratch.forward[0]), &(scratch.reverse[0]));
+}
+
 int Aligner::getOffsetAgainstMaster(std::string& slaveDR, AlignerFlag_t& flags) {
+    return getOffsetAgainstMaster(slaveDR, flags, *getScratch(0));
+}
+
+int Aligner::getOffsetAgainstMaster(std::string& slaveDR, AlignerFlag_t& flags, AlignerScratch& scratch) {
 #ifdef DEBUG
     logInfo("getting offset of this slave against master DR", 6)
 #endif
     int slave_dr_length = static_cast<int>(slaveDR.length());
-    uint8_t* slave_dr_forward = new uint8_t[slave_dr_length+1];
-    uint8_t* slave_dr_reverse = new uint8_t[slave_dr_length+1];
-    
-    prepareSlaveForAlignment(slaveDR, slave_dr_forward, slave_dr_reverse);
-
-    // query profile 
-    kswq_t *slave_forward_query_profile = 0;
-    kswq_t *slave_reverse_query_profile = 0;
-    
-    
-    
-    // alignment of slave against master
-    kswr_t forward_return = ksw_align(slave_dr_length, 
-                                      slave_dr_forward, 
-                                      AL_masterDRLength, 
-                                      AL_masterDR, 
-                                      5, 
-                                      AL_scoringMatrix, 
-                                      AL_gapOpening, 
-                                      AL_gapExtension, 
-                                      AL_xtra, 
-                                      &slave_forward_query_profile);
+    prepareSlaveForAlignment(slaveDR, scratch);
     
+    // alignment of slave against master, the query profiles
+    // are kept in the scratch for the next slave
+    kswr_t forward_return = ksw_align_reuse(slave_dr_length, 
+                                            &(scratch.forward[0]), 
+                                            AL_masterDRLength, 
+                                            &(scratch.master[0]), 
+                                            5, 
+                                            AL_scoringMatrix, 
+                                            AL_gapOpening, 
+                                            AL_gapExtension, 
+                                            AL_xtra, 
+                                            &(scratch.profile),
+                                            &(scratch.startProfile));
     
-    kswr_t reverse_return = ksw_align(slave_dr_length, 
-                                      slave_dr_reverse, 
-                                      AL_masterDRLength, 
-                                      AL_masterDR, 
-                                      5, 
-                                      AL_scoringMatrix, 
-                                      AL_gapOpening, 
-                                      AL_gapExtension, 
-                                      AL_xtra, 
-                                      &slave_reverse_query_profile);
     
+    kswr_t reverse_return = ksw_align_reuse(slave_dr_length, 
+                                            &(scratch.reverse[0]), 
+                                            AL_masterDRLength, 
+                                            &(scratch.master[0]), 
+                                            5, 
+                                            AL_scoringMatrix, 
+                                            AL_gapOpening, 
+                                            AL_gapExtension, 
+                                            AL_xtra, 
+                                            &(scratch.profile),
+                                            &(scratch.startProfile));
     
-    // free the query profile
-    free(slave_forward_query_profile); 
-    free(slave_reverse_query_profile);
-    delete [] slave_dr_reverse;
-    delete [] slave_dr_forward;
     // figure out which alignment was better
     if (reverse_return.score == forward_return.score) {
         flags[score_equal] = true;
@@ -364,7 +455,7 @@ int Aligner::getOffsetAgainstMaster(std::string& slaveDR, AlignerFlag_t& flags)
 void Aligner::placeReadsInCoverageArray(StringToken& currentDrToken) {
 
     ReadListIterator read_iter = mReads->at(currentDrToken)->begin();
-    int current_dr_length = static_cast<int>(mStringCheck->getString(currentDrToken).length());
+    int current_dr_length = static_cast<int>(mStringCheck->getStringView(currentDrToken).length);
     
     while (read_iter != mReads->at(currentDrToken)->end()) 
     {
@@ -38,6 +38,7 @@
 #include <bitset>
 #include <map>
 #include <iostream>
+#include <cstdlib>
 
 #include "ksw.h"
 #include "StringCheck.h"
@@ -49,6 +50,21 @@
 
 typedef std::bitset<3> AlignerFlag_t;
 
+// buffers that are reused from one slave DR to the next, each
+// thread aligning slaves has a set of its own
+class AlignerScratch 
+{
+public:
+    AlignerScratch() : profile(NULL), startProfile(NULL) {}
+    ~AlignerScratch() { free(profile); free(startProfile); }
+
+    std::vector<uint8_t> master;        // ksw reverses the target in place so each thread has a copy
+    std::vector<uint8_t> forward;
+    std::vector<uint8_t> reverse;
+    kswq_t * profile;                   // query profile, rebuilt for each slave in the same memory
+    kswq_t * startProfile;              // used by ksw to find the start of the alignment
+};
+
 
 class Aligner 
 {
@@ -136,6 +152,7 @@ public:
             delete [] AL_masterDR;
             AL_masterDR = NULL;
         } 
+        clearScratch();
     }
     
     inline StringToken getMasterDrToken(){return AL_masterDRToken;}
@@ -144,6 +161,11 @@ public:
     
     void alignSlave(StringToken& slaveDRToken);
 
+    // align every DR in the group except the master, the same as calling
+    // alignSlave on each one in turn. The alignments are spread over
+    // numThreads threads, the reads are placed in the array in order
+    void alignSlaves(DR_Cluster& drTokens, int numThreads = 1);
+
     // add in all of the reads for this group to the coverage array
     void generateConsensus();
     
@@ -181,6 +203,23 @@ private:
     int getOffsetAgainstMaster(std::string& slaveDR,
                                AlignerFlag_t& flags);
 
+    int getOffsetAgainstMaster(std::string& slaveDR,
+                               AlignerFlag_t& flags,
+                               AlignerScratch& scratch);
+
+    // everything alignSlave does once the first alignment is done
+    void placeSlave(StringToken& slaveDRToken, 
+                    std::string& slaveDR, 
+                    int offset, 
+                    AlignerFlag_t& flags);
+
+    // worker for alignSlaves, does every nth slave with its own scratch
+    static void alignSlaveBatch(size_t task, void * context);
+
+    AlignerScratch * getScratch(size_t i);
+
+    void clearScratch(void);
+
     // transform any sequence into the right form for ksw
     void prepareSequenceForAlignment(std::string& sequence, uint8_t *transformedSequence);
 
@@ -189,12 +228,15 @@ private:
                                   uint8_t *slaveTransformedForward, 
                                   uint8_t *slaveTransformedReverse);
 
+    void prepareSlaveForAlignment(std::string& slaveDR, AlignerScratch& scratch);
+
     // transform the master DR into the right form for ksw
     inline void prepareMasterForAlignment(std::string& masterDR) {
         AL_masterDRLength = masterDR.length();
         //AL_minAlignmentScore = static_cast<int>(AL_masterDRLength * 0.5);
         AL_masterDR = new uint8_t[AL_masterDRLength+1];
         prepareSequenceForAlignment(masterDR, AL_masterDR);
+        clearScratch();
     };
     
 
@@ -230,6 +272,9 @@ private:
     int AL_masterDRLength;
     StringToken AL_masterDRToken;
     
+    // reused alignment buffers, one set per thread
+    std::vector<AlignerScratch *> AL_scratch;
+    
     // "Glue" between WorkHorse
     ReadMap * mReads;
     StringCheck * mStringCheck;
@@ -553,7 +553,7 @@ void parseSegmentString(std::string& segmentString, std::set<std::string>& segme
 void generateTmpAssemblyFile(std::string fileName, std::set<std::string>& wantedContigs, assemblyOptions& opts, std::string& tmpFileName)
 {
     
-    gzFile fp = getFileHandle((opts.inputDirName + fileName).c_str());
+    GzipReader * fp = getFileHandle((opts.inputDirName + fileName).c_str());
     kseq_t *seq;
     int l;
     
@@ -598,7 +598,9 @@ void generateTmpAssemblyFile(std::string fileName, std::set<std::string>& wanted
                 }                
             }
         }
+        kseq_destroy(seq);
     }
+    delete fp;
 }
 
 
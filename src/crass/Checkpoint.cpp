@@ -0,0 +1,383 @@
+// File: Checkpoint.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Implementation of the WorkHorse checkpoints.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+// system includes
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <zlib.h>
+
+// local includes
+#include "Checkpoint.h"
+#include "ReadHolder.h"
+#include "Exception.h"
+
+// the file is laid out as:
+//  magic, format version, stage, fingerprint
+//  whatever the WorkHorse writes
+//  end magic, crc of everything before it
+// numbers are written the way this machine stores them, a checkpoint
+// is only meant to be used where it was made
+
+#define CP_FORMAT_VERSION   1
+
+static const char checkpointMagic[8] = {'C', 'R', 'A', 'S', 'S', 'C', 'P', '\n'};
+static const char checkpointEnd[8] = {'C', 'R', 'A', 'S', 'S', 'E', 'N', 'D'};
+
+void Checkpoint::create(const std::string& fileName, CheckpointStage stage, const std::string& fingerprint)
+{
+    close();
+    mFileName = fileName;
+    mTmpFileName = fileName + ".tmp";
+    mFile = fopen(mTmpFileName.c_str(), "wb");
+    if (mFile == NULL)
+    {
+        mTmpFileName.clear();
+        fail("could not be created");
+    }
+    mStage = stage;
+    mCrc = crc32(0L, Z_NULL, 0);
+    writeBytes(checkpointMagic, sizeof(checkpointMagic));
+    writeInt(CP_FORMAT_VERSION);
+    writeInt(stage);
+    writeString(fingerprint);
+}
+
+void Checkpoint::commit(void)
+{
+    if (mFile == NULL || mTmpFileName.empty())
+    {
+        fail("is not being written");
+    }
+    unsigned int crc = static_cast<unsigned int>(mCrc);
+    writeBytes(checkpointEnd, sizeof(checkpointEnd));
+    writeBytes(&crc, sizeof(unsigned int));
+    bool written = (fflush(mFile) == 0);
+    written = (fclose(mFile) == 0) && written;
+    mFile = NULL;
+    if (! written || rename(mTmpFileName.c_str(), mFileName.c_str()) != 0)
+    {
+        remove(mTmpFileName.c_str());
+        mTmpFileName.clear();
+        fail("could not be written");
+    }
+    mTmpFileName.clear();
+}
+
+bool Checkpoint::open(const std::string& fileName, const std::string& fingerprint)
+{
+    close();
+    mFileName = fileName;
+    mFile = fopen(mFileName.c_str(), "rb");
+    if (mFile == NULL)
+    {
+        return false;
+    }
+
+    //-----
+    // check the whole file before anything is loaded from it
+    //
+    fseek(mFile, 0, SEEK_END);
+    long length = ftell(mFile);
+    long trailer = static_cast<long>(sizeof(checkpointEnd) + sizeof(unsigned int));
+    if (length < static_cast<long>(sizeof(checkpointMagic)) + trailer)
+    {
+        fail("is truncated");
+    }
+    fseek(mFile, 0, SEEK_SET);
+    mCrc = crc32(0L, Z_NULL, 0);
+    char buffer[65536];
+    long remaining = length - trailer;
+    while (remaining > 0)
+    {
+        size_t chunk = (remaining < static_cast<long>(sizeof(buffer))) ? static_cast<size_t>(remaining) : sizeof(buffer);
+        readBytes(buffer, chunk);
+        remaining -= static_cast<long>(chunk);
+    }
+    char end[sizeof(checkpointEnd)];
+    unsigned int crc = static_cast<unsigned int>(mCrc);
+    unsigned int stored_crc;
+    readBytes(end, sizeof(end));
+    readBytes(&stored_crc, sizeof(unsigned int));
+    if (memcmp(end, checkpointEnd, sizeof(end)) != 0 || crc != stored_crc)
+    {
+        fail("is incomplete or corrupt");
+    }
+
+    fseek(mFile, 0, SEEK_SET);
+    char magic[sizeof(checkpointMagic)];
+    readBytes(magic, sizeof(magic));
+    if (memcmp(magic, checkpointMagic, sizeof(magic)) != 0)
+    {
+        fail("is not a checkpoint");
+    }
+    if (readInt() != CP_FORMAT_VERSION)
+    {
+        fail("was made by a different version");
+    }
+    int stage = readInt();
+    if (stage != CP_SEARCH && stage != CP_CLUSTERS)
+    {
+        fail("is from an unknown stage");
+    }
+    mStage = static_cast<CheckpointStage>(stage);
+    std::string saved_fingerprint;
+    readString(saved_fingerprint);
+    if (saved_fingerprint != fingerprint)
+    {
+        fail("was made from different input files or options");
+    }
+    return true;
+}
+
+void Checkpoint::close(void)
+{
+    if (mFile != NULL)
+    {
+        fclose(mFile);
+        mFile = NULL;
+    }
+    if (! mTmpFileName.empty())
+    {
+        // never committed
+        remove(mTmpFileName.c_str());
+        mTmpFileName.clear();
+    }
+    mStage = CP_NONE;
+}
+
+//
+// Values
+//
+void Checkpoint::writeBytes(const void * data, size_t length)
+{
+    if (fwrite(data, 1, length, mFile) != length)
+    {
+        fail("could not be written");
+    }
+    mCrc = crc32(mCrc, static_cast<const Bytef *>(data), static_cast<uInt>(length));
+}
+
+void Checkpoint::readBytes(void * data, size_t length)
+{
+    if (fread(data, 1, length, mFile) != length)
+    {
+        fail("is truncated");
+    }
+    mCrc = crc32(mCrc, static_cast<const Bytef *>(data), static_cast<uInt>(length));
+}
+
+void Checkpoint::fail(const char * problem)
+{
+    std::stringstream ss;
+    ss<<"The checkpoint "<<mFileName<<" "<<problem;
+    throw crispr::exception(__FILE__,
+                            __LINE__,
+                            __PRETTY_FUNCTION__,
+                            ss);
+}
+
+void Checkpoint::writeInt(int value)
+{
+    writeBytes(&value, sizeof(int));
+}
+
+int Checkpoint::readInt(void)
+{
+    int value;
+    readBytes(&value, sizeof(int));
+    return value;
+}
+
+void Checkpoint::writeLength(unsigned int length)
+{
+    writeBytes(&length, sizeof(unsigned int));
+}
+
+unsigned int Checkpoint::readLength(void)
+{
+    unsigned int length;
+    readBytes(&length, sizeof(unsigned int));
+    return length;
+}
+
+void Checkpoint::writeString(const std::string& str)
+{
+    writeLength(static_cast<unsigned int>(str.length()));
+    writeBytes(str.data(), str.length());
+}
+
+void Checkpoint::readString(std::string& str)
+{
+    unsigned int length = readLength();
+    str.resize(length);
+    if (length > 0)
+    {
+        readBytes(&(str[0]), length);
+    }
+}
+
+//
+// The WorkHorse members
+//
+void Checkpoint::writeStrings(StringCheck& stringCheck)
+{
+    //-----
+    // every string in token order. Adding them again in the same order
+    // gives them the same tokens, duplicates included
+    //
+    writeLength(static_cast<unsigned int>(stringCheck.size()));
+    for (StringToken token = 2; token <= stringCheck.mNextFreeToken; token++)
+    {
+        StringView view = stringCheck.getStringView(token);
+        writeLength(static_cast<unsigned int>(view.length));
+        writeBytes(view.data, view.length);
+    }
+}
+
+void Checkpoint::readStrings(StringCheck& stringCheck)
+{
+    unsigned int num_strings = readLength();
+    std::string str;
+    for (unsigned int i = 0; i < num_strings; i++)
+    {
+        readString(str);
+        stringCheck.addString(str);
+    }
+}
+
+void Checkpoint::writeReads(ReadMap& reads)
+{
+    writeLength(static_cast<unsigned int>(reads.size()));
+    ReadMapIterator reads_iter;
+    for (reads_iter = reads.begin(); reads_iter != reads.end(); ++reads_iter)
+    {
+        writeInt(reads_iter->first);
+        writeLength(static_cast<unsigned int>(reads_iter->second->size()));
+        ReadListIterator list_iter;
+        for (list_iter = reads_iter->second->begin(); list_iter != reads_iter->second->end(); ++list_iter)
+        {
+            (*list_iter)->save(*this);
+        }
+    }
+}
+
+void Checkpoint::readReads(ReadMap& reads, ReadHolderPool& readPool)
+{
+    unsigned int num_repeats = readLength();
+    for (unsigned int i = 0; i < num_repeats; i++)
+    {
+        StringToken token = readInt();
+        unsigned int num_reads = readLength();
+        ReadList * read_list = new ReadList();
+        reads[token] = read_list;
+        read_list->reserve(num_reads);
+        for (unsigned int j = 0; j < num_reads; j++)
+        {
+            ReadHolder * holder = readPool.construct();
+            read_list->push_back(holder);
+            holder->load(*this);
+        }
+    }
+}
+
+void Checkpoint::writeClusters(DR_Cluster_Map& clusters)
+{
+    //-----
+    // groups that have been cleaned up are kept as NULL
+    //
+    writeLength(static_cast<unsigned int>(clusters.size()));
+    DR_Cluster_MapIterator cluster_iter;
+    for (cluster_iter = clusters.begin(); cluster_iter != clusters.end(); ++cluster_iter)
+    {
+        writeInt(cluster_iter->first);
+        if (cluster_iter->second == NULL)
+        {
+            writeInt(-1);
+            continue;
+        }
+        writeInt(static_cast<int>(cluster_iter->second->size()));
+        DR_ClusterIterator dr_iter;
+        for (dr_iter = cluster_iter->second->begin(); dr_iter != cluster_iter->second->end(); ++dr_iter)
+        {
+            writeInt(*dr_iter);
+        }
+    }
+}
+
+void Checkpoint::readClusters(DR_Cluster_Map& clusters)
+{
+    unsigned int num_clusters = readLength();
+    for (unsigned int i = 0; i < num_clusters; i++)
+    {
+        int gid = readInt();
+        int num_drs = readInt();
+        if (num_drs < 0)
+        {
+            clusters[gid] = NULL;
+            continue;
+        }
+        DR_Cluster * cluster = new DR_Cluster();
+        clusters[gid] = cluster;
+        for (int j = 0; j < num_drs; j++)
+        {
+            cluster->push_back(readInt());
+        }
+    }
+}
+
+void Checkpoint::writeTrueDRs(std::map<int, std::string>& trueDRs)
+{
+    writeLength(static_cast<unsigned int>(trueDRs.size()));
+    std::map<int, std::string>::iterator dr_iter;
+    for (dr_iter = trueDRs.begin(); dr_iter != trueDRs.end(); ++dr_iter)
+    {
+        writeInt(dr_iter->first);
+        writeString(dr_iter->second);
+    }
+}
+
+void Checkpoint::readTrueDRs(std::map<int, std::string>& trueDRs)
+{
+    unsigned int num_drs = readLength();
+    for (unsigned int i = 0; i < num_drs; i++)
+    {
+        int gid = readInt();
+        readString(trueDRs[gid]);
+    }
+}
@@ -0,0 +1,119 @@
+// File: Checkpoint.h
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// The state of the WorkHorse between the stages of doWork, saved so
+// that a run can be started again without reading the input. A
+// checkpoint is written to a temporary file and only renamed once it
+// is complete, and it is checked against a crc before anything is
+// loaded from it. It also holds a description of the input files and
+// of the options that were used to make it, a checkpoint made with
+// anything different is not used.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+#ifndef Checkpoint_h
+#define Checkpoint_h
+
+// system includes
+#include <cstdio>
+#include <string>
+#include <map>
+
+// local includes
+#include "Types.h"
+#include "StringCheck.h"
+
+// how far through doWork the checkpoint was made
+enum CheckpointStage {
+    CP_NONE = 0,
+    CP_SEARCH,                                              // both passes over the reads are done
+    CP_CLUSTERS                                             // the true DRs have been found
+};
+
+class Checkpoint
+{
+    public:
+        Checkpoint(void) { mFile = NULL; mStage = CP_NONE; mCrc = 0; }
+        ~Checkpoint(void) { close(); }
+
+        //
+        // Writing. Nothing appears under fileName until commit()
+        //
+        void create(const std::string& fileName, CheckpointStage stage, const std::string& fingerprint);
+        void commit(void);                                  // finish the file and move it into place
+
+        //
+        // Reading. false if there is no checkpoint, throws if there is
+        // one that can't be used
+        //
+        bool open(const std::string& fileName, const std::string& fingerprint);
+        inline CheckpointStage stage(void) { return mStage; }
+
+        void close(void);                                   // a checkpoint that wasn't committed is removed
+
+        //
+        // Values
+        //
+        void writeInt(int value);
+        int readInt(void);
+        void writeLength(unsigned int length);
+        unsigned int readLength(void);
+        void writeString(const std::string& str);
+        void readString(std::string& str);
+
+        //
+        // The WorkHorse members
+        //
+        void writeStrings(StringCheck& stringCheck);
+        void readStrings(StringCheck& stringCheck);         // into an empty StringCheck, the tokens come out the same
+        void writeReads(ReadMap& reads);
+        void readReads(ReadMap& reads, ReadHolderPool& readPool);
+        void writeClusters(DR_Cluster_Map& clusters);
+        void readClusters(DR_Cluster_Map& clusters);
+        void writeTrueDRs(std::map<int, std::string>& trueDRs);
+        void readTrueDRs(std::map<int, std::string>& trueDRs);
+
+    private:
+        void writeBytes(const void * data, size_t length);
+        void readBytes(void * data, size_t length);
+        void fail(const char * problem);                    // throw, naming the file
+
+        // members
+        FILE * mFile;
+        std::string mFileName;
+        std::string mTmpFileName;                           // set while writing
+        CheckpointStage mStage;
+        unsigned long mCrc;                                 // of everything written so far
+};
+
+#endif //Checkpoint_h
@@ -51,6 +51,87 @@
 #include "ReadHolder.h"
 #include "Exception.h"
 
+//
+// Edge lists
+//
+edgeList::edgeList(const edgeList& other)
+{
+    mSize = 0;
+    mCapacity = CN_INLINE_EDGES;
+    mEdges = mInline;
+    *this = other;
+}
+
+edgeList& edgeList::operator=(const edgeList& other)
+{
+    if (this != &other)
+    {
+        mSize = 0;
+        while (mCapacity < other.mSize)
+        {
+            grow();
+        }
+        for (unsigned int i = 0; i < other.mSize; ++i)
+        {
+            mEdges[i] = other.mEdges[i];
+        }
+        mSize = other.mSize;
+    }
+    return *this;
+}
+
+edgeList::iterator edgeList::find(CrisprNode * node)
+{
+    for (unsigned int i = 0; i < mSize; ++i)
+    {
+        if (mEdges[i].first == node)
+        {
+            return mEdges + i;
+        }
+    }
+    return end();
+}
+
+bool& edgeList::operator[](CrisprNode * node)
+{
+    iterator edge = find(node);
+    if (edge == end())
+    {
+        push_back(node, false);
+        edge = end() - 1;
+    }
+    return edge->second;
+}
+
+void edgeList::push_back(CrisprNode * node, bool attached)
+{
+    if (mSize == mCapacity)
+    {
+        grow();
+    }
+    mEdges[mSize] = CrisprEdge(node, attached);
+    mSize++;
+}
+
+void edgeList::grow(void)
+{
+    //-----
+    // double the space, moving off the inline array the first time
+    //
+    unsigned int new_capacity = mCapacity * 2;
+    CrisprEdge * new_edges = new CrisprEdge[new_capacity];
+    for (unsigned int i = 0; i < mSize; ++i)
+    {
+        new_edges[i] = mEdges[i];
+    }
+    if (mEdges != mInline)
+    {
+        delete [] mEdges;
+    }
+    mEdges = new_edges;
+    mCapacity = new_capacity;
+}
+
 //
 // Edge level functions
 //
@@ -67,7 +148,7 @@ bool CrisprNode::addEdge(CrisprNode * parterNode, EDGE_TYPE type)
     if(add_list->find(parterNode) == add_list->end())
     {
         // new guy
-        (*add_list)[parterNode] = true;
+        add_list->push_back(parterNode, true);
         switch(type)
         {
             case CN_EDGE_FORWARD:
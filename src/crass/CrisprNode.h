@@ -40,6 +40,7 @@
 
 // system includes
 #include <vector>
+#include <utility>
 #include <string>
 #include <fstream>
 
@@ -61,10 +62,45 @@ enum EDGE_TYPE {
     CN_EDGE_ERROR
 };
 
-// a list of edges ( we use a map to make lookups faster )
-// The bool teels us if the edge is active (ie, if the joining node is still attached / in use)
-typedef std::map<CrisprNode *, bool> edgeList;
-typedef std::map<CrisprNode *, bool>::iterator edgeListIterator;
+// number of edges of each type kept inside the node before going to the heap
+#define CN_INLINE_EDGES 2
+
+// an edge to another node. The bool tells us if the edge is active
+// (ie, if the joining node is still attached / in use)
+typedef std::pair<CrisprNode *, bool> CrisprEdge;
+
+// a list of edges. Almost every node has one or two edges of each type
+// so they are kept in a small array inside the list, only the busy
+// nodes spill over onto the heap. The lists are short enough that a
+// linear find beats a map. Edges stay in the order they were added
+class edgeList
+{
+    public:
+        typedef CrisprEdge * iterator;
+
+        edgeList(void) : mEdges(mInline), mSize(0), mCapacity(CN_INLINE_EDGES) {}
+        edgeList(const edgeList& other);
+        ~edgeList(void) { if (mEdges != mInline) delete [] mEdges; }
+        edgeList& operator=(const edgeList& other);
+
+        inline iterator begin(void) { return mEdges; }
+        inline iterator end(void) { return mEdges + mSize; }
+        inline size_t size(void) const { return mSize; }
+        inline bool empty(void) const { return 0 == mSize; }
+
+        iterator find(CrisprNode * node);                   // end() if there is no edge to node
+        bool& operator[](CrisprNode * node);                // like std::map, adds a detached edge if there isn't one
+        void push_back(CrisprNode * node, bool attached);   // add an edge, doesn't check for duplicates
+
+    private:
+        void grow(void);
+
+        CrisprEdge * mEdges;                                // mInline or a heap array
+        unsigned int mSize;
+        unsigned int mCapacity;
+        CrisprEdge mInline[CN_INLINE_EDGES];
+};
+typedef edgeList::iterator edgeListIterator;
 
 class CrisprNode 
 {
@@ -0,0 +1,414 @@
+// File: DRLibrary.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Implementation of the direct repeat library.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+// system includes
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <set>
+#include <algorithm>
+#include <zlib.h>
+
+// local includes
+#include "DRLibrary.h"
+#include "GzipReader.h"
+#include "kseq.h"
+#include "SeqUtils.h"
+#include "Exception.h"
+
+// the file is laid out as:
+//  the automaton, as acism_save writes it
+//  the patterns, each as a length then the bases
+//  the trailer
+// the automaton has to come first so that acism_mmap can map it. The
+// trailer is found from the end of the file and says where the
+// patterns start. Numbers are written the way this machine stores
+// them, the automaton is no more portable than that either
+
+#define DRL_FORMAT_VERSION  1
+
+static const char libraryMagic[8] = {'C', 'R', 'A', 'S', 'S', 'D', 'R', 'L'};
+
+typedef struct _library_trailer {
+    unsigned long long patternsOffset;                      // where the automaton ends
+    unsigned int numPatterns;
+    unsigned int crc;                                       // of everything before the trailer
+    unsigned int version;
+    unsigned int padding;
+    char magic[8];
+} LibraryTrailer;
+
+static void libraryError(const std::string& fileName, const char * problem)
+{
+    std::stringstream ss;
+    ss<<"The direct repeat library "<<fileName<<" "<<problem;
+    throw crispr::exception(__FILE__,
+                            __LINE__,
+                            __PRETTY_FUNCTION__,
+                            ss);
+}
+
+static bool crcOfFile(FILE * fp, long length, uLong& crc)
+{
+    // from the start of the file
+    if (fseek(fp, 0, SEEK_SET) != 0)
+    {
+        return false;
+    }
+    char buffer[65536];
+    while (length > 0)
+    {
+        size_t chunk = (length < static_cast<long>(sizeof(buffer))) ? static_cast<size_t>(length) : sizeof(buffer);
+        if (fread(buffer, 1, chunk, fp) != chunk)
+        {
+            return false;
+        }
+        crc = crc32(crc, reinterpret_cast<const Bytef *>(buffer), static_cast<uInt>(chunk));
+        length -= static_cast<long>(chunk);
+    }
+    return true;
+}
+
+bool DRLibrary::open(const std::string& fileName)
+{
+    close();
+    FILE * fp = fopen(fileName.c_str(), "rb");
+    if (fp == NULL)
+    {
+        return false;
+    }
+
+    //-----
+    // the whole file is checked and the patterns read in before the
+    // automaton is mapped
+    //
+    LibraryTrailer trailer;
+    long length = -1;
+    if (fseek(fp, 0, SEEK_END) == 0)
+    {
+        length = ftell(fp);
+    }
+    if (length < static_cast<long>(sizeof(LibraryTrailer))
+        || fseek(fp, length - static_cast<long>(sizeof(LibraryTrailer)), SEEK_SET) != 0
+        || fread(&trailer, sizeof(LibraryTrailer), 1, fp) != 1
+        || memcmp(trailer.magic, libraryMagic, sizeof(libraryMagic)) != 0)
+    {
+        fclose(fp);
+        libraryError(fileName, "is not a direct repeat library");
+    }
+    if (trailer.version != DRL_FORMAT_VERSION)
+    {
+        fclose(fp);
+        libraryError(fileName, "was made by a different version");
+    }
+    long patterns_end = length - static_cast<long>(sizeof(LibraryTrailer));
+    if (trailer.patternsOffset > static_cast<unsigned long long>(patterns_end))
+    {
+        fclose(fp);
+        libraryError(fileName, "is truncated");
+    }
+    uLong crc = crc32(0L, Z_NULL, 0);
+    if (! crcOfFile(fp, patterns_end, crc))
+    {
+        fclose(fp);
+        libraryError(fileName, "could not be read");
+    }
+    if (static_cast<unsigned int>(crc) != trailer.crc)
+    {
+        fclose(fp);
+        libraryError(fileName, "is corrupt");
+    }
+    std::string buffer(patterns_end - static_cast<long>(trailer.patternsOffset), '\0');
+    if (fseek(fp, static_cast<long>(trailer.patternsOffset), SEEK_SET) != 0
+        || (! buffer.empty() && fread(&(buffer[0]), 1, buffer.length(), fp) != buffer.length()))
+    {
+        fclose(fp);
+        libraryError(fileName, "could not be read");
+    }
+    size_t pos = 0;
+    for (unsigned int i = 0; i < trailer.numPatterns; i++)
+    {
+        unsigned int pattern_length;
+        if (pos + sizeof(unsigned int) > buffer.length())
+        {
+            break;
+        }
+        memcpy(&pattern_length, buffer.data() + pos, sizeof(unsigned int));
+        pos += sizeof(unsigned int);
+        if (pos + pattern_length > buffer.length())
+        {
+            break;
+        }
+        mPatterns.push_back(buffer.substr(pos, pattern_length));
+        pos += pattern_length;
+    }
+    if (mPatterns.size() != trailer.numPatterns || pos != buffer.length())
+    {
+        fclose(fp);
+        mPatterns.clear();
+        libraryError(fileName, "is corrupt");
+    }
+
+    //-----
+    // acism_destroy only unmaps the automaton, the few pages of
+    // patterns after it stay mapped until the program exits. A run
+    // only opens one library so that isn't worth a copy of acism_mmap
+    //
+    if (! mPatterns.empty())
+    {
+        mAutomaton = acism_mmap(fp);
+        if (mAutomaton == NULL)
+        {
+            fclose(fp);
+            mPatterns.clear();
+            libraryError(fileName, "has no automaton in it");
+        }
+    }
+    fclose(fp);
+    refPatterns();
+    return true;
+}
+
+void DRLibrary::save(const std::string& fileName)
+{
+    std::string tmp_file_name = fileName + ".tmp";
+    FILE * fp = fopen(tmp_file_name.c_str(), "w+b");
+    if (fp == NULL)
+    {
+        libraryError(fileName, "could not be created");
+    }
+
+    LibraryTrailer trailer;
+    memset(&trailer, 0, sizeof(LibraryTrailer));
+    if (mAutomaton != NULL)
+    {
+        acism_save(fp, mAutomaton);
+    }
+    trailer.patternsOffset = static_cast<unsigned long long>(ftell(fp));
+    trailer.numPatterns = static_cast<unsigned int>(mPatterns.size());
+    trailer.version = DRL_FORMAT_VERSION;
+    memcpy(trailer.magic, libraryMagic, sizeof(libraryMagic));
+
+    // acism_save doesn't say what it wrote so it is read back for the crc
+    uLong crc = crc32(0L, Z_NULL, 0);
+    if (! crcOfFile(fp, static_cast<long>(trailer.patternsOffset), crc) || fseek(fp, 0, SEEK_END) != 0)
+    {
+        fclose(fp);
+        remove(tmp_file_name.c_str());
+        libraryError(fileName, "could not be written");
+    }
+    Vecstr::iterator pattern_iter;
+    for (pattern_iter = mPatterns.begin(); pattern_iter != mPatterns.end(); ++pattern_iter)
+    {
+        unsigned int pattern_length = static_cast<unsigned int>(pattern_iter->length());
+        fwrite(&pattern_length, sizeof(unsigned int), 1, fp);
+        fwrite(pattern_iter->data(), 1, pattern_length, fp);
+        crc = crc32(crc, reinterpret_cast<const Bytef *>(&pattern_length), sizeof(unsigned int));
+        crc = crc32(crc, reinterpret_cast<const Bytef *>(pattern_iter->data()), pattern_length);
+    }
+    trailer.crc = static_cast<unsigned int>(crc);
+    fwrite(&trailer, sizeof(LibraryTrailer), 1, fp);
+
+    bool written = (ferror(fp) == 0);
+    written = (fclose(fp) == 0) && written;
+    if (! written || rename(tmp_file_name.c_str(), fileName.c_str()) != 0)
+    {
+        remove(tmp_file_name.c_str());
+        libraryError(fileName, "could not be written");
+    }
+}
+
+void DRLibrary::close(void)
+{
+    if (mAutomaton != NULL)
+    {
+        acism_destroy(mAutomaton);
+        mAutomaton = NULL;
+    }
+    mPattv.clear();
+    mPatterns.clear();
+}
+
+bool DRLibrary::add(const Vecstr& patterns)
+{
+    std::set<std::string> all_patterns(mPatterns.begin(), mPatterns.end());
+    size_t old_size = all_patterns.size();
+    all_patterns.insert(patterns.begin(), patterns.end());
+    // the automaton can't match an empty pattern
+    all_patterns.erase("");
+    if (all_patterns.size() == old_size)
+    {
+        return false;
+    }
+    mPatterns.assign(all_patterns.begin(), all_patterns.end());
+    build();
+    return true;
+}
+
+void DRLibrary::addFasta(const std::string& fileName)
+{
+    GzipReader reader;
+    if (! reader.open(fileName.c_str()))
+    {
+        libraryError(fileName, "could not be opened");
+    }
+    Vecstr patterns;
+    kseq_t * seq = kseq_init(&reader);
+    int l;
+    while ((l = kseq_read(seq)) >= 0)
+    {
+        if (l == 0)
+        {
+            continue;
+        }
+        std::string pattern(seq->seq.s, seq->seq.l);
+        std::transform(pattern.begin(), pattern.end(), pattern.begin(), ::toupper);
+        patterns.push_back(pattern);
+        patterns.push_back(reverseComplement(pattern));
+    }
+    kseq_destroy(seq);
+    if (l < -1)
+    {
+        libraryError(fileName, "is not a fasta file");
+    }
+    add(patterns);
+}
+
+void DRLibrary::build(void)
+{
+    if (mAutomaton != NULL)
+    {
+        acism_destroy(mAutomaton);
+        mAutomaton = NULL;
+    }
+    refPatterns();
+    if (! mPattv.empty())
+    {
+        mAutomaton = acism_create(&(mPattv[0]), static_cast<int>(mPattv.size()));
+    }
+}
+
+void DRLibrary::refPatterns(void)
+{
+    mPattv.resize(mPatterns.size());
+    for (size_t i = 0; i < mPatterns.size(); i++)
+    {
+        mPattv[i].ptr = mPatterns[i].data();
+        mPattv[i].len = mPatterns[i].length();
+    }
+}
+
+typedef struct _library_match {
+    int strnum;
+    int textpos;
+} LibraryMatch;
+
+static int on_library_match(int strnum, int textpos, LibraryMatch *match)
+{
+    // like the singleton finder we stop at the first pattern found
+    match->strnum = strnum;
+    match->textpos = textpos;
+    return 1;
+}
+
+bool DRLibrary::find(const char * seq, size_t seqLength, unsigned int& start, unsigned int& end) const
+{
+    if (mAutomaton == NULL)
+    {
+        return false;
+    }
+    LibraryMatch match;
+    match.strnum = -1;
+    MEMREF text = {seq, seqLength};
+    (void)acism_scan(mAutomaton, text, (ACISM_ACTION*)on_library_match, &match);
+    if (match.strnum < 0)
+    {
+        return false;
+    }
+    // the position is one past the end of the match
+    end = static_cast<unsigned int>(match.textpos - 1);
+    if (end >= static_cast<unsigned int>(seqLength))
+    {
+        end = static_cast<unsigned int>(seqLength) - 1;
+    }
+    start = end - static_cast<unsigned int>(mPattv[match.strnum].len - 1);
+    return true;
+}
+
+typedef struct _library_matches {
+    const MEMREF * pattv;
+    int strnum;                                             // the first pattern found
+    std::vector<unsigned int> * startStops;
+} LibraryMatches;
+
+static int on_library_matches(int strnum, int textpos, LibraryMatches *matches)
+{
+    if (matches->strnum == -1)
+    {
+        matches->strnum = strnum;
+    }
+    else if (strnum != matches->strnum)
+    {
+        return 0;
+    }
+    // matches come in the order they end so only the start can overlap
+    unsigned int end = static_cast<unsigned int>(textpos - 1);
+    unsigned int start = end - static_cast<unsigned int>(matches->pattv[strnum].len - 1);
+    if (matches->startStops->empty() || start > matches->startStops->back())
+    {
+        matches->startStops->push_back(start);
+        matches->startStops->push_back(end);
+    }
+    return 0;
+}
+
+bool DRLibrary::findAll(const char * seq, size_t seqLength, std::vector<unsigned int>& startStops) const
+{
+    startStops.clear();
+    if (mAutomaton == NULL)
+    {
+        return false;
+    }
+    LibraryMatches matches;
+    matches.pattv = &(mPattv[0]);
+    matches.strnum = -1;
+    matches.startStops = &startStops;
+    MEMREF text = {seq, seqLength};
+    (void)acism_scan(mAutomaton, text, (ACISM_ACTION*)on_library_matches, &matches);
+    return ! startStops.empty();
+}
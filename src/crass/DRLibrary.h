@@ -0,0 +1,96 @@
+// File: DRLibrary.h
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// A library of direct repeats found in earlier runs. It holds the
+// non-redundant patterns and the aho-corasick automaton made from
+// them, and is saved to a single file that later runs map into memory
+// rather than building the automaton again. Reads with a known repeat
+// can then be recruited while the reads are first being searched.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+#ifndef DRLibrary_h
+#define DRLibrary_h
+
+// system includes
+#include <string>
+#include <vector>
+
+// local includes
+#include "Types.h"
+
+extern "C" {
+#include "../aho-corasick/msutil.h"
+#include "../aho-corasick/acism.h"
+}
+
+class DRLibrary
+{
+    public:
+        DRLibrary(void) { mAutomaton = NULL; }
+        ~DRLibrary(void) { close(); }
+
+        //
+        // File IO
+        //
+        bool open(const std::string& fileName);             // false if there is no library, throws if the file isn't one
+        void save(const std::string& fileName);             // written to a temporary file and moved into place
+        void close(void);
+
+        //
+        // Patterns
+        //
+        bool add(const Vecstr& patterns);                   // true if any were new, the automaton is made again
+        void addFasta(const std::string& fileName);         // each sequence and its reverse complement
+        inline size_t size(void) const { return mPatterns.size(); }
+        inline const Vecstr& patterns(void) const { return mPatterns; }
+
+        // the first pattern in seq, as the positions of its first and
+        // last bases. Safe to call from many threads at once
+        bool find(const char * seq, size_t seqLength, unsigned int& start, unsigned int& end) const;
+
+        // every place in seq the first pattern found appears, without
+        // overlaps, as start and stop pairs
+        bool findAll(const char * seq, size_t seqLength, std::vector<unsigned int>& startStops) const;
+
+    private:
+        void build(void);                                   // the automaton from mPatterns
+        void refPatterns(void);                             // point mPattv at mPatterns
+
+        // members
+        Vecstr mPatterns;                                   // sorted, no duplicates
+        std::vector<MEMREF> mPattv;                         // mPatterns as the automaton sees them
+        ACISM * mAutomaton;                                 // built or mapped, NULL when empty
+};
+
+#endif //DRLibrary_h
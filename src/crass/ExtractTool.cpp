@@ -19,7 +19,7 @@
 #include "config.h"
 #include "Exception.h"
 #include "StlExt.h"
-#include "reader.h"
+#include "streamreader.h"
 #include <getopt.h>
 #include <string>
 #include <iostream>
@@ -198,29 +198,11 @@ int ExtractTool::processOptions (int argc, char ** argv)
 
 int ExtractTool::processInputFile(const char * inputFile)
 {
-    // open the file
-    crispr::xml::reader xml_obj;
+    // read the file one group at a time
+    crispr::xml::streamreader xml_obj;
     try {
-        xercesc::DOMDocument * xml_doc = xml_obj.setFileParser(inputFile);
-        
-        xercesc::DOMElement * root_elem = xml_doc->getDocumentElement();
-        
-        if( !root_elem ) throw(crispr::xml_exception(__FILE__, 
-                                                     __LINE__, 
-                                                     __PRETTY_FUNCTION__, 
-                                                     "empty XML document" ));
-        
-        parseWantedGroups(xml_obj, root_elem);
-        
-    } catch( xercesc::XMLException& e ) {
-        char* message = xercesc::XMLString::transcode( e.getMessage() );
-        std::ostringstream errBuf;
-        errBuf << "Error parsing file: " << message << std::flush;
-        xercesc::XMLString::release( &message );
-        throw (crispr::xml_exception(__FILE__, 
-                                     __LINE__,
-                                     __PRETTY_FUNCTION__,
-                                     (errBuf.str()).c_str()));
+        ET_GroupsLeft = static_cast<int>(ET_Group.size());
+        xml_obj.parse(inputFile, ExtractTool::extractGroup, this);
         
     } catch (crispr::xml_exception& xe) {
         std::cerr<< xe.what()<<std::endl;
@@ -253,59 +235,62 @@ void ExtractTool::openStream(std::string& groupId)
         ET_FlankerStream.open((ET_OutputPrefix +ET_OutputNamePrefix+ groupId + "_flankers.fa").c_str());
     }
 }
-void ExtractTool::parseWantedGroups(crispr::xml::base& xmlObj, 
-                                    xercesc::DOMElement * rootElement)
+bool ExtractTool::extractGroup(xercesc::DOMElement * currentGroup, 
+                               crispr::xml::base& xmlObj, 
+                               void * context)
+{
+    return static_cast<ExtractTool *>(context)->parseWantedGroup(xmlObj, currentGroup);
+}
+
+// returns false once all of the wanted groups have been found
+bool ExtractTool::parseWantedGroup(crispr::xml::base& xmlObj, 
+                                   xercesc::DOMElement * currentGroup)
 {
     
     try {
-        int num_groups_to_process = static_cast<int>(ET_Group.size());
-        for (xercesc::DOMElement * currentElement = rootElement->getFirstElementChild(); 
-             currentElement != NULL; 
-             currentElement = currentElement->getNextElementSibling()) {
-            // break if we have processed all of the wanted groups
-            if(ET_BitMask[0] && num_groups_to_process == 0) {
-                break;
-            }
-            // new group
-            char * c_group_id = tc(currentElement->getAttribute(xmlObj.attr_Gid()));
-            std::string group_id = c_group_id;
-            xr(&c_group_id);
-            if (ET_BitMask[0]) {
-                // we only want some of the groups look at ET_Groups
-                if (ET_Group.find(group_id.substr(1)) == ET_Group.end() ) {
-                    continue;
-                }
-                
-                if (ET_BitMask[2]) openStream(group_id);
-                
-                extractDataFromGroup(xmlObj, currentElement);
-                
-                if(ET_BitMask[0]) num_groups_to_process--;
-                
-                if(ET_BitMask[2]) closeStream();
-            } else {
-                if (ET_BitMask[2]) openStream(group_id);
-                
-                extractDataFromGroup(xmlObj, currentElement);
-                
-                if(ET_BitMask[2]) closeStream();
+        // new group
+        char * c_group_id = tc(currentGroup->getAttribute(xmlObj.attr_Gid()));
+        std::string group_id = c_group_id;
+        xr(&c_group_id);
+        if (ET_BitMask[0]) {
+            // we only want some of the groups look at ET_Groups
+            if (ET_Group.find(group_id.substr(1)) == ET_Group.end() ) {
+                return true;
             }
+            
+            if (ET_BitMask[2]) openStream(group_id);
+            
+            extractDataFromGroup(xmlObj, currentGroup);
+            
+            ET_GroupsLeft--;
+            
+            if(ET_BitMask[2]) closeStream();
+            
+            // stop reading if we have processed all of the wanted groups
+            return (ET_GroupsLeft > 0);
+        } else {
+            if (ET_BitMask[2]) openStream(group_id);
+            
+            extractDataFromGroup(xmlObj, currentGroup);
+            
+            if(ET_BitMask[2]) closeStream();
         }
     } catch( xercesc::XMLException& e ) {
         char* message = xercesc::XMLString::transcode( e.getMessage() );
         std::stringstream errBuf;
         errBuf << "Error parsing file: " << message << std::flush;
+        xercesc::XMLString::release( &message );
         throw (crispr::xml_exception(__FILE__, 
                                      __LINE__,
                                      __PRETTY_FUNCTION__,
                                      (errBuf.str()).c_str()));
-        xercesc::XMLString::release( &message );
     } catch (crispr::xml_exception& xe) {
         std::cerr<< xe.what()<<std::endl;
-        return;
+        return false;
     } catch (std::exception& e) {
         std::cerr<<e.what()<<std::endl;
     }
+    return true;
 }
 
 void ExtractTool::extractDataFromGroup(crispr::xml::base& xmlDoc, 
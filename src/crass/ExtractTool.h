@@ -25,6 +25,7 @@
 #include <fstream>
 #include <bitset>
 #include "base.h"
+#include "streamreader.h"
 
 
 
@@ -44,7 +45,8 @@ public:
     void setOutputBuffer(std::ofstream& out, const char * file);
     // process the input
     int processInputFile(const char * inputFile);
-    void parseWantedGroups(crispr::xml::base& xmlObj, xercesc::DOMElement * rootElement);
+    static bool extractGroup(xercesc::DOMElement * currentGroup, crispr::xml::base& xmlObj, void * context);
+    bool parseWantedGroup(crispr::xml::base& xmlObj, xercesc::DOMElement * currentGroup);
     void extractDataFromGroup(crispr::xml::base& xmlDoc, xercesc::DOMElement * currentGroup);
     void processData(crispr::xml::base& xmlDoc, xercesc::DOMElement * currentType, ELEMENT_TYPE wantedType, std::string gid, std::ostream& outStream);
 private:
@@ -61,6 +63,7 @@ private:
         std::string ET_OutputPrefix;
         std::string ET_OutputHeaderPrefix;
         std::string ET_OutputNamePrefix;
+        int ET_GroupsLeft;                          // wanted groups that haven't been read yet
         std::bitset<7> ET_BitMask;
 /*
         each bit is for a different option:
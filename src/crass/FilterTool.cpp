@@ -18,10 +18,11 @@
 #include "FilterTool.h"
 #include "Exception.h"
 #include "config.h"
-#include "writer.h"
-#include "parser.h"
+#include "streamwriter.h"
+#include "streamreader.h"
 #include "StlExt.h"
 #include <iostream>
+#include <cstdio>
 #include <getopt.h>
 #include "Utils.h"
 
@@ -104,53 +105,38 @@ int FilterTool::processOptions (int argc, char ** argv)
 
 int FilterTool::processInputFile(const char * inputFile)
 {
+    if (FT_OutputFile.empty()) {
+        FT_OutputFile = inputFile;
+    }
+    // the groups are written out while the input is still being read and
+    // by default the output is the input file, so write to a temporary
+    // file and move it over the output at the end
+    std::string tmp_file = FT_OutputFile + ".tmp";
     try {
-        crispr::xml::writer output_xml;
-        int output_error;
-        xercesc::DOMElement * output_root_elem = output_xml.createDOMDocument("crispr", "1.1", output_error);
-        if(output_error && NULL == output_root_elem) {
+        crispr::xml::streamwriter output_xml;
+        if(! output_xml.createDocument(tmp_file, "crispr", "1.1")) {
             throw crispr::xml_exception(__FILE__, 
                                         __LINE__,
                                         __PRETTY_FUNCTION__,
                                         "Cannot create output xml file");
         }
         
-        crispr::xml::parser xml_parser;
-        xercesc::DOMDocument * input_doc_obj = xml_parser.setFileParser(inputFile);
-        xercesc::DOMElement * root_elem = input_doc_obj->getDocumentElement();
-        if (!root_elem) {
-            throw crispr::xml_exception(__FILE__, 
-                                        __LINE__, 
-                                        __PRETTY_FUNCTION__, 
-                                        "problem when parsing xml file");
-        }
-        if (FT_OutputFile.empty()) {
-            FT_OutputFile = inputFile;
-        }
-        
-        std::vector<xercesc::DOMElement * > good_children;
+        crispr::xml::streamreader xml_parser;
+        FT_Reader = &xml_parser;
+        FT_Output = &output_xml;
+        xml_parser.parse(inputFile, FilterTool::filterGroup, this);
+        FT_Reader = NULL;
+        FT_Output = NULL;
 
-        for (xercesc::DOMElement * currentElement = root_elem->getFirstElementChild(); 
-             currentElement != NULL; 
-             currentElement = currentElement->getNextElementSibling()) {
-                
-            // the user wants to change any of these 
-            if (FT_Spacers || FT_Repeats || FT_Flank || FT_Coverage) {
-                if (! parseGroup(currentElement, xml_parser)) {
-                    good_children.push_back(currentElement);
-                }
-            }
-        }
-        std::vector<xercesc::DOMElement * >::iterator iter = good_children.begin();
-        xercesc::DOMDocument * output_document = output_xml.getDocumentObj();
-        while (iter != good_children.end()) {
-            output_root_elem->appendChild(output_document->importNode(*iter, true));
-            iter++;
+        if (! output_xml.finishDocument() || rename(tmp_file.c_str(), FT_OutputFile.c_str())) {
+            throw crispr::xml_exception(__FILE__, 
+                                        __LINE__,
+                                        __PRETTY_FUNCTION__,
+                                        ("Cannot write " + FT_OutputFile).c_str());
         }
-
-        output_xml.printDOMToFile(FT_OutputFile, output_document);
     } catch (crispr::xml_exception& e) {
         std::cerr<<e.what()<<std::endl;
+        remove(tmp_file.c_str());
         return 1;
     } catch (xercesc::DOMException& e) {
         char * c_msg = tc(e.getMessage());
@@ -158,15 +144,30 @@ int FilterTool::processInputFile(const char * inputFile)
         << XERCES_STD_QUALIFIER endl
         << c_msg << XERCES_STD_QUALIFIER endl;
         xr(&c_msg);
+        remove(tmp_file.c_str());
         return 1;
     }
     
     return 0;
 }
 
+bool FilterTool::filterGroup(xercesc::DOMElement * currentElement, 
+                             crispr::xml::base& xmlParser, 
+                             void * context)
+{
+    FilterTool * ft = static_cast<FilterTool *>(context);
+    // the user wants to change any of these 
+    if (ft->FT_Spacers || ft->FT_Repeats || ft->FT_Flank || ft->FT_Coverage) {
+        if (! ft->parseGroup(currentElement, xmlParser)) {
+            ft->FT_Reader->copyElement(currentElement, *(ft->FT_Output));
+        }
+    }
+    return true;
+}
+
 // return true if group should be removed
 bool FilterTool::parseGroup(xercesc::DOMElement * parentNode, 
-                            crispr::xml::reader& xmlParser)
+                            crispr::xml::base& xmlParser)
 {
     // get the data tag and make sure that everything is good
     xercesc::DOMElement * currentElement = parentNode->getFirstElementChild();
@@ -190,7 +191,7 @@ bool FilterTool::parseGroup(xercesc::DOMElement * parentNode,
 
 // return true if group should be removed
 bool FilterTool::parseData(xercesc::DOMElement * parentNode, 
-                           crispr::xml::reader& xmlParser,
+                           crispr::xml::base& xmlParser,
                            std::set<std::string>& spacersToRemove)
 {
     for (xercesc::DOMElement * currentElement = parentNode->getFirstElementChild(); 
@@ -234,7 +235,7 @@ int FilterTool::countElements(xercesc::DOMElement * parentNode)
     return count;
 }
 
-int FilterTool::parseSpacers(xercesc::DOMElement *parentNode, crispr::xml::reader& xmlParser, std::set<std::string>& spacersToRemove) {
+int FilterTool::parseSpacers(xercesc::DOMElement *parentNode, crispr::xml::base& xmlParser, std::set<std::string>& spacersToRemove) {
     if (FT_Coverage) {
         std::vector<xercesc::DOMElement * > remove_list;
         for (xercesc::DOMElement * currentSpacer = parentNode->getFirstElementChild(); 
@@ -263,7 +264,7 @@ int FilterTool::parseSpacers(xercesc::DOMElement *parentNode, crispr::xml::reade
 }
 
 void FilterTool::parseAssembly(xercesc::DOMElement * parentNode, 
-                             crispr::xml::reader& xmlParser, std::set<std::string>& spacersToRemove)
+                             crispr::xml::base& xmlParser, std::set<std::string>& spacersToRemove)
 {
     for (xercesc::DOMElement * currentElement = parentNode->getFirstElementChild(); 
          currentElement != NULL; 
@@ -282,7 +283,7 @@ void FilterTool::parseAssembly(xercesc::DOMElement * parentNode,
 }
 
 void FilterTool::parseContig(xercesc::DOMElement * parentNode, 
-                           crispr::xml::reader& xmlParser, 
+                           crispr::xml::base& xmlParser, 
                              std::string& contigId, std::set<std::string>& spacersToRemove)
 {
     std::vector<xercesc::DOMElement* > remove_list;
@@ -310,7 +311,7 @@ void FilterTool::parseContig(xercesc::DOMElement * parentNode,
 }
 
 void FilterTool::parseCSpacer(xercesc::DOMElement * parentNode, 
-                            crispr::xml::reader& xmlParser, 
+                            crispr::xml::base& xmlParser, 
                             std::string& contigId, std::set<std::string>& spacersToRemove)
 {
     for (xercesc::DOMElement * currentElement = parentNode->getFirstElementChild(); 
@@ -329,7 +330,7 @@ void FilterTool::parseCSpacer(xercesc::DOMElement * parentNode,
 }
 
 void FilterTool::parseLinkSpacers(xercesc::DOMElement * parentNode, 
-                                crispr::xml::reader& xmlParser, 
+                                crispr::xml::base& xmlParser, 
                                 std::string& contigId, std::set<std::string>& spacersToRemove)
 {
     std::vector<xercesc::DOMElement* > remove_list;
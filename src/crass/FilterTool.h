@@ -17,7 +17,9 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "reader.h"
+#include "base.h"
+#include "streamreader.h"
+#include "streamwriter.h"
 #include <bitset>
 #include <set>
 #include <vector>
@@ -29,6 +31,8 @@ class FilterTool {
     int FT_contigs;
     int FT_Coverage;
     std::string FT_OutputFile;
+    crispr::xml::streamreader * FT_Reader;      // the input file while it is being read
+    crispr::xml::streamwriter * FT_Output;      // where the groups that pass go
 	int countElements(xercesc::DOMElement * parentNode);
    public: 
     FilterTool() {
@@ -37,24 +41,27 @@ class FilterTool {
         FT_Flank = 0;
         FT_contigs = 0;
         FT_Coverage = 0;
+        FT_Reader = NULL;
+        FT_Output = NULL;
     }
 
 int processOptions(int argc, char ** argv);
 int processInputFile(const char * inputFile);
-bool parseGroup(xercesc::DOMElement * parentNode, crispr::xml::reader& xmlParser);
-bool parseData(xercesc::DOMElement * parentNode, crispr::xml::reader& xmlParser, std::set<std::string>& spacersToRemove);
+static bool filterGroup(xercesc::DOMElement * currentElement, crispr::xml::base& xmlParser, void * context);
+bool parseGroup(xercesc::DOMElement * parentNode, crispr::xml::base& xmlParser);
+bool parseData(xercesc::DOMElement * parentNode, crispr::xml::base& xmlParser, std::set<std::string>& spacersToRemove);
 inline int parseDrs(xercesc::DOMElement * parentNode){return countElements(parentNode);}
-    int parseSpacers(xercesc::DOMElement * parentNode, crispr::xml::reader& xmlParser, std::set<std::string>& spacersToRemove);
+    int parseSpacers(xercesc::DOMElement * parentNode, crispr::xml::base& xmlParser, std::set<std::string>& spacersToRemove);
 inline int parseFlankers(xercesc::DOMElement * parentNode){return countElements(parentNode);}
-    void parseAssembly(xercesc::DOMElement * parentNode, crispr::xml::reader& xmlParser, std::set<std::string>& spacersToRemove); 
+    void parseAssembly(xercesc::DOMElement * parentNode, crispr::xml::base& xmlParser, std::set<std::string>& spacersToRemove); 
     void parseContig(xercesc::DOMElement * parentNode, 
-                                 crispr::xml::reader& xmlParser, 
+                                 crispr::xml::base& xmlParser, 
                      std::string& contigId, std::set<std::string>& spacersToRemove);
     void parseCSpacer(xercesc::DOMElement * parentNode, 
-                                  crispr::xml::reader& xmlParser, 
+                                  crispr::xml::base& xmlParser, 
                       std::string& contigId, std::set<std::string>& spacersToRemove);
     void parseLinkSpacers(xercesc::DOMElement * parentNode, 
-                                      crispr::xml::reader& xmlParser, 
+                                      crispr::xml::base& xmlParser, 
                                       std::string& contigId, std::set<std::string>& spacersToRemove);
 };
 
@@ -0,0 +1,578 @@
+// File: GzipReader.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Implementation of the threaded input reader.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+// system includes
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <zlib.h>
+
+// local includes
+#include "GzipReader.h"
+#include "TaskPool.h"
+#include "Exception.h"
+#include "crassDefines.h"
+
+// a BGZF block is a gzip member with a 'BC' extra field holding its size
+#define BGZF_HEADER_SIZE        (18)
+#define BGZF_FOOTER_SIZE        (8)
+#define BGZF_MAX_BLOCK_SIZE     (65536)
+
+static bool isGzipHeader(const unsigned char * header)
+{
+    return header[0] == 31 && header[1] == 139;
+}
+
+static bool isBgzfHeader(const unsigned char * header)
+{
+    // the same test bgzip uses
+    return isGzipHeader(header) && header[2] == 8 && (header[3] & 4) != 0 &&
+           header[10] == 6 && header[11] == 0 &&
+           header[12] == 'B' && header[13] == 'C' &&
+           header[14] == 2 && header[15] == 0;
+}
+
+static unsigned int littleEndian32(const unsigned char * bytes)
+{
+    return static_cast<unsigned int>(bytes[0]) |
+           (static_cast<unsigned int>(bytes[1]) << 8) |
+           (static_cast<unsigned int>(bytes[2]) << 16) |
+           (static_cast<unsigned int>(bytes[3]) << 24);
+}
+
+static size_t readFile(int fd, void * buffer, size_t length)
+{
+    for (;;)
+    {
+        ssize_t count = ::read(fd, buffer, length);
+        if (count >= 0)
+        {
+            return static_cast<size_t>(count);
+        }
+        if (errno != EINTR)
+        {
+            std::stringstream ss;
+            ss<<"Read failed: "<<strerror(errno);
+            throw crispr::input_exception(ss.str().c_str());
+        }
+    }
+}
+
+#ifdef HAVE_PTHREAD
+static void * decodeThread(void * arg)
+{
+    static_cast<GzipReader *>(arg)->decode();
+    return NULL;
+}
+#endif
+
+static void inflateBlockTask(size_t block, void * context)
+{
+    static_cast<GzipReader *>(context)->inflateBlock(block);
+}
+
+GzipReader::GzipReader(int numThreads)
+{
+    mFd = -1;
+    mOwnsFd = false;
+    mNumThreads = (numThreads < 1) ? 1 : numThreads;
+    mFormat = Plain;
+    mInputStart = mInputEnd = 0;
+    mInputEof = false;
+    mStreamOpen = false;
+    mBlockTarget = NULL;
+    mHead = mTail = mFilled = mPos = 0;
+    mHaveCurrent = mFinished = mStop = mFailed = false;
+#ifdef HAVE_PTHREAD
+    mThreadRunning = false;
+    pthread_mutex_init(&mLock, NULL);
+    pthread_cond_init(&mNotEmpty, NULL);
+    pthread_cond_init(&mNotFull, NULL);
+#endif
+}
+
+GzipReader::~GzipReader(void)
+{
+    close();
+#ifdef HAVE_PTHREAD
+    pthread_cond_destroy(&mNotFull);
+    pthread_cond_destroy(&mNotEmpty);
+    pthread_mutex_destroy(&mLock);
+#endif
+}
+
+bool GzipReader::open(const char * inputFile)
+{
+    close();
+    mFileName = inputFile;
+    if (strcmp(inputFile, "-") == 0)
+    {
+        mFd = fileno(stdin);
+        mOwnsFd = false;
+    }
+    else
+    {
+        mFd = ::open(inputFile, O_RDONLY);
+        mOwnsFd = true;
+    }
+    if (mFd < 0)
+    {
+        mOwnsFd = false;
+        return false;
+    }
+
+    mInput.resize(CRASS_DEF_INPUT_CHUNK_SIZE);
+    mInputStart = mInputEnd = 0;
+    mInputEof = false;
+    mRing.resize(CRASS_DEF_INPUT_BUFFERS);
+    mHead = mTail = mFilled = mPos = 0;
+    mHaveCurrent = mFinished = mStop = mFailed = false;
+    mError.clear();
+    try {
+        detectFormat();
+    } catch (crispr::exception& e) {
+        close();
+        return false;
+    }
+
+#ifdef HAVE_PTHREAD
+    // if the thread can't be started the buffers are decoded as they are needed
+    mThreadRunning = (pthread_create(&mThread, NULL, decodeThread, this) == 0);
+#endif
+    return true;
+}
+
+void GzipReader::close(void)
+{
+#ifdef HAVE_PTHREAD
+    if (mThreadRunning)
+    {
+        pthread_mutex_lock(&mLock);
+        mStop = true;
+        pthread_cond_signal(&mNotFull);
+        pthread_mutex_unlock(&mLock);
+        pthread_join(mThread, NULL);
+        mThreadRunning = false;
+    }
+#endif
+    if (mStreamOpen)
+    {
+        inflateEnd(&mStream);
+        mStreamOpen = false;
+    }
+    if (mOwnsFd)
+    {
+        ::close(mFd);
+    }
+    mFd = -1;
+    mOwnsFd = false;
+    mHaveCurrent = false;
+}
+
+int GzipReader::read(char * buffer, int length)
+{
+    if (mFd < 0)
+    {
+        return 0;
+    }
+    int copied = 0;
+    while (copied < length)
+    {
+        if (! mHaveCurrent || mPos == mRing[mHead].mLength)
+        {
+            if (! nextBuffer())
+            {
+                break;
+            }
+        }
+        size_t count = mRing[mHead].mLength - mPos;
+        if (count > static_cast<size_t>(length - copied))
+        {
+            count = static_cast<size_t>(length - copied);
+        }
+        memcpy(buffer + copied, &(mRing[mHead].mData[mPos]), count);
+        mPos += count;
+        copied += static_cast<int>(count);
+    }
+    return copied;
+}
+
+bool GzipReader::nextBuffer(void)
+{
+    bool have_buffer = false;
+    bool failed = false;
+#ifdef HAVE_PTHREAD
+    if (mThreadRunning)
+    {
+        //-----
+        // give the buffer that has been read back to the decoding
+        // thread and wait for the next one
+        //
+        pthread_mutex_lock(&mLock);
+        if (mHaveCurrent)
+        {
+            mHead = (mHead + 1) % mRing.size();
+            mFilled--;
+            mHaveCurrent = false;
+            pthread_cond_signal(&mNotFull);
+        }
+        while (mFilled == 0 && ! mFinished)
+        {
+            pthread_cond_wait(&mNotEmpty, &mLock);
+        }
+        have_buffer = (mFilled > 0);
+        failed = mFailed;
+        pthread_mutex_unlock(&mLock);
+    }
+    else
+#endif
+    {
+        //-----
+        // no decoding thread, decode straight into the first buffer
+        //
+        mHaveCurrent = false;
+        mHead = 0;
+        while (! mFinished && ! have_buffer)
+        {
+            try {
+                mFinished = ! fill(mRing[0]);
+            } catch (crispr::exception& e) {
+                mFinished = mFailed = true;
+                mError = e.what();
+            }
+            have_buffer = (mRing[0].mLength > 0);
+        }
+        failed = mFailed;
+    }
+
+    if (! have_buffer)
+    {
+        if (failed)
+        {
+            std::stringstream ss;
+            ss<<"Could not read "<<mFileName<<": "<<mError;
+            throw crispr::exception(__FILE__,
+                                    __LINE__,
+                                    __PRETTY_FUNCTION__,
+                                    ss);
+        }
+        return false;
+    }
+    mHaveCurrent = true;
+    mPos = 0;
+    return true;
+}
+
+void GzipReader::decode(void)
+{
+#ifdef HAVE_PTHREAD
+    for (;;)
+    {
+        pthread_mutex_lock(&mLock);
+        while (mFilled == mRing.size() && ! mStop)
+        {
+            pthread_cond_wait(&mNotFull, &mLock);
+        }
+        bool stop = mStop;
+        size_t slot = mTail;
+        pthread_mutex_unlock(&mLock);
+        if (stop)
+        {
+            return;
+        }
+
+        bool more;
+        std::string error;
+        try {
+            more = fill(mRing[slot]);
+        } catch (crispr::exception& e) {
+            more = false;
+            error = e.what();
+        }
+
+        pthread_mutex_lock(&mLock);
+        if (mRing[slot].mLength > 0)
+        {
+            mTail = (mTail + 1) % mRing.size();
+            mFilled++;
+        }
+        if (! error.empty())
+        {
+            mFailed = true;
+            mError = error;
+        }
+        mFinished = ! more;
+        pthread_cond_signal(&mNotEmpty);
+        pthread_mutex_unlock(&mLock);
+        if (! more)
+        {
+            return;
+        }
+    }
+#endif
+}
+
+//
+// Decoding, only ever done by one thread at a time
+//
+size_t GzipReader::readInput(size_t wanted)
+{
+    size_t available = mInputEnd - mInputStart;
+    if (available >= wanted || mInputEof)
+    {
+        return available;
+    }
+    if (mInputStart > 0)
+    {
+        if (available > 0)
+        {
+            memmove(&mInput[0], &mInput[mInputStart], available);
+        }
+        mInputStart = 0;
+        mInputEnd = available;
+    }
+    if (mInput.size() < wanted)
+    {
+        mInput.resize(wanted);
+    }
+    while (mInputEnd < wanted && ! mInputEof)
+    {
+        size_t count = readFile(mFd, &mInput[mInputEnd], mInput.size() - mInputEnd);
+        if (count == 0)
+        {
+            mInputEof = true;
+        }
+        mInputEnd += count;
+    }
+    return mInputEnd - mInputStart;
+}
+
+void GzipReader::detectFormat(void)
+{
+    size_t available = readInput(BGZF_HEADER_SIZE);
+    const unsigned char * header = &mInput[mInputStart];
+    if (available >= BGZF_HEADER_SIZE && isBgzfHeader(header))
+    {
+        mFormat = Bgzf;
+    }
+    else if (available >= 2 && isGzipHeader(header))
+    {
+        mFormat = Gzip;
+        memset(&mStream, 0, sizeof(mStream));
+        if (inflateInit2(&mStream, 15 + 16) != Z_OK)
+        {
+            throw crispr::input_exception("Could not start inflating");
+        }
+        mStreamOpen = true;
+    }
+    else
+    {
+        mFormat = Plain;
+    }
+}
+
+bool GzipReader::fill(DecodedBuffer& out)
+{
+    out.mLength = 0;
+    if (out.mData.size() < CRASS_DEF_INPUT_BUFFER_SIZE)
+    {
+        out.mData.resize(CRASS_DEF_INPUT_BUFFER_SIZE);
+    }
+    switch (mFormat)
+    {
+        case Bgzf: return fillBgzf(out);
+        case Gzip: return fillGzip(out);
+        default: return fillPlain(out);
+    }
+}
+
+bool GzipReader::fillPlain(DecodedBuffer& out)
+{
+    // the bytes looked at by detectFormat go first
+    size_t buffered = mInputEnd - mInputStart;
+    if (buffered > 0)
+    {
+        memcpy(&out.mData[0], &mInput[mInputStart], buffered);
+        mInputStart = mInputEnd = 0;
+        out.mLength = buffered;
+    }
+    while (out.mLength < out.mData.size() && ! mInputEof)
+    {
+        size_t count = readFile(mFd, &out.mData[out.mLength], out.mData.size() - out.mLength);
+        if (count == 0)
+        {
+            mInputEof = true;
+        }
+        out.mLength += count;
+    }
+    return ! mInputEof;
+}
+
+bool GzipReader::fillGzip(DecodedBuffer& out)
+{
+    mStream.next_out = reinterpret_cast<Bytef *>(&out.mData[0]);
+    mStream.avail_out = static_cast<uInt>(out.mData.size());
+    while (mStream.avail_out > 0)
+    {
+        if (readInput(1) == 0)
+        {
+            // the end of the file came before the end of the member
+            throw crispr::input_exception("The compressed input is truncated");
+        }
+        mStream.next_in = &mInput[mInputStart];
+        mStream.avail_in = static_cast<uInt>(mInputEnd - mInputStart);
+        int ret = inflate(&mStream, Z_NO_FLUSH);
+        mInputStart = mInputEnd - mStream.avail_in;
+        if (ret == Z_STREAM_END)
+        {
+            //-----
+            // concatenated files have another member straight after,
+            // anything else that follows is ignored the same as gzread
+            //
+            if (readInput(2) < 2 || ! isGzipHeader(&mInput[mInputStart]))
+            {
+                out.mLength = out.mData.size() - mStream.avail_out;
+                return false;
+            }
+            inflateReset(&mStream);
+        }
+        else if (ret != Z_OK && ret != Z_BUF_ERROR)
+        {
+            std::stringstream ss;
+            ss<<"The compressed input is corrupt";
+            if (mStream.msg != NULL)
+            {
+                ss<<" ("<<mStream.msg<<")";
+            }
+            throw crispr::input_exception(ss.str().c_str());
+        }
+    }
+    out.mLength = out.mData.size();
+    return true;
+}
+
+bool GzipReader::fillBgzf(DecodedBuffer& out)
+{
+    //-----
+    // gather whole blocks until the next one would not fit in the
+    // buffer, the decoded size of each is in its last four bytes, so
+    // they can all be inflated into place at the same time
+    //
+    mBlocks.clear();
+    mBlockStarts.clear();
+    mBlockOutputs.clear();
+    size_t decoded = 0;
+    bool more = true;
+    for (;;)
+    {
+        size_t available = readInput(BGZF_HEADER_SIZE);
+        if (available == 0)
+        {
+            more = false;
+            break;
+        }
+        if (available < BGZF_HEADER_SIZE || ! isBgzfHeader(&mInput[mInputStart]))
+        {
+            throw crispr::input_exception("The input is not made of BGZF blocks all the way through");
+        }
+        size_t block_size = (mInput[mInputStart + 16] | (mInput[mInputStart + 17] << 8)) + 1;
+        if (block_size < BGZF_HEADER_SIZE + BGZF_FOOTER_SIZE)
+        {
+            throw crispr::input_exception("The input has a BGZF block that is too small");
+        }
+        if (readInput(block_size) < block_size)
+        {
+            throw crispr::input_exception("The compressed input is truncated");
+        }
+        const unsigned char * block = &mInput[mInputStart];
+        size_t block_output = littleEndian32(block + block_size - 4);
+        if (block_output > BGZF_MAX_BLOCK_SIZE)
+        {
+            throw crispr::input_exception("The input has a BGZF block that is too big");
+        }
+        if (decoded + block_output > out.mData.size())
+        {
+            // it goes first in the next buffer
+            break;
+        }
+        mBlockStarts.push_back(mBlocks.size());
+        mBlockOutputs.push_back(decoded);
+        mBlocks.insert(mBlocks.end(), block, block + block_size);
+        mInputStart += block_size;
+        decoded += block_output;
+    }
+    size_t num_blocks = mBlockOutputs.size();
+    mBlockStarts.push_back(mBlocks.size());
+    mBlockOutputs.push_back(decoded);
+    mBlockTarget = &out;
+    runTasks(num_blocks, mNumThreads, inflateBlockTask, this);
+    out.mLength = decoded;
+    return more;
+}
+
+void GzipReader::inflateBlock(size_t block)
+{
+    const unsigned char * data = &mBlocks[mBlockStarts[block]];
+    size_t length = mBlockStarts[block + 1] - mBlockStarts[block];
+    size_t expected = mBlockOutputs[block + 1] - mBlockOutputs[block];
+    Bytef * output = reinterpret_cast<Bytef *>(&(mBlockTarget->mData[0]) + mBlockOutputs[block]);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, -15) != Z_OK)
+    {
+        throw crispr::input_exception("Could not start inflating");
+    }
+    stream.next_in = const_cast<Bytef *>(data + BGZF_HEADER_SIZE);
+    stream.avail_in = static_cast<uInt>(length - BGZF_HEADER_SIZE - BGZF_FOOTER_SIZE);
+    stream.next_out = output;
+    stream.avail_out = static_cast<uInt>(expected);
+    int ret = inflate(&stream, Z_FINISH);
+    size_t produced = expected - stream.avail_out;
+    inflateEnd(&stream);
+
+    if (ret != Z_STREAM_END || produced != expected ||
+        crc32(crc32(0L, Z_NULL, 0), output, static_cast<uInt>(expected)) != littleEndian32(data + length - BGZF_FOOTER_SIZE))
+    {
+        throw crispr::input_exception("The input has a corrupt BGZF block");
+    }
+}
@@ -0,0 +1,136 @@
+// File: GzipReader.h
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Reads the FASTA/FASTQ input files for kseq in place of gzread. The
+// input is decoded on a thread of its own into a ring of buffers that
+// kseq copies out of, so inflate runs alongside the search rather
+// than in front of it. BGZF files (bgzip, samtools) are a series of
+// independent gzip members that each say how long they are, so batches
+// of them are inflated on all of the threads at once. Ordinary gzip,
+// multi-member gzip and uncompressed files are read in order.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+#ifndef GzipReader_h
+#define GzipReader_h
+
+// system includes
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+// local includes
+#include "config.h"
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+class GzipReader
+{
+    public:
+        enum Format {
+            Plain,                                          // not compressed
+            Gzip,                                           // one or more gzip members
+            Bgzf                                            // gzip members with their sizes in the header
+        };
+
+        GzipReader(int numThreads = 1);
+        ~GzipReader(void);
+
+        bool open(const char * inputFile);                  // "-" is stdin, false if the file can't be opened
+        int read(char * buffer, int length);                // like gzread, 0 at the end of the file
+        void close(void);
+
+        inline Format format(void) { return mFormat; }
+
+        // used by the decoding thread
+        void decode(void);
+        void inflateBlock(size_t block);
+
+    private:
+        struct DecodedBuffer {
+            std::vector<char> mData;
+            size_t mLength;
+        };
+
+        bool fill(DecodedBuffer& out);                      // decode the next piece of the file, false at the end
+        bool fillPlain(DecodedBuffer& out);
+        bool fillGzip(DecodedBuffer& out);
+        bool fillBgzf(DecodedBuffer& out);
+        size_t readInput(size_t wanted);                    // make sure there are wanted bytes of input, returns how many there are
+        void detectFormat(void);
+        bool nextBuffer(void);
+
+        // members
+        std::string mFileName;
+        int mFd;
+        bool mOwnsFd;
+        int mNumThreads;
+        Format mFormat;
+
+        // compressed input, only touched by the decoding thread
+        std::vector<unsigned char> mInput;
+        size_t mInputStart;
+        size_t mInputEnd;
+        bool mInputEof;
+        z_stream mStream;
+        bool mStreamOpen;
+
+        // the BGZF blocks being inflated together
+        std::vector<unsigned char> mBlocks;
+        std::vector<size_t> mBlockStarts;                   // offset of each block in mBlocks
+        std::vector<size_t> mBlockOutputs;                  // offset of each block in the decoded buffer
+        DecodedBuffer * mBlockTarget;
+
+        // ring of decoded buffers, filled at mTail and read from mHead
+        std::vector<DecodedBuffer> mRing;
+        size_t mHead;
+        size_t mTail;
+        size_t mFilled;
+        size_t mPos;                                        // position in mRing[mHead]
+        bool mHaveCurrent;                                  // the reader is using mRing[mHead]
+        bool mFinished;                                     // nothing more will be decoded
+        bool mStop;                                         // the file was closed before the end
+        bool mFailed;
+        std::string mError;
+#ifdef HAVE_PTHREAD
+        pthread_t mThread;
+        bool mThreadRunning;
+        pthread_mutex_t mLock;
+        pthread_cond_t mNotEmpty;
+        pthread_cond_t mNotFull;
+#endif
+};
+
+#endif //GzipReader_h
@@ -0,0 +1,178 @@
+// File: KmerRepeatFinder.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Implementation of KmerRepeatFinder functions
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+// system includes
+#include <string>
+#include <vector>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// local includes
+#include "KmerRepeatFinder.h"
+
+void KmerRepeatFinder::encode(const std::string& seq)
+{
+    //-----
+    // A = 0, C = 1, G = 2, T = 3, everything else (N, lowercase, IUPAC)
+    // is invalid. Sixteen bases at a time when we have SSE2
+    //
+    size_t length = seq.length();
+    mBases.resize(length);
+    const char * in = seq.data();
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i base_a = _mm_set1_epi8('A');
+    const __m128i base_c = _mm_set1_epi8('C');
+    const __m128i base_g = _mm_set1_epi8('G');
+    const __m128i base_t = _mm_set1_epi8('T');
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i two = _mm_set1_epi8(2);
+    const __m128i three = _mm_set1_epi8(3);
+    const __m128i invalid = _mm_set1_epi8(KRF_INVALID_BASE);
+    for (; i + 16 <= length; i += 16)
+    {
+        __m128i bases = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        __m128i is_a = _mm_cmpeq_epi8(bases, base_a);
+        __m128i is_c = _mm_cmpeq_epi8(bases, base_c);
+        __m128i is_g = _mm_cmpeq_epi8(bases, base_g);
+        __m128i is_t = _mm_cmpeq_epi8(bases, base_t);
+        __m128i codes = _mm_or_si128(_mm_and_si128(is_c, one),
+                                     _mm_or_si128(_mm_and_si128(is_g, two),
+                                                  _mm_and_si128(is_t, three)));
+        __m128i valid = _mm_or_si128(_mm_or_si128(is_a, is_c), _mm_or_si128(is_g, is_t));
+        codes = _mm_or_si128(codes, _mm_andnot_si128(valid, invalid));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&(mBases[i])), codes);
+    }
+#endif
+    for (; i < length; ++i)
+    {
+        switch (in[i])
+        {
+            case 'A': mBases[i] = 0; break;
+            case 'C': mBases[i] = 1; break;
+            case 'G': mBases[i] = 2; break;
+            case 'T': mBases[i] = 3; break;
+            default: mBases[i] = KRF_INVALID_BASE; break;
+        }
+    }
+}
+
+void KmerRepeatFinder::index(const std::string& seq, unsigned int kmerLength)
+{
+    mKmerLength = kmerLength;
+    mMask = (kmerLength >= KRF_MAX_KMER_LENGTH) ? ~0u : ((1u << (2 * kmerLength)) - 1);
+    encode(seq);
+
+    size_t length = seq.length();
+    if (kmerLength == 0 || kmerLength > KRF_MAX_KMER_LENGTH || length < kmerLength)
+    {
+        mKmers.clear();
+        mNext.clear();
+        return;
+    }
+    size_t num_kmers = length - kmerLength + 1;
+    mKmers.resize(num_kmers);
+    mNext.resize(num_kmers);
+
+    //-----
+    // rolling 2-bit code of every kmer, remembering the last invalid
+    // base so that kmers containing it are left out of the index
+    //
+    unsigned int code = 0;
+    long last_invalid = -1;
+    for (size_t i = 0; i < length; ++i)
+    {
+        unsigned int base = mBases[i];
+        if (base == KRF_INVALID_BASE)
+        {
+            last_invalid = static_cast<long>(i);
+            base = 0;
+        }
+        code = ((code << 2) | base) & mMask;
+        if (i + 1 >= kmerLength)
+        {
+            size_t start = i + 1 - kmerLength;
+            mKmers[start] = code;
+            mNext[start] = (last_invalid >= static_cast<long>(start)) ? KRF_NOT_INDEXED : -1;
+        }
+    }
+
+    //-----
+    // link each kmer to its next copy by walking the read backwards
+    // through a small hash table that holds the last position seen
+    //
+    size_t num_slots = 16;
+    while (num_slots < 2 * num_kmers)
+    {
+        num_slots <<= 1;
+    }
+    mSlots.assign(num_slots, -1);
+    size_t slot_mask = num_slots - 1;
+    for (size_t start = num_kmers; start-- > 0; )
+    {
+        if (mNext[start] == KRF_NOT_INDEXED)
+        {
+            continue;
+        }
+        code = mKmers[start];
+        size_t slot = (code * 2654435761u) & slot_mask;
+        while (mSlots[slot] != -1 && mKmers[mSlots[slot]] != code)
+        {
+            slot = (slot + 1) & slot_mask;
+        }
+        mNext[start] = mSlots[slot];
+        mSlots[slot] = static_cast<int>(start);
+    }
+}
+
+int KmerRepeatFinder::findRepeat(unsigned int start, unsigned int begin, unsigned int end)
+{
+    if (! isIndexed(start) || end < begin + mKmerLength)
+    {
+        return -1;
+    }
+    int position = mNext[start];
+    while (position >= 0 && static_cast<unsigned int>(position) < begin)
+    {
+        position = mNext[position];
+    }
+    if (position < 0 || static_cast<unsigned int>(position) + mKmerLength > end)
+    {
+        return -1;
+    }
+    return position - static_cast<int>(begin);
+}
@@ -0,0 +1,86 @@
+// File: KmerRepeatFinder.h
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// An index of the search window kmers in a single read, used by the
+// kmer search engine in searchCore. The read is 2-bit encoded once and
+// every kmer is linked to the next place the same kmer appears, so
+// finding the first copy of a window in the downstream range is a walk
+// along that list rather than a Boyer-Moore search of the range.
+// Kmers that contain anything other than ACGT are not indexed and the
+// caller falls back to the Boyer-Moore search for those windows.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+#ifndef KmerRepeatFinder_h
+#define KmerRepeatFinder_h
+
+// system includes
+#include <string>
+#include <vector>
+
+#define KRF_INVALID_BASE    4                               // code for anything that isn't ACGT
+#define KRF_NOT_INDEXED     (-2)                            // the kmer contains an invalid base
+#define KRF_MAX_KMER_LENGTH 16                              // kmers are packed into an unsigned int
+
+class KmerRepeatFinder
+{
+    public:
+        KmerRepeatFinder(void) { mKmerLength = 0; mMask = 0; }
+        ~KmerRepeatFinder(void) {}
+
+        void index(const std::string& seq, unsigned int kmerLength);   // index every kmer in the read
+
+        // is the kmer at this position in the index
+        inline bool isIndexed(unsigned int start)
+        {
+            return start < mNext.size() && mNext[start] != KRF_NOT_INDEXED;
+        }
+
+        // the leftmost copy of the kmer at start that lies completely
+        // inside [begin, end), as an offset from begin the same way that
+        // PatternMatcher::bmpSearch reports it. -1 if there isn't one
+        int findRepeat(unsigned int start, unsigned int begin, unsigned int end);
+
+    private:
+        void encode(const std::string& seq);
+
+        // members
+        std::vector<unsigned char> mBases;                  // 2-bit code for each base
+        std::vector<unsigned int> mKmers;                   // packed kmer starting at each position
+        std::vector<int> mNext;                             // next position with the same kmer, -1 for none
+        std::vector<int> mSlots;                            // open addressing table of positions
+        unsigned int mKmerLength;
+        unsigned int mMask;                                 // keeps the low 2k bits of a packed kmer
+};
+
+#endif //KmerRepeatFinder_h
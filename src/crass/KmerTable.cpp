@@ -0,0 +1,208 @@
+// File: KmerTable.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Implementation of KmerTable functions
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+// system includes
+#include <string>
+#include <vector>
+#include <map>
+
+// local includes
+#include "KmerTable.h"
+#include "SeqUtils.h"
+
+KmerTable::KmerTable(size_t initialSlots)
+{
+    size_t num_slots = 16;
+    while (num_slots < initialSlots) 
+    {
+        num_slots <<= 1;
+    }
+    mKeys.assign(num_slots, KT_EMPTY_SLOT);
+    mValues.assign(num_slots, 0);
+    mSlotMask = num_slots - 1;
+    mSize = 0;
+}
+
+size_t KmerTable::slotFor(unsigned int kmer)
+{
+    size_t slot = (kmer * 2654435761u) & mSlotMask;
+    while (mKeys[slot] != KT_EMPTY_SLOT && mKeys[slot] != kmer) 
+    {
+        slot = (slot + 1) & mSlotMask;
+    }
+    return slot;
+}
+
+void KmerTable::grow(void)
+{
+    //-----
+    // double the table and put everything back in
+    //
+    std::vector<unsigned int> old_keys;
+    std::vector<int> old_values;
+    old_keys.swap(mKeys);
+    old_values.swap(mValues);
+    
+    size_t num_slots = old_keys.size() * 2;
+    mKeys.assign(num_slots, KT_EMPTY_SLOT);
+    mValues.assign(num_slots, 0);
+    mSlotMask = num_slots - 1;
+    for (size_t i = 0; i < old_keys.size(); ++i) 
+    {
+        if (old_keys[i] != KT_EMPTY_SLOT) 
+        {
+            size_t slot = slotFor(old_keys[i]);
+            mKeys[slot] = old_keys[i];
+            mValues[slot] = old_values[i];
+        }
+    }
+}
+
+int * KmerTable::find(unsigned int kmer)
+{
+    size_t slot = slotFor(kmer);
+    return (mKeys[slot] == kmer) ? &(mValues[slot]) : NULL;
+}
+
+int& KmerTable::operator[](unsigned int kmer)
+{
+    size_t slot = slotFor(kmer);
+    if (mKeys[slot] != kmer) 
+    {
+        // keep it at most half full so the probes stay short
+        if (2 * (mSize + 1) > mKeys.size()) 
+        {
+            grow();
+            slot = slotFor(kmer);
+        }
+        mKeys[slot] = kmer;
+        mValues[slot] = 0;
+        mSize++;
+    }
+    return mValues[slot];
+}
+
+int * KmerTable::find(const std::string& kmer)
+{
+    std::map<std::string, int>::iterator odd_iter = mOddKmers.find(kmer);
+    return (odd_iter == mOddKmers.end()) ? NULL : &(odd_iter->second);
+}
+
+int& KmerTable::operator[](const std::string& kmer)
+{
+    return mOddKmers[kmer];
+}
+
+static inline unsigned int baseCode(char base)
+{
+    switch (base) 
+    {
+        case 'A': return 0;
+        case 'C': return 1;
+        case 'G': return 2;
+        case 'T': return 3;
+        default: return 4;
+    }
+}
+
+void packLaurenizedKmers(const std::string& seq, 
+                         unsigned int kmerLength, 
+                         std::vector<unsigned int>& kmers, 
+                         std::vector<std::string>& oddKmers)
+{
+    //-----
+    // Roll the forward and reverse complement codes along the sequence.
+    // With A < C < G < T the smaller code is also the smaller string, so
+    // taking the minimum is the same as laurenize(). A kmer with any other
+    // base goes through laurenize() itself, which can still give a packable
+    // string as U complements to A
+    //
+    kmers.clear();
+    oddKmers.clear();
+    size_t length = seq.length();
+    if (kmerLength == 0 || kmerLength > KT_MAX_KMER_LENGTH || length < kmerLength) 
+    {
+        return;
+    }
+    unsigned int mask = (1u << (2 * kmerLength)) - 1;
+    unsigned int rc_shift = 2 * (kmerLength - 1);
+    unsigned int forward = 0;
+    unsigned int reverse = 0;
+    long last_invalid = -1;
+    for (size_t i = 0; i < length; ++i) 
+    {
+        unsigned int base = baseCode(seq[i]);
+        if (base > 3) 
+        {
+            last_invalid = static_cast<long>(i);
+            base = 0;
+        }
+        forward = ((forward << 2) | base) & mask;
+        reverse = (reverse >> 2) | ((3 - base) << rc_shift);
+        if (i + 1 < kmerLength) 
+        {
+            continue;
+        }
+        size_t start = i + 1 - kmerLength;
+        if (last_invalid < static_cast<long>(start)) 
+        {
+            kmers.push_back((forward < reverse) ? forward : reverse);
+            continue;
+        }
+        std::string odd_kmer = laurenize(seq.substr(start, kmerLength));
+        unsigned int code = 0;
+        size_t j = 0;
+        for (; j < kmerLength; ++j) 
+        {
+            unsigned int odd_base = baseCode(odd_kmer[j]);
+            if (odd_base > 3) 
+            {
+                break;
+            }
+            code = (code << 2) | odd_base;
+        }
+        if (j == kmerLength) 
+        {
+            kmers.push_back(code);
+        } 
+        else 
+        {
+            kmers.push_back(KT_EMPTY_SLOT);
+            oddKmers.push_back(odd_kmer);
+        }
+    }
+}
@@ -0,0 +1,97 @@
+// File: KmerTable.h
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Flat open addressing hash of 2-bit packed kmers, used to cluster the
+// DR variants. The kmers are kept in their laurenized form so a kmer and
+// its reverse complement share a slot. Kmers that can't be packed (N,
+// lowercase, IUPAC) are kept as strings on the side.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+#ifndef KmerTable_h
+#define KmerTable_h
+
+// system includes
+#include <string>
+#include <vector>
+#include <map>
+#include <cstddef>
+
+// local includes
+#include "crassDefines.h"
+
+#define KT_EMPTY_SLOT       (~0u)                           // never a packed kmer, they are all shorter than 16
+#define KT_MAX_KMER_LENGTH  15
+
+class KmerTable
+{
+    public:
+        KmerTable(size_t initialSlots = CRASS_DEF_KMER_TABLE_SLOTS);
+        ~KmerTable(void) {}
+
+        //
+        // Packed kmers. Adding a kmer can move the values so don't
+        // hold on to the pointers or references across an add
+        //
+        int * find(unsigned int kmer);                      // NULL if the kmer isn't in the table
+        int& operator[](unsigned int kmer);                 // adds the kmer with a value of 0 like std::map
+
+        //
+        // Kmers that couldn't be packed
+        //
+        int * find(const std::string& kmer);
+        int& operator[](const std::string& kmer);
+
+        inline size_t size(void) { return mSize + mOddKmers.size(); }
+
+    private:
+        size_t slotFor(unsigned int kmer);                  // where the kmer is or should go
+        void grow(void);
+
+        // members
+        std::vector<unsigned int> mKeys;                    // KT_EMPTY_SLOT for an empty slot
+        std::vector<int> mValues;
+        size_t mSize;                                       // number of packed kmers
+        size_t mSlotMask;
+        std::map<std::string, int> mOddKmers;
+};
+
+// Cut every kmer from seq and pack it in its laurenized form, in order.
+// A kmer that can't be packed is KT_EMPTY_SLOT in kmers and its
+// laurenized string is the next one in oddKmers
+void packLaurenizedKmers(const std::string& seq, 
+                         unsigned int kmerLength, 
+                         std::vector<unsigned int>& kmers, 
+                         std::vector<std::string>& oddKmers);
+
+#endif //KmerTable_h
@@ -64,7 +64,19 @@ LoggerSimp* LoggerSimp::Inst(void) {
     return mInstance;
 }
 
-LoggerSimp::LoggerSimp() {}
+LoggerSimp::LoggerSimp()
+{
+    // nothing is logged until init() is called
+    mGlobalHandle = NULL;
+    mFileHandle = NULL;
+    mBuff = NULL;
+    mTmpFH = NULL;
+    mLogLevel = 0;
+    mFileOpen = false;
+#ifdef HAVE_PTHREAD
+    pthread_mutex_init(&mLock, NULL);
+#endif
+}
 
 LoggerSimp::~LoggerSimp(){
     if(mFileOpen)
@@ -268,3 +280,20 @@ void LoggerSimp::clearLogFile(void)
     std::ofstream tmp_file(mLogFile.c_str(), std::ios::out);
     tmp_file.close();
 }
+
+void LoggerSimp::lock(void)
+{
+    //-----
+    // serialise writes to the log when searching with threads
+    //
+#ifdef HAVE_PTHREAD
+    pthread_mutex_lock(&mLock);
+#endif
+}
+
+void LoggerSimp::unlock(void)
+{
+#ifdef HAVE_PTHREAD
+    pthread_mutex_unlock(&mLock);
+#endif
+}
@@ -4,7 +4,7 @@
 //
 // OVERVIEW:
 // This file contains the class definition for a simple output logger
-// no good for multi threaded apps
+// Writes are serialised with a mutex when built with pthreads
 //
 // This is for runtime logging. For compile time and paranoid logging see
 // the file: paranoid.h
@@ -49,6 +49,9 @@
 #include "crassDefines.h"
 #include <config.h>
 #include <sstream>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
 using namespace std;
 
 // for making the main logger
@@ -84,6 +87,8 @@ public:
     void closeLogFile(void);                                        // close the log file down
     void openLogFile(void);                                         // open the log file
     void clearLogFile(void);                                        // clear the logFile at the start
+    void lock(void);                                                // take the lock before writing
+    void unlock(void);                                              // and give it back after
     
     std::iostream * mGlobalHandle;                                       // what we realy write to
     
@@ -103,6 +108,9 @@ private:
     time_t mStartTime;                                              // the time when the logger was created
     time_t mCurrentTime;                                            // now, .. no ... NOW! NOW!
     bool mFileOpen;                                                 // is the log file open?
+#ifdef HAVE_PTHREAD
+    pthread_mutex_t mLock;                                          // the search threads all log here
+#endif
 };
 
 static LoggerSimp* logger = LoggerSimp::Inst();                     // this makes the singleton available to all classes
@@ -116,28 +124,36 @@ static LoggerSimp* logger = LoggerSimp::Inst();                     // this make
 // for logging info
 #define logInfo(cOUTsTRING, ll) { \
 if(logger->getLogLevel() >= ll) { \
+logger->lock(); \
 (*(logger->mGlobalHandle)) << logger->timeToString(true) << "\tI   " << cOUTsTRING << std::endl; \
+logger->unlock(); \
 } \
 }
 
 // for dumping large amounts of info to the logfile after a msg
 #define logInfoNoPrefix(cOUTsTRING, ll) {                       \
     if(logger->getLogLevel() >= ll) {                           \
+        logger->lock();                                         \
         (*(logger->mGlobalHandle)) << cOUTsTRING <<std::endl;   \
+        logger->unlock();                                       \
     }                                                           \
 }
 
 // for errors
 #define logError(cOUTsTRING) { \
 std::stringstream s; s<<cOUTsTRING;\
+logger->lock(); \
 (*(logger->mGlobalHandle)) << logger->timeToString(true) << "\tERR " << __FILE__ << " : " << __PRETTY_FUNCTION__ << " : " << __LINE__ << ": " <<  cOUTsTRING << std::endl; \
+logger->unlock(); \
 throw crispr::exception(__FILE__, __LINE__, __PRETTY_FUNCTION__,s.str().c_str());\
 }
 
 // for warnings
 #define logWarn(cOUTsTRING, ll) { \
 if(logger->getLogLevel() >= ll) { \
+logger->lock(); \
 (*(logger->mGlobalHandle)) << logger->timeToString(true) << "\tW   " << cOUTsTRING << std::endl; \
+logger->unlock(); \
 } \
 }
 
@@ -154,19 +170,25 @@ if(logger->getLogLevel() >= ll) { \
 // for logging info
 #define logInfo(cOUTsTRING, ll) { \
 if(logger->getLogLevel() >= ll) { \
+logger->lock(); \
 (*(logger->mGlobalHandle)) << logger->timeToString(true) << "\tI   " << __FILE__ << " : " << __PRETTY_FUNCTION__ << " : " << __LINE__ << ": " <<  cOUTsTRING << std::endl; \
+logger->unlock(); \
 } \
 }
 
 // for errors
 #define logError(cOUTsTRING) { \
+logger->lock(); \
 (*(logger->mGlobalHandle)) << logger->timeToString(true) << "\tERR " << __FILE__ << " : " << __PRETTY_FUNCTION__ << " : " << __LINE__ << ": " <<  cOUTsTRING << std::endl; \
+logger->unlock(); \
 }
 
 // for warnings
 #define logWarn(cOUTsTRING, ll) { \
 if(logger->getLogLevel() >= ll) { \
+logger->lock(); \
 (*(logger->mGlobalHandle)) << logger->timeToString(true) << "\tW   " << __FILE__ << " : " << __PRETTY_FUNCTION__ << " : " << __LINE__ << ": " <<  cOUTsTRING << std::endl; \
+logger->unlock(); \
 } \
 }
 
@@ -0,0 +1,289 @@
+// File: MappedReader.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Implementation of the memory mapped read parser.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+// system includes
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// local includes
+#include "MappedReader.h"
+
+static inline bool isRecordStart(char c)
+{
+    return c == '>' || c == '@';
+}
+
+// kseq ends a sequence at any of these
+static inline bool endsSequence(char c)
+{
+    return c == '>' || c == '+' || c == '@';
+}
+
+// the quality characters kseq keeps
+static inline bool isQuality(char c)
+{
+    return static_cast<unsigned char>(c) >= 33 && static_cast<unsigned char>(c) <= 127;
+}
+
+void ReadView::clear(void)
+{
+    mHeader = mComment = mSeq = mQual = NULL;
+    mHeaderLength = mCommentLength = mSeqLength = mQualLength = 0;
+}
+
+void ReadView::assign(kseq_t * seq)
+{
+    //-----
+    // kseq keeps its buffers from one read to the next, so the lengths
+    // say whether this read has a comment or a quality
+    //
+    clear();
+    mHeader = seq->name.s;
+    mHeaderLength = seq->name.l;
+    mSeq = seq->seq.s;
+    mSeqLength = seq->seq.l;
+    if (seq->comment.l > 0)
+    {
+        mComment = seq->comment.s;
+        mCommentLength = seq->comment.l;
+    }
+    if (seq->qual.l > 0)
+    {
+        mQual = seq->qual.s;
+        mQualLength = seq->qual.l;
+    }
+}
+
+bool MappedReader::open(const char * inputFile)
+{
+    close();
+    if (strcmp(inputFile, "-") == 0)
+    {
+        return false;
+    }
+    int fd = ::open(inputFile, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || ! S_ISREG(file_stat.st_mode))
+    {
+        ::close(fd);
+        return false;
+    }
+    size_t length = static_cast<size_t>(file_stat.st_size);
+    if (length == 0)
+    {
+        // nothing to map, and nothing to read
+        ::close(fd);
+        return true;
+    }
+    void * data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+    const unsigned char * bytes = static_cast<const unsigned char *>(data);
+    if (length >= 2 && bytes[0] == 31 && bytes[1] == 139)
+    {
+        // gzipped, that's the GzipReader's job
+        munmap(data, length);
+        return false;
+    }
+    // the file is read front to back once, so the kernel can read ahead
+    // and drop the pages behind us
+    madvise(data, length, MADV_SEQUENTIAL);
+    mData = static_cast<const char *>(data);
+    mLength = length;
+    mPos = 0;
+    return true;
+}
+
+void MappedReader::close(void)
+{
+    if (mData != NULL)
+    {
+        munmap(const_cast<char *>(mData), mLength);
+    }
+    mData = NULL;
+    mLength = 0;
+    mPos = 0;
+}
+
+bool MappedReader::next(ReadView& view)
+{
+    view.clear();
+    while (mPos < mLength && ! isRecordStart(mData[mPos]))
+    {
+        mPos++;
+    }
+    if (mPos >= mLength)
+    {
+        return false;
+    }
+    mPos++;
+
+    //-----
+    // the header runs to the first space, anything else on the line
+    // is the comment
+    //
+    size_t start = mPos;
+    while (mPos < mLength && ! isspace(static_cast<unsigned char>(mData[mPos])))
+    {
+        mPos++;
+    }
+    view.mHeader = mData + start;
+    view.mHeaderLength = mPos - start;
+    if (mPos < mLength && mData[mPos] != '\n')
+    {
+        start = ++mPos;
+        const char * line_end = static_cast<const char *>(memchr(mData + mPos, '\n', mLength - mPos));
+        mPos = (line_end == NULL) ? mLength : static_cast<size_t>(line_end - mData);
+        if (mPos > start)
+        {
+            view.mComment = mData + start;
+            view.mCommentLength = mPos - start;
+        }
+    }
+    if (mPos < mLength)
+    {
+        mPos++;
+    }
+
+    if (nextSequence(view))
+    {
+        return nextQuality(view);
+    }
+    return true;
+}
+
+bool MappedReader::nextSequence(ReadView& view)
+{
+    //-----
+    // Usually the sequence is one line followed by the start of the next
+    // record or the '+' line and can be used where it is. Anything else
+    // is put together the way kseq does it, keeping the printable
+    // characters up to the next '>', '+' or '@'
+    //
+    size_t start = mPos;
+    size_t end = start;
+    while (end < mLength && isgraph(static_cast<unsigned char>(mData[end])) && ! endsSequence(mData[end]))
+    {
+        end++;
+    }
+    if (end == mLength || (mData[end] == '\n' && (end + 1 == mLength || endsSequence(mData[end + 1]))))
+    {
+        view.mSeq = mData + start;
+        view.mSeqLength = end - start;
+        mPos = (end == mLength) ? end : end + 1;
+    }
+    else
+    {
+        mJoinedSeq.clear();
+        for (mPos = start; mPos < mLength && ! endsSequence(mData[mPos]); mPos++)
+        {
+            if (isgraph(static_cast<unsigned char>(mData[mPos])))
+            {
+                mJoinedSeq += mData[mPos];
+            }
+        }
+        view.mSeq = mJoinedSeq.data();
+        view.mSeqLength = mJoinedSeq.length();
+    }
+    // a '+' means there is a quality to come
+    return mPos < mLength && mData[mPos] == '+';
+}
+
+bool MappedReader::nextQuality(ReadView& view)
+{
+    // the rest of the '+' line is skipped
+    const char * line_end = static_cast<const char *>(memchr(mData + mPos, '\n', mLength - mPos));
+    if (line_end == NULL)
+    {
+        mPos = mLength;
+        return false;
+    }
+    size_t start = static_cast<size_t>(line_end - mData) + 1;
+
+    //-----
+    // kseq takes quality characters until it has as many as there are
+    // bases, and always reads one character more than it keeps
+    //
+    size_t end = start;
+    if (start + view.mSeqLength <= mLength)
+    {
+        while (end < start + view.mSeqLength && isQuality(mData[end]))
+        {
+            end++;
+        }
+    }
+    if (end == start + view.mSeqLength)
+    {
+        view.mQual = mData + start;
+        mPos = end;
+    }
+    else
+    {
+        mJoinedQual.clear();
+        for (mPos = start; mPos < mLength && mJoinedQual.length() < view.mSeqLength; mPos++)
+        {
+            if (isQuality(mData[mPos]))
+            {
+                mJoinedQual += mData[mPos];
+            }
+        }
+        if (mJoinedQual.length() < view.mSeqLength)
+        {
+            // the file ended part way through the quality
+            return false;
+        }
+        view.mQual = mJoinedQual.data();
+    }
+    view.mQualLength = view.mSeqLength;
+    if (mPos < mLength)
+    {
+        mPos++;
+    }
+    return true;
+}
@@ -0,0 +1,106 @@
+// File: MappedReader.h
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Reads uncompressed FASTA/FASTQ files through a memory map. Each read
+// comes back as pointers into the mapping, so nothing is copied until
+// a read is actually wanted. The records are split up the way kseq
+// does it; the only reads that are copied are FASTA records whose
+// sequence is spread over several lines.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+#ifndef MappedReader_h
+#define MappedReader_h
+
+// system includes
+#include <cstddef>
+#include <string>
+
+// local includes
+#include "kseq.h"
+
+// a read made of pointers into memory that someone else owns
+class ReadView
+{
+    public:
+        ReadView(void) { clear(); }
+        ~ReadView(void) {}
+
+        void clear(void);
+        void assign(kseq_t * seq);                          // point at the record kseq is holding
+
+        // members
+        const char * mHeader;
+        size_t mHeaderLength;
+        const char * mComment;                              // NULL when the read has no comment
+        size_t mCommentLength;
+        const char * mSeq;
+        size_t mSeqLength;
+        const char * mQual;                                 // NULL for FASTA
+        size_t mQualLength;
+};
+
+class MappedReader
+{
+    public:
+        MappedReader(void) { mData = NULL; mLength = 0; mPos = 0; }
+        ~MappedReader(void) { close(); }
+
+        bool open(const char * inputFile);                  // false unless it is a regular file that isn't gzipped
+        bool next(ReadView& view);                          // false at the end of the file
+        void close(void);
+
+        // do the views of this read stay good until the file is closed.
+        // Multi-line sequences are joined in a buffer that the next read reuses
+        inline bool isMapped(const ReadView& view)
+        {
+            return inMapping(view.mSeq) && (view.mQual == NULL || inMapping(view.mQual));
+        }
+
+    private:
+        inline bool inMapping(const char * ptr)
+        {
+            return ptr >= mData && ptr <= mData + mLength;
+        }
+        bool nextSequence(ReadView& view);
+        bool nextQuality(ReadView& view);
+
+        // members
+        const char * mData;                                 // the whole file
+        size_t mLength;
+        size_t mPos;                                        // where the next read starts looking
+        std::string mJoinedSeq;                             // multi-line sequences
+        std::string mJoinedQual;
+};
+
+#endif //MappedReader_h
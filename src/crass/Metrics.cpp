@@ -0,0 +1,207 @@
+// File: Metrics.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Implementation of the run metrics.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+// system includes
+#include <string>
+#include <fstream>
+#include <iomanip>
+#include <cstdlib>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+// local includes
+#include "Metrics.h"
+#include "Exception.h"
+#include "config.h"
+
+void Metrics::startPhase(void)
+{
+    if (! resetHighWaterRSS())
+    {
+        mPerPhasePeak = false;
+    }
+}
+
+void Metrics::addPhase(const std::string& name, double seconds)
+{
+    PhaseMetrics phase;
+    phase.name = name;
+    phase.seconds = seconds;
+    phase.peakRSS = highWaterRSS();
+    mPeakRSS = (phase.peakRSS > mPeakRSS) ? phase.peakRSS : mPeakRSS;
+    mPhases.push_back(phase);
+}
+
+double Metrics::totalSeconds(void) const
+{
+    double total = 0;
+    std::vector<PhaseMetrics>::const_iterator phase_iter;
+    for (phase_iter = mPhases.begin(); phase_iter != mPhases.end(); ++phase_iter)
+    {
+        total += phase_iter->seconds;
+    }
+    return total;
+}
+
+void Metrics::setCounter(const std::string& name, long long value)
+{
+    std::vector<MetricsCounter>::iterator counter_iter;
+    for (counter_iter = mCounters.begin(); counter_iter != mCounters.end(); ++counter_iter)
+    {
+        if (counter_iter->first == name)
+        {
+            counter_iter->second = value;
+            return;
+        }
+    }
+    mCounters.push_back(MetricsCounter(name, value));
+}
+
+void Metrics::addCounter(const std::string& name, long long value)
+{
+    setCounter(name, counter(name) + value);
+}
+
+long long Metrics::counter(const std::string& name) const
+{
+    std::vector<MetricsCounter>::const_iterator counter_iter;
+    for (counter_iter = mCounters.begin(); counter_iter != mCounters.end(); ++counter_iter)
+    {
+        if (counter_iter->first == name)
+        {
+            return counter_iter->second;
+        }
+    }
+    return 0;
+}
+
+void Metrics::writeJson(std::ostream& out) const
+{
+    //-----
+    // The names are all our own so nothing needs escaping
+    //
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out<<std::fixed<<std::setprecision(3);
+    out<<"{"<<std::endl;
+    out<<"  \"version\": \""<<PACKAGE_VERSION<<"\","<<std::endl;
+    out<<"  \"phases\": ["<<std::endl;
+    std::vector<PhaseMetrics>::const_iterator phase_iter;
+    for (phase_iter = mPhases.begin(); phase_iter != mPhases.end(); ++phase_iter)
+    {
+        out<<"    {\"name\": \""<<phase_iter->name<<"\", \"seconds\": "<<phase_iter->seconds<<", \"peakRSSKB\": "<<phase_iter->peakRSS<<"}";
+        out<<((phase_iter + 1 == mPhases.end()) ? "" : ",")<<std::endl;
+    }
+    out<<"  ],"<<std::endl;
+    out<<"  \"totalSeconds\": "<<totalSeconds()<<","<<std::endl;
+    out<<"  \"peakRSSKB\": "<<mPeakRSS<<","<<std::endl;
+    out<<"  \"peakRSSPerPhase\": "<<((mPerPhasePeak) ? "true" : "false")<<","<<std::endl;
+    out<<"  \"counters\": {"<<std::endl;
+    std::vector<MetricsCounter>::const_iterator counter_iter;
+    for (counter_iter = mCounters.begin(); counter_iter != mCounters.end(); ++counter_iter)
+    {
+        out<<"    \""<<counter_iter->first<<"\": "<<counter_iter->second;
+        out<<((counter_iter + 1 == mCounters.end()) ? "" : ",")<<std::endl;
+    }
+    out<<"  }"<<std::endl;
+    out<<"}"<<std::endl;
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void Metrics::writeJson(const std::string& fileName) const
+{
+    std::ofstream out(fileName.c_str());
+    if (! out)
+    {
+        throw crispr::exception(__FILE__, __LINE__, __PRETTY_FUNCTION__, ("Cannot write metrics to " + fileName).c_str());
+    }
+    writeJson(out);
+    out.close();
+    if (out.fail())
+    {
+        throw crispr::exception(__FILE__, __LINE__, __PRETTY_FUNCTION__, ("Cannot write metrics to " + fileName).c_str());
+    }
+}
+
+double Metrics::now(void)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return now.tv_sec + now.tv_usec / 1000000.0;
+}
+
+long Metrics::highWaterRSS(void)
+{
+    //-----
+    // Linux keeps the high water mark in /proc where it can be reset,
+    // getrusage only ever has the most used since the process started
+    //
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+        {
+            return atol(line.c_str() + 6);
+        }
+    }
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#ifdef __APPLE__
+    // bytes rather than KB
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+bool Metrics::resetHighWaterRSS(void)
+{
+    // needs Linux 4.0, the mark goes back to what is used now
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    if (! clear_refs)
+    {
+        return false;
+    }
+    clear_refs<<"5";
+    clear_refs.close();
+    return ! clear_refs.fail();
+}
@@ -0,0 +1,104 @@
+// File: Metrics.h
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// How long each part of a run took, the most memory used during it and
+// counts of what it found. The WorkHorse times each stage of doWork with
+// a ScopedPhase, so a phase is recorded however it is left, and the lot
+// can be written out as JSON for --metrics.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+#ifndef Metrics_h
+#define Metrics_h
+
+// system includes
+#include <string>
+#include <vector>
+#include <ostream>
+#include <utility>
+
+typedef struct {
+    std::string name;
+    double seconds;                                         // wall clock
+    long peakRSS;                                           // KB, the most used during the phase
+} PhaseMetrics;
+
+typedef std::pair<std::string, long long> MetricsCounter;
+
+class Metrics
+{
+    public:
+        Metrics(void) { mPeakRSS = 0; mPerPhasePeak = true; }
+        ~Metrics(void) {}
+
+        void startPhase(void);                              // resets the memory high water mark, so phases can't nest
+        void addPhase(const std::string& name, double seconds);
+        inline const std::vector<PhaseMetrics>& phases(void) const { return mPhases; }
+        double totalSeconds(void) const;
+        inline long peakRSS(void) const { return mPeakRSS; }    // KB, over every phase
+        inline bool perPhasePeak(void) const { return mPerPhasePeak; }
+
+        void setCounter(const std::string& name, long long value);
+        void addCounter(const std::string& name, long long value);
+        long long counter(const std::string& name) const;   // 0 if it was never set
+        inline const std::vector<MetricsCounter>& counters(void) const { return mCounters; }
+
+        void writeJson(std::ostream& out) const;
+        void writeJson(const std::string& fileName) const;  // throws if the file can't be written
+
+        static double now(void);                            // wall clock seconds
+        static long highWaterRSS(void);                     // KB, the most used since the last reset
+        static bool resetHighWaterRSS(void);                // false where the kernel can't
+
+    private:
+        // members
+        std::vector<PhaseMetrics> mPhases;                  // in the order they finished
+        std::vector<MetricsCounter> mCounters;              // in the order they were first set
+        long mPeakRSS;
+        bool mPerPhasePeak;                                 // false if some phase's peak includes the ones before it
+};
+
+class ScopedPhase
+{
+    public:
+        ScopedPhase(Metrics& metrics, const char * name) : mMetrics(metrics), mName(name) { mMetrics.startPhase(); mStart = Metrics::now(); }
+        ~ScopedPhase(void) { mMetrics.addPhase(mName, Metrics::now() - mStart); }
+
+    private:
+        // members
+        Metrics& mMetrics;
+        const char * mName;
+        double mStart;
+};
+
+#endif //Metrics_h
@@ -87,33 +87,15 @@ NodeManager::~NodeManager(void)
     // destructor
     //
     
-    // clean up all the cripsr nodes
-    NodeListIterator node_iter = NM_Nodes.begin();
-    while(node_iter != NM_Nodes.end())
-    {
-        if(NULL != node_iter->second)
-        {
-            delete node_iter->second;
-            node_iter->second = NULL;
-        }
-        node_iter++;
-    }
-    NM_Nodes.clear();
+    // the contigs point at spacers so they go first
+    clearContigs();
     
-    SpacerListIterator spacer_iter = NM_Spacers.begin();
-    while(spacer_iter != NM_Spacers.end())
-    {
-        if(NULL != spacer_iter->second)
-        {
-            delete spacer_iter->second;
-            spacer_iter->second = NULL;
-        }
-        spacer_iter++;
-    }
+    // the nodes and spacers live in the pools, clearing them runs the
+    // destructors and gives the memory back a chunk at a time
+    NM_Nodes.clear();
     NM_Spacers.clear();
-    
-    // delete contigs;
-    clearContigs();
+    NM_SpacerPool.clear();
+    NM_NodePool.clear();
 }
 
 bool NodeManager::addReadHolder(ReadHolder * RH)
@@ -249,7 +231,7 @@ void NodeManager::addCrisprNodes(CrisprNode ** prevNode, std::string& workingStr
     {
         // first time we've seen this guy. Make some new objects
         st1 = NM_StringCheck.addString(first_kmer);
-        first_kmer_node = new CrisprNode(st1);
+        first_kmer_node = NM_NodePool.construct(st1);
         
         // add them to the pile
         NM_Nodes[st1] = first_kmer_node;
@@ -268,7 +250,7 @@ void NodeManager::addCrisprNodes(CrisprNode ** prevNode, std::string& workingStr
     if(0 == st2)
     {
         st2 = NM_StringCheck.addString(second_kmer);
-        second_kmer_node = new CrisprNode(st2);
+        second_kmer_node = NM_NodePool.construct(st2);
         second_kmer_node->setForward(false);
         NM_Nodes[st2] = second_kmer_node;
 #ifdef DEBUG
@@ -323,7 +305,7 @@ void NodeManager::addCrisprNodes(CrisprNode ** prevNode, std::string& workingStr
     	{
             sp_str_token = NM_StringCheck.addString(workingString);
     	}
-        curr_spacer = new SpacerInstance(sp_str_token, first_kmer_node, second_kmer_node);
+        curr_spacer = NM_SpacerPool.construct(sp_str_token, first_kmer_node, second_kmer_node);
         NM_Spacers[this_sp_key] = curr_spacer;
 #ifdef SEARCH_SINGLETON
         if (debug_iter != debugger->end()) {
@@ -363,7 +345,7 @@ void NodeManager::addSecondCrisprNode(CrisprNode ** prevNode, std::string& worki
     {
         // first time we've seen this guy. Make some new objects
         st2 = NM_StringCheck.addString(second_kmer);
-        second_kmer_node = new CrisprNode(st2);
+        second_kmer_node = NM_NodePool.construct(st2);
         second_kmer_node->setForward(false);
         
         // add them to the pile
@@ -408,7 +390,7 @@ void NodeManager::addFirstCrisprNode(CrisprNode ** prevNode, std::string& workin
     {
         // first time we've seen this guy. Make some new objects
         st1 = NM_StringCheck.addString(first_kmer);
-        first_kmer_node = new CrisprNode(st1);
+        first_kmer_node = NM_NodePool.construct(st1);
         
         // add them to the pile
         NM_Nodes[st1] = first_kmer_node;
@@ -1501,10 +1483,8 @@ void NodeManager::dumpReads(std::string readsFileName, bool showDetached)
 
 
 // Spacer dictionaries
-void NodeManager::addSpacersToDOM(crispr::xml::writer * xmlDoc, 
-                                  xercesc::DOMElement * parentNode, 
-                                  bool showDetached, 
-                                  std::set<StringToken>& allSources)
+void NodeManager::addSpacersToStream(crispr::xml::streamwriter * xmlOut, 
+                                     bool showDetached)
 {
     SpacerListIterator spacer_iter = NM_Spacers.begin();
     while(spacer_iter != NM_Spacers.end())
@@ -1519,21 +1499,16 @@ void NodeManager::addSpacersToDOM(crispr::xml::writer * xmlDoc,
             std::string spacer = NM_StringCheck.getString(SI->getID());
             std::string spid = "SP" + to_string(SI->getID());
             std::string cov = to_string(SI->getCount());
-            xercesc::DOMElement * spacer_node = xmlDoc->addSpacer(spacer, spid, parentNode, cov);
-            appendSourcesForSpacer(spacer_node, 
-                                   nr_tokens, 
-                                   xmlDoc);
-            allSources.insert(nr_tokens.begin(), nr_tokens.end());
-
+            xmlOut->addSpacer(spacer, spid, cov);
+            appendSourcesForSpacer(nr_tokens, xmlOut);
+            xmlOut->endElement();
         }
         spacer_iter++;
     }
 }
 
-void NodeManager::addFlankersToDOM(crispr::xml::writer * xmlDoc, 
-                                   xercesc::DOMElement * parentNode, 
-                                   bool showDetached, 
-                                   std::set<StringToken>& allSources)
+void NodeManager::addFlankersToStream(crispr::xml::streamwriter * xmlOut, 
+                                      bool showDetached)
 {
     SpacerInstanceVector_Iterator iter;
     for (iter = NM_FlankerNodes.begin(); iter != NM_FlankerNodes.end(); iter++) {
@@ -1545,26 +1520,54 @@ void NodeManager::addFlankersToDOM(crispr::xml::writer * xmlDoc,
             
             std::string spacer = NM_StringCheck.getString(SI->getID());
             std::string flid = "FL" + to_string(SI->getID());
-            xercesc::DOMElement * spacer_node = xmlDoc->addFlanker(spacer, flid, parentNode);
+            xmlOut->addFlanker(spacer, flid);
             // add in all the source tags for this spacer
-            appendSourcesForSpacer(spacer_node, 
-                                   nr_tokens, 
-                                   xmlDoc);
-            allSources.insert(nr_tokens.begin(), nr_tokens.end());
+            appendSourcesForSpacer(nr_tokens, xmlOut);
+            xmlOut->endElement();
+        }
+    }
+}
 
+void NodeManager::getAllSources(bool showDetached, std::set<StringToken>& allSourcesForNM)
+{
+    //-----
+    // <sources> comes before the spacers and flankers in the file, so the
+    // reads for them are gathered first using the same tests as
+    // addSpacersToStream and addFlankersToStream
+    //
+    SpacerListIterator spacer_iter;
+    for (spacer_iter = NM_Spacers.begin(); spacer_iter != NM_Spacers.end(); spacer_iter++)
+    {
+        SpacerInstance * SI = spacer_iter->second;
+        if((showDetached || ((SI->getLeader())->isAttached() && (SI->getLast())->isAttached())) && !(SI->isFlanker()))
+        {
+            getHeadersForSpacers(SI, allSourcesForNM);
+        }
+    }
+    SpacerInstanceVector_Iterator iter;
+    for (iter = NM_FlankerNodes.begin(); iter != NM_FlankerNodes.end(); iter++) 
+    {
+        SpacerInstance * SI = *iter;
+        if(showDetached || ((SI->getLeader())->isAttached() && (SI->getLast())->isAttached()))
+        {
+            getHeadersForSpacers(SI, allSourcesForNM);
         }
     }
 }
 
-void NodeManager::printAssemblyToDOM(crispr::xml::writer * xmlDoc, xercesc::DOMElement * parentNode, bool showDetached)
+void NodeManager::printAssemblyToStream(crispr::xml::streamwriter * xmlOut, bool showDetached)
 {
     
     int current_contig_num = 0;
+    std::vector<std::string> fspacers;
+    std::vector<std::string> bspacers;
+    std::vector<std::string> fflankers;
+    std::vector<std::string> bflankers;
     while (current_contig_num < NM_NextContigID) 
     {
         current_contig_num++;
         std::string cid = "C" + to_string(current_contig_num);
-        xercesc::DOMElement * contig_elem = xmlDoc->addContig(cid, parentNode);
+        xmlOut->addContig(cid);
 
         SpacerListIterator spacer_iter = NM_Spacers.begin();
         while(spacer_iter != NM_Spacers.end())
@@ -1575,20 +1578,16 @@ void NodeManager::printAssemblyToDOM(crispr::xml::writer * xmlDoc, xercesc::DOME
                 if( showDetached || SI->isAttached())
                 {
 
-                    std::string spacer = NM_StringCheck.getString(SI->getID());
                     std::string id = (SI->isFlanker()) ? "FL" + to_string(SI->getID()) : "SP" + to_string(SI->getID());
                     
-                    xercesc::DOMElement * cspacer = xmlDoc->addSpacerToContig(id, contig_elem);
-
-                    bool ff = false;
-                    bool bf = false;
-                    bool fs = false;
-                    bool bs = false;
-                    
-                    xercesc::DOMElement * fspacers = NULL;
-                    xercesc::DOMElement * bspacers = NULL;
-                    xercesc::DOMElement * fflankers = NULL;
-                    xercesc::DOMElement * bflankers = NULL;
+                    xmlOut->addSpacerToContig(id);
+
+                    // the joins are sorted into the four lists first as
+                    // they are written out one list after the other
+                    fspacers.clear();
+                    bspacers.clear();
+                    fflankers.clear();
+                    bflankers.clear();
                     SpacerEdgeVector_Iterator sp_iter = SI->begin();
                     while (sp_iter != SI->end()) 
                     {
@@ -1596,77 +1595,24 @@ void NodeManager::printAssemblyToDOM(crispr::xml::writer * xmlDoc, xercesc::DOME
                         {
 
                             std::string edge_id = (SI->isFlanker()) ? "FL" + to_string((*sp_iter)->edge->getID()) : "SP" + to_string((*sp_iter)->edge->getID());
-                            std::string drid = "DR1";
-                            std::string drconf = "0";
-                            std::string directjoin = "0";
                             switch ((*sp_iter)->d) 
                             {
                                 case FORWARD:
                                 {
                                     if ((*sp_iter)->edge->isFlanker()) {
-                                        if (ff) 
-                                        {
-                                            // we've already created <fflankers>
-                                            // add spacer
-                                            xmlDoc->addFlanker("ff", edge_id, drconf, directjoin, fflankers);//("fs", edge_spid, drid, drconf, fspacers);
-                                        } 
-                                        else 
-                                        {
-                                            // create <fflankers>
-                                            fflankers = xmlDoc->createFlankers("fflankers");
-                                            xmlDoc->addFlanker("ff", edge_id, drconf, directjoin, fflankers);//("fs", edge_spid, drid, drconf, fspacers);
-                                            ff = true;
-                                        }
+                                        fflankers.push_back(edge_id);
                                     } else {
-                                        if (fs) 
-                                        {
-                                            // we've already created <fspacers>
-                                            // add spacer
-                                            xmlDoc->addSpacer("fs", edge_id, drid, drconf, fspacers);
-                                        } 
-                                        else 
-                                        {
-                                            // create <fspacers>
-                                            fspacers = xmlDoc->createSpacers("fspacers");
-                                            xmlDoc->addSpacer("fs", edge_id, drid, drconf, fspacers);
-                                            fs = true;
-                                        }
+                                        fspacers.push_back(edge_id);
                                     }
-
                                     break;
                                 }
                                 case REVERSE:
                                 {
                                     if ((*sp_iter)->edge->isFlanker()) {
-                                        if (bf) 
-                                        {
-                                            // we've already created <bflankers>
-                                            // add spacer
-                                            xmlDoc->addFlanker("bf", edge_id, drconf, directjoin, bflankers);//("bs", edge_id, drid, drconf, bspacers);
-                                        } 
-                                        else 
-                                        {
-                                            // create <bflankers>
-                                            bflankers = xmlDoc->createFlankers("bflankers");
-                                            xmlDoc->addFlanker("bf", edge_id, drconf, directjoin, bflankers);//("bs", edge_id, drid, drconf, bspacers);
-                                            bf = true;
-                                        }
+                                        bflankers.push_back(edge_id);
                                     } else {
-                                        if (bs) 
-                                        {
-                                            // we've already created <fspacers>
-                                            // add spacer
-                                            xmlDoc->addSpacer("bs", edge_id, drid, drconf, bspacers);
-                                        } 
-                                        else 
-                                        {
-                                            // create <bspacers>
-                                            bspacers = xmlDoc->createSpacers("bspacers");
-                                            xmlDoc->addSpacer("bs", edge_id, drid, drconf, bspacers);
-                                            bs = true;
-                                        }
+                                        bspacers.push_back(edge_id);
                                     }
-
                                     break;
                                 }
                                 default:
@@ -1677,30 +1623,54 @@ void NodeManager::printAssemblyToDOM(crispr::xml::writer * xmlDoc, xercesc::DOME
                         }
                         ++sp_iter;
                     }
-                    if (bspacers != NULL) 
+                    std::string drid = "DR1";
+                    std::string drconf = "0";
+                    std::string directjoin = "0";
+                    std::vector<std::string>::iterator id_iter;
+                    if (!bspacers.empty()) 
                     {
-                        cspacer->appendChild(bspacers);
-
+                        xmlOut->startElement(xmlOut->tag_Bspacers());
+                        for (id_iter = bspacers.begin(); id_iter != bspacers.end(); id_iter++) 
+                        {
+                            xmlOut->addSpacer(xmlOut->tag_Bs(), *id_iter, drid, drconf);
+                        }
+                        xmlOut->endElement();
                     }
-                    if (fspacers != NULL) 
+                    if (!fspacers.empty()) 
                     {
-                        cspacer->appendChild(fspacers);
-
+                        xmlOut->startElement(xmlOut->tag_Fspacers());
+                        for (id_iter = fspacers.begin(); id_iter != fspacers.end(); id_iter++) 
+                        {
+                            xmlOut->addSpacer(xmlOut->tag_Fs(), *id_iter, drid, drconf);
+                        }
+                        xmlOut->endElement();
                     }
-                    if (bflankers != NULL) 
+                    if (!bflankers.empty()) 
                     {
-                        cspacer->appendChild(bflankers);
-                        
+                        xmlOut->startElement(xmlOut->tag_Bflankers());
+                        for (id_iter = bflankers.begin(); id_iter != bflankers.end(); id_iter++) 
+                        {
+                            xmlOut->addFlanker(xmlOut->tag_Bf(), *id_iter, drconf, directjoin);
+                        }
+                        xmlOut->endElement();
                     }
-                    if (fflankers != NULL) 
+                    if (!fflankers.empty()) 
                     {
-                        cspacer->appendChild(fflankers);
-                        
+                        xmlOut->startElement(xmlOut->tag_Fflankers());
+                        for (id_iter = fflankers.begin(); id_iter != fflankers.end(); id_iter++) 
+                        {
+                            xmlOut->addFlanker(xmlOut->tag_Ff(), *id_iter, drconf, directjoin);
+                        }
+                        xmlOut->endElement();
                     }
+                    // </cspacer>
+                    xmlOut->endElement();
                 }
             }
             spacer_iter++;
         }
+        // </contig>
+        xmlOut->endElement();
     }
 
 }
@@ -1720,35 +1690,28 @@ void NodeManager::getHeadersForSpacers(SpacerInstance * SI, std::set<StringToken
     }
 }
 
-void NodeManager::appendSourcesForSpacer(xercesc::DOMElement * spacerNode, 
-                            std::set<StringToken>& nrTokens,
-                            crispr::xml::writer * xmlDoc)
+void NodeManager::appendSourcesForSpacer(std::set<StringToken>& nrTokens,
+                                         crispr::xml::streamwriter * xmlOut)
 {
     // add in all the source tags for this spacer
     std::set<StringToken>::iterator nr_iter;
     for (nr_iter = nrTokens.begin(); nr_iter != nrTokens.end(); nr_iter++) {
-        std::string s = NM_StringCheck.getString(*nr_iter);
         std::string sid = "SO";
         sid += to_string(*nr_iter);
-        // add the source to both the current spacer
-        // and to the total sources list
-        //xmlDoc->addSource(s, sid, allSources);
-        xmlDoc->addSpacerSource(sid, spacerNode);
+        xmlOut->addSpacerSource(sid);
     }
 }
 
-void NodeManager::generateAllsourceTags(crispr::xml::writer * xmlDoc, 
-                           std::set<StringToken>& allSourcesForNM,
-                           xercesc::DOMElement * parentNode
-                           )
+void NodeManager::generateAllsourceTags(crispr::xml::streamwriter * xmlOut, 
+                                        std::set<StringToken>& allSourcesForNM)
 {
-    // add in all the source tags for this spacer
+    // add in all the source tags for this group
     std::set<StringToken>::iterator nr_iter;
     for (nr_iter = allSourcesForNM.begin(); nr_iter != allSourcesForNM.end(); nr_iter++) {
         std::string s = NM_StringCheck.getString(*nr_iter);
         std::string sid = "SO";
         sid += to_string(*nr_iter);
-        xmlDoc->addSource(s, sid, parentNode);
+        xmlOut->addSource(s, sid);
     }
 }
 // Making purdy colours
@@ -2045,7 +2008,7 @@ void NodeManager::generateFlankers(bool showDetached)
                 if(showDetached || ((SI->getLeader())->isAttached() && (SI->getLast())->isAttached()))
                 {
                     /*if(SI->isCap()) {*/
-                    int spacer_length = (int)(NM_StringCheck.getString(SI->getID())).length();
+                    int spacer_length = (int)(NM_StringCheck.getStringView(SI->getID())).length;
                     if (spacer_length > upper_bound || spacer_length < lower_bound) {
                         SI->setFlanker(true);
                         NM_FlankerNodes.push_back(SI);
@@ -44,6 +44,7 @@
 #include <iostream>
 #include <vector>
 #include <map>
+#include <set>
 #include <string>
 #include <fstream>
 #include <queue>
@@ -58,8 +59,9 @@
 #include "ReadHolder.h"
 #include "GraphDrawingDefines.h"
 #include "Rainbow.h"
-#include "writer.h"
+#include "streamwriter.h"
 #include "StatsManager.h"
+#include "ObjectPool.h"
 
 #ifdef SEARCH_SINGLETON
 #include "SearchChecker.h"
@@ -128,6 +130,9 @@ class NodeManager {
 
         NodeListIterator nodeBegin(void) { return NM_Nodes.begin(); } 
         NodeListIterator nodeEnd(void) { return NM_Nodes.end(); }
+        inline size_t numNodes(void) { return NM_Nodes.size(); }
+        inline size_t numSpacers(void) { return NM_Spacers.size(); }
+        inline size_t numContigs(void) { return NM_Contigs.size(); }
         
     // get / set
     
@@ -215,35 +220,32 @@ class NodeManager {
                       bool showDetached
                       );
 	
-    void addSpacersToDOM(crispr::xml::writer * xmlDoc, 
-                         xercesc::DOMElement * parentNode, 
-                         bool showDetached, 
-                         std::set<StringToken>&  allSourcesForNM
-                         );
-    
-    void addFlankersToDOM(crispr::xml::writer * xmlDoc, 
-                          xercesc::DOMElement * parentNode, 
-                          bool showDetached,
-                          std::set<StringToken>& allSourcesForNM
-                          );
-    
-    void printAssemblyToDOM(crispr::xml::writer * xmlDoc, 
-                            xercesc::DOMElement * parentNode, 
+    void addSpacersToStream(crispr::xml::streamwriter * xmlOut, 
                             bool showDetached
                             );
     
+    void addFlankersToStream(crispr::xml::streamwriter * xmlOut, 
+                             bool showDetached
+                             );
+    
+    void printAssemblyToStream(crispr::xml::streamwriter * xmlOut, 
+                               bool showDetached
+                               );
+    
     void getHeadersForSpacers(SpacerInstance * SI, 
                               std::set<StringToken>& nrTokens
                               );
     
-    void appendSourcesForSpacer(xercesc::DOMElement * spacerNode, 
-                                std::set<StringToken>& nrTokens,
-                                crispr::xml::writer * xmlDoc
+    void getAllSources(bool showDetached, 
+                       std::set<StringToken>& allSourcesForNM
+                       );
+    
+    void appendSourcesForSpacer(std::set<StringToken>& nrTokens,
+                                crispr::xml::streamwriter * xmlOut
                                 );
     
-    void generateAllsourceTags(crispr::xml::writer * xmlDoc, 
-                               std::set<StringToken>& allSourcesForNM,
-                               xercesc::DOMElement * parentNode
+    void generateAllsourceTags(crispr::xml::streamwriter * xmlOut, 
+                               std::set<StringToken>& allSourcesForNM
                                );
 
     // Spacer dictionaries
@@ -293,6 +295,8 @@ class NodeManager {
         ContigList NM_Contigs; 								// our contigs
         StatsManager<std::vector<size_t> > NM_SpacerLenStat;   // Keep a check on all of the spacer lengths for deciding whecher thay are a flanker or not
         SpacerInstanceVector NM_FlankerNodes;               // a list of spacers that are also flankers -- used only in the print functions
+        ObjectPool<CrisprNode> NM_NodePool;                 // NM_Nodes are made in here
+        ObjectPool<SpacerInstance> NM_SpacerPool;           // and NM_Spacers in here
 };
 
 
@@ -0,0 +1,314 @@
+// File: ObjectPool.h
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+//
+// OVERVIEW:
+//
+// A pool for the small objects crass makes by the million (readholders,
+// graph nodes, spacers). Objects are carved out of chunks of
+// CRASS_DEF_POOL_CHUNK_SIZE slots so that making one is a pointer bump
+// and throwing the lot away frees one block per chunk instead of one
+// per object. Objects can also be given back one at a time, their slot
+// is reused by the next construct.
+//
+// A pool made with shared = true takes a lock around the slot
+// bookkeeping so that the search threads can all fill the same one.
+//
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+#ifndef ObjectPool_h
+#define ObjectPool_h
+
+// system includes
+#include <new>
+#include <vector>
+#include <cstddef>
+
+// local includes
+#include "config.h"
+#include "crassDefines.h"
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+template <class T>
+class ObjectPool
+{
+    public:
+        ObjectPool(bool shared = false, size_t chunkSize = CRASS_DEF_POOL_CHUNK_SIZE);
+        ~ObjectPool(void);
+
+        //
+        // Make objects in the pool, same as new T(...)
+        //
+        T * construct(void);
+        template <class A1> 
+        T * construct(const A1& a1);
+        template <class A1, class A2> 
+        T * construct(const A1& a1, const A2& a2);
+        template <class A1, class A2, class A3> 
+        T * construct(const A1& a1, const A2& a2, const A3& a3);
+
+        void destroy(T * object);                           // same as delete, object must have come from this pool
+        void clear(void);                                   // destroy everything and give the chunks back
+
+        inline size_t size(void) { return mNumLive; }       // objects alive in the pool
+        inline size_t numChunks(void) { return mChunks.size(); }
+
+    private:
+        // storage for one object, the union keeps it aligned for anything T holds
+        typedef union {
+            char bytes[sizeof(T)];
+            double alignDouble;
+            long double alignLongDouble;
+            long long alignLongLong;
+            void * alignPointer;
+        } Storage;
+
+        typedef struct _slot {
+            Storage storage;
+            struct _slot * nextFree;                        // only used while the slot is on the free list
+            bool live;
+        } Slot;
+
+        // no copying, the pool owns the objects
+        ObjectPool(const ObjectPool&);
+        ObjectPool& operator=(const ObjectPool&);
+
+        Slot * takeSlot(void);
+        void giveSlot(Slot * slot);
+        inline void lock(void);
+        inline void unlock(void);
+
+        // members
+        std::vector<Slot *> mChunks;
+        size_t mChunkSize;                                  // slots per chunk
+        size_t mNextSlot;                                   // first never used slot in the last chunk
+        Slot * mFreeList;                                   // slots given back by destroy
+        size_t mNumLive;
+        bool mShared;
+#ifdef HAVE_PTHREAD
+        pthread_mutex_t mLock;
+#endif
+};
+
+template <class T>
+ObjectPool<T>::ObjectPool(bool shared, size_t chunkSize)
+{
+    mChunkSize = (chunkSize > 0) ? chunkSize : 1;
+    mNextSlot = mChunkSize;
+    mFreeList = NULL;
+    mNumLive = 0;
+    mShared = shared;
+#ifdef HAVE_PTHREAD
+    pthread_mutex_init(&mLock, NULL);
+#endif
+}
+
+template <class T>
+ObjectPool<T>::~ObjectPool(void)
+{
+    clear();
+#ifdef HAVE_PTHREAD
+    pthread_mutex_destroy(&mLock);
+#endif
+}
+
+template <class T>
+void ObjectPool<T>::lock(void)
+{
+#ifdef HAVE_PTHREAD
+    if (mShared)
+    {
+        pthread_mutex_lock(&mLock);
+    }
+#endif
+}
+
+template <class T>
+void ObjectPool<T>::unlock(void)
+{
+#ifdef HAVE_PTHREAD
+    if (mShared)
+    {
+        pthread_mutex_unlock(&mLock);
+    }
+#endif
+}
+
+template <class T>
+typename ObjectPool<T>::Slot * ObjectPool<T>::takeSlot(void)
+{
+    //-----
+    // reuse a slot if one has been given back, otherwise bump along
+    // the last chunk, getting a new one when it is full
+    //
+    lock();
+    Slot * slot;
+    if (mFreeList != NULL)
+    {
+        slot = mFreeList;
+        mFreeList = slot->nextFree;
+    }
+    else
+    {
+        if (mNextSlot == mChunkSize)
+        {
+            try {
+                mChunks.push_back(static_cast<Slot *>(::operator new(sizeof(Slot) * mChunkSize)));
+            } catch (...) {
+                unlock();
+                throw;
+            }
+            mNextSlot = 0;
+        }
+        slot = mChunks.back() + mNextSlot;
+        mNextSlot++;
+    }
+    slot->live = true;
+    mNumLive++;
+    unlock();
+    return slot;
+}
+
+template <class T>
+void ObjectPool<T>::giveSlot(Slot * slot)
+{
+    lock();
+    slot->live = false;
+    slot->nextFree = mFreeList;
+    mFreeList = slot;
+    mNumLive--;
+    unlock();
+}
+
+template <class T>
+T * ObjectPool<T>::construct(void)
+{
+    Slot * slot = takeSlot();
+    T * object;
+    try {
+        object = new (slot->storage.bytes) T();
+    } catch (...) {
+        giveSlot(slot);
+        throw;
+    }
+    return object;
+}
+
+template <class T>
+template <class A1>
+T * ObjectPool<T>::construct(const A1& a1)
+{
+    Slot * slot = takeSlot();
+    T * object;
+    try {
+        object = new (slot->storage.bytes) T(a1);
+    } catch (...) {
+        giveSlot(slot);
+        throw;
+    }
+    return object;
+}
+
+template <class T>
+template <class A1, class A2>
+T * ObjectPool<T>::construct(const A1& a1, const A2& a2)
+{
+    Slot * slot = takeSlot();
+    T * object;
+    try {
+        object = new (slot->storage.bytes) T(a1, a2);
+    } catch (...) {
+        giveSlot(slot);
+        throw;
+    }
+    return object;
+}
+
+template <class T>
+template <class A1, class A2, class A3>
+T * ObjectPool<T>::construct(const A1& a1, const A2& a2, const A3& a3)
+{
+    Slot * slot = takeSlot();
+    T * object;
+    try {
+        object = new (slot->storage.bytes) T(a1, a2, a3);
+    } catch (...) {
+        giveSlot(slot);
+        throw;
+    }
+    return object;
+}
+
+template <class T>
+void ObjectPool<T>::destroy(T * object)
+{
+    if (object == NULL)
+    {
+        return;
+    }
+    object->~T();
+    // the storage is the first member of the slot
+    giveSlot(reinterpret_cast<Slot *>(object));
+}
+
+template <class T>
+void ObjectPool<T>::clear(void)
+{
+    //-----
+    // run the destructors of whatever is still alive, the objects own
+    // memory of their own, then free the chunks wholesale
+    //
+    lock();
+    for (size_t i = 0; i < mChunks.size(); ++i)
+    {
+        size_t used = (i + 1 == mChunks.size()) ? mNextSlot : mChunkSize;
+        Slot * chunk = mChunks[i];
+        for (size_t j = 0; j < used; ++j)
+        {
+            if (chunk[j].live)
+            {
+                reinterpret_cast<T *>(chunk[j].storage.bytes)->~T();
+            }
+        }
+        ::operator delete(chunk);
+    }
+    mChunks.clear();
+    mNextSlot = mChunkSize;
+    mFreeList = NULL;
+    mNumLive = 0;
+    unlock();
+}
+
+#endif //ObjectPool_h
@@ -24,8 +24,12 @@
 #include <algorithm>
 
 int PatternMatcher::bmpSearch(const std::string &text, const std::string &pattern){
-    size_t textSize = text.size();
-    size_t patternSize = pattern.size();
+    BmpTable bmpLast;
+    computeBmpLast(pattern.data(), pattern.size(), bmpLast);
+    return bmpSearch(text.data(), text.size(), pattern.data(), pattern.size(), bmpLast);
+}
+
+int PatternMatcher::bmpSearch(const char * text, size_t textSize, const char * pattern, size_t patternSize, const BmpTable& bmpLast){
     if(textSize == 0 || patternSize == 0){
         return -1;
     }
@@ -33,7 +37,6 @@ int PatternMatcher::bmpSearch(const std::string &text, const std::string &patter
         return -1;
     }
     
-    std::vector<int> bmpLast = computeBmpLast(pattern);
     size_t tIdx = patternSize - 1;
     size_t pIdx = patternSize - 1;
     while(tIdx < textSize)
@@ -50,7 +53,7 @@ int PatternMatcher::bmpSearch(const std::string &text, const std::string &patter
         else 
         {
             //Character Jump Heuristics
-            int lastOccur = bmpLast[text[tIdx]];
+            int lastOccur = bmpLast.last[(unsigned char)text[tIdx]];
             tIdx = tIdx + patternSize - std::min<int>((int)pIdx, 1 + lastOccur);
             pIdx = patternSize - 1;
         }
@@ -71,7 +74,8 @@ void PatternMatcher::bmpMultiSearch(const std::string &text, const std::string &
         return;
     }
     
-    std::vector<int> bmpLast = computeBmpLast(pattern);
+    BmpTable bmpLast;
+    computeBmpLast(pattern.data(), patternSize, bmpLast);
     size_t tIdx = patternSize - 1;
     size_t pIdx = patternSize - 1;
     while(tIdx < textSize)
@@ -88,7 +92,7 @@ void PatternMatcher::bmpMultiSearch(const std::string &text, const std::string &
         else 
         {
             //Character Jump Heuristics
-            int lastOccur = bmpLast[text[tIdx]];
+            int lastOccur = bmpLast.last[(unsigned char)text[tIdx]];
             tIdx = tIdx + patternSize - std::min<int>((int)pIdx, 1 + lastOccur);
             pIdx = patternSize - 1;
         }
@@ -96,102 +100,173 @@ void PatternMatcher::bmpMultiSearch(const std::string &text, const std::string &
 }
 
 
-std::vector<int> PatternMatcher::computeBmpLast(const std::string &pattern){
-    const size_t NUM_ASCII_CHARS = 128;
-    std::vector<int> bmpLast(NUM_ASCII_CHARS);
-    for(size_t i = 0; i < NUM_ASCII_CHARS; i++){
-        bmpLast[i] = -1;
+void PatternMatcher::computeBmpLast(const char * pattern, size_t patternSize, BmpTable& bmpLast){
+    clearBmpLast(bmpLast);
+    setBmpLast(pattern, patternSize, bmpLast);
+}
+
+void PatternMatcher::clearBmpLast(BmpTable& bmpLast){
+    for(size_t i = 0; i < BMP_TABLE_SIZE; i++){
+        bmpLast.last[i] = -1;
+    }
+}
+
+void PatternMatcher::setBmpLast(const char * pattern, size_t patternSize, BmpTable& bmpLast){
+    for(size_t i = 0; i < patternSize; i++){
+        bmpLast.last[(unsigned char)pattern[i]] = (int)i;
     }
-    for(size_t i = 0; i < pattern.size(); i++){
-        bmpLast[pattern[i]] = (int)i;
+}
+
+void PatternMatcher::unsetBmpLast(const char * pattern, size_t patternSize, BmpTable& bmpLast){
+    for(size_t i = 0; i < patternSize; i++){
+        bmpLast.last[(unsigned char)pattern[i]] = -1;
     }
-    return bmpLast;
 }
 
 int PatternMatcher::levenstheinDistance( std::string& source,  std::string& target) {
-    
-    // Step 1
-    
     int n = (int)source.length();
     int m = (int)target.length();
-    if (n == 0) {
-        return m;
+    return levenstheinDistance(source.data(), n, target.data(), m, std::max(n, m));
+}
+
+int PatternMatcher::levenstheinDistance(const char * source, int sourceLength, const char * target, int targetLength, int maxDistance)
+{
+    int length_difference = (sourceLength > targetLength) ? sourceLength - targetLength : targetLength - sourceLength;
+    if (length_difference > maxDistance) {
+        return maxDistance + 1;
     }
-    if (m == 0) {
-        return n;
+    if (sourceLength == 0) {
+        return targetLength;
+    }
+    if (targetLength == 0) {
+        return sourceLength;
     }
     
-    // Good form to declare a TYPEDEF
-    
-    
-    Tmatrix matrix(n+1);
-    
-    // Size the vectors in the 2.nd dimension. Unfortunately C++ doesn't
-    // allow for allocation on declaration of 2.nd dimension of vec of vec
-    
-    for (int i = 0; i <= n; i++) {
-        matrix[i].resize(m+1);
+    // the distance is symmetric so put the shorter string in the bit vectors
+    if (sourceLength > targetLength) {
+        std::swap(source, target);
+        std::swap(sourceLength, targetLength);
+    }
+    if (sourceLength <= 64) {
+        return myersDistance(source, sourceLength, target, targetLength, maxDistance);
+    }
+    return blockedMyersDistance(source, sourceLength, target, targetLength, maxDistance);
+}
+
+// Myers' bit-vector algorithm with Hyyro's extension for transpositions.
+// Bit i of the vectors holds row i + 1 of the DP matrix for the current
+// column: vp and vn are the positive and negative vertical deltas, d0 the
+// cells that take their value from the diagonal.
+//
+// The old matrix code only allowed a transposition when both the row and
+// the column were past the second character (Berghel and Roach's step 6A
+// with i>2 && j>2) so the same cells are masked out here
+int PatternMatcher::myersDistance(const char * pattern, int patternLength, const char * text, int textLength, int maxDistance)
+{
+    // only the entries we are going to read need to be cleared
+    uint64_t peq[256];
+    for (int j = 0; j < textLength; j++) {
+        peq[(unsigned char)text[j]] = 0;
+    }
+    for (int i = 0; i < patternLength; i++) {
+        peq[(unsigned char)pattern[i]] = 0;
+    }
+    for (int i = 0; i < patternLength; i++) {
+        peq[(unsigned char)pattern[i]] |= (uint64_t)1 << i;
     }
     
-    // Step 2
+    const uint64_t last_row = (uint64_t)1 << (patternLength - 1);
+    const uint64_t no_transpose_row = ~(uint64_t)2;
+    uint64_t vp = ~(uint64_t)0;
+    uint64_t vn = 0;
+    uint64_t d0 = 0;
+    uint64_t pm_previous = 0;
+    int score = patternLength;
     
-    for (int i = 0; i <= n; i++) {
-        matrix[i][0]=i;
+    for (int j = 0; j < textLength; j++) {
+        uint64_t pm = peq[(unsigned char)text[j]];
+        uint64_t transpose = ((((~d0) & pm) << 1) & pm_previous) & no_transpose_row;
+        d0 = (((pm & vp) + vp) ^ vp) | pm | vn | transpose;
+        uint64_t hp = vn | ~(d0 | vp);
+        uint64_t hn = d0 & vp;
+        if (hp & last_row) {
+            score++;
+        } else if (hn & last_row) {
+            score--;
+        }
+        hp = (hp << 1) | 1;
+        hn = hn << 1;
+        vp = hn | ~(d0 | hp);
+        vn = hp & d0;
+        pm_previous = (j >= 1) ? pm : 0;
+        
+        // the score can only drop by one for every column that is left
+        if (score - (textLength - 1 - j) > maxDistance) {
+            return maxDistance + 1;
+        }
     }
-    
-    for (int j = 0; j <= m; j++) {
-        matrix[0][j]=j;
+    return score;
+}
+
+// The same recurrence as myersDistance run over a column of 64 bit blocks.
+// The horizontal deltas and the transposition bit carry from one block
+// into the next
+int PatternMatcher::blockedMyersDistance(const char * pattern, int patternLength, const char * text, int textLength, int maxDistance)
+{
+    const int words = (patternLength + 63) / 64;
+    std::vector<uint64_t> peq(256 * words, 0);
+    for (int i = 0; i < patternLength; i++) {
+        peq[(unsigned char)pattern[i] * words + i / 64] |= (uint64_t)1 << (i % 64);
     }
     
-    // Step 3
+    std::vector<uint64_t> vp(words, ~(uint64_t)0);
+    std::vector<uint64_t> vn(words, 0);
+    std::vector<uint64_t> d0(words, 0);
+    std::vector<uint64_t> pm_previous(words, 0);
+    const uint64_t last_row = (uint64_t)1 << ((patternLength - 1) % 64);
+    int score = patternLength;
     
-    for (int i = 1; i <= n; i++) {
-        
-        char s_i = source[i-1];
-        
-        // Step 4
-        
-        for (int j = 1; j <= m; j++) {
-            
-            char t_j = target[j-1];
-            
-            // Step 5
-            
-            int cost;
-            if (s_i == t_j) {
-                cost = 0;
-            }
-            else {
-                cost = 1;
+    for (int j = 0; j < textLength; j++) {
+        const uint64_t * pm = &peq[(unsigned char)text[j] * words];
+        uint64_t hp_carry = 1;
+        uint64_t hn_carry = 0;
+        uint64_t transpose_carry = 0;
+        for (int w = 0; w < words; w++) {
+            uint64_t not_diagonal = (~d0[w]) & pm[w];
+            uint64_t transpose = ((not_diagonal << 1) | transpose_carry) & pm_previous[w];
+            if (w == 0) {
+                transpose &= ~(uint64_t)2;
             }
+            transpose_carry = not_diagonal >> 63;
             
-            // Step 6
-            
-            int above = matrix[i-1][j];
-            int left = matrix[i][j-1];
-            int diag = matrix[i-1][j-1];
-            int cell = std::min( above + 1, std::min(left + 1, diag + cost));
-            
-            // Step 6A: Cover transposition, in addition to deletion,
-            // insertion and substitution. This step is taken from:
-            // Berghel, Hal ; Roach, David : "An Extension of Ukkonen's 
-            // Enhanced Dynamic Programming ASM Algorithm"
-            // (http://www.acm.org/~hlb/publications/asm/asm.html)
-            
-            if (i>2 && j>2) {
-                int trans=matrix[i-2][j-2]+1;
-                if (source[i-2]!=t_j) trans++;
-                if (s_i!=target[j-2]) trans++;
-                if (cell>trans) cell=trans;
+            uint64_t x = pm[w] | hn_carry;
+            uint64_t d = (((x & vp[w]) + vp[w]) ^ vp[w]) | x | vn[w] | transpose;
+            uint64_t hp = vn[w] | ~(d | vp[w]);
+            uint64_t hn = d & vp[w];
+            if (w == words - 1) {
+                if (hp & last_row) {
+                    score++;
+                } else if (hn & last_row) {
+                    score--;
+                }
             }
-            
-            matrix[i][j]=cell;
+            uint64_t hp_out = hp >> 63;
+            uint64_t hn_out = hn >> 63;
+            hp = (hp << 1) | hp_carry;
+            hn = (hn << 1) | hn_carry;
+            hp_carry = hp_out;
+            hn_carry = hn_out;
+            vp[w] = hn | ~(d | hp);
+            vn[w] = hp & d;
+            d0[w] = d;
+            pm_previous[w] = (j >= 1) ? pm[w] : 0;
+        }
+        
+        if (score - (textLength - 1 - j) > maxDistance) {
+            return maxDistance + 1;
         }
     }
-    
-    // Step 7
-    
-    return matrix[n][m];
+    return score;
 }
 
 float PatternMatcher::getStringSimilarity(std::string& s1, std::string& s2)
@@ -203,3 +278,16 @@ float PatternMatcher::getStringSimilarity(std::string& s1, std::string& s2)
     return 1.0 - (edit_distance/max_length);
 }
 
+float PatternMatcher::getStringSimilarity(std::string& s1, std::string& s2, float minSimilarity)
+{
+    float max_length = std::max(s1.length(), s2.length());
+    if(s1.length() < 3 || s2.length() < 3)
+    	return 0;
+    // one more edit than this and the similarity can't be above the cutoff
+    int max_distance = static_cast<int>((1.0 - minSimilarity) * max_length) + 1;
+    if (max_distance < 0) {
+        max_distance = 0;
+    }
+    float edit_distance = levenstheinDistance(s1.data(), (int)s1.length(), s2.data(), (int)s2.length(), max_distance);
+    return 1.0 - (edit_distance/max_length);
+}
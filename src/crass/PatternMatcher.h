@@ -24,20 +24,54 @@
 #include <iostream>
 #include <string>
 #include <vector>
-typedef std::vector< std::vector<int> > Tmatrix; 
+#include <stdint.h>
+
+#define BMP_TABLE_SIZE 256
+
+// Bad character table for a single pattern. Fill it once with
+// computeBmpLast and it can be reused for every search of that pattern
+typedef struct {
+    int last[BMP_TABLE_SIZE];
+} BmpTable;
 
 class PatternMatcher{
 public:
     static int bmpSearch(const std::string& text, const std::string& pattern);
     
+    // search text[0, textSize) for the pattern using a precomputed table,
+    // nothing is copied or allocated
+    static int bmpSearch(const char * text, size_t textSize, const char * pattern, size_t patternSize, const BmpTable& bmpLast);
+    
     static void bmpMultiSearch(const std::string &text, const std::string &pattern, std::vector<int> &startOffsetVec);
     
+    static void computeBmpLast(const char * pattern, size_t patternSize, BmpTable& bmpLast);
+    
+    // when many short patterns are searched one after the other the table
+    // can be cleared once and then only the entries for each pattern are
+    // set before the search and unset after it
+    static void clearBmpLast(BmpTable& bmpLast);
+    static void setBmpLast(const char * pattern, size_t patternSize, BmpTable& bmpLast);
+    static void unsetBmpLast(const char * pattern, size_t patternSize, BmpTable& bmpLast);
+    
+    // edit distance with adjacent transpositions. The shorter string is
+    // kept in the bits of a machine word (or a row of words when it is
+    // longer than 64bp) so each column of the matrix costs a few word ops
     static int levenstheinDistance( std::string& source,  std::string& target);
     
+    // as above but gives up as soon as the distance must be larger than
+    // maxDistance, in which case maxDistance + 1 is returned
+    static int levenstheinDistance(const char * source, int sourceLength, const char * target, int targetLength, int maxDistance);
+    
     static float getStringSimilarity(std::string& s1, std::string& s2);
+    
+    // the similarity is only exact when it is above minSimilarity, otherwise
+    // an upper bound that is not above minSimilarity is returned. Use it
+    // when all that matters is which side of a cutoff the strings fall on
+    static float getStringSimilarity(std::string& s1, std::string& s2, float minSimilarity);
 
 private:
-    static std::vector<int> computeBmpLast(const std::string& pattern);
+    static int myersDistance(const char * pattern, int patternLength, const char * text, int textLength, int maxDistance);
+    static int blockedMyersDistance(const char * pattern, int patternLength, const char * text, int textLength, int maxDistance);
     
     PatternMatcher();
     PatternMatcher(const PatternMatcher&);
@@ -0,0 +1,198 @@
+// File: ReadBatch.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Implementation of ReadBatch functions
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+// system includes
+#include <string>
+#include <vector>
+
+// local includes
+#include "ReadBatch.h"
+
+void ReadRecord::assign(kseq_t * seq)
+{
+    ReadView read;
+    read.assign(seq);
+    assign(read);
+}
+
+void ReadRecord::assign(const ReadView& read)
+{
+    mMapped = false;
+    mHeader.assign(read.mHeader, read.mHeaderLength);
+    mSeq.assign(read.mSeq, read.mSeqLength);
+    mHasComment = (read.mComment != NULL);
+    if (mHasComment)
+    {
+        mComment.assign(read.mComment, read.mCommentLength);
+    }
+    mHasQual = (read.mQual != NULL);
+    if (mHasQual)
+    {
+        mQual.assign(read.mQual, read.mQualLength);
+    }
+}
+
+void ReadRecord::point(const ReadView& read)
+{
+    mMapped = true;
+    mView = read;
+}
+
+ReadView ReadRecord::view(void) const
+{
+    if (mMapped)
+    {
+        return mView;
+    }
+    ReadView read;
+    read.mHeader = mHeader.data();
+    read.mHeaderLength = mHeader.length();
+    read.mSeq = mSeq.data();
+    read.mSeqLength = mSeq.length();
+    if (mHasComment)
+    {
+        read.mComment = mComment.data();
+        read.mCommentLength = mComment.length();
+    }
+    if (mHasQual)
+    {
+        read.mQual = mQual.data();
+        read.mQualLength = mQual.length();
+    }
+    return read;
+}
+
+void ReadRecord::fill(ReadHolder& holder) const
+{
+    fillReadHolder(view(), holder);
+}
+
+void fillReadHolder(const ReadView& read, ReadHolder& holder)
+{
+    holder.setSequence(std::string(read.mSeq, read.mSeqLength));
+    holder.setHeader(std::string(read.mHeader, read.mHeaderLength));
+    if (read.mComment != NULL)
+    {
+        holder.setComment(std::string(read.mComment, read.mCommentLength));
+    }
+    if (read.mQual != NULL)
+    {
+        holder.setQual(std::string(read.mQual, read.mQualLength));
+    }
+}
+
+ReadBatch::~ReadBatch(void)
+{
+    clearHits();
+}
+
+void ReadBatch::reset(int id)
+{
+    //-----
+    // get ready to be filled again. The records are kept so
+    // their string buffers can be reused
+    //
+    clearHits();
+    mId = id;
+    mSize = 0;
+}
+
+ReadRecord& ReadBatch::nextRecord(void)
+{
+    if (mSize == mRecords.size())
+    {
+        mRecords.push_back(ReadRecord());
+    }
+    return mRecords[mSize++];
+}
+
+void ReadBatch::clearHits(void)
+{
+    //-----
+    // once the hits are merged the ReadMap has the readholders and this
+    // list is empty. Anything left here was never merged, it still
+    // belongs to the pool it was made in and goes when that is cleared
+    //
+    mHits.clear();
+}
+
+#ifdef HAVE_PTHREAD
+ReadBatchQueue::ReadBatchQueue(void)
+{
+    mClosed = false;
+    pthread_mutex_init(&mLock, NULL);
+    pthread_cond_init(&mNotEmpty, NULL);
+}
+
+ReadBatchQueue::~ReadBatchQueue(void)
+{
+    pthread_cond_destroy(&mNotEmpty);
+    pthread_mutex_destroy(&mLock);
+}
+
+void ReadBatchQueue::push(ReadBatch * batch)
+{
+    pthread_mutex_lock(&mLock);
+    mQueue.push_back(batch);
+    pthread_cond_signal(&mNotEmpty);
+    pthread_mutex_unlock(&mLock);
+}
+
+ReadBatch * ReadBatchQueue::pop(void)
+{
+    pthread_mutex_lock(&mLock);
+    while (mQueue.empty() && !mClosed)
+    {
+        pthread_cond_wait(&mNotEmpty, &mLock);
+    }
+    ReadBatch * batch = NULL;
+    if (!mQueue.empty())
+    {
+        batch = mQueue.front();
+        mQueue.pop_front();
+    }
+    pthread_mutex_unlock(&mLock);
+    return batch;
+}
+
+void ReadBatchQueue::close(void)
+{
+    pthread_mutex_lock(&mLock);
+    mClosed = true;
+    pthread_cond_broadcast(&mNotEmpty);
+    pthread_mutex_unlock(&mLock);
+}
+#endif
@@ -0,0 +1,129 @@
+// File: ReadBatch.h
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Batches of reads copied out of kseq so that they can be handed to
+// worker threads, plus a simple blocking queue to pass them around.
+// The reader fills a batch, a worker searches it and leaves its hits
+// in the batch, the main thread merges the hits back in batch order.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+#ifndef ReadBatch_h
+#define ReadBatch_h
+
+// system includes
+#include <string>
+#include <vector>
+#include <deque>
+
+// local includes
+#include "config.h"
+#include "kseq.h"
+#include "ReadHolder.h"
+#include "MappedReader.h"
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+class ReadRecord
+{
+    public:
+        ReadRecord(void) { mHasComment = false; mHasQual = false; mMapped = false; }
+        ~ReadRecord(void) {}
+
+        void assign(kseq_t * seq);                          // copy the current kseq record
+        void assign(const ReadView& read);                  // copy a read
+        void point(const ReadView& read);                   // use a read that stays put, like a mapped file
+        ReadView view(void) const;                          // the read, wherever it is
+        void fill(ReadHolder& holder) const;                // load the record into a readholder
+
+        // members
+        std::string mHeader;
+        std::string mSeq;
+        std::string mComment;
+        std::string mQual;
+        bool mHasComment;                                   // the read had a comment
+        bool mHasQual;                                      // the read had a quality
+        ReadView mView;                                     // the read when it wasn't copied
+        bool mMapped;                                       // use mView instead of the strings
+};
+
+// load a read into an empty readholder
+void fillReadHolder(const ReadView& read, ReadHolder& holder);
+
+typedef struct {
+    size_t index;                                           // which record in the batch this came from
+    ReadHolder * holder;                                    // in lowlexi form, ready for the ReadMap, owned by the read pool
+    std::string drLowLexi;                                  // the lowlexi DR used to find the token
+    std::string firstRepeat;                                // first repeat as found, for the patterns hash
+} SearchHit;
+
+class ReadBatch
+{
+    public:
+        ReadBatch(void) { mId = 0; mFirstRead = 0; mSize = 0; }
+        ~ReadBatch(void);
+
+        void reset(int id);                                 // empty the batch, keeps the allocated records
+        ReadRecord& nextRecord(void);                       // get the next free record slot
+        void clearHits(void);                               // forget any hits that weren't merged
+
+        // members
+        int mId;                                            // position of this batch in the file
+        unsigned long mFirstRead;                           // position of the first record in the file
+        size_t mSize;                                       // number of records in use
+        std::vector<ReadRecord> mRecords;                   // recycled between batches
+        std::vector<SearchHit> mHits;                       // found by the worker, in read order
+};
+
+#ifdef HAVE_PTHREAD
+class ReadBatchQueue
+{
+    public:
+        ReadBatchQueue(void);
+        ~ReadBatchQueue(void);
+
+        void push(ReadBatch * batch);
+        ReadBatch * pop(void);                              // blocks, returns NULL once closed and empty
+        void close(void);                                   // no more batches are coming
+
+    private:
+        std::deque<ReadBatch *> mQueue;
+        bool mClosed;
+        pthread_mutex_t mLock;
+        pthread_cond_t mNotEmpty;
+};
+#endif
+
+#endif //ReadBatch_h
@@ -46,8 +46,194 @@
 #include "SmithWaterman.h"
 #include "LoggerSimp.h"
 #include "Exception.h"
+#include "Checkpoint.h"
 
+//-----
+// Keeps a packed read unpacked while a method that changes the
+// sequence runs and packs it again on the way out
+//
+class SeqUnpacker
+{
+    public:
+        SeqUnpacker(ReadHolder * holder) 
+        { 
+            mHolder = holder; 
+            mWasPacked = holder->isPacked(); 
+            if (mWasPacked) 
+            {
+                mHolder->unpack();
+            }
+        }
+        ~SeqUnpacker(void) 
+        { 
+            if (mWasPacked) 
+            {
+                mHolder->pack();
+            }
+        }
+    private:
+        ReadHolder * mHolder;
+        bool mWasPacked;
+};
 
+static const char packedBases[4] = {'A', 'C', 'G', 'T'};
+
+void ReadHolder::pack(void)
+{
+    //-----
+    // two bits a base, anything that isn't ACGT goes in the odd lists
+    //
+    if (RH_IsPacked) 
+    {
+        return;
+    }
+    size_t length = RH_Seq.length();
+    RH_Packed.assign((length + 3) / 4, '\0');
+    RH_OddPositions.clear();
+    RH_OddBases.clear();
+    for (size_t i = 0; i < length; ++i) 
+    {
+        unsigned char code;
+        switch (RH_Seq[i]) 
+        {
+            case 'A': code = 0; break;
+            case 'C': code = 1; break;
+            case 'G': code = 2; break;
+            case 'T': code = 3; break;
+            default:
+                code = 0;
+                RH_OddPositions.push_back(static_cast<unsigned int>(i));
+                RH_OddBases.push_back(RH_Seq[i]);
+                break;
+        }
+        RH_Packed[i / 4] |= static_cast<char>(code << ((i % 4) * 2));
+    }
+    RH_PackedLength = static_cast<unsigned int>(length);
+    RH_IsPacked = true;
+    
+    // swap rather than clear so the memory is given back. The run length
+    // encoding is still needed to decode a squeezed read
+    std::string().swap(RH_Seq);
+    if (! RH_isSqueezed) 
+    {
+        std::string().swap(RH_Rle);
+    }
+}
+
+void ReadHolder::unpack(void)
+{
+    if (! RH_IsPacked) 
+    {
+        return;
+    }
+    RH_Seq = seqSubstr(0, RH_PackedLength);
+    RH_IsPacked = false;
+    std::string().swap(RH_Packed);
+    std::vector<unsigned int>().swap(RH_OddPositions);
+    std::string().swap(RH_OddBases);
+    RH_PackedLength = 0;
+}
+
+void ReadHolder::save(Checkpoint& out)
+{
+    out.writeString(RH_Rle);
+    out.writeString(RH_Header);
+    out.writeString(RH_Comment);
+    out.writeString(RH_Qual);
+    out.writeInt(RH_IsFasta);
+    out.writeString(RH_Seq);
+    out.writeInt(RH_WasLowLexi);
+    out.writeLength(static_cast<unsigned int>(RH_StartStops.size()));
+    for (StartStopListIterator ss_iter = RH_StartStops.begin(); ss_iter != RH_StartStops.end(); ++ss_iter) 
+    {
+        out.writeLength(*ss_iter);
+    }
+    out.writeInt(RH_isSqueezed);
+    out.writeInt(RH_LastDREnd);
+    out.writeInt(RH_NextSpacerStart);
+    out.writeInt(RH_RepeatLength);
+    out.writeInt(RH_IsPacked);
+    out.writeString(RH_Packed);
+    out.writeLength(static_cast<unsigned int>(RH_OddPositions.size()));
+    for (std::vector<unsigned int>::iterator odd_iter = RH_OddPositions.begin(); odd_iter != RH_OddPositions.end(); ++odd_iter) 
+    {
+        out.writeLength(*odd_iter);
+    }
+    out.writeString(RH_OddBases);
+    out.writeLength(RH_PackedLength);
+}
+
+void ReadHolder::load(Checkpoint& in)
+{
+    in.readString(RH_Rle);
+    in.readString(RH_Header);
+    in.readString(RH_Comment);
+    in.readString(RH_Qual);
+    RH_IsFasta = (in.readInt() != 0);
+    in.readString(RH_Seq);
+    RH_WasLowLexi = (in.readInt() != 0);
+    RH_StartStops.resize(in.readLength());
+    for (StartStopListIterator ss_iter = RH_StartStops.begin(); ss_iter != RH_StartStops.end(); ++ss_iter) 
+    {
+        *ss_iter = in.readLength();
+    }
+    RH_isSqueezed = (in.readInt() != 0);
+    RH_LastDREnd = in.readInt();
+    RH_NextSpacerStart = in.readInt();
+    RH_RepeatLength = in.readInt();
+    RH_IsPacked = (in.readInt() != 0);
+    in.readString(RH_Packed);
+    RH_OddPositions.resize(in.readLength());
+    for (std::vector<unsigned int>::iterator odd_iter = RH_OddPositions.begin(); odd_iter != RH_OddPositions.end(); ++odd_iter) 
+    {
+        *odd_iter = in.readLength();
+    }
+    in.readString(RH_OddBases);
+    RH_PackedLength = in.readLength();
+}
+
+std::string ReadHolder::seqSubstr(size_t pos, size_t length)
+{
+    if (! RH_IsPacked) 
+    {
+        return RH_Seq.substr(pos, length);
+    }
+    if (pos > RH_PackedLength) 
+    {
+        throw std::out_of_range("ReadHolder::seqSubstr");
+    }
+    if (length > RH_PackedLength - pos) 
+    {
+        length = RH_PackedLength - pos;
+    }
+    std::string ret(length, 'A');
+    for (size_t i = 0; i < length; ++i) 
+    {
+        size_t j = pos + i;
+        ret[i] = packedBases[(static_cast<unsigned char>(RH_Packed[j / 4]) >> ((j % 4) * 2)) & 3];
+    }
+    std::vector<unsigned int>::iterator odd_iter = std::lower_bound(RH_OddPositions.begin(), 
+                                                                     RH_OddPositions.end(), 
+                                                                     static_cast<unsigned int>(pos));
+    while (odd_iter != RH_OddPositions.end() && *odd_iter < pos + length) 
+    {
+        ret[*odd_iter - pos] = RH_OddBases[odd_iter - RH_OddPositions.begin()];
+        ++odd_iter;
+    }
+    return ret;
+}
+
+char ReadHolder::packedCharAt(size_t i)
+{
+    std::vector<unsigned int>::iterator odd_iter = std::lower_bound(RH_OddPositions.begin(), 
+                                                                     RH_OddPositions.end(), 
+                                                                     static_cast<unsigned int>(i));
+    if (odd_iter != RH_OddPositions.end() && *odd_iter == i) 
+    {
+        return RH_OddBases[odd_iter - RH_OddPositions.begin()];
+    }
+    return packedBases[(static_cast<unsigned char>(RH_Packed[i / 4]) >> ((i % 4) * 2)) & 3];
+}
 
 // the input must be an even number which will be the start of the repeat
 unsigned int ReadHolder::getRepeatAt(unsigned int i)
@@ -96,7 +282,7 @@ std::string ReadHolder::repeatStringAt(unsigned int i)
 		                        __PRETTY_FUNCTION__,
 		                        ss);
     }
-    return RH_Seq.substr(RH_StartStops[i], RH_StartStops[i + 1] - RH_StartStops[i] + 1);
+    return seqSubstr(RH_StartStops[i], RH_StartStops[i + 1] - RH_StartStops[i] + 1);
 }
 
 std::string ReadHolder::spacerStringAt(unsigned int i)
@@ -127,11 +313,11 @@ std::string ReadHolder::spacerStringAt(unsigned int i)
     try {
         curr_spacer_start_index = RH_StartStops.at(i + 1) + 1;
         curr_spacer_end_index = RH_StartStops.at(i + 2) - 1;
-        tmp_seq = RH_Seq.substr(curr_spacer_start_index, (curr_spacer_end_index - curr_spacer_start_index));
+        tmp_seq = seqSubstr(curr_spacer_start_index, (curr_spacer_end_index - curr_spacer_start_index));
     } catch (std::out_of_range& e) {
 
         throw crispr::substring_exception(e.what(), 
-                                            RH_Seq.c_str(), 
+                                            getSeq().c_str(), 
                                             curr_spacer_start_index,
                                             (curr_spacer_end_index - curr_spacer_start_index), 
                                             __FILE__,
@@ -176,7 +362,7 @@ unsigned int ReadHolder::getAverageSpacerLength()
             stored_len = (int)tmp_string.length();
         }
         // check to make sure that the read doesn't end on a spacer
-        if(RH_StartStops.back() == (RH_Seq.length() - 1))
+        if(RH_StartStops.back() == (seqLength() - 1))
         {
             // ends on a DR
             num_spacers++;
@@ -216,7 +402,7 @@ void ReadHolder::getAllSpacerStrings(std::vector<std::string>& spacers)
                 spacers.push_back(tmp_string);
             }
             // check to make sure that the read doesn't end on a spacer
-            if(RH_StartStops.back() != (RH_Seq.length() - 1))
+            if(RH_StartStops.back() != (seqLength() - 1))
             {
                 // ends on a Spacer
                 spacers.pop_back();
@@ -279,7 +465,7 @@ void ReadHolder::startStopsAdd(unsigned int i, unsigned int j)
 		                        __PRETTY_FUNCTION__,
 		                        ss);
 	}
-	if((i > RH_Seq.length()) || (j > RH_Seq.length())) { 
+	if((i > seqLength()) || (j > seqLength())) { 
 		std::stringstream ss;
 		ss<<"Too long! " << i << " : " << j;
 		throw crispr::exception(__FILE__,
@@ -310,9 +496,9 @@ void ReadHolder::dropPartials(void)
     }
     
     r_iter = RH_StartStops.end() - 1;
-    if(*r_iter >= (unsigned int)RH_Seq.length() - 1)
+    if(*r_iter >= (unsigned int)seqLength() - 1)
     {
-        logInfo("\tDropping end partial repeat "<<*r_iter<<"; seq_len - rep_len = "<< (unsigned int)RH_Seq.length() - RH_RepeatLength<< "; seq_len = "<<RH_Seq.length()<<"; rep_len = "<<RH_RepeatLength, 8);
+        logInfo("\tDropping end partial repeat "<<*r_iter<<"; seq_len - rep_len = "<< (unsigned int)seqLength() - RH_RepeatLength<< "; seq_len = "<<seqLength()<<"; rep_len = "<<RH_RepeatLength, 8);
         // this is a partial
         RH_StartStops.erase(r_iter-1, RH_StartStops.end());
     }
@@ -329,7 +515,7 @@ void ReadHolder::reverseStartStops(void)
     
     StartStopList tmp_ss;
     
-    int seq_len = (int)RH_Seq.length();
+    int seq_len = (int)seqLength();
     int true_start_offset = seq_len - RH_StartStops.back() - 1;
 #ifdef DEBUG
     if (true_start_offset < 0) 
@@ -387,6 +573,7 @@ void ReadHolder::updateStartStops(const int frontOffset, std::string * DR, const
     //
     // Take this opportunity to look for partials at either end of the read
     //
+    SeqUnpacker unpacker(this);
     
     int DR_length = static_cast<int>(DR->length());
     
@@ -408,7 +595,7 @@ void ReadHolder::updateStartStops(const int frontOffset, std::string * DR, const
         {
             *ss_iter -= frontOffset;
         }
-        if(*ss_iter > static_cast<unsigned int>(RH_Seq.length())) { 
+        if(*ss_iter > static_cast<unsigned int>(seqLength())) { 
 			std::stringstream ss;
 			ss<<"Something wrong with front offset!\n" 
 				<<"ss iter: "<<*ss_iter << "\n" 
@@ -425,9 +612,9 @@ void ReadHolder::updateStartStops(const int frontOffset, std::string * DR, const
         *ss_iter = *(ss_iter - 1) + usable_length;
         
         // correct if we have gone beyond the end of the read
-        if(*ss_iter >= RH_Seq.length())
+        if(*ss_iter >= seqLength())
         {
-            *ss_iter = static_cast<unsigned int>(RH_Seq.length()) - 1;
+            *ss_iter = static_cast<unsigned int>(seqLength()) - 1;
         }
         ss_iter++;
         
@@ -460,7 +647,7 @@ void ReadHolder::updateStartStops(const int frontOffset, std::string * DR, const
 						//                        __PRETTY_FUNCTION__,
 						//                        (ss.str()).c_str());
 					}
-					if(part_e > (int)RH_Seq.length()) { 
+					if(part_e > (int)seqLength()) { 
 						std::stringstream ss;
 						ss <<"SS longer than read: " << part_e;
 						logError(ss.str());
@@ -478,7 +665,7 @@ void ReadHolder::updateStartStops(const int frontOffset, std::string * DR, const
 		}
     }
     // then the back
-    unsigned int end_dist = static_cast<unsigned int>(RH_Seq.length()) - RH_StartStops.back();
+    unsigned int end_dist = static_cast<unsigned int>(seqLength()) - RH_StartStops.back();
     if(end_dist > (unsigned int)(opts->lowSpacerSize))
     {
         // we should look for a DR here
@@ -496,7 +683,7 @@ void ReadHolder::updateStartStops(const int frontOffset, std::string * DR, const
 		{
 			if (part_e - part_s >= CRASS_DEF_MIN_PARTIAL_LENGTH) 
 			{
-				if((((int)(RH_Seq.length()) - 1 ) == part_e) && (0 == DR->find(sp.second)))
+				if((((int)(seqLength()) - 1 ) == part_e) && (0 == DR->find(sp.second)))
 				{
 					logInfo("adding partial direct repeat to end",10);
 					logInfo(sp.first << " : " << sp.second << " : " << part_s << " : " << part_e,10);
@@ -538,7 +725,7 @@ std::string ReadHolder::DRLowLexi(void)
         }
         
         // take the first
-        else if (RH_StartStops.back() == static_cast<unsigned int>(RH_Seq.length()))
+        else if (RH_StartStops.back() == static_cast<unsigned int>(seqLength()))
         {
             tmp_dr = repeatStringAt(0);
             rev_comp = reverseComplement(tmp_dr);
@@ -575,7 +762,7 @@ std::string ReadHolder::DRLowLexi(void)
         // the direct repeat is in it lowest lexicographical form
         RH_WasLowLexi = true;
 #ifdef DEBUG
-        logInfo("DR in low lexi"<<endl<<RH_Seq, 9);
+        logInfo("DR in low lexi"<<endl<<getSeq(), 9);
 #endif
         return tmp_dr;
     }
@@ -584,7 +771,7 @@ std::string ReadHolder::DRLowLexi(void)
         reverseComplementSeq();
         RH_WasLowLexi = false;
 #ifdef DEBUG
-        logInfo("DR not in low lexi"<<endl<<RH_Seq, 9);
+        logInfo("DR not in low lexi"<<endl<<getSeq(), 9);
 #endif
         return rev_comp;
     }
@@ -595,6 +782,7 @@ void ReadHolder::reverseComplementSeq(void)
     //-----
     // Reverse complement the read and fix the start stops
     // 
+    SeqUnpacker unpacker(this);
 
     RH_Seq = reverseComplement(RH_Seq);
 	if(RH_Seq.empty()) {
@@ -626,12 +814,13 @@ void ReadHolder::encode(void)
     } 
     else 
     {
+        SeqUnpacker unpacker(this);
         std::stringstream rle, seq;
         rle<<this->RH_Seq[0];
         seq<<this->RH_Seq[0];
-		//std::cout<<"seq length: "<<RH_Seq.length()<<std::endl;
+		//std::cout<<"seq length: "<<seqLength()<<std::endl;
 		//std::cout<<"orig seq: "<<RH_Seq<<std::endl;
-		int length = static_cast<int>(this->RH_Seq.length());
+		int length = static_cast<int>(this->seqLength());
         for (int  i = 1; i < length; i++) 
         {
             if (this->RH_Seq[i] == this->RH_Seq[i - 1]) 
@@ -676,6 +865,7 @@ void ReadHolder::decode(void)
     // Go from RLE to normal
     // Call it anytime. Fixes start stops
     //
+    SeqUnpacker unpacker(this);
     std::string tmp = this->expand(true);
     this->RH_isSqueezed = false;
     this->RH_Seq = tmp;
@@ -698,7 +888,7 @@ std::string ReadHolder::expand(bool fixStopStarts)
     
     if (!this->RH_isSqueezed) 
     {
-        return this->RH_Seq;
+        return this->getSeq();
     } 
     else 
     {
@@ -799,7 +989,7 @@ bool ReadHolder::getNextDR(std::string * retStr)
     int dist = end_cut - start_cut;
     if(0 != dist)
     {
-        *retStr = RH_Seq.substr(start_cut, dist + 1);
+        *retStr = seqSubstr(start_cut, dist + 1);
         RH_LastDREnd+=2;
         return true;
     }
@@ -852,9 +1042,9 @@ bool ReadHolder::getNextSpacer(std::string * retStr)
     		// read starts with a spacer
     		// the next spacer starts after the first DR
             try {
-                *retStr = RH_Seq.substr(0, *ss_iter);
+                *retStr = seqSubstr(0, *ss_iter);
             } catch (std::out_of_range& e) {
-                throw crispr::substring_exception(e.what(), RH_Seq.c_str(), 0, *ss_iter, __FILE__, __LINE__, __PRETTY_FUNCTION__);
+                throw crispr::substring_exception(e.what(), getSeq().c_str(), 0, *ss_iter, __FILE__, __LINE__, __PRETTY_FUNCTION__);
             }
     		RH_NextSpacerStart = 1;
     	}
@@ -867,9 +1057,9 @@ bool ReadHolder::getNextSpacer(std::string * retStr)
     		if(ss_iter < RH_StartStops.end())
     		{
                 try {
-                    *retStr = RH_Seq.substr(start_cut, *ss_iter - start_cut);
+                    *retStr = seqSubstr(start_cut, *ss_iter - start_cut);
                 } catch (std::out_of_range& e) {
-                    throw crispr::substring_exception(e.what(), RH_Seq.c_str(), start_cut, (*ss_iter - start_cut), __FILE__, __LINE__, __PRETTY_FUNCTION__);
+                    throw crispr::substring_exception(e.what(), getSeq().c_str(), start_cut, (*ss_iter - start_cut), __FILE__, __LINE__, __PRETTY_FUNCTION__);
                 }
             }
     		else
@@ -877,9 +1067,9 @@ bool ReadHolder::getNextSpacer(std::string * retStr)
                 // only one DR in thie whole guy!
                 try {
                     
-                    *retStr = RH_Seq.substr(start_cut, RH_Seq.length() - start_cut);
+                    *retStr = seqSubstr(start_cut, seqLength() - start_cut);
                 } catch (std::exception& e) {
-                    throw crispr::substring_exception(e.what(), RH_Seq.c_str(), start_cut, (int)(RH_Seq.length() - start_cut), __FILE__, __LINE__, __PRETTY_FUNCTION__);
+                    throw crispr::substring_exception(e.what(), getSeq().c_str(), start_cut, (int)(seqLength() - start_cut), __FILE__, __LINE__, __PRETTY_FUNCTION__);
 
                 }
     		}
@@ -896,16 +1086,16 @@ bool ReadHolder::getNextSpacer(std::string * retStr)
     	if(RH_NextSpacerStart == ((int)(RH_StartStops.size()) - 1))
     	{
     		// last one
-            if(*ss_iter < (RH_Seq.length() - 1))
+            if(*ss_iter < (seqLength() - 1))
             {
             	// read ends with a spacer
                 try {
-                    *retStr = RH_Seq.substr(*ss_iter + 1);
+                    *retStr = seqSubstr(*ss_iter + 1, std::string::npos);
                     RH_NextSpacerStart+=2;
                     return true;
                 } catch (std::exception& e) {
                     throw crispr::substring_exception(e.what(), 
-                                                      RH_Seq.c_str(),
+                                                      getSeq().c_str(),
                                                       0, 
                                                       *ss_iter, 
                                                       __FILE__, 
@@ -916,11 +1106,11 @@ bool ReadHolder::getNextSpacer(std::string * retStr)
             else
             {
             	// read ends with a DR. No more spacers to get
-            	if(*ss_iter > (RH_Seq.length() - 1))
+            	if(*ss_iter > (seqLength() - 1))
             	{
                     std::stringstream error_stream;
                     this->printContents(error_stream);
-                    error_stream <<"ss list out of range; "<<*ss_iter<< " > "<<RH_Seq.length() - 1;
+                    error_stream <<"ss list out of range; "<<*ss_iter<< " > "<<seqLength() - 1;
                     logError(error_stream.str().c_str());
             	}
                 return false;    		
@@ -933,12 +1123,12 @@ bool ReadHolder::getNextSpacer(std::string * retStr)
             ss_iter++;
     		int length = *ss_iter - start_cut;
             try {
-                *retStr = RH_Seq.substr(start_cut, length);
+                *retStr = seqSubstr(start_cut, length);
     		    RH_NextSpacerStart += 2;
                 return true;
             } catch (std::exception& e) {
                 throw crispr::substring_exception(e.what(), 
-                                                  RH_Seq.c_str(), 
+                                                  getSeq().c_str(), 
                                                   0, 
                                                   *ss_iter, 
                                                   __FILE__, 
@@ -1142,7 +1332,7 @@ std::string ReadHolder::splitApartSimple(void)
         {
             // starts with a DR
             ss_iter++;
-            ss << "DR: " << RH_Seq.substr(0, *ss_iter + 1) << sep_str;
+            ss << "DR: " << seqSubstr(0, *ss_iter + 1) << sep_str;
             prev_end = *ss_iter;
         }
         else
@@ -1158,10 +1348,10 @@ std::string ReadHolder::splitApartSimple(void)
                 length = *ss_iter - prev_end  - 1;
                 prev_end++;
             }
-            ss << "SP: " << RH_Seq.substr(prev_end, length) << sep_str;
+            ss << "SP: " << seqSubstr(prev_end, length) << sep_str;
             int start = *ss_iter;
             ss_iter++;
-            ss << "DR: " << RH_Seq.substr(start, *ss_iter - start + 1) << sep_str;
+            ss << "DR: " << seqSubstr(start, *ss_iter - start + 1) << sep_str;
             prev_end = *ss_iter;
             
         }
@@ -1169,10 +1359,10 @@ std::string ReadHolder::splitApartSimple(void)
         if(RH_StartStops.end() == (ss_iter + 1))
         {
             // this is the last one.
-            if((RH_Seq.length() - 1) != *ss_iter)
+            if((seqLength() - 1) != *ss_iter)
             {
                 // ends on spacer
-                ss << "SP: " << RH_Seq.substr(prev_end + 1);
+                ss << "SP: " << seqSubstr(prev_end + 1, std::string::npos);
             }
         }
         ss_iter++;
@@ -1195,8 +1385,8 @@ void ReadHolder::printContents(void)
         ss_iter++;
     }
     std::cout << std::endl;
-    std::cout << "Sequence:"<< RH_Seq << std::endl;
-    std::cout << "Len: " << RH_Seq.length() << std::endl;
+    std::cout << "Sequence:"<< getSeq() << std::endl;
+    std::cout << "Len: " << seqLength() << std::endl;
     std::cout << "---------------------------------------------" << std::endl;
     std::cout << "---------------------------------------------" << std::endl;
     
@@ -1215,8 +1405,8 @@ void ReadHolder::printContents(std::ostream& out)
         ss_iter++;
     }
     out << std::endl;
-    out << "Sequence:"<< RH_Seq << std::endl;
-    out << "Len: " << RH_Seq.length() << std::endl;
+    out << "Sequence:"<< getSeq() << std::endl;
+    out << "Len: " << seqLength() << std::endl;
     out << "---------------------------------------------" << std::endl;
     out << "---------------------------------------------" << std::endl;
     
@@ -1235,7 +1425,7 @@ void ReadHolder::logContents(int logLevel)
         ss << *ss_iter << ",";
         ss_iter++;
     }
-    ss << "\n" <<RH_Seq<<"\n";
+    ss << "\n" <<getSeq()<<"\n";
     logInfo(ss.str().c_str(), logLevel);
 }
 
@@ -1251,12 +1441,12 @@ std::ostream& ReadHolder::print (std::ostream& s)
         {
             s<<' '<<RH_Comment;
         }
-        s<<std::endl<<RH_Seq;
+        s<<std::endl<<getSeq();
 #ifdef OUTPUT_READS_FASTQ
     } 
     else 
     {
-        s<<'@'<<RH_Header<<std::endl<<RH_Seq<<std::endl<<'+';
+        s<<'@'<<RH_Header<<std::endl<<getSeq()<<std::endl<<'+';
         if (RH_Comment.length() > 0) 
         {
             s<<RH_Comment<<std::endl;
@@ -47,6 +47,8 @@
 // local includes
 #include "crassDefines.h"
 
+class Checkpoint;
+
 // typedefs
 typedef std::vector<unsigned int> StartStopList;
 typedef std::vector<unsigned int>::iterator StartStopListIterator;
@@ -66,6 +68,8 @@ class ReadHolder
             RH_NextSpacerStart = 0; 
             RH_isSqueezed = false;
             RH_IsFasta = true;
+            RH_IsPacked = false;
+            RH_PackedLength = 0;
         }  
         
         ReadHolder(std::string s, std::string h) 
@@ -76,6 +80,8 @@ class ReadHolder
             RH_NextSpacerStart = 0; 
             RH_isSqueezed = false;
             RH_IsFasta = true;
+            RH_IsPacked = false;
+            RH_PackedLength = 0;
 
         }
 
@@ -87,30 +93,36 @@ class ReadHolder
             RH_NextSpacerStart = 0; 
             RH_isSqueezed = false;
             RH_IsFasta = true;
+            RH_IsPacked = false;
+            RH_PackedLength = 0;
 
         }
         ReadHolder(std::string s, std::string h, std::string c, std::string q) 
         {
             RH_Seq = s; 
             RH_Header = h; 
-            RH_Comment = c;
-            RH_Qual = q;
+            setComment(c);
+            setQual(q);
             RH_LastDREnd = 0; 
             RH_NextSpacerStart = 0; 
             RH_isSqueezed = false;
             RH_IsFasta = false;
+            RH_IsPacked = false;
+            RH_PackedLength = 0;
         }
         
         ReadHolder(const char * s, const char * h, const char * c, const char * q) 
         {
             RH_Seq = s; 
             RH_Header = h;
-            RH_Comment = c;
-            RH_Qual = q;
+            setComment(c);
+            setQual(q);
             RH_LastDREnd = 0; 
             RH_NextSpacerStart = 0; 
             RH_isSqueezed = false;
             RH_IsFasta = false;
+            RH_IsPacked = false;
+            RH_PackedLength = 0;
 
         }
         
@@ -127,11 +139,38 @@ class ReadHolder
             RH_Rle.clear();
             RH_Comment.clear();
             RH_Qual.clear();
+            RH_Packed.clear();
+            RH_OddPositions.clear();
+            RH_OddBases.clear();
+            RH_PackedLength = 0;
+            RH_IsPacked = false;
             RH_NextSpacerStart = 0; 
             RH_isSqueezed = false;
             RH_IsFasta = false;
         }
 
+        //----
+        // Packing. Once a read is filed away it only needs to be read, so
+        // the sequence is kept two bits to a base with anything that isn't
+        // ACGT stored on the side. The getters decode on demand and any
+        // method that needs the whole sequence unpacks it while it runs
+        //
+        void pack(void);                        // pack the sequence and free the string
+        
+        void unpack(void);                      // put the sequence back in a string
+        
+        inline bool isPacked(void)
+        {
+            return this->RH_IsPacked;
+        }
+
+        //----
+        // Checkpoints, every member is saved as it is, packed or not
+        //
+        void save(Checkpoint& out);
+        
+        void load(Checkpoint& in);              // into an empty readholder
+
 
     
         //----
@@ -151,6 +190,14 @@ class ReadHolder
         }
         inline std::string getSeq(void)
         {
+            return (RH_IsPacked) ? seqSubstr(0, RH_PackedLength) : this->RH_Seq;
+        }
+        
+        // no copy, only valid until the sequence is changed.
+        // A packed read is unpacked for good
+        inline const std::string& getSeqRef(void)
+        {
+            unpack();
             return this->RH_Seq;
         }
     
@@ -228,7 +275,7 @@ class ReadHolder
         
         int getSeqLength(void)
         {
-            return (int)RH_Seq.length();
+            return (RH_IsPacked) ? (int)RH_PackedLength : (int)RH_Seq.length();
         }
         
         unsigned int getStartStopListSize(void)
@@ -243,7 +290,7 @@ class ReadHolder
     
         inline char getSeqCharAt(int i)
         {
-            return RH_Seq[i];
+            return (RH_IsPacked) ? packedCharAt(i) : RH_Seq[i];
         }
         
         unsigned int getRepeatAt(unsigned int i);
@@ -265,19 +312,28 @@ class ReadHolder
         //----
         //setters
         // 
+        // the quality is only written out with the reads when
+        // OUTPUT_READS_FASTQ is set, otherwise it isn't kept
         inline void setComment(std::string _comment)
         {
             RH_Comment = _comment;
         }
         inline void setQual(std::string _qual)
         {
+#ifdef OUTPUT_READS_FASTQ
             RH_Qual = _qual;
+#endif
             RH_IsFasta = false;
         }
         inline void setSequence(std::string _sequence)
         {
             RH_RepeatLength = 0;
             RH_Seq = _sequence;
+            RH_IsPacked = false;
+            RH_Packed.clear();
+            RH_OddPositions.clear();
+            RH_OddBases.clear();
+            RH_PackedLength = 0;
         }
 
         inline void setRepeatLength(int length)
@@ -373,32 +429,32 @@ class ReadHolder
 
         std::string substr(int i, int j)
         {
-            return RH_Seq.substr(i, j);
+            return seqSubstr(i, j);
         }
         
         std::string substr(int i)
         {
-            return RH_Seq.substr(i);
+            return seqSubstr(i, std::string::npos);
         }
         
         std::string substr(unsigned int i, unsigned int j)
         {
-            return RH_Seq.substr(i, j );
+            return seqSubstr(i, j);
         }
         
         std::string substr(unsigned int i)
         {
-            return RH_Seq.substr(i);
+            return seqSubstr(i, std::string::npos);
         }
         
         std::string substr(size_t i, size_t j)
         {
-            return RH_Seq.substr(i, j );
+            return seqSubstr(i, j);
         }
         
         std::string substr(size_t i)
         {
-            return RH_Seq.substr(i);
+            return seqSubstr(i, std::string::npos);
         }
     
         std::string DRLowLexi(void);            // Put the sequence in the form that makes the DR in it's laurenized form
@@ -436,6 +492,15 @@ class ReadHolder
         inline std::ostream& print(std::ostream& s);
     
     private:
+        std::string seqSubstr(size_t pos, size_t length);  // std::string::substr that also works on a packed read
+        
+        inline size_t seqLength(void)
+        {
+            return (RH_IsPacked) ? RH_PackedLength : RH_Seq.length();
+        }
+        
+        char packedCharAt(size_t i);
+        
         // members
         std::string RH_Rle;                     // Run length encoded string
         std::string RH_Header;                  // Header for the sequence
@@ -449,6 +514,11 @@ class ReadHolder
         int RH_LastDREnd;                       // the end of the last DR cut (offset of the iterator)
         int RH_NextSpacerStart;                 // the end of the last spacer cut (offset of the iterator)
         int RH_RepeatLength;
+        bool RH_IsPacked;                       // the sequence is in RH_Packed, RH_Seq is empty
+        std::string RH_Packed;                  // four bases to a byte
+        std::vector<unsigned int> RH_OddPositions;  // positions of anything that isn't ACGT, in order
+        std::string RH_OddBases;                // and what was there
+        unsigned int RH_PackedLength;           // length of the packed sequence
 };
 
 // overloaded operators 
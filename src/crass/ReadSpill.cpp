@@ -0,0 +1,258 @@
+// File: ReadSpill.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Implementation of ReadSpill functions
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+// system includes
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <sstream>
+
+// local includes
+#include "ReadSpill.h"
+#include "Exception.h"
+#include "config.h"
+
+// each record is laid out as:
+//  header length, header
+//  comment flag, [comment length, comment]
+//  quality flag, [quality length, quality]  (OUTPUT_READS_FASTQ only)
+//  sequence length, packed sequence
+//  number of odd bases, [position, base] ...
+
+static const char spillBases[4] = {'A', 'C', 'G', 'T'};
+
+void ReadSpill::open(const std::string& fileName)
+{
+    close();
+    mFileName = fileName;
+    mFile = fopen(mFileName.c_str(), "w+b");
+    if (mFile == NULL)
+    {
+        std::stringstream ss;
+        ss<<"Could not create the spill file "<<mFileName;
+        throw crispr::exception(__FILE__,
+                                __LINE__,
+                                __PRETTY_FUNCTION__,
+                                ss);
+    }
+    mNumReads = 0;
+    mBytesWritten = 0;
+}
+
+void ReadSpill::add(const ReadView& read)
+{
+    writeString(read.mHeader, read.mHeaderLength);
+
+    unsigned char flag = (read.mComment != NULL);
+    writeBytes(&flag, 1);
+    if (read.mComment != NULL)
+    {
+        writeString(read.mComment, read.mCommentLength);
+    }
+
+    flag = (read.mQual != NULL);
+    writeBytes(&flag, 1);
+#ifdef OUTPUT_READS_FASTQ
+    if (read.mQual != NULL)
+    {
+        writeString(read.mQual, read.mQualLength);
+    }
+#endif
+
+    //-----
+    // pack the sequence, four bases to a byte
+    //
+    unsigned int seq_length = static_cast<unsigned int>(read.mSeqLength);
+    writeLength(seq_length);
+    mPacked.assign((seq_length + 3) / 4, '\0');
+    std::vector<unsigned int> odd_positions;
+    for (unsigned int i = 0; i < seq_length; ++i)
+    {
+        unsigned char code;
+        switch (read.mSeq[i])
+        {
+            case 'A': code = 0; break;
+            case 'C': code = 1; break;
+            case 'G': code = 2; break;
+            case 'T': code = 3; break;
+            default:
+                code = 0;
+                odd_positions.push_back(i);
+                break;
+        }
+        mPacked[i / 4] |= static_cast<char>(code << ((i % 4) * 2));
+    }
+    writeBytes(mPacked.data(), mPacked.length());
+
+    writeLength(static_cast<unsigned int>(odd_positions.size()));
+    std::vector<unsigned int>::iterator odd_iter;
+    for (odd_iter = odd_positions.begin(); odd_iter != odd_positions.end(); ++odd_iter)
+    {
+        writeLength(*odd_iter);
+        writeBytes(read.mSeq + *odd_iter, 1);
+    }
+    mNumReads++;
+}
+
+void ReadSpill::rewind(void)
+{
+    if (mFile == NULL)
+    {
+        throw crispr::exception(__FILE__,
+                                __LINE__,
+                                __PRETTY_FUNCTION__,
+                                "The spill file is not open");
+    }
+    fflush(mFile);
+    fseek(mFile, 0, SEEK_SET);
+}
+
+bool ReadSpill::next(ReadRecord& record)
+{
+    //-----
+    // read the next record back in, false at the end of the file
+    //
+    int c = fgetc(mFile);
+    if (c == EOF)
+    {
+        return false;
+    }
+    ungetc(c, mFile);
+
+    // the record keeps its own copy of the read
+    record.mMapped = false;
+    readString(record.mHeader);
+
+    unsigned char flag;
+    readBytes(&flag, 1);
+    record.mHasComment = (flag != 0);
+    if (record.mHasComment)
+    {
+        readString(record.mComment);
+    }
+
+    readBytes(&flag, 1);
+    record.mHasQual = (flag != 0);
+#ifdef OUTPUT_READS_FASTQ
+    if (record.mHasQual)
+    {
+        readString(record.mQual);
+    }
+#else
+    record.mQual.clear();
+#endif
+
+    unsigned int seq_length = readLength();
+    mPacked.resize((seq_length + 3) / 4);
+    if (! mPacked.empty())
+    {
+        readBytes(&(mPacked[0]), mPacked.length());
+    }
+    record.mSeq.resize(seq_length);
+    for (unsigned int i = 0; i < seq_length; ++i)
+    {
+        record.mSeq[i] = spillBases[(static_cast<unsigned char>(mPacked[i / 4]) >> ((i % 4) * 2)) & 3];
+    }
+
+    unsigned int num_odd = readLength();
+    for (unsigned int i = 0; i < num_odd; ++i)
+    {
+        unsigned int position = readLength();
+        readBytes(&(record.mSeq[position]), 1);
+    }
+    return true;
+}
+
+void ReadSpill::close(void)
+{
+    if (mFile != NULL)
+    {
+        fclose(mFile);
+        mFile = NULL;
+        remove(mFileName.c_str());
+    }
+}
+
+void ReadSpill::writeBytes(const void * data, size_t length)
+{
+    if (fwrite(data, 1, length, mFile) != length)
+    {
+        throw crispr::exception(__FILE__,
+                                __LINE__,
+                                __PRETTY_FUNCTION__,
+                                "Could not write to the spill file");
+    }
+    mBytesWritten += length;
+}
+
+void ReadSpill::readBytes(void * data, size_t length)
+{
+    if (fread(data, 1, length, mFile) != length)
+    {
+        throw crispr::exception(__FILE__,
+                                __LINE__,
+                                __PRETTY_FUNCTION__,
+                                "The spill file is truncated");
+    }
+}
+
+void ReadSpill::writeLength(unsigned int length)
+{
+    writeBytes(&length, sizeof(unsigned int));
+}
+
+unsigned int ReadSpill::readLength(void)
+{
+    unsigned int length;
+    readBytes(&length, sizeof(unsigned int));
+    return length;
+}
+
+void ReadSpill::writeString(const char * str, size_t length)
+{
+    writeLength(static_cast<unsigned int>(length));
+    writeBytes(str, length);
+}
+
+void ReadSpill::readString(std::string& str)
+{
+    unsigned int length = readLength();
+    str.resize(length);
+    if (length > 0)
+    {
+        readBytes(&(str[0]), length);
+    }
+}
@@ -0,0 +1,84 @@
+// File: ReadSpill.h
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// A temporary file holding the reads that failed the search so that
+// the singleton finder can scan them without decompressing and
+// parsing the input files a second time. The sequence is packed two
+// bits to a base, anything that isn't ACGT is kept on the side.
+// Qualities are only kept when they will be written out
+// (OUTPUT_READS_FASTQ).
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+#ifndef ReadSpill_h
+#define ReadSpill_h
+
+// system includes
+#include <cstdio>
+#include <string>
+
+// local includes
+#include "ReadBatch.h"
+
+class ReadSpill
+{
+    public:
+        ReadSpill(void) { mFile = NULL; mNumReads = 0; mBytesWritten = 0; }
+        ~ReadSpill(void) { close(); }
+
+        void open(const std::string& fileName);             // start a new spill file
+        void add(const ReadView& read);                     // append a read
+        void rewind(void);                                  // finished writing, go back to the first read
+        bool next(ReadRecord& record);                      // false when there are no more reads
+        void close(void);                                   // close and remove the file
+
+        inline size_t numReads(void) { return mNumReads; }
+        inline unsigned long long bytesWritten(void) { return mBytesWritten; }
+
+    private:
+        void writeBytes(const void * data, size_t length);
+        void readBytes(void * data, size_t length);
+        void writeLength(unsigned int length);
+        unsigned int readLength(void);
+        void writeString(const char * str, size_t length);
+        void readString(std::string& str);
+
+        // members
+        FILE * mFile;
+        std::string mFileName;
+        size_t mNumReads;                                   // reads written
+        unsigned long long mBytesWritten;                   // size of the spill file
+        std::string mPacked;                                // packing buffer
+};
+
+#endif //ReadSpill_h
@@ -37,7 +37,6 @@
 #include <algorithm>
 #include <iostream>
 #include <sstream>
-#include <zlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <config.h>
@@ -97,30 +96,23 @@ std::string laurenize (std::string seq1)
 }
 
 
-gzFile getFileHandle(const char * inputFile)
+GzipReader * getFileHandle(const char * inputFile, int numThreads)
 {
-    gzFile fp;
-    if ( strcmp(inputFile, "-") == 0 ) 
+    GzipReader * fp = new GzipReader(numThreads);
+    if (fp->open(inputFile))
     {
-        fp = gzdopen(fileno(stdin), "r");
-    }
-    else 
-    {
-        fp = gzopen(inputFile, "r");
+        return fp;
     }
+    delete fp;
     
-    if ( (fp == NULL) && (strcmp(inputFile, "-") != 0) ) 
+    if (strcmp(inputFile, "-") != 0) 
     {
         std::cerr<< PACKAGE_NAME<<" : [ERROR] Could not open FASTQ "<<inputFile<<" for reading."<<std::endl;
         exit(1);
     }
     
-    if ( (fp == NULL) && (strcmp(inputFile, "-") == 0) ) 
-    {
-        std::cerr<< PACKAGE_NAME<<" : [ERROR] Could not open stdin for reading."<<std::endl;
-        exit(1);
-    }
-    return fp;
+    std::cerr<< PACKAGE_NAME<<" : [ERROR] Could not open stdin for reading."<<std::endl;
+    exit(1);
 }
 
 #define OUT_FILE_PERMISSION_MASK (S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH)
@@ -35,7 +35,7 @@
 #ifndef __SEQ_UTILS_H
 #define __SEQ_UTILS_H
 #include <string>
-#include <zlib.h>
+#include "GzipReader.h"
 
 std::string reverseComplement(std::string str);
 
@@ -45,7 +45,8 @@ std::string laurenize(std::string seq);
 // system
 //**************************************
 
-gzFile getFileHandle(const char * inputFile);
+// the input is decoded on a thread of its own, BGZF input on numThreads
+GzipReader * getFileHandle(const char * inputFile, int numThreads = 1);
 
 void RecursiveMkdir(std::string dir);
 #endif
@@ -58,6 +58,12 @@
 #include <sys/time.h>
 #include <map>
 #include <exception>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 // local includes
 #include "SmithWaterman.h"
@@ -148,144 +154,280 @@ stringPair smithWaterman(std::string& seqA, std::string& seqB, int * aStartAlign
     return smithWaterman(seqA, seqB, aStartAlign, aEndAlign, aStartSearch, aSearchLen, 0);
 }
 
-stringPair smithWaterman(std::string& seqA, std::string& seqB, int * aStartAlign, int * aEndAlign, int aStartSearch, int aSearchLen, double similarity)
+//-----
+// Both kernels below fill in the same matrix as the original version did,
+// with the scores multiplied by 5 so they are whole numbers. Instead of
+// storing a pointer for every cell and walking back from the best one,
+// each cell carries the cell that the walk back from it would stop on:
+// itself when it points at itself or into the first row or column,
+// otherwise wherever its predecessor's walk stops. A stop row of -1 marks
+// the first row and column. Ties go the same way as in findMax and the
+// best cell is the first one with the top score in row order
+//
+static void alignScalar(const char * seqA, int aSearchLen, const char * seqB, int bLength, int * iMax, int * jMax, int * stopI, int * stopJ)
+{
+    // score, stop row and stop column for the previous and current rows
+    std::vector<int> buffer(6 * (bLength + 1), 0);
+    int * prev_score = &buffer[0];
+    int * prev_stop_i = prev_score + (bLength + 1);
+    int * prev_stop_j = prev_stop_i + (bLength + 1);
+    int * curr_score = prev_stop_j + (bLength + 1);
+    int * curr_stop_i = curr_score + (bLength + 1);
+    int * curr_stop_j = curr_stop_i + (bLength + 1);
+    // the first column is never written so it stays marked in both rows
+    std::fill(prev_stop_i, prev_stop_i + bLength + 1, -1);
+    std::fill(curr_stop_i, curr_stop_i + bLength + 1, -1);
+    
+    int matrix_max = -1;
+    for (int i = 1; i <= aSearchLen; i++)
+    {
+        char a_char = seqA[i - 1];
+        // the cell to the left is carried along in registers
+        int left_score = 0;
+        int left_si = -1;
+        int left_sj = 0;
+        for (int j = 1; j <= bLength; j++)
+        {
+            int diag = prev_score[j-1] + SW_INT_SIM_SCORE(a_char, seqB[j-1]);
+            int up = prev_score[j] + SW_INT_GAP;
+            int left = left_score + SW_INT_GAP;
+            // the order of these tests decides the ties
+            bool up_wins = up > diag;
+            int best = up_wins ? up : diag;
+            int si = up_wins ? prev_stop_i[j] : prev_stop_i[j-1];
+            int sj = up_wins ? prev_stop_j[j] : prev_stop_j[j-1];
+            bool left_wins = (left > 0) && (left > best);
+            bool zero_wins = ! left_wins && (0 > best);
+            int score = left_wins ? left : (zero_wins ? 0 : best);
+            si = left_wins ? left_si : (zero_wins ? -1 : si);
+            sj = left_wins ? left_sj : sj;
+            if(0 > si)
+            {
+                si = i;
+                sj = j;
+            }
+            curr_score[j] = left_score = score;
+            curr_stop_i[j] = left_si = si;
+            curr_stop_j[j] = left_sj = sj;
+            
+            if(score > matrix_max)
+            {
+                matrix_max = score;
+                *iMax = i;
+                *jMax = j;
+                *stopI = si;
+                *stopJ = sj;
+            }
+        }
+        std::swap(prev_score, curr_score);
+        std::swap(prev_stop_i, curr_stop_i);
+        std::swap(prev_stop_j, curr_stop_j);
+    }
+}
+
+#ifdef __SSE2__
+// the 16 bit lanes have to hold the best score and every row and column
+#define SW_SSE2_MAX_LENGTH      (5000)
+
+static void alignSSE2(const char * seqA, int aSearchLen, const char * seqB, int bLength, int * iMax, int * jMax, int * stopI, int * stopJ)
 {
     //-----
-    // Trickle-ier verison of the original version of the smith waterman algorithm I found in this file
-    // 
-    // This function is seqA centric, it will align ALL of seqB to the parts of seqA which lie INCLUSIVELY
-    // between aStartSearch and aEndSearch. It will return the UNIMPUTED alignment strings for A and B respectively
-    // in the stringPair variable AND it also stores the start and end indexes used to cut the seqA substring in the 
-    // two int references  aStartAlign, aEndAlign 
-    // 
-    // Hoi!
+    // The cells on an anti-diagonal don't depend on each other so they are
+    // done 8 at a time. Everything is indexed by row: the three diagonals
+    // in flight are kept in rotating buffers and the best cell so far is
+    // kept per row, so that the first best in row order can be picked out
+    // at the end. Lanes past the end of a diagonal are computed anyway,
+    // they only ever write where nothing valid is read back from
     //
-    // initialize some variables
-    int length_seq_B = (int)seqB.length();
+    const int n = aSearchLen;
+    const int m = bLength;
+    const int width = n + 1 + 8;
+    std::vector<int16_t> buffer(13 * width, 0);
+    int16_t * score[3];
+    int16_t * stop_i[3];
+    int16_t * stop_j[3];
+    for (int k = 0; k < 3; k++)
+    {
+        score[k] = &buffer[k * width];
+        stop_i[k] = &buffer[(3 + k) * width];
+        stop_j[k] = &buffer[(6 + k) * width];
+        std::fill(stop_i[k], stop_i[k] + width, -1);
+    }
+    int16_t * row_max = &buffer[9 * width];
+    int16_t * row_j = &buffer[10 * width];
+    int16_t * row_stop_i = &buffer[11 * width];
+    int16_t * row_stop_j = &buffer[12 * width];
+    std::fill(row_max, row_max + width, -1);
     
-    // initialize matrix
-    double ** matrix = new double*[aSearchLen+1];
-    int ** I_i = new int*[aSearchLen+1];
-    int ** I_j = new int*[aSearchLen+1];
+    // seqA by row and seqB backwards so that a diagonal reads both forwards.
+    // The padding can never match
+    std::vector<int16_t> a_codes(n + 8, 0x100);
+    std::vector<int16_t> b_codes(m + 8, 0x200);
+    for (int i = 0; i < n; i++)
+    {
+        a_codes[i] = (unsigned char)seqA[i];
+    }
+    for (int j = 0; j < m; j++)
+    {
+        b_codes[j] = (unsigned char)seqB[m - 1 - j];
+    }
+    
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i match = _mm_set1_epi16(SW_INT_MATCH);
+    const __m128i mismatch = _mm_set1_epi16(SW_INT_MISMATCH);
+    const __m128i gap = _mm_set1_epi16(SW_INT_GAP);
+    const __m128i lanes = _mm_set_epi16(7, 6, 5, 4, 3, 2, 1, 0);
     
-    for(int i=0;i<=aSearchLen;i++)
+    for (int d = 2; d <= n + m; d++)
     {
-        double * tmp_mat = new double[length_seq_B+1];
-        int * tmp_i = new int[length_seq_B+1];
-        int * tmp_j = new int[length_seq_B+1];
-
-        matrix[i] = tmp_mat;
-        I_i[i] = tmp_i;
-        I_j[i] = tmp_j;
+        const int16_t * h2 = score[(d - 2) % 3];
+        const int16_t * si2 = stop_i[(d - 2) % 3];
+        const int16_t * sj2 = stop_j[(d - 2) % 3];
+        const int16_t * h1 = score[(d - 1) % 3];
+        const int16_t * si1 = stop_i[(d - 1) % 3];
+        const int16_t * sj1 = stop_j[(d - 1) % 3];
+        int16_t * h0 = score[d % 3];
+        int16_t * si0 = stop_i[d % 3];
+        int16_t * sj0 = stop_j[d % 3];
         
-        for(int j=0;j<=length_seq_B;j++)
+        int lo = std::max(1, d - m);
+        int hi = std::min(n, d - 1);
+        const __m128i last_row = _mm_set1_epi16((int16_t)hi);
+        for (int i = lo; i <= hi; i += 8)
+        {
+            __m128i row = _mm_add_epi16(_mm_set1_epi16((int16_t)i), lanes);
+            __m128i col = _mm_sub_epi16(_mm_set1_epi16((int16_t)d), row);
+            __m128i a = _mm_loadu_si128((const __m128i *)(&a_codes[i - 1]));
+            __m128i b = _mm_loadu_si128((const __m128i *)(&b_codes[m - d + i]));
+            __m128i same = _mm_cmpeq_epi16(a, b);
+            __m128i sim = _mm_or_si128(_mm_and_si128(same, match), _mm_andnot_si128(same, mismatch));
+            
+            __m128i diag = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(h2 + i - 1)), sim);
+            __m128i up = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(h1 + i - 1)), gap);
+            __m128i left = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(h1 + i)), gap);
+            
+            __m128i up_wins = _mm_cmpgt_epi16(up, diag);
+            __m128i best = _mm_max_epi16(up, diag);
+            __m128i si = _mm_or_si128(_mm_and_si128(up_wins, _mm_loadu_si128((const __m128i *)(si1 + i - 1))),
+                                      _mm_andnot_si128(up_wins, _mm_loadu_si128((const __m128i *)(si2 + i - 1))));
+            __m128i sj = _mm_or_si128(_mm_and_si128(up_wins, _mm_loadu_si128((const __m128i *)(sj1 + i - 1))),
+                                      _mm_andnot_si128(up_wins, _mm_loadu_si128((const __m128i *)(sj2 + i - 1))));
+            __m128i left_wins = _mm_and_si128(_mm_cmpgt_epi16(left, zero), _mm_cmpgt_epi16(left, best));
+            __m128i zero_wins = _mm_andnot_si128(left_wins, _mm_cmpgt_epi16(zero, best));
+            __m128i h = _mm_max_epi16(_mm_max_epi16(left, best), zero);
+            si = _mm_or_si128(_mm_and_si128(left_wins, _mm_loadu_si128((const __m128i *)(si1 + i))),
+                              _mm_andnot_si128(left_wins, si));
+            si = _mm_or_si128(zero_wins, _mm_andnot_si128(zero_wins, si));
+            sj = _mm_or_si128(_mm_and_si128(left_wins, _mm_loadu_si128((const __m128i *)(sj1 + i))),
+                              _mm_andnot_si128(left_wins, sj));
+            __m128i own = _mm_cmpgt_epi16(zero, si);
+            si = _mm_or_si128(_mm_and_si128(own, row), _mm_andnot_si128(own, si));
+            sj = _mm_or_si128(_mm_and_si128(own, col), _mm_andnot_si128(own, sj));
+            
+            _mm_storeu_si128((__m128i *)(h0 + i), h);
+            _mm_storeu_si128((__m128i *)(si0 + i), si);
+            _mm_storeu_si128((__m128i *)(sj0 + i), sj);
+            
+            // within a row the columns come in order so only a strictly
+            // better score replaces the best one
+            __m128i better = _mm_andnot_si128(_mm_cmpgt_epi16(row, last_row),
+                                              _mm_cmpgt_epi16(h, _mm_loadu_si128((const __m128i *)(row_max + i))));
+            _mm_storeu_si128((__m128i *)(row_max + i), _mm_or_si128(_mm_and_si128(better, h), _mm_andnot_si128(better, _mm_loadu_si128((const __m128i *)(row_max + i)))));
+            _mm_storeu_si128((__m128i *)(row_j + i), _mm_or_si128(_mm_and_si128(better, col), _mm_andnot_si128(better, _mm_loadu_si128((const __m128i *)(row_j + i)))));
+            _mm_storeu_si128((__m128i *)(row_stop_i + i), _mm_or_si128(_mm_and_si128(better, si), _mm_andnot_si128(better, _mm_loadu_si128((const __m128i *)(row_stop_i + i)))));
+            _mm_storeu_si128((__m128i *)(row_stop_j + i), _mm_or_si128(_mm_and_si128(better, sj), _mm_andnot_si128(better, _mm_loadu_si128((const __m128i *)(row_stop_j + i)))));
+        }
+        // the cell in the first column of this diagonal
+        if(d <= n)
         {
-            matrix[i][j]=0;
+            h0[d] = 0;
+            si0[d] = -1;
         }
     }
     
-      
-    //start populating matrix
-    double matrix_max = -1;
-    int i_max = 0, j_max = 0;
-    for (int i=1;i<=aSearchLen;i++)
+    int matrix_max = -1;
+    for (int i = 1; i <= n; i++)
     {
-        for(int j=1;j<=length_seq_B;j++)
+        if(row_max[i] > matrix_max)
         {
-            int index = -1;
-            matrix[i][j] = findMax(   matrix[i-1][j-1] + SW_SIM_SCORE(seqA[i-1 + aStartSearch],seqB[j-1]), \
-                                      matrix[i-1][j] + SW_GAP, \
-                                      matrix[i][j-1] + SW_GAP, \
-                                      0, \
-                                      &index
-                                  );
-
-            if(matrix[i][j] > matrix_max)
-            {
-                matrix_max = matrix[i][j];
-                i_max = i;
-                j_max = j;
-            }
-            
-            switch(index)
-            {
-                case 0:
-                    I_i[i][j] = i-1;
-                    I_j[i][j] = j-1;
-                    break;
-                case 1:
-                    I_i[i][j] = i-1;
-                    I_j[i][j] = j;
-                    break;
-                case 2:
-                    I_i[i][j] = i;
-                    I_j[i][j] = j-1;
-                    break;
-                case 3:
-                    I_i[i][j] = i;
-                    I_j[i][j] = j;
-                    break;
-                default:
-                    throw crispr::exception( __FILE__, __LINE__, __PRETTY_FUNCTION__,"Index never set in findMax");
-            }
+            matrix_max = row_max[i];
+            *iMax = i;
+            *jMax = row_j[i];
+            *stopI = row_stop_i[i];
+            *stopJ = row_stop_j[i];
         }
     }
+}
+#endif
+
+bool smithWatermanCoordinates(const char * seqA, int aStartSearch, int aSearchLen, const char * seqB, int bLength, int * aStart, int * aEnd, int * bStart, int * bEnd)
+{
+    *aStart = *aEnd = *bStart = *bEnd = 0;
+    if(aSearchLen <= 0 || bLength <= 0)
+    {
+        return false;
+    }
     
-    int current_i = i_max;
-    int current_j = j_max;
-    int next_i = I_i[current_i][current_j];
-    int next_j = I_j[current_i][current_j];
-    
-    while((next_j!=0) && (next_i!=0) && ((current_i!=next_i) || (current_j!=next_j)))
+    int i_max = 0, j_max = 0;
+    int stop_i = 0, stop_j = 0;
+#ifdef __SSE2__
+    if(aSearchLen <= SW_SSE2_MAX_LENGTH && bLength <= SW_SSE2_MAX_LENGTH)
+    {
+        alignSSE2(seqA + aStartSearch, aSearchLen, seqB, bLength, &i_max, &j_max, &stop_i, &stop_j);
+    }
+    else
+#endif
     {
-        current_i = next_i;
-        current_j = next_j;
-        next_i = I_i[current_i][current_j];
-        next_j = I_j[current_i][current_j];
+        alignScalar(seqA + aStartSearch, aSearchLen, seqB, bLength, &i_max, &j_max, &stop_i, &stop_j);
     }
     
     // record the start and end of seqA
-    current_i--;
-    current_j--;
+    int current_i = stop_i - 1;
+    int current_j = stop_j - 1;
     if(0 > current_j) { current_j = 0; } 
     if(0 > current_i) { current_i = 0; } 
     
-    *aStartAlign = current_i+ aStartSearch;
-    *aEndAlign = (*aStartAlign) + i_max - current_i - 1;
-    
-    // we don't need these guys anymore
-    for(int i=0;i<=aSearchLen;i++)
+    *aStart = current_i + aStartSearch;
+    *aEnd = (*aStart) + i_max - current_i - 1;
+    *bStart = current_j;
+    *bEnd = j_max;
+    return true;
+}
+
+stringPair smithWaterman(std::string& seqA, std::string& seqB, int * aStartAlign, int * aEndAlign, int aStartSearch, int aSearchLen, double similarity)
+{
+    //-----
+    // Trickle-ier verison of the original version of the smith waterman algorithm I found in this file
+    // 
+    // This function is seqA centric, it will align ALL of seqB to the parts of seqA which lie INCLUSIVELY
+    // between aStartSearch and aEndSearch. It will return the UNIMPUTED alignment strings for A and B respectively
+    // in the stringPair variable AND it also stores the start and end indexes used to cut the seqA substring in the 
+    // two int references  aStartAlign, aEndAlign 
+    // 
+    // Hoi!
+    //
+    int b_start, b_end;
+    if(! smithWatermanCoordinates(seqA.data(), aStartSearch, aSearchLen, seqB.data(), (int)seqB.length(), aStartAlign, aEndAlign, &b_start, &b_end))
     {
-        delete [] matrix[i];
-        delete [] I_i[i];
-        delete [] I_j[i];
+        return std::pair<std::string, std::string>("","");
     }
-    delete [] matrix;
-    delete [] I_i;
-    delete [] I_j;
     
-    // calculate similarity and return substrings is need be
-    std::string a_ret;
-    std::string b_ret;
-    try {
-        a_ret = seqA.substr(current_i+ aStartSearch, i_max - current_i + aStartSearch);
-    } catch (std::exception& e) {
-        throw (crispr::exception( __FILE__, __LINE__, __PRETTY_FUNCTION__, e.what()));
-    }
-    try {
-        b_ret = seqB.substr(current_j, j_max - current_j);
-    } catch (std::exception& e) {
-        throw (crispr::exception( __FILE__, __LINE__, __PRETTY_FUNCTION__, e.what()));
+    // the part of seqA that gets compared runs on past the end of the
+    // alignment by aStartSearch bases, same as it always has
+    size_t a_pos = *aStartAlign;
+    if(a_pos > seqA.length() || (size_t)b_start > seqB.length())
+    {
+        throw crispr::exception( __FILE__, __LINE__, __PRETTY_FUNCTION__, "alignment lies outside of the sequence");
     }
+    int a_len = std::min((int)(seqA.length() - a_pos), *aEndAlign - *aStartAlign + 1 + aStartSearch);
+    int b_len = b_end - b_start;
+    
     if(0 != similarity)
     {
-        
-        double similarity_ld = 1.0 - (PatternMatcher::levenstheinDistance(a_ret, b_ret) /(double)a_ret.length()); 
-        if(similarity_ld >= similarity)
-        {
-            return std::pair<std::string, std::string>(a_ret, b_ret); 
-        }
-        else
+        // one more edit than this and it can't pass
+        int max_distance = (int)((1.0 - similarity) * a_len) + 1;
+        double similarity_ld = 1.0 - (PatternMatcher::levenstheinDistance(seqA.data() + a_pos, a_len, seqB.data() + b_start, b_len, max_distance) /(double)a_len); 
+        if(similarity_ld < similarity)
         {
             // no go joe
             *aStartAlign = 0;
@@ -293,16 +435,5 @@ stringPair smithWaterman(std::string& seqA, std::string& seqB, int * aStartAlign
             return std::pair<std::string, std::string>("","");
         }
     }
-    else
-    {
-        // just return the substrings
-        return std::pair<std::string, std::string>(a_ret, b_ret);
-    }
+    return std::pair<std::string, std::string>(seqA.substr(a_pos, a_len), seqB.substr(b_start, b_len));
 }
-
-
-
-
-
-
-
@@ -62,6 +62,12 @@
 #define SW_GAP                  (-1)
 #define SW_SIM_SCORE(_a, _b)    ((_a == _b) ? SW_MATCH : SW_MISMATCH )
 
+// the same scores multiplied by 5 so the matrix can be done in ints
+#define SW_INT_MATCH            (6)
+#define SW_INT_MISMATCH         (-5)
+#define SW_INT_GAP              (-5)
+#define SW_INT_SIM_SCORE(_a, _b)    ((_a == _b) ? SW_INT_MATCH : SW_INT_MISMATCH )
+
 typedef std::pair<std::string, std::string> stringPair;
 
 double findMax(double a, double b, double c, double d, int * index);
@@ -83,4 +89,11 @@ stringPair smithWaterman(std::string& seqA, std::string& seqB, int * aStartAlign
 // two int references  aStartAlign, aEndAlign 
 stringPair smithWaterman(std::string& seqA, std::string& seqB, int * aStartAlign, int * aEndAlign, int aStartSearch, int aEndSearch);
 
+//-----
+// The alignment that smithWaterman finds, as coordinates only. aStart and aEnd
+// are the inclusive range of seqA and bStart, bEnd the half open range of seqB.
+// The full matrix is never stored, only a few rows of it. Returns false if
+// either sequence is empty
+bool smithWatermanCoordinates(const char * seqA, int aStartSearch, int aSearchLen, const char * seqB, int bLength, int * aStart, int * aEnd, int * bStart, int * bEnd);
+
 #endif // __SMITH_WATERMAN_H
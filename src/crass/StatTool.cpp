@@ -18,7 +18,7 @@
 #include "StatTool.h"
 #include "config.h"
 #include "Exception.h"
-#include "reader.h"
+#include "streamreader.h"
 #include "Utils.h"
 #include <iostream>
 #include <fstream>
@@ -127,49 +127,16 @@ int StatTool::processOptions (int argc, char ** argv)
 int StatTool::processInputFile(const char * inputFile)
 {
     try {
-        crispr::xml::reader xml_parser;
+        crispr::xml::streamreader xml_parser;
         std::ifstream in_file_stream(inputFile);
         if (in_file_stream.good()) {
             in_file_stream.close();
         } else {
             throw crispr::input_exception("cannot open input file");
         }
-        xercesc::DOMDocument * input_doc_obj = xml_parser.setFileParser(inputFile);
-        xercesc::DOMElement * root_elem = input_doc_obj->getDocumentElement();
-        if (!root_elem) {
-            throw crispr::xml_exception(__FILE__, 
-                                        __LINE__, 
-                                        __PRETTY_FUNCTION__, 
-                                        "problem when parsing xml file");
-        }
-        int num_groups_to_process = static_cast<int>(ST_Groups.size());
-        //std::cout<<num_groups_to_process<<std::endl;
-        for (xercesc::DOMElement * currentElement = root_elem->getFirstElementChild();
-             currentElement != NULL; 
-             currentElement = currentElement->getNextElementSibling()) {
-
-            if (ST_Subset && num_groups_to_process == 0) {
-                break;
-            }
-            // is this a group element
-            if (xercesc::XMLString::equals(currentElement->getTagName(), xml_parser.tag_Group())) {
-                char * c_gid = tc(currentElement->getAttribute(xml_parser.attr_Gid()));
-                std::string group_id = c_gid;
-                if (ST_Subset) {
-                    // we only want some of the groups look at DT_Groups
-                    if (ST_Groups.find(group_id.substr(1)) != ST_Groups.end() ) {
-                        parseGroup(currentElement, xml_parser);
-
-                        // decrease the number of groups left
-                        // if we are only using a subset
-                        if(ST_Subset) num_groups_to_process--;
-                    }
-                } else {
-                    parseGroup(currentElement, xml_parser);   
-                }
-                xr(&c_gid);
-            }
-        }
+        // only the stats are kept, each group is thrown away once it has been read
+        ST_GroupsLeft = static_cast<int>(ST_Groups.size());
+        xml_parser.parse(inputFile, StatTool::statGroup, this);
         AStats agregate_stats;
         agregate_stats.total_groups = 0;
         agregate_stats.total_spacers = 0;
@@ -230,6 +197,39 @@ int StatTool::processInputFile(const char * inputFile)
     }
     return 0;
 }
+bool StatTool::statGroup(xercesc::DOMElement * currentElement, 
+                         crispr::xml::base& xmlParser, 
+                         void * context)
+{
+    return static_cast<StatTool *>(context)->parseWantedGroup(currentElement, xmlParser);
+}
+
+// returns false once all of the wanted groups have been found
+bool StatTool::parseWantedGroup(xercesc::DOMElement * currentElement, 
+                                crispr::xml::base& xmlParser)
+{
+    // is this a group element
+    if (xercesc::XMLString::equals(currentElement->getTagName(), xmlParser.tag_Group())) {
+        char * c_gid = tc(currentElement->getAttribute(xmlParser.attr_Gid()));
+        std::string group_id = c_gid;
+        xr(&c_gid);
+        if (ST_Subset) {
+            // we only want some of the groups look at DT_Groups
+            if (ST_Groups.find(group_id.substr(1)) != ST_Groups.end() ) {
+                parseGroup(currentElement, xmlParser);
+
+                // decrease the number of groups left
+                // if we are only using a subset
+                ST_GroupsLeft--;
+            }
+            return (ST_GroupsLeft > 0);
+        } else {
+            parseGroup(currentElement, xmlParser);   
+        }
+    }
+    return true;
+}
+
 void StatTool::parseGroup(xercesc::DOMElement * parentNode, 
                           crispr::xml::base& xmlParser)
 {
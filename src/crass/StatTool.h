@@ -24,6 +24,7 @@
 #include <string>
 #include <set>
 #include "base.h"
+#include "streamreader.h"
 #include "StlExt.h"
 
 
@@ -130,6 +131,7 @@ class StatTool {
     //bool ST_Pretty;
     bool ST_AssemblyStats;
     bool ST_Subset;
+    int ST_GroupsLeft;                      // wanted groups that haven't been read yet
     std::string ST_OutputFileName;
     bool ST_WithHeader;
     bool ST_AggregateStats;
@@ -143,6 +145,7 @@ public:
 
         //ST_Pretty = false;
         ST_Subset = false;
+        ST_GroupsLeft = 0;
         ST_AssemblyStats = false;
         ST_WithHeader = false;
         ST_AggregateStats = false;
@@ -158,6 +161,8 @@ public:
     //void generateGroupsFromString(std::string str);
     int processOptions(int argc, char ** argv);
     int processInputFile(const char * inputFile);
+    static bool statGroup(xercesc::DOMElement * currentElement, crispr::xml::base& xmlParser, void * context);
+    bool parseWantedGroup(xercesc::DOMElement * currentElement, crispr::xml::base& xmlParser);
     void parseGroup(xercesc::DOMElement * parentNode, crispr::xml::base& xmlParser);
     void parseData(xercesc::DOMElement * parentNode, crispr::xml::base& xmlParser, StatManager * statManager);
     void parseDrs(xercesc::DOMElement * parentNode, crispr::xml::base& xmlParser, StatManager * statManager);
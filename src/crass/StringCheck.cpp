@@ -37,11 +37,76 @@
 // system includes
 #include <iostream>
 #include <sstream>
+#include <cstring>
 
 // local includes
 #include "StringCheck.h"
 #include "Exception.h"
 
+#define SC_INITIAL_TABLE_SIZE 1024                          // must be a power of 2
+
+void StringCheck::init(void)
+{
+    //-----
+    // tokens start at 2, nothing is ever stored for 0 or 1
+    //
+    mNextFreeToken = 1;
+    mOffsets.assign(2, 0);
+    mTable.assign(SC_INITIAL_TABLE_SIZE, 0);
+    mTableUsed = 0;
+}
+
+size_t StringCheck::hashString(const char * str, size_t length)
+{
+    // FNV-1a
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= static_cast<unsigned char>(str[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+size_t StringCheck::findSlot(const char * str, size_t length)
+{
+    size_t mask = mTable.size() - 1;
+    size_t slot = hashString(str, length) & mask;
+    while (mTable[slot] != 0)
+    {
+        StringToken token = mTable[slot];
+        size_t start = mOffsets[token - 1];
+        if (mOffsets[token] - start == length && 
+            (length == 0 || memcmp(&(mArena[start]), str, length) == 0))
+        {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void StringCheck::growTable(void)
+{
+    //-----
+    // double the table and put every token back in. When a string was
+    // added more than once only the newest token is kept, same as before
+    //
+    std::vector<StringToken> old_table;
+    old_table.swap(mTable);
+    mTable.assign(old_table.size() * 2, 0);
+    std::vector<StringToken>::iterator table_iter;
+    for (table_iter = old_table.begin(); table_iter != old_table.end(); ++table_iter)
+    {
+        if (*table_iter != 0)
+        {
+            size_t start = mOffsets[*table_iter - 1];
+            size_t length = mOffsets[*table_iter] - start;
+            const char * str = (length > 0) ? &(mArena[start]) : "";
+            mTable[findSlot(str, length)] = *table_iter;
+        }
+    }
+}
 
 StringToken StringCheck::addString(std::string newStr)
 {
@@ -49,25 +114,46 @@ StringToken StringCheck::addString(std::string newStr)
     // add the string and retuen it's token
     //
     mNextFreeToken++;
-    mT2S_map[mNextFreeToken] = newStr;
-    mS2T_map[newStr] = mNextFreeToken;
+    mArena.insert(mArena.end(), newStr.begin(), newStr.end());
+    mOffsets.push_back(mArena.size());
+
+    // a string we already have points at the new token from now on
+    size_t slot = findSlot(newStr.data(), newStr.length());
+    if (mTable[slot] == 0)
+    {
+        mTableUsed++;
+    }
+    mTable[slot] = mNextFreeToken;
+    if (2 * mTableUsed > mTable.size())
+    {
+        growTable();
+    }
     return mNextFreeToken;
 }
 
-std::string StringCheck::getString(StringToken token)
+StringView StringCheck::getStringView(StringToken token)
 {
     //-----
     // return the string for a given token or spew
     //
-    if(mT2S_map.find(token) != mT2S_map.end()) {
-        return mT2S_map[token];
-    } else {
+    if (token < 2 || token > mNextFreeToken) 
+    {
         throw crispr::exception(__FILE__, 
                                 __LINE__, 
                                 __PRETTY_FUNCTION__,
                                 "Token not stored");
     }
+    StringView view;
+    size_t start = mOffsets[token - 1];
+    view.length = mOffsets[token] - start;
+    view.data = (view.length > 0) ? &(mArena[start]) : "";
+    return view;
+}
 
+std::string StringCheck::getString(StringToken token)
+{
+    StringView view = getStringView(token);
+    return std::string(view.data, view.length);
 }
 
 StringToken StringCheck::getToken(const std::string& queryStr)
@@ -75,7 +161,5 @@ StringToken StringCheck::getToken(const std::string& queryStr)
     //-----
     // return the token or 0
     //
-    if(mS2T_map.end() == mS2T_map.find(queryStr))
-        return 0;
-    return mS2T_map[queryStr];
+    return mTable[findSlot(queryStr.data(), queryStr.length())];
 }
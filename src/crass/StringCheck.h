@@ -7,7 +7,9 @@
 // Give this guy a string, get a token, give this guy a token, get a string
 // All token are unique, all strings aren't!
 // 
-// Basically a glorified map
+// Basically a glorified map. The strings are interned in a single char
+// arena and found again through an open addressing hash table so each
+// string is only stored once
 //
 // --------------------------------------------------------------------
 //  Copyright  2011 Michael Imelfort and Connor Skennerton
@@ -43,31 +45,51 @@
 
 // system includes
 #include <iostream>
-#include <map>
+#include <string>
+#include <vector>
 
 
 // typedefs
 typedef int StringToken;
 
+// A string stored in the StringCheck arena. It points into the arena
+// so it is only good until the next string is added
+typedef struct {
+    const char * data;
+    size_t length;
+} StringView;
+
 class StringCheck 
 {
     public:
-		StringCheck(std::string name) { mNextFreeToken = 1; mName = name;}  
-		StringCheck(void) { mNextFreeToken = 1; mName = "unset";}  
+		StringCheck(std::string name) { init(); mName = name;}  
+		StringCheck(void) { init(); mName = "unset";}  
         ~StringCheck(void) {}  
         
         StringToken addString(std::string newStr);
         std::string getString(StringToken token);
+        StringView getStringView(StringToken token);            // no copy
         StringToken getToken(const std::string& queryStr);
         
         inline void setName(std::string name) { mName = name; }
+        inline size_t size(void) { return mOffsets.size() - 2; }  // number of strings stored
+        inline size_t arenaSize(void) { return mArena.size(); }
 
         // members
         StringToken mNextFreeToken;                            // der
-        std::map<StringToken, std::string> mT2S_map;           // token to string map
-        std::map<std::string, StringToken> mS2T_map;           // string to token map
         
         std::string mName;
+
+    private:
+        void init(void);
+        size_t hashString(const char * str, size_t length);
+        size_t findSlot(const char * str, size_t length);       // the slot holding the string or the empty slot for it
+        void growTable(void);
+
+        std::vector<char> mArena;                               // every string, one after the other in token order
+        std::vector<size_t> mOffsets;                           // string t is [mOffsets[t-1], mOffsets[t]) in the arena
+        std::vector<StringToken> mTable;                        // open addressing hash of string to token, 0 is empty
+        size_t mTableUsed;                                      // filled slots in mTable
 };
 
 #endif //StringCheck_h
@@ -0,0 +1,168 @@
+// File: TaskPool.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Implementation of TaskPool functions
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+// system includes
+#include <string>
+#include <vector>
+#include <exception>
+#include <iostream>
+
+// local includes
+#include "TaskPool.h"
+#include "Exception.h"
+#include "LoggerSimp.h"
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+typedef struct _task_pool_payload {
+    TaskFunction work;
+    void * context;
+    size_t numTasks;
+    size_t nextTask;
+    bool failed;
+    std::string errorMessage;
+#ifdef HAVE_PTHREAD
+    pthread_mutex_t lock;
+#endif
+} TaskPoolPayload;
+
+static bool nextTask(TaskPoolPayload * payload, size_t& task)
+{
+    //-----
+    // hand out the next task, none are given out once something failed
+    //
+#ifdef HAVE_PTHREAD
+    pthread_mutex_lock(&(payload->lock));
+#endif
+    bool more = (! payload->failed && payload->nextTask < payload->numTasks);
+    if (more) 
+    {
+        task = payload->nextTask++;
+    }
+#ifdef HAVE_PTHREAD
+    pthread_mutex_unlock(&(payload->lock));
+#endif
+    return more;
+}
+
+static void * taskWorker(void * arg)
+{
+    //-----
+    // Keep taking tasks until there are none left. Errors are
+    // stored for the calling thread to report
+    //
+    TaskPoolPayload * payload = static_cast<TaskPoolPayload *>(arg);
+    size_t task;
+    while (nextTask(payload, task)) 
+    {
+        std::string error_message;
+        try {
+            payload->work(task, payload->context);
+        } catch (crispr::exception& e) {
+            error_message = e.what();
+        } catch (std::exception& e) {
+            error_message = e.what();
+        }
+        if (! error_message.empty()) 
+        {
+#ifdef HAVE_PTHREAD
+            pthread_mutex_lock(&(payload->lock));
+#endif
+            if (! payload->failed) 
+            {
+                payload->failed = true;
+                payload->errorMessage = error_message;
+            }
+#ifdef HAVE_PTHREAD
+            pthread_mutex_unlock(&(payload->lock));
+#endif
+        }
+    }
+    return NULL;
+}
+
+void runTasks(size_t numTasks, int numThreads, TaskFunction work, void * context)
+{
+    //-----
+    // The calling thread works as well, so numThreads - 1 extra
+    // threads are started. If none can be started it all gets done here
+    //
+    TaskPoolPayload payload;
+    payload.work = work;
+    payload.context = context;
+    payload.numTasks = numTasks;
+    payload.nextTask = 0;
+    payload.failed = false;
+    
+#ifdef HAVE_PTHREAD
+    pthread_mutex_init(&(payload.lock), NULL);
+    
+    std::vector<pthread_t> workers;
+    for (int i = 1; i < numThreads && static_cast<size_t>(i) < numTasks; ++i) 
+    {
+        pthread_t worker;
+        if (pthread_create(&worker, NULL, taskWorker, &payload) != 0) 
+        {
+            logWarn("Could only start "<<i - 1<<" extra threads, the rest of the work will be done by the main thread", 1);
+            break;
+        }
+        workers.push_back(worker);
+    }
+#endif
+    
+    taskWorker(&payload);
+    
+#ifdef HAVE_PTHREAD
+    std::vector<pthread_t>::iterator worker_iter;
+    for (worker_iter = workers.begin(); worker_iter != workers.end(); ++worker_iter) 
+    {
+        pthread_join(*worker_iter, NULL);
+    }
+    pthread_mutex_destroy(&(payload.lock));
+#endif
+    
+    if (payload.failed) 
+    {
+        std::cerr<<payload.errorMessage<<std::endl;
+        throw crispr::exception(__FILE__, 
+                                __LINE__, 
+                                __PRETTY_FUNCTION__,
+                                "Fatal error in threaded task!");
+    }
+}
@@ -0,0 +1,57 @@
+// File: TaskPool.h
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// A small pool of threads for running a list of independent tasks.
+// Each worker takes the next task off the list as soon as it is free,
+// so if the list is ordered biggest first the long tasks start early
+// and the short ones fill in the gaps at the end.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+#ifndef TaskPool_h
+#define TaskPool_h
+
+// system includes
+#include <cstddef>
+
+// local includes
+#include "config.h"
+
+// does the work for one task, may be called from any of the threads
+typedef void (*TaskFunction)(size_t task, void * context);
+
+// run tasks 0 to numTasks-1 on up to numThreads threads and wait for them
+// all to finish. Throws crispr::exception if any of the tasks threw
+void runTasks(size_t numTasks, int numThreads, TaskFunction work, void * context);
+
+#endif //TaskPool_h
@@ -39,6 +39,8 @@
 #include <string>
 #include "ReadHolder.h"
 #include "StringCheck.h"
+#include "ObjectPool.h"
+#include "KmerTable.h"
 
 
 // forward declaration of readholder class
@@ -51,6 +53,9 @@ typedef std::map<std::string, bool> lookupTable;
 typedef std::vector<ReadHolder *> ReadList;
 typedef std::vector<ReadHolder *>::iterator ReadListIterator;
 
+// where the readholders in a ReadMap are made
+typedef ObjectPool<ReadHolder> ReadHolderPool;
+
 // direct repeat as a string and a list of the read objects that contain that direct repeat
 typedef std::map<StringToken, ReadList *> ReadMap;
 typedef std::map<StringToken, ReadList *>::iterator ReadMapIterator;
@@ -64,8 +69,6 @@ typedef std::vector<StringToken>::iterator DR_ClusterIterator;
 typedef std::map<int, DR_Cluster *>::iterator DR_Cluster_MapIterator;
 typedef std::map<int, DR_Cluster *> DR_Cluster_Map;
 
-typedef std::map<int, std::map<std::string, int> * > GroupKmerMap;
-
 typedef std::vector<std::string> Vecstr;
 
 #endif
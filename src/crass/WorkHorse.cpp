@@ -42,6 +42,7 @@
 #include <vector>
 #include <zlib.h>  
 #include <fstream>
+#include <sstream>
 #include <algorithm>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -63,33 +64,14 @@
 #include "StringCheck.h"
 #include "config.h"
 #include "ksw.h"
+#include "TaskPool.h"
+#include "DRLibrary.h"
 
 bool sortLengthDecending( const std::string& a, const std::string& b)
 {
     return a.length() > b.length();
 }
 
-bool sortLengthAssending( const std::string& a, const std::string& b)
-{
-    return a.length() < b.length();
-}
-
-// a should be shorter than b if sorted correctly
-bool includeSubstring(const std::string& a, const std::string& b)
-{
-    if (std::string::npos != b.find(a)) {
-        return true;
-    } else if(std::string::npos != b.find(reverseComplement(a))) {
-        return true;
-    }
-    return false;
-}
-
-bool isNotEmpty(const std::string& a)
-{
-    return !a.empty();
-}
-
 WorkHorse::~WorkHorse()
 {
     //    //-----
@@ -134,7 +116,7 @@ void WorkHorse::clearReadList(ReadList * tmp_list)
     {
         if(*read_iter != NULL)
         {
-            delete *read_iter;
+            mReadPool.destroy(*read_iter);
             *read_iter = NULL;
         }
         read_iter++;
@@ -145,20 +127,21 @@ void WorkHorse::clearReadList(ReadList * tmp_list)
 void WorkHorse::clearReadMap(ReadMap * tmp_map)
 {
     //-----
-    // clear all the reads from the readlist
+    // clear all the reads from the readmap. The readholders are all in
+    // the pool so they go in one go at the end rather than one by one
     //
     ReadMapIterator read_iter = tmp_map->begin();
     while(read_iter != tmp_map->end())
     {
         if (read_iter->second != NULL)
         {
-            clearReadList(read_iter->second);
             delete read_iter->second;
             read_iter->second = NULL;
         }
         read_iter++;
     }
     tmp_map->clear();
+    mReadPool.clear();
 }
 
 int WorkHorse::numOfReads(void)
@@ -185,18 +168,52 @@ int WorkHorse::doWork(Vecstr seqFiles)
     
 
     
-	logInfo("Parsing reads in " << (seqFiles.size()) << " files", 1);
-	if(parseSeqFiles(seqFiles))
-	{
-		logError("FATAL ERROR: parseSeqFiles failed");
-        return 2;
-	}
+    int next_free_GID = 1;
+    CheckpointStage resumed_from = CP_NONE;
+    if (mOpts->resume) 
+    {
+        ScopedPhase phase(mMetrics, "loadCheckpoint");
+        resumed_from = loadCheckpoint(seqFiles, next_free_GID);
+    }
+    
+    if (resumed_from == CP_NONE) 
+    {
+        ScopedPhase phase(mMetrics, "parseSeqFiles");
+        logInfo("Parsing reads in " << (seqFiles.size()) << " files", 1);
+        if(parseSeqFiles(seqFiles, next_free_GID))
+        {
+            logError("FATAL ERROR: parseSeqFiles failed");
+            return 2;
+        }
+        saveCheckpoint(CP_SEARCH, seqFiles, next_free_GID);
+    }
+    
+    if (resumed_from != CP_CLUSTERS) 
+    {
+        ScopedPhase phase(mMetrics, "findConsensusDRs");
+        try {
+            if (findConsensusDRs(next_free_GID))
+            {
+                logError("FATAL ERROR: findConsensusDRs failed");
+                return 2;
+            }
+        } catch(crispr::exception& e) {
+            std::cerr<<e.what()<<std::endl;
+            logError("FATAL ERROR: findConsensusDRs failed");
+            return 2;
+        }
+        saveCheckpoint(CP_CLUSTERS, seqFiles, next_free_GID);
+    }
+    mMetrics.setCounter("groupsClustered", mTrueDRs.size());
 
     // build the spacer end graph
-    if(buildGraph())
     {
-        logError("FATAL ERROR: buildGraph failed");
-        return 3;
+        ScopedPhase phase(mMetrics, "buildGraph");
+        if(buildGraph())
+        {
+            logError("FATAL ERROR: buildGraph failed");
+            return 3;
+        }
     }
 #ifdef SEARCH_SINGLETON
     std::ofstream debug_out;
@@ -244,45 +261,63 @@ int WorkHorse::doWork(Vecstr seqFiles)
 #endif
 	
 	// clean each spacer end graph
-	if(cleanGraph())
-	{
-        logError("FATAL ERROR: cleanGraph failed");
-        return 5;
-	}
+    {
+        ScopedPhase phase(mMetrics, "cleanGraph");
+        if(cleanGraph())
+        {
+            logError("FATAL ERROR: cleanGraph failed");
+            return 5;
+        }
+    }
     
 	// make spacer graphs
-	if(makeSpacerGraphs())
-	{
-        logError("FATAL ERROR: makeSpacerGraphs failed");
-        return 50;
-	}
+    {
+        ScopedPhase phase(mMetrics, "makeSpacerGraphs");
+        if(makeSpacerGraphs())
+        {
+            logError("FATAL ERROR: makeSpacerGraphs failed");
+            return 50;
+        }
+    }
 	
 	// clean spacer graphs
-	if(cleanSpacerGraphs())
-	{
-        logError("FATAL ERROR: cleanSpacerGraphs failed");
-        return 51;
-	}
+    {
+        ScopedPhase phase(mMetrics, "cleanSpacerGraphs");
+        if(cleanSpacerGraphs())
+        {
+            logError("FATAL ERROR: cleanSpacerGraphs failed");
+            return 51;
+        }
+    }
 	
 	// make contigs
-	if(splitIntoContigs())
-	{
-        logError("FATAL ERROR: splitIntoContigs failed");
-        return 6;
-	}
+    {
+        ScopedPhase phase(mMetrics, "splitIntoContigs");
+        if(splitIntoContigs())
+        {
+            logError("FATAL ERROR: splitIntoContigs failed");
+            return 6;
+        }
+    }
     // call flanking regions
-    if (generateFlankers()) {
-        logError("FATAL ERROR: generateFlankers failed");
-        return 70;
+    {
+        ScopedPhase phase(mMetrics, "generateFlankers");
+        if (generateFlankers()) {
+            logError("FATAL ERROR: generateFlankers failed");
+            return 70;
+        }
     }
     
     //remove NodeManagers with low numbers of spacers
     // and where the standard deviation of the spacer length 
     // is too high
-    if (removeLowConfidenceNodeManagers())
     {
-        logError("FATAL ERROR: removeLowSpacerNodeManagers failed");
-        return 7;
+        ScopedPhase phase(mMetrics, "removeLowConfidenceNodeManagers");
+        if (removeLowConfidenceNodeManagers())
+        {
+            logError("FATAL ERROR: removeLowSpacerNodeManagers failed");
+            return 7;
+        }
     }
 	
     // print the reads to a file if requested
@@ -312,13 +347,17 @@ int WorkHorse::doWork(Vecstr seqFiles)
 //        return 11;
 //	}
 	
-	outputResults();
+    countGraphs();
+    {
+        ScopedPhase phase(mMetrics, "outputResults");
+        outputResults();
+    }
 	
     logInfo("all done!", 1);
 	return 0;
 }
 
-int WorkHorse::parseSeqFiles(Vecstr seqFiles)
+int WorkHorse::parseSeqFiles(Vecstr seqFiles, int& nextFreeGID)
 {
 	//-----
 	// Load data from files and search for DRs
@@ -331,8 +370,63 @@ int WorkHorse::parseSeqFiles(Vecstr seqFiles)
     // the sequence of whole spacers and their unique ID
     lookupTable reads_found;
 
+    // in single pass mode the reads without a repeat are kept here so
+    // that the singleton finder doesn't need to read the input again
+    ReadSpill spill;
+    ReadSpill * spill_ptr = NULL;
+    unsigned long long input_bytes = 0;
+    if (mOpts->singlePass)
+    {
+        try {
+            spill.open(mOpts->output_fastq + PACKAGE_NAME + "." + mTimeStamp + ".spill");
+        } catch (crispr::exception& e) {
+            std::cerr<<e.what()<<std::endl;
+            return 1;
+        }
+        spill_ptr = &spill;
+    }
+
+    // the repeats found in earlier runs, reads with one of them are
+    // recruited during the search
+    DRLibrary dr_library;
+    DRLibrary * library_ptr = NULL;
+    if (! mOpts->drLibrary.empty())
+    {
+        try {
+            if (dr_library.open(mOpts->drLibrary))
+            {
+                std::cout<<"["<<PACKAGE_NAME<<"_drLibrary]: "<<dr_library.size()<<" known patterns in "<<mOpts->drLibrary<<std::endl;
+                library_ptr = &dr_library;
+            }
+            else
+            {
+                std::cout<<"["<<PACKAGE_NAME<<"_drLibrary]: "<<mOpts->drLibrary<<" will be made from this run"<<std::endl;
+            }
+        } catch (crispr::exception& e) {
+            std::cerr<<e.what()<<std::endl;
+            return 1;
+        }
+    }
+
+    // repeats from the reference databases, reads with one of these
+    // don't need to be searched
+    DRLibrary known_repeats;
+    DRLibrary * known_repeats_ptr = NULL;
+    if (! mOpts->knownRepeats.empty())
+    {
+        try {
+            known_repeats.addFasta(mOpts->knownRepeats);
+        } catch (crispr::exception& e) {
+            std::cerr<<e.what()<<std::endl;
+            return 1;
+        }
+        std::cout<<"["<<PACKAGE_NAME<<"_knownRepeats]: "<<known_repeats.size()<<" patterns, with reverse complements, in "<<mOpts->knownRepeats<<std::endl;
+        known_repeats_ptr = &known_repeats;
+    }
+
     time_t start_time;
     time(&start_time);
+    unsigned long reads_searched = readsSearched();
     while(seq_iter != seqFiles.end())
     {
         logInfo("Parsing file: " << *seq_iter, 1);
@@ -340,10 +434,14 @@ int WorkHorse::parseSeqFiles(Vecstr seqFiles)
             int max_len = searchFile(seq_iter->c_str(), 
                                             *mOpts, 
                                             &mReads, 
+                                            &mReadPool, 
                                             &mStringCheck, 
                                             patterns_lookup, 
                                             reads_found,
-                                            start_time);
+                                            start_time,
+                                            spill_ptr,
+                                            library_ptr,
+                                            known_repeats_ptr);
             
             mMaxReadLength = (max_len > mMaxReadLength) ? max_len : mMaxReadLength;
             logInfo("Finished file: " << *seq_iter, 1);
@@ -360,16 +458,44 @@ int WorkHorse::parseSeqFiles(Vecstr seqFiles)
         }
         logInfo("Finished file: " << *seq_iter, 1);
         
+        struct stat file_stats;
+        if (stat(seq_iter->c_str(), &file_stats) == 0)
+        {
+            input_bytes += file_stats.st_size;
+        }
         seq_iter++;
     }
     // add in a new line so the looger won't overlap itself
     std::cout<<std::endl;
 
-    GroupKmerMap group_kmer_counts_map;
-    int next_free_GID = 1;
-    Vecstr * non_redundant_set = createNonRedundantSet(group_kmer_counts_map, next_free_GID);
+    int reads_recruited = numOfReads();
+    mMetrics.setCounter("readsScanned", readsSearched() - reads_searched);
+    mMetrics.setCounter("readsRecruitedBySearch", reads_recruited);
+    mMetrics.setCounter("drVariantsFromSearch", mReads.size());
+
+    Vecstr * non_redundant_set = createNonRedundantSet(nextFreeGID);
+    mMetrics.setCounter("nonRedundantPatterns", non_redundant_set->size());
     logInfo("Number of reads found so far: "<<this->numOfReads(), 2);
 
+    if (! mOpts->drLibrary.empty())
+    {
+        //-----
+        // Not being able to update the library only means that later
+        // runs won't know about these repeats, so it isn't fatal
+        //
+        try {
+            size_t known_patterns = dr_library.size();
+            if (dr_library.add(*non_redundant_set))
+            {
+                dr_library.save(mOpts->drLibrary);
+                std::cout<<"["<<PACKAGE_NAME<<"_drLibrary]: Added "<<(dr_library.size() - known_patterns)<<" patterns to "<<mOpts->drLibrary<<std::endl;
+            }
+        } catch (crispr::exception& e) {
+            std::cerr<<PACKAGE_NAME<<" [WARNING]: Could not update the direct repeat library"<<std::endl;
+            std::cerr<<e.what()<<std::endl;
+        }
+    }
+
     if (non_redundant_set->size() > 0) 
     {
         std::cout<<"["<<PACKAGE_NAME<<"_clusterCore]: " << non_redundant_set->size() << " non-redundant patterns."<<std::endl;
@@ -378,12 +504,30 @@ int WorkHorse::parseSeqFiles(Vecstr seqFiles)
 
 
         time(&start_time);
+        reads_searched = readsScannedForSingletons();
+        if (spill_ptr != NULL)
+        {
+            logInfo("Scanning " << spill.numReads() << " spilled reads", 1);
+            try {
+                findSingletons(spill_ptr, *mOpts, non_redundant_set, reads_found, &mReads, &mReadPool, &mStringCheck, start_time);
+            } catch (crispr::exception& e) {
+                std::cerr<<e.what()<<std::endl;
+                delete non_redundant_set;
+                return 1;
+            }
+            
+            // the spill file is read instead of the input, report the difference
+            long long bytes_saved = static_cast<long long>(input_bytes) - static_cast<long long>(spill.bytesWritten());
+            std::cout<<std::endl<<"["<<PACKAGE_NAME<<"_singletonFinder]: Read "<<spill.bytesWritten()<<" spilled bytes instead of "<<input_bytes<<" input bytes ("<<bytes_saved<<" saved)";
+            logInfo("Single pass: spilled " << spill.numReads() << " reads in " << spill.bytesWritten() << " bytes, input was " << input_bytes << " bytes, saved " << bytes_saved << " bytes", 1);
+            seq_iter = seqFiles.end();
+        }
         while (seq_iter != seqFiles.end()) {
             
             logInfo("Parsing file: " << *seq_iter, 1);
             
             try {
-                findSingletons(seq_iter->c_str(), *mOpts, non_redundant_set, reads_found, &mReads, &mStringCheck, start_time);
+                findSingletons(seq_iter->c_str(), *mOpts, non_redundant_set, reads_found, &mReads, &mReadPool, &mStringCheck, start_time);
             } catch (crispr::exception& e) {
                 std::cerr<<e.what()<<std::endl;
                 delete non_redundant_set;
@@ -391,24 +535,17 @@ int WorkHorse::parseSeqFiles(Vecstr seqFiles)
             }
             seq_iter++;
         }
+        mMetrics.setCounter("readsScannedForSingletons", readsScannedForSingletons() - reads_searched);
     }
     // add in a new line so the ouptut won't overlap itself
     std::cout<<std::endl;
     delete non_redundant_set;
+    spill.close();
+    mMetrics.setCounter("readsRecruitedBySingletons", numOfReads() - reads_recruited);
+    mMetrics.setCounter("drVariants", mReads.size());
     std::cout<<"["<<PACKAGE_NAME<<"_patternFinder]: "<<"Found "<<numOfReads()<<" reads"<<std::endl;
     logInfo("Searching complete. " << mReads.size()<<" direct repeat variants have been found", 1);
     logInfo("Number of reads found so far: "<<this->numOfReads(), 2);
-
-    try {
-        if (findConsensusDRs(group_kmer_counts_map, next_free_GID))
-        {
-            logError("Wierd stuff happend when trying to get the 'true' direct repeat");            
-            return 1;
-        }
-    } catch(crispr::exception& e) {
-        std::cerr<<e.what()<<std::endl;
-        return 1;
-    }
     
     return 0;
 }
@@ -451,16 +588,108 @@ void WorkHorse::combineGroupsWithIdenticalDRs()
     }
 }
 
+typedef struct {
+    GroupStage stage;
+    std::vector<GroupTask> * tasks;
+    std::vector<int> * results;                     // one per task so the threads never share a slot
+} GroupStagePayload;
+
+static bool biggestGroupFirst(const GroupTask& a, const GroupTask& b)
+{
+    if (a.numReads != b.numReads) 
+    {
+        return a.numReads > b.numReads;
+    }
+    return a.gid < b.gid;
+}
+
+static void groupStageWorker(size_t task, void * context)
+{
+    //-----
+    // Do one stage for one group. Nothing here touches anything
+    // outside of the group's own nodemanager and reads
+    //
+    GroupStagePayload * payload = static_cast<GroupStagePayload *>(context);
+    GroupTask& group = (*(payload->tasks))[task];
+    int result = 0;
+    switch (payload->stage) 
+    {
+        case GS_ADD_READS:
+        {
+            std::vector<ReadList *>::iterator list_iter;
+            for (list_iter = group.reads.begin(); list_iter != group.reads.end(); ++list_iter) 
+            {
+                ReadListIterator read_iter = (*list_iter)->begin();
+                while (read_iter != (*list_iter)->end()) 
+                {
+                    if(*read_iter == NULL) {
+                        logError("Read is set to null");
+                    }
+                    group.manager->addReadHolder(*read_iter);
+                    read_iter++;
+                }
+            }
+            break;
+        }
+        case GS_CLEAN_GRAPH:
+            result = group.manager->cleanGraph();
+            break;
+        case GS_MAKE_SPACER_GRAPH:
+            logInfo("Making spacer graph for DR: " << group.trueDR, 1);
+            result = group.manager->buildSpacerGraph();
+            break;
+        case GS_CLEAN_SPACER_GRAPH:
+            logInfo("Cleaning spacer graph for DR: " << group.trueDR, 1);
+            result = group.manager->cleanSpacerGraph();
+            break;
+        case GS_SPLIT_CONTIGS:
+            logInfo("Making spacer contigs for DR: " << group.trueDR, 1);
+            result = group.manager->splitIntoContigs();
+            break;
+        case GS_FLANKERS:
+            logInfo("Assigning flankers for NodeManager "<<group.gid, 3);
+            group.manager->generateFlankers();
+            break;
+    }
+    (*(payload->results))[task] = result;
+}
+
+int WorkHorse::runGroupStage(GroupStage stage)
+{
+    //-----
+    // Run one stage over all the groups with a pool of threads. The
+    // groups are handed out biggest first, the order they finish in
+    // doesn't matter as the results are written out later by GID
+    //
+    std::vector<int> results(mGroupTasks.size(), 0);
+    GroupStagePayload payload;
+    payload.stage = stage;
+    payload.tasks = &mGroupTasks;
+    payload.results = &results;
+    
+    runTasks(mGroupTasks.size(), mOpts->numThreads, groupStageWorker, &payload);
+    
+    std::vector<int>::iterator result_iter;
+    for (result_iter = results.begin(); result_iter != results.end(); ++result_iter) 
+    {
+        if (*result_iter) 
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 int WorkHorse::buildGraph(void)
 {
 	//-----
 	// Load the spacers into a graph
 	//
-    // go through the DR2GID_map and make all reads in each group into nodes
-    
+    // go through the DR2GID_map and make a nodemanager for each group. The
+    // maps can't be changed from the threads so the managers are made here
+    // and the reads are added to them in parallel afterwards
+    mGroupTasks.clear();
     DR_Cluster_MapIterator drg_iter = mDR2GIDMap.begin();
-    //std::cout<<'['<<PACKAGE_NAME<<"_graphBuilder]: "<<mTrueDRs.size()<<" putative CRISPRs found!"<<std::endl;
-    //MI std::cout<<'['<<PACKAGE_NAME<<"_graphBuilder]: "<<std::flush;
     while(drg_iter != mDR2GIDMap.end())
     {
         if(NULL != drg_iter->second)
@@ -468,41 +697,69 @@ int WorkHorse::buildGraph(void)
 #ifdef DEBUG
             logInfo("Creating NodeManager "<<drg_iter->first, 6);
 #endif
-            //MI std::cout<<'['<<drg_iter->first<<','<<mTrueDRs[drg_iter->first]<<std::flush;
-            mDRs[mTrueDRs[drg_iter->first]] = new NodeManager(mTrueDRs[drg_iter->first], mOpts);
-            //MI std::cout<<'.'<<std::flush;
-            DR_ClusterIterator drc_iter = (drg_iter->second)->begin();
-            while(drc_iter != (drg_iter->second)->end())
+            GroupTask group;
+            group.gid = drg_iter->first;
+            group.trueDR = mTrueDRs[drg_iter->first];
+            group.manager = new NodeManager(group.trueDR, mOpts);
+            group.numReads = 0;
+            
+            // two groups with the same true DR, the last one wins
+            NodeManager *& dr_manager = mDRs[group.trueDR];
+            if (NULL != dr_manager) 
             {
-                // go through each read
-            	//MI std::cout<<'|'<<std::flush;
-                ReadListIterator read_iter = mReads[*drc_iter]->begin();
-                while (read_iter != mReads[*drc_iter]->end()) 
+                std::vector<GroupTask>::iterator task_iter = mGroupTasks.begin();
+                while (task_iter != mGroupTasks.end()) 
                 {
-                    if(*read_iter == NULL) {
-                        logError("Read is set to null");
+                    if (task_iter->manager == dr_manager) 
+                    {
+                        task_iter = mGroupTasks.erase(task_iter);
+                    } 
+                    else 
+                    {
+                        task_iter++;
                     }
-                    //MI std::cout<<'.'<<std::flush;
+                }
+                delete dr_manager;
+            }
+            dr_manager = group.manager;
+            
+            DR_ClusterIterator drc_iter = (drg_iter->second)->begin();
+            while(drc_iter != (drg_iter->second)->end())
+            {
+                ReadList * dr_reads = mReads[*drc_iter];
+                group.reads.push_back(dr_reads);
+                group.numReads += dr_reads->size();
 #ifdef SEARCH_SINGLETON
+                ReadListIterator read_iter = dr_reads->begin();
+                while (read_iter != dr_reads->end()) 
+                {
                     SearchCheckerList::iterator debug_iter = debugger->find((*read_iter)->getHeader());
                     if (debug_iter != debugger->end()) {
                         //found one of our interesting reads
                         // add in the true DR
-                        debug_iter->second.truedr(mTrueDRs[drg_iter->first]);
+                        debug_iter->second.truedr(group.trueDR);
                         debug_iter->second.gid(drg_iter->first);
                     }
-#endif
-                    mDRs[mTrueDRs[drg_iter->first]]->addReadHolder(*read_iter);
                     read_iter++;
                 }
+#endif
                 drc_iter++;
             }
-            //MI std::cout<<"],"<<std::flush;
+            mGroupTasks.push_back(group);
         }
         drg_iter++;
     }
-    //MI std::cout<<std::endl;
-    return 0;
+    
+    std::sort(mGroupTasks.begin(), mGroupTasks.end(), biggestGroupFirst);
+    int result = runGroupStage(GS_ADD_READS);
+    
+    // the reads now belong to the managers, no need to keep the lists around
+    std::vector<GroupTask>::iterator task_iter;
+    for (task_iter = mGroupTasks.begin(); task_iter != mGroupTasks.end(); ++task_iter) 
+    {
+        task_iter->reads.clear();
+    }
+    return result;
 }
 
 int WorkHorse::cleanGraph(void)
@@ -511,40 +768,15 @@ int WorkHorse::cleanGraph(void)
 	// Wrapper for graph cleaning
 	//
 	logInfo("Cleaning graphs", 1);
-	DR_Cluster_MapIterator drg_iter = mDR2GIDMap.begin();
-	while(drg_iter != mDR2GIDMap.end())
-	{
-		if(NULL != drg_iter->second)
-		{            
-#ifdef DEBUG
-            if (NULL == mDRs[mTrueDRs[drg_iter->first]])
-            {
-                logWarn("Before Clean Graph: NodeManager "<<drg_iter->first<<" is NULL",6);
-            }
-            else
-            {
-#endif
-                if((mDRs[mTrueDRs[drg_iter->first]])->cleanGraph())
-                {
-                    return 1;
-                }
-#ifdef DEBUG
-            }
-            if (NULL == mDRs[mTrueDRs[drg_iter->first]])
-            {
-                logWarn("After Clean Graph: NodeManager "<<drg_iter->first<<" is NULL",6);
-            }
-#endif
-		}
-		drg_iter++;
-	}
-	return 0;
+	return runGroupStage(GS_CLEAN_GRAPH);
 }
 
 int WorkHorse::removeLowConfidenceNodeManagers(void)
 {
     logInfo("Removing CRISPRs with low numbers of spacers", 1);
 	int counter = 0;
+    // some of the managers go below, the per group stages are all done
+    mGroupTasks.clear();
     DR_Cluster_MapIterator drg_iter = mDR2GIDMap.begin();
 	while(drg_iter != mDR2GIDMap.end())
 	{
@@ -572,10 +804,33 @@ int WorkHorse::removeLowConfidenceNodeManagers(void)
 	return 0;
 }
 
+void WorkHorse::countGraphs(void)
+{
+    //-----
+    // The size of what is left once the low confidence groups are gone
+    //
+    long long groups = 0, nodes = 0, spacers = 0, contigs = 0;
+    DR_ListIterator dr_iter;
+    for (dr_iter = mDRs.begin(); dr_iter != mDRs.end(); ++dr_iter)
+    {
+        if (NULL != dr_iter->second)
+        {
+            groups++;
+            nodes += dr_iter->second->numNodes();
+            spacers += dr_iter->second->numSpacers();
+            contigs += dr_iter->second->numContigs();
+        }
+    }
+    mMetrics.setCounter("groups", groups);
+    mMetrics.setCounter("nodes", nodes);
+    mMetrics.setCounter("spacers", spacers);
+    mMetrics.setCounter("contigs", contigs);
+}
+
 //**************************************
 // Functions used to cluster DRs into groups and identify the "true" DR
 //**************************************
-int WorkHorse::findConsensusDRs(GroupKmerMap& groupKmerCountsMap, int& nextFreeGID)
+int WorkHorse::findConsensusDRs(int& nextFreeGID)
 {
     //-----
     // Cluster potential DRs and work out their true sequences
@@ -584,68 +839,34 @@ int WorkHorse::findConsensusDRs(GroupKmerMap& groupKmerCountsMap, int& nextFreeG
 
     logInfo("Reducing list of potential DRs (2): Cluster refinement and true DR finding", 1);
     
-    // go through all the counts for each group
-    GroupKmerMap::iterator group_count_iter; 
-    for(group_count_iter =  groupKmerCountsMap.begin(); 
-        group_count_iter != groupKmerCountsMap.end(); 
-        group_count_iter++)
+    // go through the groups made by the initial clustering. Groups are
+    // added and removed as we go so take a copy of the IDs first
+    std::vector<int> initial_groups;
+    DR_Cluster_MapIterator drg_iter;
+    for (drg_iter = mDR2GIDMap.begin(); drg_iter != mDR2GIDMap.end(); ++drg_iter) 
+    {
+        initial_groups.push_back(drg_iter->first);
+    }
+    std::vector<int>::iterator group_iter; 
+    for(group_iter = initial_groups.begin(); 
+        group_iter != initial_groups.end(); 
+        group_iter++)
     {
-        if(NULL == mDR2GIDMap[group_count_iter->first])
+        if(NULL == mDR2GIDMap[*group_iter])
         {
             continue;
         }
 #ifdef DEBUG
-        logInfo(__FILE__ <<":"<<__LINE__<<" checking for null "<< mDR2GIDMap[group_count_iter->first], 6)
+        logInfo(__FILE__ <<":"<<__LINE__<<" checking for null "<< mDR2GIDMap[*group_iter], 6)
 #endif
-        parseGroupedDRs(group_count_iter->first, &nextFreeGID);
+        parseGroupedDRs(*group_iter, &nextFreeGID);
         combineGroupsWithIdenticalDRs();
-        // delete the kmer count lists cause we're finsihed with them now
-        if(NULL != group_count_iter->second)
-        {
-            delete group_count_iter->second;
-            group_count_iter->second = NULL;
-        }
     }
     
     return 0;
 }
-void WorkHorse::removeRedundantRepeats(Vecstr& repeatVector)
-{
-    // given a vector of repeat sequences, will order the vector based on repeat
-    // length and then remove longer repeats if there is a shorter one that is
-    // a perfect substring
-    std::sort(repeatVector.begin(), repeatVector.end(), sortLengthAssending);
-    Vecstr::iterator iter;
-
-    // go though all of the patterns and determine which are substrings
-    // clear the string if it is
-    for (iter = repeatVector.begin(); iter != repeatVector.end(); iter++) {
-        if (iter->empty()) {
-            continue;
-        }
-        Vecstr::iterator iter2;
-        for (iter2 = iter+1; iter2 != repeatVector.end(); iter2++) {
-            if (iter2->empty()) {
-                continue;
-            }
-            //pass both itererators into the comparison function
-            if (includeSubstring(*iter, *iter2)) {
-                iter2->clear();
-            }
-        }
-
-    }
-
-    // ok so now partition the vector so that all the empties are at one end
-    // will return an iterator postion to the first position where the string
-    // is empty
-    Vecstr::iterator empty_iter = std::partition(repeatVector.begin(), repeatVector.end(), isNotEmpty);
-    // remove all the empties from the list
-    repeatVector.erase(empty_iter, repeatVector.end());
-}
 
-
-Vecstr * WorkHorse::createNonRedundantSet(GroupKmerMap& groupKmerCountsMap, int& nextFreeGID)
+Vecstr * WorkHorse::createNonRedundantSet(int& nextFreeGID)
 {
     // cluster the direct repeats then remove the redundant ones
     // creates a vector in dynamic memory, so don't forget to delete 
@@ -653,14 +874,14 @@ Vecstr * WorkHorse::createNonRedundantSet(GroupKmerMap& groupKmerCountsMap, int&
     // Cluster potential DRs and work out their true sequences
     // make the node managers while we're at it!
     //
-    std::map<std::string, int> k2GID_map;
+    KmerTable k2GID_map(mReads.size() * CRASS_DEF_KMER_SIZE);
     logInfo("Reducing list of potential DRs (1): Initial clustering", 1);
     logInfo("Reticulating splines...", 1);    
     // go through all of the read holder objects
     ReadMapIterator read_map_iter = mReads.begin();
     while (read_map_iter != mReads.end()) 
     {
-        clusterDRReads(read_map_iter->first, &nextFreeGID, &k2GID_map, &groupKmerCountsMap);
+        clusterDRReads(read_map_iter->first, &nextFreeGID, &k2GID_map);
         ++read_map_iter;
     }
     std::cout<<'['<<PACKAGE_NAME<<"_clusterCore]: "<<mReads.size()<<" variants mapped to "<<mDR2GIDMap.size()<<" clusters"<<std::endl;
@@ -761,18 +982,10 @@ bool WorkHorse::populateCoverageArray(int GID, Aligner& drAligner)
     //++++++++++++++++++++++++++++++++++++++++++++++++
     // now go thru all the other DRs in this group and add them into
     // the consensus array
-    DR_ClusterIterator dr_iter;// = (mDR2GIDMap[GID])->begin();
-    for (dr_iter = (mDR2GIDMap[GID])->begin(); dr_iter != (mDR2GIDMap[GID])->end(); dr_iter++) 
-    {
-        // we've already done the master DR
-        if(drAligner.getMasterDrToken() == *dr_iter)
-        {
-            continue;
-        }
-        drAligner.alignSlave(*dr_iter);
-    }
+    drAligner.alignSlaves(*(mDR2GIDMap[GID]), mOpts->numThreads);
+    
     // kill the unfounded ones
-    dr_iter = (mDR2GIDMap[GID])->begin();
+    DR_ClusterIterator dr_iter = (mDR2GIDMap[GID])->begin();
     while (dr_iter != (mDR2GIDMap[GID])->end()) 
     {
     	if(drAligner.offsetFind(*dr_iter) != drAligner.offsetEnd())
@@ -1403,17 +1616,13 @@ int WorkHorse::numberOfReadsInGroup(DR_Cluster * currentGroup)
 
 bool WorkHorse::clusterDRReads(StringToken DRToken, 
                                int * nextFreeGID, 
-                               std::map<std::string, int> * k2GIDMap, 
-                               GroupKmerMap * groupKmerCountsMap)
+                               KmerTable * k2GIDMap)
 {
     //-----
     // hash a DR!
     //
 
     std::string DR = mStringCheck.getString(DRToken);
-    int str_len = (int)DR.length();
-    int off = str_len - CRASS_DEF_KMER_SIZE;
-    int num_mers = off + 1;
     
     //***************************************
     //***************************************
@@ -1430,163 +1639,62 @@ bool WorkHorse::clusterDRReads(StringToken DRToken,
     //***************************************
     //***************************************
     
-    // STOLED FROM SaSSY!!!!
-    // First we cut kmers from the sequence then we use these to
-    // determine overlaps, finally we make edges
-    //
-    // When we cut kmers from a read it is like this...
-    //
-    // XXXXXXXXXXXXXXXXXXXXXXXXXXXXXX
-    // ------------------------------
-    // XXXXXXXXXXXXXXXXXXXXXXXXXX
-    // XXXXXXXXXXXXXXXXXXXXXXXXXX
-    // XXXXXXXXXXXXXXXXXXXXXXXXXX
-    // XXXXXXXXXXXXXXXXXXXXXXXXXX
-    // XXXXXXXXXXXXXXXXXXXXXXXXXX
-    //
-    // so we break the job into three parts
-    //
-    // XXXX|XXXXXXXXXXXXXXXXXXXXXX|XXXX
-    // ----|----------------------|----
-    // XXXX|XXXXXXXXXXXXXXXXXXXXXX|
-    //  XXX|XXXXXXXXXXXXXXXXXXXXXX|X
-    //   XX|XXXXXXXXXXXXXXXXXXXXXX|XX
-    //    X|XXXXXXXXXXXXXXXXXXXXXX|XXX
-    //     |XXXXXXXXXXXXXXXXXXXXXX|XXXX
-    //
-    // the first and last part may be a little slow but the middle part can fly through...
-    //
-    
-    // make a 2d array for the kmers!
-	char ** kmers = NULL;
-	int * kmer_offsets = NULL;
-	try {
-		kmers = new char*[num_mers];
-	} catch(std::exception& e) {
-		std::cerr<<"Attempting to alloc "<<num_mers<<std::endl;
-		throw crispr::exception(__FILE__, 
-		                        __LINE__, 
-		                        __PRETTY_FUNCTION__, 
-		                        e.what());
-	}
-	try {
-		for(int i = 0; i < num_mers; i++)
-		{
-			kmers[i] = new char [CRASS_DEF_KMER_SIZE+1];
-		}
-// use these offsets when we cut kmers, they are a component of the algorithm
-		kmer_offsets = new int[num_mers];              
-		for(int i = 0; i < num_mers; i++)
-		{
-			kmer_offsets[i] = i * -1; // Starts at [0, -1, -2, -3, -4, ...]
-		}
-	} catch(std::exception& e) {
-		std::cerr<<"Attempting to alloc "<<CRASS_DEF_KMER_SIZE+1<<std::endl;
-		throw crispr::exception(__FILE__, 
-		                        __LINE__, 
-		                        __PRETTY_FUNCTION__, 
-		                        e.what());
-	}
-    int pos_counter = 0;
-    
-    // a slow-ish first part
-    while(pos_counter < CRASS_DEF_KMER_SIZE)
-    {
-        for(int j = 0; j < num_mers; j++)
-        {
-            if(pos_counter >= j)
-            {
-                kmers[j][kmer_offsets[j]] = DR[pos_counter];
-            }
-            kmer_offsets[j]++;
-        }
-        pos_counter++;
-    }
-    
-    // this is the fast part of the loop
-    while(pos_counter < off)
-    {
-        for(int j = 0; j < num_mers; j++)
-        {
-            if(kmer_offsets[j] >= 0 && kmer_offsets[j] < CRASS_DEF_KMER_SIZE)
-            {
-                kmers[j][kmer_offsets[j]] = DR[pos_counter];
-            }
-            kmer_offsets[j]++;
-        }
-        pos_counter++;
-    }
-    
-    // an even slower ending
-    while(pos_counter < str_len)
-    {
-        for(int j = 0; j < num_mers; j++)
-        {
-            if(kmer_offsets[j] < CRASS_DEF_KMER_SIZE)
-            {
-                kmers[j][kmer_offsets[j]] = DR[pos_counter];
-            }
-            kmer_offsets[j]++;
-        }
-        pos_counter++;
-    }
+    // cut the kmers as 2-bit codes, in their laurenized form
+    std::vector<unsigned int> kmers;
+    Vecstr odd_kmers;
+    packLaurenizedKmers(DR, CRASS_DEF_KMER_SIZE, kmers, odd_kmers);
     
     //
     // Now the fun stuff begins:
     //
-    Vecstr homeless_kmers;
+    std::vector<unsigned int> homeless_kmers;
+    Vecstr homeless_odd_kmers;
     std::map<int, int> group_count;
-    std::map<std::string, int> local_kmer_CountMap;
     
     int group = 0;
-    for(int i = 0; i < num_mers; ++i)
+    Vecstr::iterator odd_iter = odd_kmers.begin();
+    std::vector<unsigned int>::iterator kmer_iter;
+    for(kmer_iter = kmers.begin(); kmer_iter != kmers.end(); ++kmer_iter)
     {
-        // make it a string!
-        kmers[i][CRASS_DEF_KMER_SIZE] = '\0';
-        
-        std::string tmp_str(kmers[i]);
-        tmp_str = laurenize(tmp_str);
-        
-        // see if this guy has been counted LOCALLY
-        // use this list when we go to select N most abundant kmers
-        if(local_kmer_CountMap.find(tmp_str) == local_kmer_CountMap.end())
+        // see if we've seen this kmer before GLOBALLY
+        int * kmer_group;
+        if(KT_EMPTY_SLOT != *kmer_iter)
         {
-        	// first time this kmer has been seen in this read
-            local_kmer_CountMap[tmp_str] = 1;
+            kmer_group = k2GIDMap->find(*kmer_iter);
+            if(NULL == kmer_group)
+            {
+                // first time we seen this one GLOBALLY
+                homeless_kmers.push_back(*kmer_iter);
+            }
         }
         else
         {
-            local_kmer_CountMap[tmp_str]++;
+            kmer_group = k2GIDMap->find(*odd_iter);
+            if(NULL == kmer_group)
+            {
+                homeless_odd_kmers.push_back(*odd_iter);
+            }
+            ++odd_iter;
         }
         
-        // see if we've seen this kmer before GLOBALLY
-        std::map<std::string, int>::iterator k2g_iter = k2GIDMap->find(tmp_str);
-        if(k2g_iter == k2GIDMap->end())
-        {
-            // first time we seen this one GLOBALLY
-            homeless_kmers.push_back(tmp_str);
-        }
-        else
+        // we've seen this guy before.
+        // only do this if our guy doesn't belong to a group yet
+        if(NULL != kmer_group && 0 == group)
         {
-        	// we've seen this guy before.
-            // only do this if our guy doesn't belong to a group yet
-            if(0 == group)
+            // this kmer belongs to a group -> increment the local group count
+            std::map<int, int>::iterator this_group_iter = group_count.find(*kmer_group);
+            if(this_group_iter == group_count.end())
             {
-                // this kmer belongs to a group -> increment the local group count
-                std::map<int, int>::iterator this_group_iter = group_count.find(k2g_iter->second);
-                if(this_group_iter == group_count.end())
+                group_count[*kmer_group] = 1;
+            }
+            else
+            {
+                this_group_iter->second++;
+                // have we seen this guy enought times?
+                if(min_clust_membership_count <= this_group_iter->second)
                 {
-                    group_count[k2g_iter->second] = 1;
-                }
-                else
-                {
-                    group_count[k2g_iter->second]++;
-                    // have we seen this guy enought times?
-                    if(min_clust_membership_count <= group_count[k2g_iter->second])
-                    {
-                        // we have found a group for this mofo!
-                        group = k2g_iter->second;
-                    }
+                    // we have found a group for this mofo!
+                    group = *kmer_group;
                 }
             }
         }
@@ -1600,42 +1708,141 @@ bool WorkHorse::clusterDRReads(StringToken DRToken,
         // we need to make a new entry in the group map
         mGroupMap[group] = true;
         mDR2GIDMap[group] = new DR_Cluster;
-        
-        // we need a new kmer counter for this group
-        (*groupKmerCountsMap)[group] = new std::map<std::string, int>;
     }
     
     // we need to record the group for this mofo!
     mDR2GIDMap[group]->push_back(DRToken);
     
     // we need to assign all homeless kmers to the group!
-    Vecstr::iterator homeless_iter = homeless_kmers.begin();
-    while(homeless_iter != homeless_kmers.end())
-    {
-        (*k2GIDMap)[*homeless_iter] = group;
-        homeless_iter++;
-    }
-    
-    // we need to fix up the group counts
-    std::map<std::string, int>::iterator local_count_iter = local_kmer_CountMap.begin();
-    while(local_count_iter != local_kmer_CountMap.end())
+    for(kmer_iter = homeless_kmers.begin(); kmer_iter != homeless_kmers.end(); ++kmer_iter)
     {
-        (*(*groupKmerCountsMap)[group])[local_count_iter->first] += local_count_iter->second;
-        local_count_iter++;
+        (*k2GIDMap)[*kmer_iter] = group;
     }
-    
-    // clean up
-    delete [] kmer_offsets;
-    for(int i = 0; i < num_mers; i++)
+    for(odd_iter = homeless_odd_kmers.begin(); odd_iter != homeless_odd_kmers.end(); ++odd_iter)
     {
-        delete [] kmers[i];
+        (*k2GIDMap)[*odd_iter] = group;
     }
-    delete [] kmers;
     
     return true;
     
 }
 
+//**************************************
+// checkpoints
+//**************************************
+std::string WorkHorse::checkpointFileName(CheckpointStage stage)
+{
+    // no timestamp, a later run has to be able to find it
+    return mOpts->output_fastq + PACKAGE_NAME + ((stage == CP_CLUSTERS) ? CRASS_DEF_CLUSTER_CHECKPOINT_EXT : CRASS_DEF_SEARCH_CHECKPOINT_EXT);
+}
+
+std::string WorkHorse::checkpointFingerprint(Vecstr& seqFiles)
+{
+    //-----
+    // The input files and every option that the search and the
+    // clustering use. The options that only matter once the graphs
+    // are being made, like covCutoff, can change between a run and
+    // the run that resumes it
+    //
+    std::stringstream ss;
+    Vecstr::iterator seq_iter;
+    for (seq_iter = seqFiles.begin(); seq_iter != seqFiles.end(); ++seq_iter) 
+    {
+        ss<<*seq_iter;
+        struct stat file_stats;
+        if (stat(seq_iter->c_str(), &file_stats) == 0)
+        {
+            ss<<" "<<file_stats.st_size<<" "<<file_stats.st_mtime;
+        }
+        ss<<std::endl;
+    }
+    ss<<"DR "<<mOpts->lowDRsize<<"-"<<mOpts->highDRsize;
+    ss<<" spacer "<<mOpts->lowSpacerSize<<"-"<<mOpts->highSpacerSize;
+    ss<<" window "<<mOpts->searchWindowLength;
+    ss<<" engine "<<mOpts->searchEngine;
+    ss<<" singlePass "<<mOpts->singlePass;
+    ss<<" repeats "<<mOpts->minNumRepeats;
+    ss<<" kmers "<<mOpts->kmer_clust_size;
+    ss<<" library "<<mOpts->drLibrary;
+    ss<<" known "<<mOpts->knownRepeats;
+    ss<<" subsample "<<mOpts->subsample;
+    return ss.str();
+}
+
+void WorkHorse::saveCheckpoint(CheckpointStage stage, Vecstr& seqFiles, int nextFreeGID)
+{
+    //-----
+    // Only written when asked for, a resumed run writes them too so
+    // that it can be resumed from further on. Not being able to write
+    // a checkpoint only means that this run can't be resumed, so it
+    // isn't fatal
+    //
+    if (! mOpts->checkpoint && ! mOpts->resume) 
+    {
+        return;
+    }
+    std::string file_name = checkpointFileName(stage);
+    try {
+        Checkpoint checkpoint;
+        checkpoint.create(file_name, stage, checkpointFingerprint(seqFiles));
+        checkpoint.writeInt(mMaxReadLength);
+        checkpoint.writeInt(nextFreeGID);
+        checkpoint.writeStrings(mStringCheck);
+        checkpoint.writeReads(mReads);
+        checkpoint.writeClusters(mDR2GIDMap);
+        if (stage == CP_CLUSTERS) 
+        {
+            checkpoint.writeTrueDRs(mTrueDRs);
+        }
+        checkpoint.commit();
+        logInfo("Wrote checkpoint " << file_name, 1);
+    } catch (crispr::exception& e) {
+        std::cerr<<PACKAGE_NAME<<" [WARNING]: Could not write a checkpoint, this run can't be resumed"<<std::endl;
+        std::cerr<<e.what()<<std::endl;
+    }
+}
+
+CheckpointStage WorkHorse::loadCheckpoint(Vecstr& seqFiles, int& nextFreeGID)
+{
+    //-----
+    // Start from the latest checkpoint that can be used. One that is
+    // damaged or was made from something else falls back to the one
+    // before it. The file has been checked by the time it is loaded so
+    // anything going wrong while loading is an error
+    //
+    std::string fingerprint = checkpointFingerprint(seqFiles);
+    CheckpointStage stages[2] = {CP_CLUSTERS, CP_SEARCH};
+    for (int i = 0; i < 2; i++) 
+    {
+        std::string file_name = checkpointFileName(stages[i]);
+        Checkpoint checkpoint;
+        try {
+            if (! checkpoint.open(file_name, fingerprint)) 
+            {
+                continue;
+            }
+        } catch (crispr::exception& e) {
+            std::cerr<<PACKAGE_NAME<<" [WARNING]: Not resuming from "<<file_name<<std::endl;
+            std::cerr<<e.what()<<std::endl;
+            continue;
+        }
+        mMaxReadLength = checkpoint.readInt();
+        nextFreeGID = checkpoint.readInt();
+        checkpoint.readStrings(mStringCheck);
+        checkpoint.readReads(mReads, mReadPool);
+        checkpoint.readClusters(mDR2GIDMap);
+        if (checkpoint.stage() == CP_CLUSTERS) 
+        {
+            checkpoint.readTrueDRs(mTrueDRs);
+        }
+        std::cout<<"["<<PACKAGE_NAME<<"_checkpoint]: Resuming from "<<file_name<<" with "<<numOfReads()<<" reads"<<std::endl;
+        logInfo("Resuming from checkpoint " << file_name << ", " << mReads.size() << " direct repeat variants in " << mDR2GIDMap.size() << " groups", 1);
+        return checkpoint.stage();
+    }
+    std::cout<<"["<<PACKAGE_NAME<<"_checkpoint]: No checkpoint to resume from, starting at the beginning"<<std::endl;
+    return CP_NONE;
+}
+
 //**************************************
 // spacer graphs
 //**************************************
@@ -1644,19 +1851,7 @@ int WorkHorse::makeSpacerGraphs(void)
 	//-----
 	// build the spacer graphs
 	//
-    // go through the DR2GID_map and make all reads in each group into nodes
-    DR_ListIterator dr_iter = mDRs.begin();
-    while(dr_iter != mDRs.end())
-    {
-        if(NULL != dr_iter->second)
-        {
-        	logInfo("Making spacer graph for DR: " << dr_iter->first, 1);
-        	if((dr_iter->second)->buildSpacerGraph())
-        		return 1;
-        }
-        dr_iter++;
-    }
-    return 0;
+    return runGroupStage(GS_MAKE_SPACER_GRAPH);
 }
 
 int WorkHorse::cleanSpacerGraphs(void)
@@ -1664,46 +1859,19 @@ int WorkHorse::cleanSpacerGraphs(void)
 	//-----
 	// clean the spacer graphs
 	//
-    // go through the DR2GID_map and make all reads in each group into nodes
 #ifdef DEBUG
     //renderSpacerGraphs("Spacer_Preclean_");
 #endif
-    DR_ListIterator dr_iter = mDRs.begin();
-    while(dr_iter != mDRs.end())
-    {
-        if(NULL != dr_iter->second)
-        {
-        	logInfo("Cleaning spacer graph for DR: " << dr_iter->first, 1);
-        	//(dr_iter->second)->printAllSpacers();
-        	if((dr_iter->second)->cleanSpacerGraph())
-        		return 1;
-        }
-        dr_iter++;
-    }
-    return 0;
+    return runGroupStage(GS_CLEAN_SPACER_GRAPH);
 }
 
 int WorkHorse::generateFlankers(void)
 {
 	//-----
-	// Wrapper for graph cleaning
+	// Wrapper for flanker detection
 	//
-	// create a spacer dictionary
 	logInfo("Detecting Flanker sequences", 1);
-	DR_Cluster_MapIterator drg_iter = mDR2GIDMap.begin();
-	while(drg_iter != mDR2GIDMap.end())
-	{
-		if(NULL != drg_iter->second)
-		{            
-            if (NULL != mDRs[mTrueDRs[drg_iter->first]])
-            {
-                logInfo("Assigning flankers for NodeManager "<<drg_iter->first, 3);
-                (mDRs[mTrueDRs[drg_iter->first]])->generateFlankers();
-		    }
-        }
-		drg_iter++;
-	}
-	return 0;
+	return runGroupStage(GS_FLANKERS);
 }
 //**************************************
 // contig making
@@ -1713,19 +1881,7 @@ int WorkHorse::splitIntoContigs(void)
 	//-----
 	// split all groups into contigs
 	//
-    DR_ListIterator dr_iter = mDRs.begin();
-    while(dr_iter != mDRs.end())
-    {
-        if(NULL != dr_iter->second)
-        {
-        	logInfo("Making spacer contigs for DR: " << dr_iter->first, 1);
-
-            if((dr_iter->second)->splitIntoContigs())
-        		return 1;
-        }
-        dr_iter++;
-    }
-    return 0;
+    return runGroupStage(GS_SPLIT_CONTIGS);
 }
 
 //**************************************
@@ -1931,15 +2087,14 @@ bool WorkHorse::outputResults(std::string namePrefix)
 	logInfo("Writing XML output to \"" << namePrefix << "\"", 1);
 	
 
-    crispr::xml::writer * xml_doc = new crispr::xml::writer();
-    int error_num;
-    xercesc::DOMElement * root_element = xml_doc->createDOMDocument(CRASS_DEF_ROOT_ELEMENT, 
-                                                                    CRASS_DEF_XML_VERSION, 
-                                                                    error_num);
-    
-    if (!root_element && error_num) 
+    // each group is written out as soon as it is done so only one group
+    // ever has to be held in memory
+    crispr::xml::streamwriter * xml_out = new crispr::xml::streamwriter();
+    if (!xml_out->createDocument(namePrefix, 
+                                 CRASS_DEF_ROOT_ELEMENT, 
+                                 CRASS_DEF_XML_VERSION)) 
     {
-        delete xml_doc;
+        delete xml_out;
         throw crispr::xml_exception(__FILE__,
                                     __LINE__,
                                     __PRETTY_FUNCTION__,
@@ -1983,6 +2138,7 @@ bool WorkHorse::outputResults(std::string namePrefix)
                 if(system(cmd.c_str()))
                 {
                     logError("Problem running "<<mOpts->layoutAlgorithm<<" when rendering spacer graphs");
+                    delete xml_out;
                     return 1;
                 }
             }
@@ -2001,24 +2157,26 @@ bool WorkHorse::outputResults(std::string namePrefix)
              */
             std::string gid_as_string = "G" + to_string(drg_iter->first);
             final_out_number++;
-            xercesc::DOMElement * group_elem = xml_doc->addGroup(gid_as_string, 
-                                                                 mTrueDRs[drg_iter->first], 
-                                                                 root_element);
+            xml_out->addGroup(gid_as_string, mTrueDRs[drg_iter->first]);
             /*
              * <data> section
              */
-            this->addDataToDOM(xml_doc, group_elem, drg_iter->first);
+            this->addDataToStream(xml_out, drg_iter->first);
             
             /*
              * <metadata> section
              */
-            this->addMetadataToDOM(xml_doc, group_elem, drg_iter->first);
+            this->addMetadataToStream(xml_out, drg_iter->first);
             
             /*
              * <assembly> section
              */
-            xercesc::DOMElement * assem_elem = xml_doc->addAssembly(group_elem);
-            current_manager->printAssemblyToDOM(xml_doc, assem_elem, false);
+            xml_out->startElement(xml_out->tag_Assembly());
+            current_manager->printAssemblyToStream(xml_out, false);
+            xml_out->endElement();
+            
+            // </group>
+            xml_out->endElement();
         }
         else 
         {
@@ -2028,77 +2186,71 @@ bool WorkHorse::outputResults(std::string namePrefix)
         }
     }
     std::cout<<"["<<PACKAGE_NAME<<"_graphBuilder]: "<<final_out_number<<" CRISPRs found!"<<std::endl;
-    xml_doc->printDOMToFile(namePrefix);
+    if (!xml_out->finishDocument()) 
+    {
+        logError("Problem writing the XML output to \"" << namePrefix << "\"");
+    }
 
-    delete xml_doc;
+    delete xml_out;
     
     gvGraphFooter(key_file);
     key_file.close();
 	return 0;
 }
 
-bool WorkHorse::addDataToDOM(crispr::xml::writer * xmlDoc, xercesc::DOMElement * groupElement, int groupNumber)
+bool WorkHorse::addDataToStream(crispr::xml::streamwriter * xmlOut, int groupNumber)
 {
-    try 
-    {
-        xercesc::DOMElement * data_elem = xmlDoc->addData(groupElement);
-        if ((mDRs[mTrueDRs[groupNumber]])->haveAnyFlankers()) {
-            xmlDoc->createFlankers(data_elem);
-        }
-        
-        xercesc::DOMElement * sources_tag = data_elem->getFirstElementChild();
-        std::set<StringToken> all_sources;
-        
-        for (xercesc::DOMElement * currentElement = data_elem->getFirstElementChild(); currentElement != NULL; currentElement = currentElement->getNextElementSibling()) 
-        {
-            if( xercesc::XMLString::equals(currentElement->getTagName(), xmlDoc->tag_Drs()))
-            {
-                // TODO: current implementation in Crass only supports a single DR for a group
-                // in the future this will change, but for now ok to keep as a constant
-                std::string drid = "DR1";
-                xmlDoc->addDirectRepeat(drid, mTrueDRs[groupNumber], currentElement);
-            }
-            else if (xercesc::XMLString::equals(currentElement->getTagName(), xmlDoc->tag_Spacers()))
-            {
-                // print out all the spacers for this group
-                (mDRs[mTrueDRs[groupNumber]])->addSpacersToDOM(xmlDoc, currentElement, false, all_sources);
-                
-            }
-            else if (xercesc::XMLString::equals(currentElement->getTagName(), xmlDoc->tag_Flankers()))
-            {
-                // should only get in here if there are flankers for the group
-
-                // print out all the flankers for this group
-                (mDRs[mTrueDRs[groupNumber]])->addFlankersToDOM(xmlDoc, currentElement, false, all_sources);
-
-            }
-        }
-        (mDRs[mTrueDRs[groupNumber]])->generateAllsourceTags(xmlDoc, all_sources, sources_tag);
-        
-    }
-    catch( xercesc::XMLException& e )
+    NodeManager * current_manager = mDRs[mTrueDRs[groupNumber]];
+    xmlOut->startElement(xmlOut->tag_Data());
+    
+    // <sources> comes first but needs the reads from every spacer and flanker
+    std::set<StringToken> all_sources;
+    current_manager->getAllSources(false, all_sources);
+    xmlOut->startElement(xmlOut->tag_Sources());
+    current_manager->generateAllsourceTags(xmlOut, all_sources);
+    xmlOut->endElement();
+    
+    // TODO: current implementation in Crass only supports a single DR for a group
+    // in the future this will change, but for now ok to keep as a constant
+    std::string drid = "DR1";
+    xmlOut->startElement(xmlOut->tag_Drs());
+    xmlOut->addDirectRepeat(drid, mTrueDRs[groupNumber]);
+    xmlOut->endElement();
+    
+    // print out all the spacers for this group
+    xmlOut->startElement(xmlOut->tag_Spacers());
+    current_manager->addSpacersToStream(xmlOut, false);
+    xmlOut->endElement();
+    
+    if (current_manager->haveAnyFlankers()) 
     {
-        char* message = xercesc::XMLString::transcode( e.getMessage() );
-        std::ostringstream errBuf;
-        errBuf << "Error parsing file: " << message << std::flush;
-        xercesc::XMLString::release( &message );
-        return 1;
+        // print out all the flankers for this group
+        xmlOut->startElement(xmlOut->tag_Flankers());
+        current_manager->addFlankersToStream(xmlOut, false);
+        xmlOut->endElement();
     }
+    
+    // </data>
+    xmlOut->endElement();
     return 0;
 }
 
-bool WorkHorse::addMetadataToDOM(crispr::xml::writer * xmlDoc, xercesc::DOMElement * groupElement, int groupNumber)
+bool WorkHorse::addMetadataToStream(crispr::xml::streamwriter * xmlOut, int groupNumber)
 {
+    // opened and closed outside of the try so that <metadata> is always
+    // closed, even when one of the files can't be found
+    bool retval = 0;
+    xmlOut->startElement(xmlOut->tag_Metadata());
     try {
         
         std::stringstream notes;
         notes << "Run on "<< mTimeStamp;
-        xercesc::DOMElement * metadata_elem = xmlDoc->addMetaData(groupElement);
-        xercesc::DOMElement * prog_elem = xmlDoc->addProgram(metadata_elem);
-        xmlDoc->addProgName(PACKAGE_NAME, prog_elem);
-        xmlDoc->addProgVersion(PACKAGE_VERSION, prog_elem);
-        xmlDoc->addProgCommand(mCommandLine, prog_elem);
-        xmlDoc->addNotesToMetadata(notes.str(), metadata_elem);
+        xmlOut->startElement(xmlOut->tag_Program());
+        xmlOut->addTextElement(xmlOut->tag_Name(), PACKAGE_NAME);
+        xmlOut->addTextElement(xmlOut->tag_Version(), PACKAGE_VERSION);
+        xmlOut->addTextElement(xmlOut->tag_Command(), mCommandLine);
+        xmlOut->endElement();
+        xmlOut->addTextElement(xmlOut->tag_Notes(), notes.str());
         
         std::string file_name;
         char buf[4096];
@@ -2117,7 +2269,7 @@ bool WorkHorse::addMetadataToDOM(crispr::xml::writer * xmlDoc, xercesc::DOMEleme
             file_name = mOpts->output_fastq + PACKAGE_NAME + "." + mTimeStamp + ".log";
             if (! checkFileOrError(file_name.c_str())) 
             {
-                xmlDoc->addFileToMetadata("log", absolute_dir + file_name, metadata_elem);
+                xmlOut->addFileToMetadata("log", absolute_dir + file_name);
             }
             else
             {
@@ -2137,7 +2289,7 @@ bool WorkHorse::addMetadataToDOM(crispr::xml::writer * xmlDoc, xercesc::DOMEleme
             std::string file_sufix = to_string(groupNumber) + "_" + mTrueDRs[groupNumber] + "_debug.gv";
             if (! checkFileOrError((file_name + file_sufix).c_str())) 
             {
-                xmlDoc->addFileToMetadata("data", absolute_dir + file_name + file_sufix, metadata_elem);
+                xmlOut->addFileToMetadata("data", absolute_dir + file_name + file_sufix);
             } 
             else 
             {
@@ -2151,7 +2303,7 @@ bool WorkHorse::addMetadataToDOM(crispr::xml::writer * xmlDoc, xercesc::DOMEleme
             file_name = mOpts->output_fastq + "Clean_";
             if (! checkFileOrError((file_name + file_sufix).c_str())) 
             {
-                xmlDoc->addFileToMetadata("data", absolute_dir + file_name + file_sufix, metadata_elem);
+                xmlOut->addFileToMetadata("data", absolute_dir + file_name + file_sufix);
             } 
             else 
             {
@@ -2173,7 +2325,7 @@ bool WorkHorse::addMetadataToDOM(crispr::xml::writer * xmlDoc, xercesc::DOMEleme
             file_name = mOpts->output_fastq + "Group_" + to_string(groupNumber) + "_" + mTrueDRs[groupNumber] + ".eps";
             if (! checkFileOrError(file_name.c_str())) 
             {
-                xmlDoc->addFileToMetadata("image", absolute_dir + file_name, metadata_elem);
+                xmlOut->addFileToMetadata("image", absolute_dir + file_name);
             } 
             else 
             {
@@ -2184,7 +2336,7 @@ bool WorkHorse::addMetadataToDOM(crispr::xml::writer * xmlDoc, xercesc::DOMEleme
             
             if (! checkFileOrError(file_name.c_str())) 
             {
-                xmlDoc->addFileToMetadata("image", absolute_dir + file_name, metadata_elem);
+                xmlOut->addFileToMetadata("image", absolute_dir + file_name);
             } 
             else 
             {
@@ -2198,7 +2350,7 @@ bool WorkHorse::addMetadataToDOM(crispr::xml::writer * xmlDoc, xercesc::DOMEleme
             file_name = mOpts->output_fastq + "Spacers_" + to_string(groupNumber) + "_" + mTrueDRs[groupNumber] + ".eps";
             if (! checkFileOrError(file_name.c_str())) 
             {
-                xmlDoc->addFileToMetadata("image", absolute_dir + file_name, metadata_elem);
+                xmlOut->addFileToMetadata("image", absolute_dir + file_name);
             } 
             else 
             {
@@ -2214,7 +2366,7 @@ bool WorkHorse::addMetadataToDOM(crispr::xml::writer * xmlDoc, xercesc::DOMEleme
         std::string file_sufix = to_string(groupNumber) + "_" + mTrueDRs[groupNumber] + "_spacers.gv";
         if (! checkFileOrError((file_name + file_sufix).c_str())) 
         {
-            xmlDoc->addFileToMetadata("data", absolute_dir + file_name + file_sufix, metadata_elem);
+            xmlOut->addFileToMetadata("data", absolute_dir + file_name + file_sufix);
         } 
         else 
         {
@@ -2229,7 +2381,7 @@ bool WorkHorse::addMetadataToDOM(crispr::xml::writer * xmlDoc, xercesc::DOMEleme
         file_name = mOpts->output_fastq +  "Group_" + to_string(groupNumber) + "_" + mTrueDRs[groupNumber] + ".fa";
         if (! checkFileOrError(file_name.c_str())) 
         {
-            xmlDoc->addFileToMetadata("sequence", absolute_dir + file_name, metadata_elem);
+            xmlOut->addFileToMetadata("sequence", absolute_dir + file_name);
         } 
         else 
         {
@@ -2237,14 +2389,14 @@ bool WorkHorse::addMetadataToDOM(crispr::xml::writer * xmlDoc, xercesc::DOMEleme
         }
     } catch(crispr::no_file_exception& e) {
         std::cerr<<e.what()<<std::endl;
-        return 1;
+        retval = 1;
     } catch(std::exception& e) {
         std::cerr<<e.what()<<std::endl;
-        return 1;
-    } catch(xercesc::DOMException& e) {
-        
+        retval = 1;
     }
-    return 0;
+    // </metadata>
+    xmlOut->endElement();
+    return retval;
     
 }
 
@@ -50,7 +50,9 @@
 #include "NodeManager.h"
 #include "ReadHolder.h"
 #include "StringCheck.h"
-#include "writer.h"
+#include "streamwriter.h"
+#include "Checkpoint.h"
+#include "Metrics.h"
 #if SEARCH_SINGLETON
 #include "SearchChecker.h"
 #endif
@@ -62,16 +64,34 @@
 typedef std::map<std::string, NodeManager *> DR_List;
 typedef std::map<std::string, NodeManager *>::iterator DR_ListIterator;
 
+// one group of DRs and the nodemanager made for it. The groups are
+// independent once the graphs are built, so they are worked on in parallel
+typedef struct {
+    int gid;                                        // group ID, the results are still written in this order
+    std::string trueDR;                             // key of the nodemanager in mDRs
+    NodeManager * manager;
+    std::vector<ReadList *> reads;                  // the reads for each DR in the group, only used to build the graph
+    size_t numReads;                                // used to start the biggest groups first
+} GroupTask;
+
+// the parts of doWork that are done for each group on its own
+enum GroupStage {
+    GS_ADD_READS,
+    GS_CLEAN_GRAPH,
+    GS_MAKE_SPACER_GRAPH,
+    GS_CLEAN_SPACER_GRAPH,
+    GS_SPLIT_CONTIGS,
+    GS_FLANKERS
+};
+
 
 
-bool sortLengthAssending( const std::string &a, const std::string &b);
 bool sortLengthDecending( const std::string &a, const std::string &b);
-bool includeSubstring(const std::string& a, const std::string& b);
-bool isNotEmpty(const std::string& a);
 
 class WorkHorse {
     public:
-    WorkHorse (options * opts, std::string timestamp, std::string commandLine) 
+    WorkHorse (options * opts, std::string timestamp, std::string commandLine) :
+        mReadPool(true)
         { 
             mOpts = opts; 
             mMaxReadLength = 0;
@@ -89,6 +109,8 @@ class WorkHorse {
         //**************************************
 
         int numOfReads(void);
+        
+        inline const Metrics& metrics(void) const { return mMetrics; }
     
     
         
@@ -100,26 +122,25 @@ class WorkHorse {
         //**************************************
         // functions used to cluster DRs into groups and identify the "true" DR
         //**************************************
-        int parseSeqFiles(Vecstr seqFiles);	// parse the raw read files
+        int parseSeqFiles(Vecstr seqFiles, int& nextFreeGID);	// parse the raw read files
         
         int buildGraph(void);									// build the basic graph structue
         
         int cleanGraph(void);									// clean the graph structue
-
-        void removeRedundantRepeats(Vecstr& repeatVector);
         
-        Vecstr * createNonRedundantSet(GroupKmerMap& groupKmerCountsMap, 
-                                                         int& nextFreeGID);
+        int runGroupStage(GroupStage stage);					// do one stage for every group, using all the threads
+
+        Vecstr * createNonRedundantSet(int& nextFreeGID);
 
         int removeLowConfidenceNodeManagers(void);
+
+        void countGraphs(void);                                 // the groups, nodes, spacers and contigs left, for the metrics
         
-        int findConsensusDRs(GroupKmerMap& groupKmerCountsMap, 
-                             int& nextFreeGID);
+        int findConsensusDRs(int& nextFreeGID);
     
         bool clusterDRReads(StringToken DRToken, 
                 int * nextFreeGID, 
-                std::map<std::string, int> * k2GIDMap, 
-                GroupKmerMap * groupKmerCountsMap);  // cut kmers and hash
+                KmerTable * k2GIDMap);               // cut kmers and hash
         
         bool findMasterDR(int GID, 
                 StringToken&  masterDRToken);
@@ -142,6 +163,17 @@ class WorkHorse {
         
         void cleanGroup(int GID);
         
+        //**************************************
+        // checkpoints
+        //**************************************
+        std::string checkpointFileName(CheckpointStage stage);
+        
+        std::string checkpointFingerprint(Vecstr& seqFiles);    // what a checkpoint depends on
+        
+        void saveCheckpoint(CheckpointStage stage, Vecstr& seqFiles, int nextFreeGID);
+        
+        CheckpointStage loadCheckpoint(Vecstr& seqFiles, int& nextFreeGID);   // CP_NONE if there's nothing to resume from
+        
         //**************************************
         // spacer graphs
         //**************************************
@@ -176,14 +208,15 @@ class WorkHorse {
         
         bool outputResults(std::string namePrefix);
 
-        bool addDataToDOM(crispr::xml::writer * xmlDoc, xercesc::DOMElement * groupElement, int groupNumber);
+        bool addDataToStream(crispr::xml::streamwriter * xmlOut, int groupNumber);
         
-        bool addMetadataToDOM(crispr::xml::writer * xmlDoc, xercesc::DOMElement * groupElement, int groupNumber);
+        bool addMetadataToStream(crispr::xml::streamwriter * xmlOut, int groupNumber);
 
         
     // members
         DR_List mDRs;                               // list of nodemanagers, cannonical DRs, one nodemanager per direct repeat
         ReadMap mReads;                             // reads containing possible double DRs
+        ReadHolderPool mReadPool;                   // the readholders in mReads, shared by the search threads
         options * mOpts;                      // search options
         std::string mOutFileDir;                    // where to spew text to
         int mMaxReadLength;                       // the average seen read length
@@ -194,6 +227,8 @@ class WorkHorse {
         std::map<int, bool> mGroupMap;				// list of valid group IDs
         DR_Cluster_Map mDR2GIDMap;					// map a DR (StringToken) to a GID
         std::map<int, std::string> mTrueDRs;		// map GId to true DR strings
+        std::vector<GroupTask> mGroupTasks;			// one per nodemanager, biggest group first
+        Metrics mMetrics;                           // how long each stage of doWork took
 };
 
 #endif //WorkHorse_h
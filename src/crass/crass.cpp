@@ -111,6 +111,19 @@ void usage(void)
     std::cout<< "-o --outDir          <DIR>   Output directory [default: .]"<<std::endl;
     std::cout<< "-V --version                 Program and version information"<<std::endl;
     std::cout<< "-g --logToScreen             Print the logging information to screen rather than a file"<<std::endl;
+    std::cout<< "-t --threads         <INT>   Number of threads used to search the reads [Default: "<<CRASS_DEF_NUM_THREADS<<"]"<<std::endl;
+    std::cout<< "--singlePass                 Keep the reads without a repeat in a temporary file in the"<<std::endl;
+    std::cout<< "                             output directory instead of reading the input a second time"<<std::endl;
+    std::cout<< "--checkpoint                 Write checkpoints to the output directory after the reads have"<<std::endl;
+    std::cout<< "                             been searched and after the true direct repeats are found, so"<<std::endl;
+    std::cout<< "                             that the run can be resumed [Default: no checkpoints]"<<std::endl;
+    std::cout<< "--resume                     Start from the latest checkpoint in the output directory, and"<<std::endl;
+    std::cout<< "                             write checkpoints as --checkpoint does. Checkpoints can only be"<<std::endl;
+    std::cout<< "                             used with the same input files and search and clustering options"<<std::endl;
+    std::cout<< "--dr-library        <FILE>   A library of the direct repeats found in earlier runs. Reads"<<std::endl;
+    std::cout<< "                             with a known repeat are recruited while the reads are searched"<<std::endl;
+    std::cout<< "                             and the repeats found in this run are added to it. The library"<<std::endl;
+    std::cout<< "                             is made if it doesn't exist"<<std::endl;
     std::cout<<std::endl;
     std::cout<<"CRISPR Identification Options:"<<std::endl;
     std::cout<< "-d --minDR           <INT>   Minimim length of the direct repeat"<<std::endl; 
@@ -123,6 +136,16 @@ void usage(void)
     std::cout<< "-S --maxSpacer       <INT>   Maximim length of the spacer to search for [Default: "<<CRASS_DEF_MAX_SPACER_SIZE<<"]"<<std::endl;
     std::cout<< "-w --windowLength    <INT>   The length of the search window. Can only be"<<std::endl; 
     std::cout<< "                             a number between "<<CRASS_DEF_MIN_SEARCH_WINDOW_LENGTH<<" - "<<CRASS_DEF_MAX_SEARCH_WINDOW_LENGTH<<" [Default: "<<CRASS_DEF_OPTIMAL_SEARCH_WINDOW_LENGTH<<"]"<<std::endl;
+    std::cout<< "--searchEngine      <TYPE>   How repeated search windows are found, either crt (Boyer-Moore"<<std::endl;
+    std::cout<< "                             search of each window) or kmer (kmer index of each read). Both"<<std::endl;
+    std::cout<< "                             find the same reads [Default: crt]"<<std::endl;
+    std::cout<< "--knownRepeats      <FILE>   A fasta file of direct repeats that are already known. Reads"<<std::endl;
+    std::cout<< "                             with one of them, or its reverse complement, are taken without"<<std::endl;
+    std::cout<< "                             searching and only the rest of the reads are searched"<<std::endl;
+    std::cout<< "--subsample         <REAL>   Only search some of the reads for direct repeats, the rest are"<<std::endl;
+    std::cout<< "                             recruited by the repeats found. Below 1 it is the fraction of"<<std::endl;
+    std::cout<< "                             reads, otherwise the number of reads from the start of each file."<<std::endl;
+    std::cout<< "                             Repeats only in reads outside the sample are missed [Default: search all]"<<std::endl;
     /*std::cout<< "-x --spacerScalling  <REAL>  A decimal number that represents the reduction in size of the spacer"<<std::endl;
     std::cout<< "                             when the --removeHomopolymers option is set [Default: "<<CRASS_DEF_HOMOPOLYMER_SCALLING<<"]"<<std::endl;
     std::cout<< "-y --repeatScalling  <REAL>  A decimal number that represents the reduction in size of the direct repeat"<<std::endl;
@@ -167,6 +190,8 @@ void usage(void)
     std::cout<<"                              red-blue, blue-red, green-red-blue, red-blue-green"<<std::endl;
     std::cout<<"-L --longDescription          Set if you want the spacer sequence printed along with the ID in the spacer graph. [Default: false]"<<std::endl;
     std::cout<<"-G --showSingltons            Set if you want to print singleton spacers in the spacer graph [Default: false]"<<std::endl;
+    std::cout<<"--metrics             <FILE>  Write the time and peak memory of each stage, and counts of the reads"<<std::endl;
+    std::cout<<"                              searched and recruited, groups, spacers and contigs, to a JSON file"<<std::endl;
 #ifdef DEBUG
     std::cout<<"-e --noDebugGraph             Stops creation of debug .gv files even if the DEBUG preprocessor macro is set [Default: false]"<<std::endl;
 #endif
@@ -195,7 +220,7 @@ int processOptions(int argc, char *argv[], options *opts)
 {
     int c;
     int index;
-    while( (c = getopt_long(argc, argv, "a:b:c:d:D:ef:gGhk:K:l:Ln:o:rs:S:Vw:", long_options, &index)) != -1 ) 
+    while( (c = getopt_long(argc, argv, "a:b:c:d:D:ef:gGhk:K:l:Ln:o:rs:S:t:Vw:", long_options, &index)) != -1 ) 
     {
         switch(c) 
         {
@@ -359,6 +384,21 @@ int processOptions(int argc, char *argv[], options *opts)
             case 'S': 
                 from_string<unsigned int>(opts->highSpacerSize, optarg, std::dec);
                 break;
+            case 't':
+                from_string<int>(opts->numThreads, optarg, std::dec);
+                if (opts->numThreads < 1) 
+                {
+                    std::cerr<<PACKAGE_NAME<<" [WARNING]: The number of threads cannot be "<<opts->numThreads<<" changing to "<<CRASS_DEF_NUM_THREADS<<std::endl;
+                    opts->numThreads = CRASS_DEF_NUM_THREADS;
+                }
+#ifndef HAVE_PTHREAD
+                if (opts->numThreads > 1) 
+                {
+                    std::cerr<<PACKAGE_NAME<<" [WARNING]: Not compiled with thread support, the search will use a single thread"<<std::endl;
+                    opts->numThreads = 1;
+                }
+#endif
+                break;
             case 'V': 
                 versionInfo(); 
                 exit(1); 
@@ -373,6 +413,37 @@ int processOptions(int argc, char *argv[], options *opts)
                 }
                 break;        
             case 0:
+                if (strcmp("singlePass", long_options[index].name) == 0) opts->singlePass = true;
+                if (strcmp("checkpoint", long_options[index].name) == 0) opts->checkpoint = true;
+                if (strcmp("resume", long_options[index].name) == 0) opts->resume = true;
+                if (strcmp("dr-library", long_options[index].name) == 0) opts->drLibrary = optarg;
+                if (strcmp("knownRepeats", long_options[index].name) == 0) opts->knownRepeats = optarg;
+                if (strcmp("metrics", long_options[index].name) == 0) opts->metrics = optarg;
+                if (strcmp("subsample", long_options[index].name) == 0) 
+                {
+                    from_string<double>(opts->subsample, optarg, std::dec);
+                    if (opts->subsample < 0) 
+                    {
+                        std::cerr<<PACKAGE_NAME<<" [WARNING]: The subsample can't be negative, searching every read"<<std::endl;
+                        opts->subsample = CRASS_DEF_SUBSAMPLE;
+                    }
+                }
+                if (strcmp("searchEngine", long_options[index].name) == 0) 
+                {
+                    if (strcmp(optarg, "crt") == 0) 
+                    {
+                        opts->searchEngine = CRT_ENGINE;
+                    }
+                    else if (strcmp(optarg, "kmer") == 0)
+                    {
+                        opts->searchEngine = KMER_ENGINE;
+                    }
+                    else
+                    {
+                        std::cerr<<PACKAGE_NAME<<" [WARNING]: Unknown search engine "<<optarg<<" changing to default search engine (crt)"<<std::endl;
+                        opts->searchEngine = CRASS_DEF_SEARCH_ENGINE;
+                    }
+                }
 #ifdef SEARCH_SINGLETON
                 if (strcmp("searchChecker", long_options[index].name) == 0) opts->searchChecker = optarg;
 #endif
@@ -398,6 +469,14 @@ int processOptions(int argc, char *argv[], options *opts)
         usage();
         exit(1);
     }
+#ifdef SEARCH_SINGLETON
+    // the search checker changes the log level per read so it has to see them in order
+    if (opts->numThreads > 1) 
+    {
+        std::cerr<<PACKAGE_NAME<<" [WARNING]: The search checker only works with a single thread, ignoring --threads"<<std::endl;
+        opts->numThreads = 1;
+    }
+#endif
     
     
     
@@ -458,6 +537,15 @@ int main(int argc, char *argv[])
     opts.layoutAlgorithm       = "unset";
 #endif
     opts.covCutoff             = CRASS_DEF_COVCUTOFF;
+    opts.numThreads            = CRASS_DEF_NUM_THREADS;                  // number of threads used to search the reads
+    opts.singlePass            = CRASS_DEF_SINGLE_PASS;                  // read the input files twice
+    opts.searchEngine          = CRASS_DEF_SEARCH_ENGINE;                // how searchCore finds repeated windows
+    opts.checkpoint            = CRASS_DEF_CHECKPOINT;                   // write checkpoints
+    opts.resume                = CRASS_DEF_RESUME;                       // start from the latest checkpoint
+    opts.drLibrary             = "";                                     // no library of known repeats
+    opts.knownRepeats          = "";                                     // search every read
+    opts.subsample             = CRASS_DEF_SUBSAMPLE;                    // search every read
+    opts.metrics               = "";                                     // no metrics report
 
     int opt_idx = processOptions(argc, argv, &opts);
 
@@ -529,6 +617,16 @@ int main(int argc, char *argv[])
         }
  */
         int error_code = mHorse->doWork(seq_files);
+        if (! opts.metrics.empty()) 
+        {
+            // written even when the run failed, to show how far it got
+            try {
+                mHorse->metrics().writeJson(opts.metrics);
+            } catch (crispr::exception& e) {
+                std::cerr<<PACKAGE_NAME<<" [WARNING]: Could not write the metrics report"<<std::endl;
+                std::cerr<<e.what()<<std::endl;
+            }
+        }
     
 #ifdef SEARCH_SINGLETON
         delete debugger;
@@ -80,6 +80,15 @@ static struct option long_options [] = {
 #endif
     {"minSpacer", required_argument, NULL, 's'},
     {"maxSpacer", required_argument, NULL, 'S'},
+    {"threads", required_argument, NULL, 't'},
+    {"singlePass", no_argument, NULL, 0},
+    {"searchEngine", required_argument, NULL, 0},
+    {"checkpoint", no_argument, NULL, 0},
+    {"resume", no_argument, NULL, 0},
+    {"dr-library", required_argument, NULL, 0},
+    {"knownRepeats", required_argument, NULL, 0},
+    {"subsample", required_argument, NULL, 0},
+    {"metrics", required_argument, NULL, 0},
     {"version", no_argument, NULL, 'V'},
     {"windowLength", required_argument, NULL, 'w'},
     {"spacerScalling",required_argument,NULL,'x'},
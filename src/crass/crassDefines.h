@@ -57,6 +57,14 @@
 #define CRASS_DEF_SCAN_LENGTH                      (30)
 #define CRASS_DEF_SCAN_CONFIDENCE                  (0.70)
 #define CRASS_DEF_TRIM_EXTEND_CONFIDENCE           (0.5)
+
+// the ways searchCore can look for a repeated window
+enum SEARCH_ENGINE
+{
+    CRT_ENGINE,                 // Boyer-Moore search of the downstream range
+    KMER_ENGINE                 // lookup in a 2-bit kmer index of the read
+};
+#define CRASS_DEF_SEARCH_ENGINE                    CRT_ENGINE
 // --------------------------------------------------------------------
  // STRING LENGTH / MISMATCH / CLUSTER SIZE PARAMETERS
 // --------------------------------------------------------------------
@@ -64,8 +72,12 @@
 #define CRASS_DEF_MIN_SW_ALIGNMENT_RATIO        (0.85)              // SW alignments need to be this percentage of the original query to be considered real
 #define CRASS_DEF_SW_SEARCH_EXT                 (8)
 #define CRASS_DEF_KMER_SIZE                     (11)					// length of the kmers used when clustering DR groups
+#define CRASS_DEF_KMER_TABLE_SLOTS              (64)                  // starting size of the kmer hash tables used when clustering
 #define CRASS_DEF_K_CLUST_MIN                   (6)					// number of shared kmers needed to group DR variants together
 #define CRASS_DEF_READ_COUNTER_LOGGER           (100000)
+#define CRASS_DEF_READ_BATCH_SIZE               (4096)                // number of reads handed to a search thread at a time
+#define CRASS_DEF_BATCHES_PER_THREAD            (2)                   // batches in flight per search thread
+#define CRASS_DEF_POOL_CHUNK_SIZE               (1024)                // objects carved out of each ObjectPool allocation
 #define CRASS_DEF_MAX_READS_FOR_DECISION        (1000)
   // HARD CODED PARAMS FOR FINDING TRUE DRs
 #define CRASS_DEF_MIN_CONS_ARRAY_LEN            (1200)                // minimum size of the consensus array
@@ -98,6 +110,11 @@
 #define CRASS_DEF_DEF_PATTERN_LOOKUP_EXT        "crass_direct_repeats.txt"
 #define CRASS_DEF_DEF_SPACER_LOOKUP_EXT         "crass_spacers.txt"
 #define CRASS_DEF_CRISPR_EXT                    ".crispr"
+#define CRASS_DEF_INPUT_BUFFER_SIZE             (4*1024*1024)       // size of each decoded buffer the input reader fills
+#define CRASS_DEF_INPUT_BUFFERS                 (4)                   // decoded buffers in the ring between the input reader and kseq
+#define CRASS_DEF_INPUT_CHUNK_SIZE              (256*1024)          // compressed bytes read from the input at a time
+#define CRASS_DEF_SEARCH_CHECKPOINT_EXT         ".search.checkpoint"  // state after both passes over the reads
+#define CRASS_DEF_CLUSTER_CHECKPOINT_EXT        ".clusters.checkpoint" // state once the true DRs are known
 // --------------------------------------------------------------------
 // XML
 // --------------------------------------------------------------------
@@ -136,6 +153,11 @@
 #define CRASS_DEF_GRAPH_COLOUR                  BLUE_RED            // default colour scale for the graphs
 #define CRASS_DEF_SPACER_LONG_DESC              false               // use a long desc of the spacer in the output graph
 #define CRASS_DEF_SPACER_SHOW_SINGLES           false                // do not show singles by default
+#define CRASS_DEF_NUM_THREADS                   (1)                   // number of threads used to search the reads
+#define CRASS_DEF_SINGLE_PASS                   false               // read the input files twice to recruit singletons
+#define CRASS_DEF_CHECKPOINT                    false               // don't write checkpoints
+#define CRASS_DEF_RESUME                        false               // start from the beginning even if there is a checkpoint
+#define CRASS_DEF_SUBSAMPLE                     (0)                   // search every read
 
 typedef struct {
     int                 logLevel;                                           // level of verbosity allowed in the log file
@@ -166,6 +188,15 @@ typedef struct {
     bool                noRendering;                                        // Even if RENDERING preprocessor macro is set do not produce any rendered images
 #endif
     int                 covCutoff;                                          // The lower bounds of acceptable numbers of reads that a group can have
+    int                 numThreads;                                         // number of threads used to search the reads
+    bool                singlePass;                                         // spill the reads without a repeat rather than reading the input twice
+    SEARCH_ENGINE       searchEngine;                                       // how searchCore finds repeated windows
+    bool                checkpoint;                                         // write checkpoints that a later run can be resumed from
+    bool                resume;                                             // start from the latest checkpoint in the output directory
+    std::string         drLibrary;                                          // the library of direct repeats from earlier runs
+    std::string         knownRepeats;                                       // a fasta file of direct repeats that reads are checked for before searching
+    double              subsample;                                          // search only this fraction, or this many, of the reads in each file
+    std::string         metrics;                                            // where the timings, memory and counts of the run are written as JSON
 
 } options;
 
@@ -32,10 +32,10 @@
 #include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
-#include <zlib.h>
 #include "kseq.h"
+#include "GzipReader.h"
 
-kstream_t *ks_init(gzFile f)
+kstream_t *ks_init(GzipReader *f)
 {
 	kstream_t *ks = (kstream_t*)calloc(1, sizeof(kstream_t));
 	ks->f = f;
@@ -59,7 +59,7 @@ int ks_getc(kstream_t *ks)
 	if (ks->begin >= ks->end)
 	{
 		ks->begin = 0;
-		ks->end = gzread(ks->f, ks->buf, 4096);
+		ks->end = ks->f->read(ks->buf, 4096);
 		if (ks->end < 4096)
 			ks->is_eof = 1;
 		if (ks->end == 0)
@@ -84,7 +84,7 @@ int ks_getuntil(kstream_t *ks, int delimiter, kstring_t *str, int *dret)
 			if (!ks->is_eof)
 			{
 				ks->begin = 0;
-				ks->end = gzread(ks->f, ks->buf, 4096);
+				ks->end = ks->f->read(ks->buf, 4096);
 				if (ks->end < 4096)
 					ks->is_eof = 1;
 				if (ks->end == 0)
@@ -143,7 +143,7 @@ int ks_getuntil(kstream_t *ks, int delimiter, kstring_t *str, int *dret)
 	return (int)str->l;
 }
 
-kseq_t *kseq_init(gzFile fd)
+kseq_t *kseq_init(GzipReader *fd)
 {
 	kseq_t *s = (kseq_t*)calloc(1, sizeof(kseq_t));
 	s->f = ks_init(fd);
@@ -35,13 +35,15 @@
 #include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
-#include <zlib.h>
+
+// gzread is replaced by a reader that decodes the input on its own thread
+class GzipReader;
 
 typedef struct //__kstream_t
 {
 	char *buf;
 	int begin, end, is_eof;
-	gzFile f;
+	GzipReader *f;
 } kstream_t;
 
 typedef struct //__kstring_t
@@ -57,7 +59,7 @@ typedef struct
 	kstream_t *f;
 } kseq_t;
 
-kstream_t *ks_init(gzFile f);
+kstream_t *ks_init(GzipReader *f);
 
 void ks_destroy(kstream_t *ks);
 
@@ -65,7 +67,7 @@ int ks_getc(kstream_t *ks);
 
 int ks_getuntil(kstream_t *ks, int delimiter, kstring_t *str, int *dret);
 
-kseq_t *kseq_init(gzFile fd);
+kseq_t *kseq_init(GzipReader *fd);
 
 void kseq_rewind(kseq_t *ks);
 
@@ -42,6 +42,7 @@ struct _kswq_t {
 	int qlen, slen;
 	uint8_t shift, mdiff, max, size;
 	__m128i *qp, *H0, *H1, *E, *Hmax;
+	size_t cap; // bytes in the block, so that ksw_qreinit() can reuse it
 };
 
 /**
@@ -57,13 +58,23 @@ struct _kswq_t {
  */
 kswq_t *ksw_qinit(int size, int qlen, const uint8_t *query, int m, const int8_t *mat)
 {
-	kswq_t *q;
+	return ksw_qreinit(0, size, qlen, query, m, mat);
+}
+
+kswq_t *ksw_qreinit(kswq_t *q, int size, int qlen, const uint8_t *query, int m, const int8_t *mat)
+{
 	int slen, a, tmp, p;
+	size_t cap;
     
 	size = size > 1? 2 : 1;
 	p = 8 * (3 - size); // # values per __m128i
 	slen = (qlen + p - 1) / p; // segmented length
-	q = (kswq_t*)malloc(sizeof(kswq_t) + 256 + 16 * slen * (m + 4)); // a single block of memory
+	cap = sizeof(kswq_t) + 256 + 16 * slen * (m + 4);
+	if (q == 0 || q->cap < cap) { // only go back to malloc when the old block is too small
+		free(q);
+		q = (kswq_t*)malloc(cap); // a single block of memory
+		q->cap = cap;
+	}
 	q->qp = (__m128i*)(((size_t)q + sizeof(kswq_t) + 15) >> 4 << 4); // align memory
 	q->H0 = q->qp + slen * m;
 	q->H1 = q->H0 + slen;
@@ -351,6 +362,26 @@ kswr_t ksw_align(int qlen, uint8_t *query, int tlen, uint8_t *target, int m, con
 	return r;
 }
 
+kswr_t ksw_align_reuse(int qlen, uint8_t *query, int tlen, uint8_t *target, int m, const int8_t *mat, int gapo, int gape, int xtra, kswq_t **qry, kswq_t **sqry)
+{
+	int size;
+	kswr_t r, rr;
+	kswr_t (*func)(kswq_t*, int, const uint8_t*, int, int, int);
+    
+	*qry = ksw_qreinit(*qry, (xtra&KSW_XBYTE)? 1 : 2, qlen, query, m, mat);
+	func = (*qry)->size == 2? ksw_i16 : ksw_u8;
+	size = (*qry)->size;
+	r = func(*qry, tlen, target, gapo, gape, xtra);
+	if ((xtra&KSW_XSTART) == 0 || ((xtra&KSW_XSUBO) && r.score < (xtra&0xffff))) return r;
+	revseq(r.qe + 1, query); revseq(r.te + 1, target); // +1 because qe/te points to the exact end, not the position after the end
+	*sqry = ksw_qreinit(*sqry, size, r.qe + 1, query, m, mat);
+	rr = func(*sqry, tlen, target, gapo, gape, KSW_XSTOP | r.score);
+	revseq(r.qe + 1, query); revseq(r.te + 1, target);
+	if (r.score == rr.score)
+		r.tb = r.te - rr.te, r.qb = r.qe - rr.qe;
+	return r;
+}
+
 /*******************************************
  * Main function (not compiled by default) *
  *******************************************/
@@ -61,7 +61,20 @@ extern "C" {
 	 * query profile will be deallocated in ksw_align().
 	 */
 	kswr_t ksw_align(int qlen, uint8_t *query, int tlen, uint8_t *target, int m, const int8_t *mat, int gapo, int gape, int xtra, kswq_t **qry);
+
+	/**
+	 * Same as ksw_align() but the query profiles are kept between calls
+	 *
+	 * @param qry     profile for the query, rebuilt for this query
+	 * @param sqry    profile used to find the start positions with KSW_XSTART
+	 *
+	 * Both profiles start as NULL and are grown as needed, so aligning many
+	 * queries one after the other only allocates when a longer query comes
+	 * along. Free them with free() after the last call.
+	 */
+	kswr_t ksw_align_reuse(int qlen, uint8_t *query, int tlen, uint8_t *target, int m, const int8_t *mat, int gapo, int gape, int xtra, kswq_t **qry, kswq_t **sqry);
     kswq_t *ksw_qinit(int size, int qlen, const uint8_t *query, int m, const int8_t *mat);
+    kswq_t *ksw_qreinit(kswq_t *q, int size, int qlen, const uint8_t *query, int m, const int8_t *mat); // reuses q if it is big enough
     kswr_t ksw_u8(kswq_t *q, int tlen, const uint8_t *target, int _gapo, int _gape, int xtra);
     kswr_t ksw_i16(kswq_t *q, int tlen, const uint8_t *target, int _gapo, int _gape, int xtra);
 
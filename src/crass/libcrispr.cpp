@@ -48,6 +48,7 @@
 #include <fcntl.h>
 #include <stdlib.h>
 #include <exception>
+#include <algorithm>
 #include "StlExt.h"
 #include "Exception.h"
 
@@ -58,6 +59,9 @@
 #include "PatternMatcher.h"
 #include "SeqUtils.h"
 #include "kseq.h"
+#include "ReadBatch.h"
+#include "ReadSpill.h"
+#include "MappedReader.h"
 #include "config.h"
 
 extern "C" {
@@ -65,13 +69,581 @@ extern "C" {
 #include "../aho-corasick/acism.h"
 }
 
+// the reads looked at so far, kept across files so that the progress
+// carries on from one file to the next
+static int search_read_counter = 0;
+static int singleton_read_counter = 0;
+
+unsigned long readsSearched(void)
+{
+    return static_cast<unsigned long>(search_read_counter);
+}
+
+unsigned long readsScannedForSingletons(void)
+{
+    return static_cast<unsigned long>(singleton_read_counter);
+}
+
+#ifdef HAVE_PTHREAD
+// does the work on one batch, called from the worker threads
+typedef void (*BatchWorkFunction)(ReadBatch * batch, void * context);
+
+// moves the results of a batch into the shared containers,
+// called from the main thread in the order the batches were read
+typedef void (*BatchMergeFunction)(ReadBatch * batch, void * context);
+
+typedef struct _batch_worker_payload {
+    BatchWorkFunction work;
+    void * context;
+    ReadBatchQueue * todo;
+    ReadBatchQueue * done;
+    pthread_mutex_t * errorLock;
+    std::string * errorMessage;
+    bool * failed;
+} BatchWorkerPayload;
+
+static void reportBatchError(BatchWorkerPayload * payload, const std::string& errorMessage)
+{
+    //-----
+    // Only the first error is kept, the rest are most likely caused by it
+    //
+    pthread_mutex_lock(payload->errorLock);
+    if (! *(payload->failed)) 
+    {
+        *(payload->failed) = true;
+        *(payload->errorMessage) = errorMessage;
+    }
+    pthread_mutex_unlock(payload->errorLock);
+}
+
+static void * batchWorker(void * arg)
+{
+    //-----
+    // Take batches off the queue and work on them until there are
+    // no more. Errors are stored for the main thread to report
+    //
+    BatchWorkerPayload * payload = static_cast<BatchWorkerPayload *>(arg);
+    ReadBatch * batch;
+    while ((batch = payload->todo->pop()) != NULL) 
+    {
+        pthread_mutex_lock(payload->errorLock);
+        bool failed = *(payload->failed);
+        pthread_mutex_unlock(payload->errorLock);
+        
+        std::string error_message;
+        if (! failed) 
+        {
+            try {
+                payload->work(batch, payload->context);
+            } catch (crispr::exception& e) {
+                error_message = e.what();
+            } catch (std::exception& e) {
+                error_message = e.what();
+            }
+        }
+        if (! error_message.empty()) 
+        {
+            reportBatchError(payload, error_message);
+        }
+        // always hand the batch back so the reader never waits on it forever
+        payload->done->push(batch);
+    }
+    return NULL;
+}
+
+static void collectBatch(ReadBatchQueue& done,
+                         std::map<int, ReadBatch *>& finished,
+                         int& nextToMerge,
+                         std::vector<ReadBatch *>& freeBatches,
+                         BatchMergeFunction merge,
+                         void * context)
+{
+    //-----
+    // Wait for a worker to finish a batch then merge every batch
+    // we can without skipping ahead of one that is still out
+    //
+    ReadBatch * batch = done.pop();
+    finished[batch->mId] = batch;
+    
+    std::map<int, ReadBatch *>::iterator finished_iter = finished.find(nextToMerge);
+    while (finished_iter != finished.end()) 
+    {
+        merge(finished_iter->second, context);
+        freeBatches.push_back(finished_iter->second);
+        finished.erase(finished_iter);
+        nextToMerge++;
+        finished_iter = finished.find(nextToMerge);
+    }
+}
+
+static int processReadsThreaded(kseq_t * seq, 
+                                MappedReader * mapped,
+                                ReadSpill * spill,
+                                int numThreads,
+                                const char * stageName,
+                                BatchWorkFunction work,
+                                BatchMergeFunction merge,
+                                void * context,
+                                int& readCounter,
+                                time_t& timeStart)
+{
+    //-----
+    // This thread reads the reads into batches, either from a sequence
+    // file, a mapped sequence file or from a spill file, a pool of
+    // workers does the work on them
+    // and the results are merged back here in the order the batches
+    // were read. Whatever the merge does ends up in the same order as
+    // it would with a single thread
+    //
+    int l, log_counter, max_read_length;
+    log_counter = max_read_length = 0;
+    int first_read = readCounter;
+    time_t time_current;
+    ReadView mapped_read;
+    
+    ReadBatchQueue todo;
+    ReadBatchQueue done;
+    pthread_mutex_t error_lock;
+    pthread_mutex_init(&error_lock, NULL);
+    std::string error_message;
+    bool failed = false;
+    
+    BatchWorkerPayload payload;
+    payload.work = work;
+    payload.context = context;
+    payload.todo = &todo;
+    payload.done = &done;
+    payload.errorLock = &error_lock;
+    payload.errorMessage = &error_message;
+    payload.failed = &failed;
+    
+    // the batches are recycled so memory stays flat however big the file is
+    std::vector<ReadBatch *> all_batches;
+    std::vector<ReadBatch *> free_batches;
+    for (int i = 0; i < numThreads * CRASS_DEF_BATCHES_PER_THREAD; ++i) 
+    {
+        all_batches.push_back(new ReadBatch());
+    }
+    free_batches = all_batches;
+    
+    std::vector<pthread_t> workers;
+    for (int i = 0; i < numThreads; ++i) 
+    {
+        pthread_t worker;
+        if (pthread_create(&worker, NULL, batchWorker, &payload) != 0) 
+        {
+            logWarn("Could only start "<<i<<" threads, the rest of the work will be done by the reader", 1);
+            break;
+        }
+        workers.push_back(worker);
+    }
+    
+    std::map<int, ReadBatch *> finished;
+    int next_batch_id = 0;
+    int next_to_merge = 0;
+    bool more_reads = true;
+    
+    //-----
+    // Reading the reads or merging a batch can throw too. Nothing leaves
+    // this function before the workers have stopped, they are still
+    // using the queues and the batches
+    //
+    try {
+        while (more_reads) 
+        {
+            pthread_mutex_lock(&error_lock);
+            bool stop = failed;
+            pthread_mutex_unlock(&error_lock);
+            if (stop) 
+            {
+                break;
+            }
+        
+            if (free_batches.empty()) 
+            {
+                collectBatch(done, finished, next_to_merge, free_batches, merge, context);
+                continue;
+            }
+        
+            ReadBatch * batch = free_batches.back();
+            free_batches.pop_back();
+            batch->reset(next_batch_id);
+            batch->mFirstRead = static_cast<unsigned long>(readCounter - first_read);
+        
+            while (batch->mSize < CRASS_DEF_READ_BATCH_SIZE) 
+            {
+                ReadRecord& record = batch->nextRecord();
+                if (spill != NULL) 
+                {
+                    l = (spill->next(record)) ? static_cast<int>(record.mSeq.length()) : -1;
+                } 
+                else if (mapped != NULL) 
+                {
+                    l = (mapped->next(mapped_read)) ? static_cast<int>(mapped_read.mSeqLength) : -1;
+                    if (l >= 0) 
+                    {
+                        // reads in the mapping stay there until the file is closed
+                        if (mapped->isMapped(mapped_read)) 
+                        {
+                            record.point(mapped_read);
+                        } 
+                        else 
+                        {
+                            record.assign(mapped_read);
+                        }
+                    }
+                }
+                else if ((l = kseq_read(seq)) >= 0) 
+                {
+                    record.assign(seq);
+                }
+                if (l < 0) 
+                {
+                    // give back the slot we didn't fill
+                    batch->mSize--;
+                    more_reads = false;
+                    break;
+                }
+                max_read_length = (l > max_read_length) ? l : max_read_length;
+                if (log_counter == CRASS_DEF_READ_COUNTER_LOGGER) 
+                {
+                    time(&time_current);
+                    double diff = difftime(time_current, timeStart);
+                
+                    std::cout<<"\r["<<PACKAGE_NAME<<"_"<<stageName<<"]: "
+                             << "Processed "<<readCounter<<" ...";
+                    std::cout<<diff<<" sec"<<std::flush;
+                    log_counter = 0;
+                }
+                log_counter++;
+                readCounter++;
+            }
+        
+            if (batch->mSize == 0) 
+            {
+                free_batches.push_back(batch);
+            } 
+            else if (workers.empty()) 
+            {
+                // couldn't get any threads so do it ourselves
+                work(batch, context);
+                merge(batch, context);
+                free_batches.push_back(batch);
+            } 
+            else 
+            {
+                todo.push(batch);
+                next_batch_id++;
+            }
+        }
+    
+        // no more reads, merge what the workers have left
+        while (next_to_merge < next_batch_id) 
+        {
+            pthread_mutex_lock(&error_lock);
+            bool stop = failed;
+            pthread_mutex_unlock(&error_lock);
+            if (stop) 
+            {
+                break;
+            }
+            collectBatch(done, finished, next_to_merge, free_batches, merge, context);
+        }
+    } catch (crispr::exception& e) {
+        reportBatchError(&payload, e.what());
+    } catch (std::exception& e) {
+        reportBatchError(&payload, e.what());
+    }
+    
+    // let the workers drain the queue and stop
+    todo.close();
+    std::vector<pthread_t>::iterator worker_iter;
+    for (worker_iter = workers.begin(); worker_iter != workers.end(); ++worker_iter) 
+    {
+        pthread_join(*worker_iter, NULL);
+    }
+    pthread_mutex_destroy(&error_lock);
+    
+    // anything that was not merged is cleaned up with the batch
+    std::vector<ReadBatch *>::iterator batch_iter;
+    for (batch_iter = all_batches.begin(); batch_iter != all_batches.end(); ++batch_iter) 
+    {
+        delete *batch_iter;
+    }
+    
+    if (failed) 
+    {
+        std::cerr<<error_message<<std::endl;
+        throw crispr::exception(__FILE__, 
+                                __LINE__, 
+                                __PRETTY_FUNCTION__,
+                                "Fatal error in threaded search!");
+    }
+    return max_read_length;
+}
+
+typedef struct _search_context {
+    const options * opts;
+    ReadMap * mReads;
+    ReadHolderPool * readPool;
+    StringCheck * mStringCheck;
+    lookupTable * patternsHash;
+    lookupTable * readsFound;
+    ReadSpill * spill;
+    const DRLibrary * library;
+    const DRLibrary * knownRepeats;
+} SearchContext;
+
+static bool nextRead(MappedReader * mapped, kseq_t * seq, ReadView& read)
+{
+    //-----
+    // the next read from whichever reader is in use, false at the end
+    //
+    if (mapped != NULL) 
+    {
+        return mapped->next(read);
+    }
+    if (kseq_read(seq) < 0) 
+    {
+        return false;
+    }
+    read.assign(seq);
+    return true;
+}
+
+static bool inSample(unsigned long index, const options& opts)
+{
+    //-----
+    // When subsampling only some of the reads go to searchCore. Below
+    // one it is the fraction of reads, spread evenly through the file,
+    // otherwise it is how many reads from the start of each file. The
+    // rest are only recruited by findSingletons
+    //
+    if (opts.subsample <= 0) 
+    {
+        return true;
+    }
+    if (opts.subsample < 1) 
+    {
+        return floor((index + 1) * opts.subsample) != floor(index * opts.subsample);
+    }
+    return index < opts.subsample;
+}
+
+static bool worthSearching(const ReadView& read, const options& opts)
+{
+    //-----
+    // The kmer engine indexes the whole read anyway so every read
+    // goes to searchCore. For the CRT search a read where no window
+    // is repeated can't have a CRISPR so it isn't copied at all
+    //
+    if (opts.searchEngine != CRT_ENGINE) 
+    {
+        return true;
+    }
+    return hasRepeatedWindow(read.mSeq, static_cast<unsigned int>(read.mSeqLength), opts);
+}
+
+static bool findKnownRepeat(const ReadView& read, const DRLibrary * library, ReadHolder& holder)
+{
+    //-----
+    // A read that searchCore passed over can still have a repeat from
+    // the library in it, recruit it now rather than in the second pass
+    //
+    unsigned int start, end;
+    if (library == NULL || ! library->find(read.mSeq, read.mSeqLength, start, end)) 
+    {
+        return false;
+    }
+    fillReadHolder(read, holder);
+    holder.startStopsAdd(start, end);
+    return true;
+}
+
+static bool seedKnownRepeats(const ReadView& read, const DRLibrary * knownRepeats, const options& opts, ReadHolder& holder)
+{
+    //-----
+    // A read with a known repeat in it doesn't need the window search,
+    // every copy of the repeat becomes a start and stop. The copies have
+    // to pass the same tests on their number and the spacers between
+    // them that searchCore uses, otherwise the read is searched as
+    // normal. Reads with a single repeat are left for the second pass,
+    // as they are without the known repeats
+    //
+    StartStopList start_stops;
+    if (knownRepeats == NULL || ! knownRepeats->findAll(read.mSeq, read.mSeqLength, start_stops)) 
+    {
+        return false;
+    }
+    if (start_stops.size() / 2 < opts.minNumRepeats) 
+    {
+        return false;
+    }
+    for (size_t i = 2; i < start_stops.size(); i += 2) 
+    {
+        int spacer_length = static_cast<int>(start_stops[i]) - static_cast<int>(start_stops[i - 1]) - 1;
+        if (spacer_length < static_cast<int>(opts.lowSpacerSize) || spacer_length > static_cast<int>(opts.highSpacerSize)) 
+        {
+            return false;
+        }
+    }
+    fillReadHolder(read, holder);
+    StartStopListIterator ss_iter;
+    for (ss_iter = start_stops.begin(); ss_iter != start_stops.end(); ss_iter += 2) 
+    {
+        holder.startStopsAdd(*ss_iter, *(ss_iter + 1));
+    }
+    return true;
+}
+
+static void searchBatch(ReadBatch * batch, void * context)
+{
+    //-----
+    // Run searchCore over a batch and keep the hits in read order.
+    // Nothing shared is touched in here
+    //
+    SearchContext * search = static_cast<SearchContext *>(context);
+    KmerRepeatFinder kmer_finder;
+    for (size_t i = 0; i < batch->mSize; ++i) 
+    {
+        ReadView read = batch->mRecords[i].view();
+        bool crispr_read = false;
+        ReadHolder tmp_holder;
+        if (inSample(batch->mFirstRead + i, *(search->opts)) && worthSearching(read, *(search->opts))) 
+        {
+            crispr_read = seedKnownRepeats(read, search->knownRepeats, *(search->opts), tmp_holder);
+            if (! crispr_read) 
+            {
+                fillReadHolder(read, tmp_holder);
+                crispr_read = searchCore(tmp_holder, *(search->opts), kmer_finder);
+            }
+        }
+        if (! crispr_read) 
+        {
+            ReadHolder known_holder;
+            crispr_read = findKnownRepeat(read, search->library, known_holder);
+            if (crispr_read) 
+            {
+                tmp_holder = known_holder;
+            }
+        }
+        if (crispr_read) 
+        {
+            SearchHit hit;
+            hit.index = i;
+            hit.firstRepeat = tmp_holder.repeatStringAt(0);
+            hit.holder = prepareReadHolder(search->readPool, tmp_holder, hit.drLowLexi);
+            batch->mHits.push_back(hit);
+        }
+    }
+}
+
+static void mergeSearchBatch(ReadBatch * batch, void * context)
+{
+    //-----
+    // Move the hits into the shared containers exactly as the
+    // single threaded search would have added them. Everything
+    // else goes to the spill file if we have one
+    //
+    SearchContext * search = static_cast<SearchContext *>(context);
+    std::vector<SearchHit>::iterator hit_iter = batch->mHits.begin();
+    for (size_t i = 0; i < batch->mSize; ++i) 
+    {
+        if (hit_iter != batch->mHits.end() && hit_iter->index == i) 
+        {
+            insertReadHolder(search->mReads, search->mStringCheck, hit_iter->holder, hit_iter->drLowLexi);
+            (*(search->patternsHash))[hit_iter->firstRepeat] = true;
+            (*(search->readsFound))[hit_iter->holder->getHeader()] = true;
+            ++hit_iter;
+        } 
+        else if (search->spill != NULL) 
+        {
+            search->spill->add(batch->mRecords[i].view());
+        }
+    }
+    batch->mHits.clear();
+}
+
+static int searchFileThreaded(const char *inputFastq, 
+                              const options& opts, 
+                              ReadMap * mReads, 
+                              ReadHolderPool * readPool, 
+                              StringCheck * mStringCheck, 
+                              lookupTable& patternsHash, 
+                              lookupTable& readsFound,
+                              time_t& time_start,
+                              ReadSpill * spill,
+                              const DRLibrary * library,
+                              const DRLibrary * knownRepeats
+                              )
+{
+    int& read_counter = search_read_counter;
+    
+    // uncompressed files are read straight out of a memory map
+    MappedReader mapped;
+    GzipReader * fp = NULL;
+    kseq_t * seq = NULL;
+    bool use_map = mapped.open(inputFastq);
+    if (! use_map) 
+    {
+        fp = getFileHandle(inputFastq, opts.numThreads);
+        seq = kseq_init(fp);
+    }
+    
+    SearchContext context;
+    context.opts = &opts;
+    context.mReads = mReads;
+    context.readPool = readPool;
+    context.mStringCheck = mStringCheck;
+    context.patternsHash = &patternsHash;
+    context.readsFound = &readsFound;
+    context.spill = spill;
+    context.library = library;
+    context.knownRepeats = knownRepeats;
+    
+    int max_read_length;
+    try {
+        max_read_length = processReadsThreaded(seq, 
+                                               (use_map) ? &mapped : NULL,
+                                               NULL,
+                                               opts.numThreads, 
+                                               "patternFinder", 
+                                               searchBatch, 
+                                               mergeSearchBatch, 
+                                               &context, 
+                                               read_counter, 
+                                               time_start);
+    } catch (crispr::exception& e) {
+        kseq_destroy(seq);
+        delete fp;
+        throw;
+    }
+    kseq_destroy(seq); // destroy seq
+    delete fp;
+    
+    logInfo("finished processing file:"<<inputFastq, 1);    
+    time_t time_current;
+    time(&time_current);
+    double diff = difftime(time_current, time_start);
+    std::cout<<"\r["<<PACKAGE_NAME<<"_patternFinder]: "<< "Processed "<<read_counter<<" ...";
+    std::cout<<diff<<" sec"<<std::flush;
+    logInfo("So far " << mReads->size()<<" direct repeat variants have been found from " << read_counter << " reads", 2);
+    
+    return max_read_length;
+}
+#endif
+
 int searchFile(const char *inputFastq, 
                       const options& opts, 
                       ReadMap * mReads, 
+                      ReadHolderPool * readPool, 
                       StringCheck * mStringCheck, 
                       lookupTable& patternsHash, 
                       lookupTable& readsFound,
-                      time_t& time_start
+                      time_t& time_start,
+                      ReadSpill * spill,
+                      const DRLibrary * library,
+                      const DRLibrary * knownRepeats
                       )
 
 {
@@ -80,21 +652,41 @@ int searchFile(const char *inputFastq,
     // depending on the length of the read. 
 	// this funciton may use the boyer moore algorithm
     // or the CRT search algorithm
+    // If there is a spill file the reads without DRs are kept in it.
+    // If there is a library the reads with a known DR are recruited.
+    // Reads with more than one copy of a known repeat skip the window
+    // search. When subsampling the reads outside the sample aren't
+    // searched at all
     //
-    gzFile fp = getFileHandle(inputFastq);
-    kseq_t * seq;
-
-    // initialize seq
-    seq = kseq_init(fp);
+#ifdef HAVE_PTHREAD
+    if (opts.numThreads > 1) 
+    {
+        return searchFileThreaded(inputFastq, opts, mReads, readPool, mStringCheck, patternsHash, readsFound, time_start, spill, library, knownRepeats);
+    }
+#endif
+    // uncompressed files are read straight out of a memory map
+    MappedReader mapped;
+    GzipReader * fp = NULL;
+    kseq_t * seq = NULL;
+    bool use_map = mapped.open(inputFastq);
+    if (! use_map) 
+    {
+        fp = getFileHandle(inputFastq, opts.numThreads);
+        seq = kseq_init(fp);
+    }
     
     int l, log_counter, max_read_length;
     log_counter = max_read_length = 0;
-    static int read_counter = 0;
+    int& read_counter = search_read_counter;
+    unsigned long read_index = 0;
     time_t time_current;
+    ReadView read;
+    KmerRepeatFinder kmer_finder;
     
     // read sequence  
-    while ( (l = kseq_read(seq)) >= 0 ) 
+    while (nextRead((use_map) ? &mapped : NULL, seq, read)) 
     {
+        l = static_cast<int>(read.mSeqLength);
         max_read_length = (l > max_read_length) ? l : max_read_length;
         if (log_counter == CRASS_DEF_READ_COUNTER_LOGGER) 
         {
@@ -108,40 +700,50 @@ int searchFile(const char *inputFastq,
             log_counter = 0;
         }
         try {
-            // grab a readholder
-            ReadHolder tmp_holder;
-            tmp_holder.setSequence(seq->seq.s);tmp_holder.setHeader( seq->name.s);
+            // only reads that might have a repeat are copied into a readholder
+            bool crispr_read = false;
+            if (inSample(read_index, opts) && worthSearching(read, opts)) 
+            {
+                ReadHolder tmp_holder;
+                // reads with a known repeat skip the window search
+                crispr_read = seedKnownRepeats(read, knownRepeats, opts, tmp_holder);
+                if (! crispr_read) 
+                {
+                    fillReadHolder(read, tmp_holder);
 #if SEARCH_SINGLETON
-            SearchCheckerList::iterator debug_iter = debugger->find(seq->name.s);
-            if (debug_iter != debugger->end()) {
-                changeLogLevel(10);
-                std::cout<<"Processing interesting read: "<<debug_iter->first<<std::endl;
-            } else {
-                changeLogLevel(opts.logLevel);
-            }
+                    SearchCheckerList::iterator debug_iter = debugger->find(tmp_holder.getHeader());
+                    if (debug_iter != debugger->end()) {
+                        changeLogLevel(10);
+                        std::cout<<"Processing interesting read: "<<debug_iter->first<<std::endl;
+                    } else {
+                        changeLogLevel(opts.logLevel);
+                    }
 #endif
-            // test if it has a comment entry and a quality entry (fastq input file)
-            if (seq->comment.s) 
-            {
-                tmp_holder.setComment(seq->comment.s);
+                    crispr_read = searchCore(tmp_holder, opts, kmer_finder);
+                }
+                if(crispr_read) {
+                    addReadHolder(mReads, readPool, mStringCheck, tmp_holder);
+                    patternsHash[tmp_holder.repeatStringAt(0)] = true;
+                    readsFound[tmp_holder.getHeader()] = true;
+                }
             }
-            if (seq->qual.s) 
-            {
-                tmp_holder.setQual(seq->qual.s);
+            if (! crispr_read) {
+                ReadHolder known_holder;
+                crispr_read = findKnownRepeat(read, library, known_holder);
+                if (crispr_read) {
+                    addReadHolder(mReads, readPool, mStringCheck, known_holder);
+                    patternsHash[known_holder.repeatStringAt(0)] = true;
+                    readsFound[known_holder.getHeader()] = true;
+                }
             }
-            
-
-            bool crispr_read = searchCore(tmp_holder, opts );
-            if(crispr_read) {
-                addReadHolder(mReads, mStringCheck, tmp_holder);
-                patternsHash[tmp_holder.repeatStringAt(0)] = true;
-                readsFound[tmp_holder.getHeader()] = true;
+            if (! crispr_read && spill != NULL) {
+                spill->add(read);
             }
 
         } catch (crispr::exception& e) {
             std::cerr<<e.what()<<std::endl;
             kseq_destroy(seq);
-            gzclose(fp);
+            delete fp;
             throw crispr::exception(__FILE__, 
                                     __LINE__, 
                                     __PRETTY_FUNCTION__,
@@ -149,10 +751,11 @@ int searchFile(const char *inputFastq,
         }
         log_counter++;
         read_counter++;
+        read_index++;
     }
     
     kseq_destroy(seq); // destroy seq
-    gzclose(fp);
+    delete fp;
     
     logInfo("finished processing file:"<<inputFastq, 1);    
     time(&time_current);
@@ -171,13 +774,33 @@ int scanRight(ReadHolder&  tmp_holder,
               std::string& pattern, 
               unsigned int minSpacerLength, 
               unsigned int scanRange)
+{
+    BmpTable bmp_last;
+    PatternMatcher::computeBmpLast(pattern.data(), pattern.length(), bmp_last);
+    return scanRight(tmp_holder, 
+                     pattern.data(), 
+                     static_cast<unsigned int>(pattern.length()), 
+                     bmp_last, 
+                     minSpacerLength, 
+                     scanRange);
+}
+
+int scanRight(ReadHolder&  tmp_holder, 
+              const char * pattern, 
+              unsigned int patternLength, 
+              const BmpTable& bmpLast, 
+              unsigned int minSpacerLength, 
+              unsigned int scanRange)
 {
 #ifdef DEBUG
     logInfo("Scanning Right for more repeats:", 9);
 #endif
     unsigned int start_stops_size = tmp_holder.getStartStopListSize();
     
-    unsigned int pattern_length = static_cast<unsigned int>(pattern.length());
+    unsigned int pattern_length = patternLength;
+    
+    // the search windows are read straight out of the sequence
+    const std::string& read = tmp_holder.getSeqRef();
     
     // final start index
     unsigned int last_repeat_index = tmp_holder.getRepeatAt(start_stops_size - 2);
@@ -234,12 +857,14 @@ int scanRight(ReadHolder&  tmp_holder,
         }
         /******************** end range checks ********************/
         
-        std::string text = tmp_holder.substr(begin_search, (end_search - begin_search));
-        
         #ifdef DEBUG
-        logInfo(pattern<<" : "<<text, 9);
+        logInfo(std::string(pattern, pattern_length)<<" : "<<read.substr(begin_search, (end_search - begin_search)), 9);
         #endif
-        position = PatternMatcher::bmpSearch(text, pattern);
+        position = PatternMatcher::bmpSearch(read.data() + begin_search, 
+                                             end_search - begin_search, 
+                                             pattern, 
+                                             pattern_length, 
+                                             bmpLast);
         
         
         if (position >= 0)
@@ -262,8 +887,68 @@ int scanRight(ReadHolder&  tmp_holder,
     return begin_search + position;
 }
 
+bool hasRepeatedWindow(const char * read, 
+                       unsigned int seqLength, 
+                       const options& opts)
+{
+    //-----
+    // The first thing searchCore does is look for a search window that
+    // is found again further along the read, and it can only find a
+    // CRISPR if there is one. The windows are tried in the same order
+    // and over the same ranges here, without a readholder. Reads that
+    // are too short are passed on so that searchCore can warn about them
+    //
+    unsigned int skips = opts.lowDRsize - (2 * opts.searchWindowLength - 1);
+    if (skips < 1)
+    {
+        skips = 1;
+    }
+    int searchEnd = seqLength - opts.lowDRsize - opts.lowSpacerSize - opts.searchWindowLength - 1;
+    if (searchEnd < 0) 
+    {
+        return true;
+    }
+    
+    BmpTable bmp_last;
+    PatternMatcher::clearBmpLast(bmp_last);
+    for (unsigned int j = 0; j <= static_cast<unsigned int>(searchEnd); j = j + skips)
+    {
+        unsigned int beginSearch = j + opts.lowDRsize + opts.lowSpacerSize;
+        unsigned int endSearch = j + opts.highDRsize + opts.highSpacerSize + opts.searchWindowLength;
+        if (endSearch >= seqLength)
+        {
+            endSearch = seqLength - 1;
+        }
+        if (endSearch < beginSearch)
+        {
+            endSearch = beginSearch;
+        }
+        const char * pattern = read + j;
+        PatternMatcher::setBmpLast(pattern, opts.searchWindowLength, bmp_last);
+        int position = PatternMatcher::bmpSearch(read + beginSearch, 
+                                                 endSearch - beginSearch, 
+                                                 pattern, 
+                                                 opts.searchWindowLength, 
+                                                 bmp_last);
+        PatternMatcher::unsetBmpLast(pattern, opts.searchWindowLength, bmp_last);
+        if (position >= 0) 
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 int searchCore(ReadHolder& tmpHolder, 
                    const options& opts)
+{
+    KmerRepeatFinder kmer_finder;
+    return searchCore(tmpHolder, opts, kmer_finder);
+}
+
+int searchCore(ReadHolder& tmpHolder, 
+                   const options& opts,
+                   KmerRepeatFinder& kmerFinder)
 {
     //-----
     // Code lifted from CRT, ported by Connor and hacked by Mike.
@@ -286,12 +971,23 @@ int searchCore(ReadHolder& tmpHolder,
 
     int searchEnd = seq_length - opts.lowDRsize - opts.lowSpacerSize - opts.searchWindowLength - 1;
     
+    BmpTable bmp_last;
+    PatternMatcher::clearBmpLast(bmp_last);
+    
     if (searchEnd < 0) 
     {
         logWarn("Read "<<tmpHolder.getHeader()<<" is too short. With current parameters, the minimum length must be "<<opts.lowDRsize + opts.lowSpacerSize + opts.searchWindowLength + 1<<"bp (read is "<< seq_length << "bp)", 3);
         return false;
     }
     
+    // the kmer engine indexes the read once and looks each window up in
+    // the index instead of searching the downstream range for it
+    bool use_kmers = (opts.searchEngine == KMER_ENGINE);
+    if (use_kmers)
+    {
+        kmerFinder.index(read, opts.searchWindowLength);
+    }
+    
     for (unsigned int j = 0; j <= static_cast<unsigned int>(searchEnd); j = j + skips)
     {
                     
@@ -308,35 +1004,26 @@ int searchCore(ReadHolder& tmpHolder,
             endSearch = beginSearch;
         }
         
-        std::string text;
-        std::string pattern;
-        try {
-            text = read.substr(beginSearch, (endSearch - beginSearch));
-
-        } catch (std::exception& e) {
-            throw crispr::substring_exception(e.what(), 
-                                              text.c_str(), 
-                                              beginSearch, 
-                                              (endSearch - beginSearch), 
-                                              __FILE__, 
-                                              __LINE__, 
-                                              __PRETTY_FUNCTION__);
-        }
-        try {
-            pattern = read.substr(j, opts.searchWindowLength);
-        } catch (std::exception& e) {
-            throw crispr::substring_exception(e.what(), 
-                                              read.c_str(), 
-                                              j, 
-                                              opts.searchWindowLength, 
-                                              __FILE__, 
-                                              __LINE__, 
-                                              __PRETTY_FUNCTION__);
-        }
+        // the pattern and the text are searched in place, the bad character
+        // table is set up once here and used again by scanRight
+        const char * text = read.data() + beginSearch;
+        const char * pattern = read.data() + j;
+        PatternMatcher::setBmpLast(pattern, opts.searchWindowLength, bmp_last);
 
         //if pattern is found, add it to candidate list and scan right for additional similarly spaced repeats
         int pattern_in_text_index = -1;
-            pattern_in_text_index = PatternMatcher::bmpSearch(text, pattern);
+        if (use_kmers && kmerFinder.isIndexed(j))
+        {
+            pattern_in_text_index = kmerFinder.findRepeat(j, beginSearch, endSearch);
+        }
+        else
+        {
+            pattern_in_text_index = PatternMatcher::bmpSearch(text, 
+                                                              endSearch - beginSearch, 
+                                                              pattern, 
+                                                              opts.searchWindowLength, 
+                                                              bmp_last);
+        }
 
         if (pattern_in_text_index >= 0)
         {
@@ -344,8 +1031,9 @@ int searchCore(ReadHolder& tmpHolder,
             unsigned int found_pattern_start_index = beginSearch + static_cast<unsigned int>(pattern_in_text_index);
             
             tmpHolder.startStopsAdd(found_pattern_start_index, found_pattern_start_index + opts.searchWindowLength - 1);
-            scanRight(tmpHolder, pattern, opts.lowSpacerSize, 24);
+            scanRight(tmpHolder, pattern, opts.searchWindowLength, bmp_last, opts.lowSpacerSize, 24);
         }
+        PatternMatcher::unsetBmpLast(pattern, opts.searchWindowLength, bmp_last);
 
         if ( (tmpHolder.numRepeats() >= opts.minNumRepeats) ) //tmp_holder->numRepeats is half the size of the StartStopList
         {
@@ -398,12 +1086,31 @@ int searchCore(ReadHolder& tmpHolder,
 
 typedef struct _multisearch_payload {
     ReadMap * mReads;
+    ReadHolderPool * readPool;
     StringCheck * mStringCheck;
     kseq_t * read;
     lookupTable *readsFound;
     MEMREF * pattv;
+    bool everyCopy;
 } MultisearchPayload;
 
+static void addEveryCopy(const char * seq, size_t seqLength, const MEMREF& pattern, unsigned int drEnd, ReadHolder& holder)
+{
+    //-----
+    // When only a sample of the reads was searched most of the reads
+    // with a whole CRISPR are recruited by the singleton finder, so
+    // they get every copy of the repeat rather than just the first
+    //
+    const char * seq_end = seq + seqLength;
+    const char * pos = seq + drEnd + 1;
+    while ((pos = std::search(pos, seq_end, pattern.ptr, pattern.ptr + pattern.len)) != seq_end) 
+    {
+        unsigned int start = static_cast<unsigned int>(pos - seq);
+        holder.startStopsAdd(start, start + static_cast<unsigned int>(pattern.len) - 1);
+        pos += pattern.len;
+    }
+}
+
 
 static int on_match(int strnum, int textpos, MultisearchPayload *payload)
 {
@@ -435,19 +1142,106 @@ static int on_match(int strnum, int textpos, MultisearchPayload *payload)
         }
         //logInfo("textpos: "<<textpos<<" DR_end: "<<DR_end<<" start: "<<DR_end << " len: "<< payload->pattv[strnum].len, 1)
         tmp_holder.startStopsAdd(DR_end - (payload->pattv[strnum].len - 1), DR_end);
-        addReadHolder(payload->mReads, payload->mStringCheck, tmp_holder);
+        if (payload->everyCopy) 
+        {
+            addEveryCopy(payload->read->seq.s, payload->read->seq.l, payload->pattv[strnum], DR_end, tmp_holder);
+        }
+        addReadHolder(payload->mReads, payload->readPool, payload->mStringCheck, tmp_holder);
     }
 
     return 1;
 }
 
-void findSingletons(const char *inputFastq, 
-                    const options &opts, 
-                    std::vector<std::string> * nonRedundantPatterns, 
-                    lookupTable &readsFound, 
-                    ReadMap * mReads, 
-                    StringCheck * mStringCheck,
-                    time_t& startTime)
+typedef struct _singleton_context {
+    ACISM * psp;
+    MEMREF * pattv;
+    lookupTable * readsFound;
+    ReadMap * mReads;
+    ReadHolderPool * readPool;
+    StringCheck * mStringCheck;
+    bool everyCopy;
+} SingletonContext;
+
+typedef struct _singleton_match {
+    bool found;
+    int strnum;
+    int textpos;
+} SingletonMatch;
+
+static int on_batch_match(int strnum, int textpos, SingletonMatch *match)
+{
+    // like on_match we stop at the first pattern found
+    match->found = true;
+    match->strnum = strnum;
+    match->textpos = textpos;
+    return 1;
+}
+
+static void singletonBatch(ReadBatch * batch, void * context)
+{
+    //-----
+    // Scan a batch with the shared automaton. It is read only once it
+    // has been created and readsFound doesn't change during this pass,
+    // so the matches can be made into readholders here and kept in the
+    // batch until the main thread merges them
+    //
+    SingletonContext * singleton = static_cast<SingletonContext *>(context);
+    for (size_t i = 0; i < batch->mSize; ++i) 
+    {
+        ReadRecord& record = batch->mRecords[i];
+        if (singleton->readsFound->find(record.mHeader) != singleton->readsFound->end()) 
+        {
+            continue;
+        }
+        
+        SingletonMatch match;
+        match.found = false;
+        MEMREF tmp = {record.mSeq.c_str(), record.mSeq.length()};
+        (void)acism_scan(singleton->psp, tmp, (ACISM_ACTION*)on_batch_match, &match);
+        if (! match.found) 
+        {
+            continue;
+        }
+        
+#ifdef DEBUG
+        logInfo("new read recruited: "<<record.mHeader, 9);
+        logInfo(record.mSeq, 10);
+#endif
+        // same as on_match
+        unsigned int DR_end = static_cast<unsigned int>(match.textpos - 1);
+        if(DR_end >= static_cast<unsigned int>(record.mSeq.length()))
+        {
+            DR_end = static_cast<unsigned int>(record.mSeq.length()) - 1;
+        }
+        ReadHolder tmp_holder;
+        record.fill(tmp_holder);
+        tmp_holder.startStopsAdd(DR_end - (singleton->pattv[match.strnum].len - 1), DR_end);
+        if (singleton->everyCopy) 
+        {
+            addEveryCopy(record.mSeq.c_str(), record.mSeq.length(), singleton->pattv[match.strnum], DR_end, tmp_holder);
+        }
+        
+        SearchHit hit;
+        hit.index = i;
+        hit.holder = prepareReadHolder(singleton->readPool, tmp_holder, hit.drLowLexi);
+        batch->mHits.push_back(hit);
+    }
+}
+
+static void mergeSingletonBatch(ReadBatch * batch, void * context)
+{
+    SingletonContext * singleton = static_cast<SingletonContext *>(context);
+    std::vector<SearchHit>::iterator hit_iter;
+    for (hit_iter = batch->mHits.begin(); hit_iter != batch->mHits.end(); ++hit_iter) 
+    {
+        insertReadHolder(singleton->mReads, singleton->mStringCheck, hit_iter->holder, hit_iter->drLowLexi);
+    }
+    batch->mHits.clear();
+}
+
+static ACISM * createSingletonAutomaton(std::vector<std::string> * nonRedundantPatterns, 
+                                        char ** concstr, 
+                                        MEMREF ** pattv)
 {
     std::string conc;
     std::vector<std::string>::iterator iter;
@@ -458,31 +1252,108 @@ void findSingletons(const char *inputFastq,
     // this is a hack as refsplit creates an extra blank record, which stuffs
     // up the search if the string ends with a new line character. Basically
     // here I'm replacing the last newline with null to prevent this
-    char * concstr = new char[conc.size() + 1];
-    std::copy(conc.begin(), conc.end(), concstr);
-    concstr[conc.size()] = '\0';
-    concstr[conc.size()-1] = '\0';
+    *concstr = new char[conc.size() + 1];
+    std::copy(conc.begin(), conc.end(), *concstr);
+    (*concstr)[conc.size()] = '\0';
+    (*concstr)[conc.size()-1] = '\0';
     int npatts;
 
-    MEMREF *pattv = refsplit(concstr, '\n', &npatts);
+    *pattv = refsplit(*concstr, '\n', &npatts);
+
+    return acism_create(*pattv, npatts);
+}
+
+#ifdef HAVE_PTHREAD
+static void findSingletonsThreaded(kseq_t * seq,
+                                   ReadSpill * spill,
+                                   const options &opts, 
+                                   ACISM * psp,
+                                   MEMREF * pattv,
+                                   lookupTable &readsFound, 
+                                   ReadMap * mReads, 
+                                   ReadHolderPool * readPool, 
+                                   StringCheck * mStringCheck,
+                                   time_t& startTime)
+{
+    int& read_counter = singleton_read_counter;
+    
+    SingletonContext context;
+    context.psp = psp;
+    context.pattv = pattv;
+    context.readsFound = &readsFound;
+    context.mReads = mReads;
+    context.readPool = readPool;
+    context.mStringCheck = mStringCheck;
+    context.everyCopy = (opts.subsample > 0);
+    
+    processReadsThreaded(seq, 
+                         NULL,
+                         spill,
+                         opts.numThreads, 
+                         "singletonFinder", 
+                         singletonBatch, 
+                         mergeSingletonBatch, 
+                         &context, 
+                         read_counter, 
+                         startTime);
+    
+    time_t time_current;
+    time(&time_current);
+    double diff = difftime(time_current, startTime);
+    std::cout<<"\r["<<PACKAGE_NAME<<"_singletonFinder]: "<<"Processed "<<read_counter<<" ...";
+    std::cout<<diff<<" sec"<<std::flush;
+}
+#endif
 
-    ACISM *psp = acism_create(pattv, npatts);
+void findSingletons(const char *inputFastq, 
+                    const options &opts, 
+                    std::vector<std::string> * nonRedundantPatterns, 
+                    lookupTable &readsFound, 
+                    ReadMap * mReads, 
+                    ReadHolderPool * readPool, 
+                    StringCheck * mStringCheck,
+                    time_t& startTime)
+{
+    char * concstr;
+    MEMREF * pattv;
+    ACISM *psp = createSingletonAutomaton(nonRedundantPatterns, &concstr, &pattv);
 
-    gzFile fp = getFileHandle(inputFastq);
+    GzipReader * fp = getFileHandle(inputFastq, opts.numThreads);
     kseq_t *seq;
     seq = kseq_init(fp);
 
+#ifdef HAVE_PTHREAD
+    if (opts.numThreads > 1) 
+    {
+        try {
+            findSingletonsThreaded(seq, NULL, opts, psp, pattv, readsFound, mReads, readPool, mStringCheck, startTime);
+        } catch (crispr::exception& e) {
+            delete fp;
+            kseq_destroy(seq);
+            throw;
+        }
+        delete fp;
+        kseq_destroy(seq); // destroy seq
+        acism_destroy(psp);
+        free(pattv);
+        delete[] concstr;
+        return;
+    }
+#endif
+
     int l;
     int log_counter = 0;
-    static int read_counter = 0;
+    int& read_counter = singleton_read_counter;
 
     time_t time_current;
 
     MultisearchPayload payload;
     payload.mReads = mReads;
+    payload.readPool = readPool;
     payload.mStringCheck = mStringCheck;
     payload.pattv = pattv;
     payload.readsFound = &readsFound;
+    payload.everyCopy = (opts.subsample > 0);
     
     while ( (l = kseq_read(seq)) >= 0 ) 
     {
@@ -506,8 +1377,10 @@ void findSingletons(const char *inputFastq,
         read_counter++;
     }
 
-    gzclose(fp);
+    delete fp;
     kseq_destroy(seq); // destroy seq
+    acism_destroy(psp);
+    free(pattv);
     delete[] concstr;
 
     time(&time_current);
@@ -517,6 +1390,89 @@ void findSingletons(const char *inputFastq,
     
 }
 
+void findSingletons(ReadSpill * spill, 
+                    const options &opts, 
+                    std::vector<std::string> * nonRedundantPatterns, 
+                    lookupTable &readsFound, 
+                    ReadMap * mReads, 
+                    ReadHolderPool * readPool, 
+                    StringCheck * mStringCheck,
+                    time_t& startTime)
+{
+    //-----
+    // Same as above but the reads come out of the spill file made during
+    // the search, so the input files only have to be read once
+    //
+    char * concstr;
+    MEMREF * pattv;
+    ACISM *psp = createSingletonAutomaton(nonRedundantPatterns, &concstr, &pattv);
+
+    spill->rewind();
+
+#ifdef HAVE_PTHREAD
+    if (opts.numThreads > 1) 
+    {
+        findSingletonsThreaded(NULL, spill, opts, psp, pattv, readsFound, mReads, readPool, mStringCheck, startTime);
+        acism_destroy(psp);
+        free(pattv);
+        delete[] concstr;
+        return;
+    }
+#endif
+
+    int log_counter = 0;
+    int& read_counter = singleton_read_counter;
+
+    time_t time_current;
+
+    SingletonContext context;
+    context.psp = psp;
+    context.pattv = pattv;
+    context.readsFound = &readsFound;
+    context.mReads = mReads;
+    context.readPool = readPool;
+    context.mStringCheck = mStringCheck;
+    context.everyCopy = (opts.subsample > 0);
+
+    ReadBatch batch;
+    bool more_reads = true;
+    while (more_reads) 
+    {
+        batch.reset(0);
+        while (batch.mSize < CRASS_DEF_READ_BATCH_SIZE) 
+        {
+            if (! spill->next(batch.nextRecord())) 
+            {
+                // give back the slot we didn't fill
+                batch.mSize--;
+                more_reads = false;
+                break;
+            }
+            if (log_counter == CRASS_DEF_READ_COUNTER_LOGGER) 
+            {
+                time(&time_current);
+                double diff = difftime(time_current, startTime);
+                std::cout<<"\r["<<PACKAGE_NAME<<"_singletonFinder]: "<<"Processed "<<read_counter<<" ...";
+                std::cout<<diff<<" sec"<<std::flush;
+                log_counter = 0;
+            }
+            log_counter++;
+            read_counter++;
+        }
+        singletonBatch(&batch, &context);
+        mergeSingletonBatch(&batch, &context);
+    }
+
+    acism_destroy(psp);
+    free(pattv);
+    delete[] concstr;
+
+    time(&time_current);
+    double diff = difftime(time_current, startTime);
+    std::cout<<"\r["<<PACKAGE_NAME<<"_singletonFinder]: "<<"Processed "<<read_counter<<" ...";
+    std::cout<<diff<<" sec"<<std::flush;
+}
+
 unsigned int extendPreRepeat(ReadHolder&  tmp_holder, int searchWindowLength, int minSpacerLength)
 {
 #ifdef DEBUG
@@ -1012,7 +1968,8 @@ bool qcFoundRepeats(ReadHolder& tmp_holder, int minSpacerLength, int maxSpacerLe
         {
             return false;
         }
-        float similarity = PatternMatcher::getStringSimilarity(repeat, spacer);
+        // only which side of the cutoff it falls on matters here
+        float similarity = PatternMatcher::getStringSimilarity(repeat, spacer, CRASS_DEF_SPACER_OR_REPEAT_MAX_SIMILARITY);
         if(! testSpacerRepeatSimilarity(similarity))
         {
             return false;
@@ -1116,37 +2073,176 @@ bool drHasHighlyAbundantKmers(std::string& directRepeat, float& maxFrequency)
     }
 }
 
-void addReadHolder(ReadMap * mReads, 
-                   StringCheck * mStringCheck, 
-                   ReadHolder& tmpReadholder)
+static bool sortLengthAssending(const std::string& a, const std::string& b)
 {
+    return a.length() < b.length();
+}
 
-    ReadHolder * candidate = new ReadHolder(tmpReadholder);
-    std::string dr_lowlexi;
+static bool isNotEmpty(const std::string& a)
+{
+    return !a.empty();
+}
+
+typedef struct _redundant_repeat_payload {
+    std::vector<size_t> * firstSeen;                // earliest repeat that gave each pattern
+    std::vector<size_t> * lengths;
+    size_t current;                                 // the repeat being scanned
+    size_t currentLength;
+    bool redundant;
+} RedundantRepeatPayload;
+
+static int on_redundant_match(int strnum, int textpos, RedundantRepeatPayload * payload)
+{
+    // anything shorter counts, the same length means it's the same string
+    // so it only counts if it came from an earlier repeat
+    if ((*(payload->lengths))[strnum] < payload->currentLength ||
+        (*(payload->firstSeen))[strnum] < payload->current) 
+    {
+        payload->redundant = true;
+        return 1;
+    }
+    return 0;
+}
+
+void removeRedundantRepeats(std::vector<std::string>& repeatVector)
+{
+    //-----
+    // Given a vector of repeat sequences, will order the vector based on
+    // repeat length and then remove longer repeats if there is a shorter
+    // one, or its reverse complement, that is a perfect substring.
+    //
+    // Being a substring is transitive, so a repeat goes if any repeat
+    // before it is inside it, whether or not that one was removed. All the
+    // repeats and their reverse complements go into one Aho-Corasick
+    // automaton and each repeat is scanned once, rather than comparing
+    // every pair
+    //
+    std::sort(repeatVector.begin(), repeatVector.end(), sortLengthAssending);
+    
+    // the automaton can't have the same pattern twice, so remember the
+    // earliest repeat each distinct pattern came from
+    std::map<std::string, size_t> patterns;
+    for (size_t i = 0; i < repeatVector.size(); ++i) 
+    {
+        if (repeatVector[i].empty()) 
+        {
+            continue;
+        }
+        patterns.insert(std::pair<std::string, size_t>(repeatVector[i], i));
+        patterns.insert(std::pair<std::string, size_t>(reverseComplement(repeatVector[i]), i));
+    }
+    if (patterns.empty()) 
+    {
+        return;
+    }
+    
+    std::vector<MEMREF> pattv;
+    std::vector<size_t> first_seen;
+    std::vector<size_t> lengths;
+    std::map<std::string, size_t>::iterator pattern_iter;
+    for (pattern_iter = patterns.begin(); pattern_iter != patterns.end(); ++pattern_iter) 
+    {
+        MEMREF pattern = {pattern_iter->first.data(), pattern_iter->first.length()};
+        pattv.push_back(pattern);
+        first_seen.push_back(pattern_iter->second);
+        lengths.push_back(pattern_iter->first.length());
+    }
+    ACISM * psp = acism_create(&(pattv[0]), static_cast<int>(pattv.size()));
+    
+    RedundantRepeatPayload payload;
+    payload.firstSeen = &first_seen;
+    payload.lengths = &lengths;
+    std::vector<bool> redundant(repeatVector.size(), false);
+    for (size_t i = 0; i < repeatVector.size(); ++i) 
+    {
+        if (repeatVector[i].empty()) 
+        {
+            continue;
+        }
+        payload.current = i;
+        payload.currentLength = repeatVector[i].length();
+        payload.redundant = false;
+        MEMREF text = {repeatVector[i].data(), repeatVector[i].length()};
+        (void)acism_scan(psp, text, (ACISM_ACTION*)on_redundant_match, &payload);
+        redundant[i] = payload.redundant;
+    }
+    acism_destroy(psp);
+    
+    // clear the string if it is redundant
+    for (size_t i = 0; i < repeatVector.size(); ++i) 
+    {
+        if (redundant[i]) 
+        {
+            repeatVector[i].clear();
+        }
+    }
+    
+    // ok so now partition the vector so that all the empties are at one end
+    // will return an iterator postion to the first position where the string
+    // is empty
+    std::vector<std::string>::iterator empty_iter = std::partition(repeatVector.begin(), repeatVector.end(), isNotEmpty);
+    // remove all the empties from the list
+    repeatVector.erase(empty_iter, repeatVector.end());
+}
+
+ReadHolder * prepareReadHolder(ReadHolderPool * readPool, ReadHolder& tmpReadholder, std::string& drLowLexi)
+{
+    //-----
+    // Make a copy of the readholder and put it in lowlexi form. This part
+    // doesn't touch anything shared so the search threads can do it
+    //
+    ReadHolder * candidate = readPool->construct(tmpReadholder);
 	try {
-		dr_lowlexi = candidate->DRLowLexi();
+		drLowLexi = candidate->DRLowLexi();
 	} catch(crispr::exception& e) {
 		std::cerr<<e.what()<<std::endl;
+		readPool->destroy(candidate);
 		throw crispr::exception(__FILE__,
 		                        __LINE__,
 		                        __PRETTY_FUNCTION__,
 		                        "Cannot obtain read in lowlexi form"
 		                        );
 	}
+    // from here on the read is only looked at so it's kept packed
+    candidate->pack();
+    return candidate;
+}
 
-    StringToken st = mStringCheck->getToken(dr_lowlexi);
+StringToken insertReadHolder(ReadMap * mReads, 
+                             StringCheck * mStringCheck, 
+                             ReadHolder * candidate, 
+                             std::string& drLowLexi)
+{
+    //-----
+    // File a prepared readholder under the token for its DR. Tokens are
+    // handed out in the order this is called so it must see the reads in
+    // the order they are in the file
+    //
+    StringToken st = mStringCheck->getToken(drLowLexi);
     if(0 == st)
     {
         // new guy
-        st = mStringCheck->addString(dr_lowlexi);
+        st = mStringCheck->addString(drLowLexi);
         (*mReads)[st] = new ReadList();
     }
 
 #ifdef DEBUG
-    logInfo("Direct repeat: "<<dr_lowlexi<<" String Token: "<<st, 10);
+    logInfo("Direct repeat: "<<drLowLexi<<" String Token: "<<st, 10);
 #endif
-    
+
+    (*mReads)[st]->push_back(candidate);
+    return st;
+}
+
+void addReadHolder(ReadMap * mReads, 
+                   ReadHolderPool * readPool, 
+                   StringCheck * mStringCheck, 
+                   ReadHolder& tmpReadholder)
+{
+    std::string dr_lowlexi;
+    ReadHolder * candidate = prepareReadHolder(readPool, tmpReadholder, dr_lowlexi);
 #ifdef SEARCH_SINGLETON
+    StringToken st = insertReadHolder(mReads, mStringCheck, candidate, dr_lowlexi);
     SearchCheckerList::iterator debug_iter = debugger->find(tmpReadholder.getHeader());
     if (debug_iter != debugger->end()) {
         // our read got through to this stage
@@ -1156,8 +2252,7 @@ void addReadHolder(ReadMap * mReads,
         debug_iter->second.token(st);
         std::cout<<debug_iter->first<<" " <<st<<std::endl;
     }
+#else
+    insertReadHolder(mReads, mStringCheck, candidate, dr_lowlexi);
 #endif
-
-    (*mReads)[st]->push_back(candidate);
 }
-
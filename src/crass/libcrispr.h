@@ -49,10 +49,13 @@
 // local includes
 #include "crassDefines.h"
 #include "PatternMatcher.h"
+#include "KmerRepeatFinder.h"
 #include "kseq.h"
 #include "ReadHolder.h"
 #include "SeqUtils.h"
 #include "StringCheck.h"
+#include "ReadSpill.h"
+#include "DRLibrary.h"
 #include "Types.h"
 #if SEARCH_SINGLETON
 #include "SearchChecker.h"
@@ -74,28 +77,65 @@ enum side{rightSide, leftSide};
 int searchFile(const char *inputFile, 
                       const options &opts, 
                       ReadMap * mReads, 
+                      ReadHolderPool * readPool, 
                       StringCheck * mStringCheck, 
                       lookupTable& patternsHash, 
                       lookupTable& readsFound,
-                      time_t& startTime);
+                      time_t& startTime,
+                      ReadSpill * spill,
+                      const DRLibrary * library,
+                      const DRLibrary * knownRepeats);
+
+// false when no search window in the read is found again downstream,
+// in which case searchCore won't find a CRISPR in it either
+bool hasRepeatedWindow(const char * seq, 
+                       unsigned int seqLength, 
+                       const options &opts);
 
 int searchCore(ReadHolder& seq, 
                    const options &opts
                    );
 
+int searchCore(ReadHolder& seq, 
+                   const options &opts,
+                   KmerRepeatFinder& kmerFinder
+                   );
+
 void findSingletons(const char *inputFastq, 
                     const options &opts, 
                     std::vector<std::string> * nonRedundantPatterns, 
                     lookupTable &readsFound, 
                     ReadMap * mReads, 
+                    ReadHolderPool * readPool, 
                     StringCheck * mStringCheck,
                     time_t& startTime);
 
+void findSingletons(ReadSpill * spill, 
+                    const options &opts, 
+                    std::vector<std::string> * nonRedundantPatterns, 
+                    lookupTable &readsFound, 
+                    ReadMap * mReads, 
+                    ReadHolderPool * readPool, 
+                    StringCheck * mStringCheck,
+                    time_t& startTime);
+
+// reads looked at by searchFile and findSingletons since the program
+// started, over every file
+unsigned long readsSearched(void);
+unsigned long readsScannedForSingletons(void);
+
 int scanRight(ReadHolder& tmp_holder, 
               std::string& pattern, 
               unsigned int minSpacerLength, 
               unsigned int scanRange);
 
+int scanRight(ReadHolder& tmp_holder, 
+              const char * pattern, 
+              unsigned int patternLength, 
+              const BmpTable& bmpLast, 
+              unsigned int minSpacerLength, 
+              unsigned int scanRange);
+
 unsigned int extendPreRepeat(ReadHolder& tmp_holder, 
                              int searchWindowLength,
                              int minSpacerLength);
@@ -120,7 +160,19 @@ bool drHasHighlyAbundantKmers(std::string& directRepeat, float& max_count);
 
 bool drHasHighlyAbundantKmers(std::string& directRepeat);
 
+void removeRedundantRepeats(std::vector<std::string>& repeatVector);
+
+ReadHolder * prepareReadHolder(ReadHolderPool * readPool, 
+                               ReadHolder& tmp_holder, 
+                               std::string& drLowLexi);
+
+StringToken insertReadHolder(ReadMap * mReads, 
+                             StringCheck * mStringCheck, 
+                             ReadHolder * candidate, 
+                             std::string& drLowLexi);
+
 void addReadHolder(ReadMap * mReads, 
+                   ReadHolderPool * readPool, 
                    StringCheck * mStringCheck, 
                    ReadHolder& tmp_holder);
 
@@ -0,0 +1,214 @@
+// File: streamreader.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Implementation of the event driven crispr file reader.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+// system includes
+#include <sstream>
+
+// local includes
+#include "streamreader.h"
+
+crispr::xml::streamreader::streamreader()
+{
+    SR_GroupDoc = NULL;
+    SR_Depth = 0;
+    SR_Function = NULL;
+    SR_Context = NULL;
+    SR_Stop = false;
+
+    // Configure SAX2 parser the same way as the DOM parser in reader
+    SR_Parser = xercesc::XMLReaderFactory::createXMLReader();
+    SR_Parser->setFeature(xercesc::XMLUni::fgSAX2CoreValidation, false);
+    SR_Parser->setFeature(xercesc::XMLUni::fgSAX2CoreNameSpaces, false);
+    SR_Parser->setFeature(xercesc::XMLUni::fgXercesSchema, false);
+    SR_Parser->setFeature(xercesc::XMLUni::fgXercesLoadExternalDTD, false);
+    SR_Parser->setContentHandler(this);
+    SR_Parser->setErrorHandler(this);
+
+    XMLCh * core = tc("Core");
+    SR_Impl = xercesc::DOMImplementationRegistry::getDOMImplementation(core);
+    xr(&core);
+}
+
+crispr::xml::streamreader::~streamreader()
+{
+    if (SR_GroupDoc != NULL) 
+    {
+        SR_GroupDoc->release();
+    }
+    delete SR_Parser;
+}
+
+void crispr::xml::streamreader::parse(const char * xmlFile, GroupFunction groupFunction, void * context)
+{
+    SR_Function = groupFunction;
+    SR_Context = context;
+    SR_Stop = false;
+    SR_Depth = 0;
+    SR_OpenElements.clear();
+    try
+    {
+        //-----
+        // progressive parse so that we can stop as soon as the callback
+        // has seen all of the groups that it wants
+        //
+        xercesc::XMLPScanToken token;
+        if (SR_Parser->parseFirst(xmlFile, token)) 
+        {
+            while (!SR_Stop && SR_Parser->parseNext(token)) 
+            {}
+        }
+        SR_Parser->parseReset(token);
+    }
+    catch( xercesc::XMLException& e ) {
+        char* message = xercesc::XMLString::transcode( e.getMessage() );
+        std::stringstream errBuf;
+        errBuf << "Error parsing file: " << message << std::flush;
+        xercesc::XMLString::release( &message );
+        throw crispr::xml_exception(__FILE__, __LINE__, __PRETTY_FUNCTION__,(errBuf.str()).c_str());
+    }
+}
+
+void crispr::xml::streamreader::copyElement(xercesc::DOMElement * element, streamwriter& out)
+{
+    char * c_name = tc(element->getTagName());
+    out.startElement(c_name);
+    xr(&c_name);
+
+    xercesc::DOMNamedNodeMap * attributes = element->getAttributes();
+    for (XMLSize_t i = 0; i < attributes->getLength(); i++) 
+    {
+        xercesc::DOMNode * attr = attributes->item(i);
+        char * c_attr_name = tc(attr->getNodeName());
+        char * c_attr_value = tc(attr->getNodeValue());
+        out.addAttribute(c_attr_name, c_attr_value);
+        xr(&c_attr_name);
+        xr(&c_attr_value);
+    }
+
+    // the whitespace between elements is left to the writer
+    bool text_only = (element->getFirstElementChild() == NULL);
+    for (xercesc::DOMNode * child = element->getFirstChild(); 
+         child != NULL; 
+         child = child->getNextSibling()) 
+    {
+        if (child->getNodeType() == xercesc::DOMNode::ELEMENT_NODE) 
+        {
+            copyElement(static_cast<xercesc::DOMElement *>(child), out);
+        } 
+        else if (text_only && child->getNodeType() == xercesc::DOMNode::TEXT_NODE) 
+        {
+            char * c_text = tc(child->getNodeValue());
+            out.addText(c_text);
+            xr(&c_text);
+        }
+    }
+    out.endElement();
+}
+
+//
+// SAX2 handlers
+//
+void crispr::xml::streamreader::startElement(const XMLCh * const uri,
+                                             const XMLCh * const localname,
+                                             const XMLCh * const qname,
+                                             const xercesc::Attributes& attrs)
+{
+    xercesc::DOMElement * element = NULL;
+    if (SR_Depth == 1) 
+    {
+        // a new group gets a document all of its own, which is thrown away
+        // in one go once the group has been dealt with
+        SR_GroupDoc = SR_Impl->createDocument(0, qname, 0);
+        element = SR_GroupDoc->getDocumentElement();
+    } 
+    else if (SR_Depth > 1) 
+    {
+        element = SR_GroupDoc->createElement(qname);
+        SR_OpenElements.back()->appendChild(element);
+    }
+    if (element != NULL) 
+    {
+        for (XMLSize_t i = 0; i < attrs.getLength(); i++) 
+        {
+            element->setAttribute(attrs.getQName(i), attrs.getValue(i));
+        }
+        SR_OpenElements.push_back(element);
+    }
+    SR_Depth++;
+}
+
+void crispr::xml::streamreader::endElement(const XMLCh * const uri,
+                                           const XMLCh * const localname,
+                                           const XMLCh * const qname)
+{
+    SR_Depth--;
+    if (SR_Depth < 1) 
+    {
+        // the root element
+        return;
+    }
+    SR_OpenElements.pop_back();
+    if (SR_Depth == 1) 
+    {
+        if (!SR_Function(SR_GroupDoc->getDocumentElement(), *this, SR_Context)) 
+        {
+            SR_Stop = true;
+        }
+        SR_GroupDoc->release();
+        SR_GroupDoc = NULL;
+    }
+}
+
+void crispr::xml::streamreader::characters(const XMLCh * const chars, const XMLSize_t length)
+{
+    if (SR_OpenElements.empty()) 
+    {
+        return;
+    }
+    SR_TextBuffer.assign(chars, chars + length);
+    SR_TextBuffer.push_back(0);
+    SR_OpenElements.back()->appendChild(SR_GroupDoc->createTextNode(&SR_TextBuffer[0]));
+}
+
+void crispr::xml::streamreader::fatalError(const xercesc::SAXParseException& e)
+{
+    char* message = xercesc::XMLString::transcode( e.getMessage() );
+    std::stringstream errBuf;
+    errBuf << "Error parsing file at line " << e.getLineNumber() << ": " << message << std::flush;
+    xercesc::XMLString::release( &message );
+    throw crispr::xml_exception(__FILE__, __LINE__, __PRETTY_FUNCTION__,(errBuf.str()).c_str());
+}
@@ -0,0 +1,118 @@
+// File: streamreader.h
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Event driven (SAX2) reading of crispr files. Only the <group> that is
+// being read is kept in memory: it is built up as a small DOM of its
+// own, handed to a callback once its end tag is seen and then thrown
+// away, so the tools that look at one group at a time don't need to
+// hold the whole file.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+#ifndef STREAMREADER_H
+#define STREAMREADER_H
+
+// system includes
+#include <vector>
+#include <xercesc/sax2/SAX2XMLReader.hpp>
+#include <xercesc/sax2/XMLReaderFactory.hpp>
+#include <xercesc/sax2/DefaultHandler.hpp>
+#include <xercesc/sax2/Attributes.hpp>
+#include <xercesc/sax/SAXParseException.hpp>
+#include <xercesc/framework/XMLPScanToken.hpp>
+
+// local includes
+#include "base.h"
+#include "streamwriter.h"
+
+namespace crispr {
+    namespace xml {
+
+        // called with each child of the root element (normally a <group>)
+        // as soon as it has been read. The element is only valid until the
+        // function returns. Return false to stop reading the file
+        typedef bool (*GroupFunction)(xercesc::DOMElement * group, base& xmlObj, void * context);
+
+        class streamreader : virtual public base, public xercesc::DefaultHandler {
+
+            //members
+            xercesc::SAX2XMLReader * SR_Parser;                     // parsing object
+            xercesc::DOMImplementation * SR_Impl;                   // makes the documents for each group
+            xercesc::DOMDocument * SR_GroupDoc;                     // holds the group that is being read
+            std::vector<xercesc::DOMElement *> SR_OpenElements;     // elements of the group still waiting for their end tag
+            std::vector<XMLCh> SR_TextBuffer;                       // characters() are not null terminated
+            int SR_Depth;                                           // how far below the root element we are
+            GroupFunction SR_Function;
+            void * SR_Context;
+            bool SR_Stop;                                           // the callback has had enough
+
+        public:
+
+            //constructor/destructor
+            streamreader();
+            ~streamreader();
+
+            /** Read a crispr file, calling groupFunction for every group
+             *  @param xmlFile The file to read
+             *  @param groupFunction called with each group in turn
+             *  @param context passed through to groupFunction
+             */
+            void parse(const char * xmlFile, GroupFunction groupFunction, void * context);
+
+            /** Write out an element that has been read in, along with all
+             *  of its children, for the tools that pass groups through
+             *  @param element The element to copy
+             *  @param out Where to write it
+             */
+            void copyElement(xercesc::DOMElement * element, streamwriter& out);
+
+            //
+            // SAX2 handlers
+            //
+            void startElement(const XMLCh * const uri,
+                              const XMLCh * const localname,
+                              const XMLCh * const qname,
+                              const xercesc::Attributes& attrs);
+
+            void endElement(const XMLCh * const uri,
+                            const XMLCh * const localname,
+                            const XMLCh * const qname);
+
+            void characters(const XMLCh * const chars, const XMLSize_t length);
+
+            void fatalError(const xercesc::SAXParseException& e);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,334 @@
+// File: streamwriter.cpp
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Implementation of the streaming crispr file writer.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+// local includes
+#include "streamwriter.h"
+
+crispr::xml::streamwriter::streamwriter()
+{
+    XS_Out = NULL;
+    XS_StartTagOpen = false;
+    XS_LastWasText = false;
+}
+
+crispr::xml::streamwriter::~streamwriter()
+{
+    if (XS_Out != NULL)
+    {
+        finishDocument();
+    }
+}
+
+bool crispr::xml::streamwriter::createDocument(std::string outFileName, const char * rootElement, const char * versionNumber)
+{
+    XS_File.open(outFileName.c_str());
+    if (!XS_File)
+    {
+        return false;
+    }
+    createDocument(&XS_File, rootElement, versionNumber);
+    return true;
+}
+
+void crispr::xml::streamwriter::createDocument(std::ostream * out, const char * rootElement, const char * versionNumber)
+{
+    XS_Out = out;
+    // the same declaration the DOM serializer writes
+    *XS_Out << "<?xml version=\"1.0\" encoding=\"ISO8859-1\" standalone=\"no\" ?>";
+    startElement(rootElement);
+    addAttribute(attr_Version(), versionNumber);
+}
+
+bool crispr::xml::streamwriter::finishDocument(void)
+{
+    if (XS_Out == NULL)
+    {
+        return false;
+    }
+    while (!XS_OpenElements.empty())
+    {
+        endElement();
+    }
+    *XS_Out << '\n';
+    XS_Out->flush();
+    bool retval = XS_Out->good();
+    if (XS_File.is_open())
+    {
+        XS_File.close();
+        retval = retval && !XS_File.fail();
+    }
+    XS_Out = NULL;
+    return retval;
+}
+
+//
+// Elements
+//
+void crispr::xml::streamwriter::newLine(size_t level)
+{
+    *XS_Out << '\n';
+    for (size_t i = 0; i < level; i++)
+    {
+        *XS_Out << "  ";
+    }
+}
+
+void crispr::xml::streamwriter::escape(const std::string& str, bool inAttribute)
+{
+    size_t start = 0;
+    for (size_t i = 0; i < str.length(); i++)
+    {
+        const char * replacement;
+        switch (str[i])
+        {
+            case '&': replacement = "&amp;"; break;
+            case '<': replacement = "&lt;"; break;
+            case '>': replacement = "&gt;"; break;
+            case '"': replacement = (inAttribute) ? "&quot;" : NULL; break;
+            default: replacement = NULL; break;
+        }
+        if (replacement != NULL)
+        {
+            XS_Out->write(str.data() + start, i - start);
+            *XS_Out << replacement;
+            start = i + 1;
+        }
+    }
+    XS_Out->write(str.data() + start, str.length() - start);
+}
+
+void crispr::xml::streamwriter::closeStartTag(bool empty)
+{
+    //-----
+    // attributes come out sorted by name, the way the DOM keeps them.
+    // There are only ever a handful so an insertion sort will do
+    //
+    for (size_t i = 1; i < XS_Attributes.size(); i++)
+    {
+        for (size_t j = i; j > 0 && XS_Attributes[j].first < XS_Attributes[j - 1].first; j--)
+        {
+            XS_Attributes[j].swap(XS_Attributes[j - 1]);
+        }
+    }
+    std::vector<std::pair<std::string, std::string> >::iterator attr_iter;
+    for (attr_iter = XS_Attributes.begin(); attr_iter != XS_Attributes.end(); attr_iter++)
+    {
+        *XS_Out << ' ' << attr_iter->first << "=\"";
+        escape(attr_iter->second, true);
+        *XS_Out << '"';
+    }
+    XS_Attributes.clear();
+    *XS_Out << ((empty) ? "/>" : ">");
+    XS_StartTagOpen = false;
+}
+
+void crispr::xml::streamwriter::startElement(const char * tag)
+{
+    if (XS_Out == NULL)
+    {
+        throw crispr::xml_exception(__FILE__,
+                                    __LINE__,
+                                    __PRETTY_FUNCTION__,
+                                    "No document to add the element to");
+    }
+    if (XS_StartTagOpen)
+    {
+        closeStartTag(false);
+    }
+    if (!XS_HasChildElements.empty())
+    {
+        XS_HasChildElements.back() = true;
+    }
+    // groups get a blank line between them
+    size_t level = XS_OpenElements.size();
+    if (level == 1)
+    {
+        *XS_Out << '\n';
+    }
+    newLine(level);
+    *XS_Out << '<' << tag;
+    XS_OpenElements.push_back(tag);
+    XS_HasChildElements.push_back(false);
+    XS_StartTagOpen = true;
+    XS_LastWasText = false;
+}
+
+void crispr::xml::streamwriter::addAttribute(const char * attr, const std::string& value)
+{
+    if (!XS_StartTagOpen)
+    {
+        throw crispr::xml_exception(__FILE__,
+                                    __LINE__,
+                                    __PRETTY_FUNCTION__,
+                                    "Attributes must be added before the children of an element");
+    }
+    XS_Attributes.push_back(std::pair<std::string, std::string>(attr, value));
+}
+
+void crispr::xml::streamwriter::addText(const std::string& text)
+{
+    if (XS_StartTagOpen)
+    {
+        closeStartTag(false);
+    }
+    escape(text, false);
+    XS_LastWasText = true;
+}
+
+void crispr::xml::streamwriter::endElement(void)
+{
+    if (XS_OpenElements.empty())
+    {
+        throw crispr::xml_exception(__FILE__,
+                                    __LINE__,
+                                    __PRETTY_FUNCTION__,
+                                    "No open element to close");
+    }
+    if (XS_StartTagOpen)
+    {
+        closeStartTag(true);
+    }
+    else
+    {
+        size_t level = XS_OpenElements.size() - 1;
+        if (XS_HasChildElements.back() && !XS_LastWasText)
+        {
+            if (level == 0)
+            {
+                *XS_Out << '\n';
+            }
+            newLine(level);
+        }
+        *XS_Out << "</" << XS_OpenElements.back() << '>';
+    }
+    XS_OpenElements.pop_back();
+    XS_HasChildElements.pop_back();
+    XS_LastWasText = false;
+}
+
+void crispr::xml::streamwriter::addTextElement(const char * tag, const std::string& text)
+{
+    startElement(tag);
+    addText(text);
+    endElement();
+}
+
+//
+// The same pieces as crispr::xml::writer
+//
+void crispr::xml::streamwriter::addGroup(const std::string& gID, const std::string& drConsensus)
+{
+    startElement(tag_Group());
+    addAttribute(attr_Gid(), gID);
+    addAttribute(attr_Drseq(), drConsensus);
+}
+
+void crispr::xml::streamwriter::addDirectRepeat(const std::string& drid, const std::string& seq)
+{
+    startElement(tag_Dr());
+    addAttribute(attr_Seq(), seq);
+    addAttribute(attr_Drid(), drid);
+    endElement();
+}
+
+void crispr::xml::streamwriter::addSpacer(const std::string& seq, const std::string& spid, const std::string& cov)
+{
+    startElement(tag_Spacer());
+    addAttribute(attr_Seq(), seq);
+    addAttribute(attr_Spid(), spid);
+    addAttribute(attr_Cov(), cov);
+}
+
+void crispr::xml::streamwriter::addFlanker(const std::string& seq, const std::string& flid)
+{
+    startElement(tag_Flanker());
+    addAttribute(attr_Seq(), seq);
+    addAttribute(attr_Flid(), flid);
+}
+
+void crispr::xml::streamwriter::addSource(const std::string& accession, const std::string& soid)
+{
+    startElement(tag_Source());
+    addAttribute(attr_Accession(), accession);
+    addAttribute(attr_Soid(), soid);
+    endElement();
+}
+
+void crispr::xml::streamwriter::addSpacerSource(const std::string& soid)
+{
+    startElement(tag_Source());
+    addAttribute(attr_Soid(), soid);
+    endElement();
+}
+
+void crispr::xml::streamwriter::addContig(const std::string& cid)
+{
+    startElement(tag_Contig());
+    addAttribute(attr_Cid(), cid);
+}
+
+void crispr::xml::streamwriter::addSpacerToContig(const std::string& spid)
+{
+    startElement(tag_Cspacer());
+    addAttribute(attr_Spid(), spid);
+}
+
+void crispr::xml::streamwriter::addSpacer(const char * tag, const std::string& spid, const std::string& drid, const std::string& drconf)
+{
+    startElement(tag);
+    addAttribute(attr_Drid(), drid);
+    addAttribute(attr_Drconf(), drconf);
+    addAttribute(attr_Spid(), spid);
+    endElement();
+}
+
+void crispr::xml::streamwriter::addFlanker(const char * tag, const std::string& flid, const std::string& drconf, const std::string& directjoin)
+{
+    startElement(tag);
+    addAttribute(attr_Flid(), flid);
+    addAttribute(attr_Drconf(), drconf);
+    addAttribute(attr_Directjoin(), directjoin);
+    endElement();
+}
+
+void crispr::xml::streamwriter::addFileToMetadata(const std::string& type, const std::string& url)
+{
+    startElement(tag_File());
+    addAttribute(attr_Type(), type);
+    addAttribute(attr_Url(), url);
+    endElement();
+}
@@ -0,0 +1,259 @@
+// File: streamwriter.h
+// Original Author: Connor Skennerton 2016
+// --------------------------------------------------------------------
+//
+// OVERVIEW:
+//
+// Writes a crispr file straight to disk while it is being generated.
+// The elements and attributes are the ones in crispr::xml::base and the
+// layout is the one the DOM serializer in crispr::xml::writer makes, but
+// nothing is kept in memory apart from the names of the open elements,
+// so a group can be written out as soon as it is finished.
+//
+// --------------------------------------------------------------------
+//  Copyright  2016       Connor Skennerton
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+// --------------------------------------------------------------------
+//
+//                        A
+//                       A B
+//                      A B R
+//                     A B R A
+//                    A B R A C
+//                   A B R A C A
+//                  A B R A C A D
+//                 A B R A C A D A
+//                A B R A C A D A B
+//               A B R A C A D A B R
+//              A B R A C A D A B R A
+//
+
+#ifndef STREAMWRITER_H
+#define STREAMWRITER_H
+
+// system includes
+#include <string>
+#include <vector>
+#include <utility>
+#include <ostream>
+#include <fstream>
+
+// local includes
+#include "Exception.h"
+
+namespace crispr {
+    namespace xml {
+        class streamwriter {
+
+            //members
+            std::ofstream XS_File;                                          // used when the writer opens the file itself
+            std::ostream * XS_Out;                                          // where the document goes
+            std::vector<std::string> XS_OpenElements;                       // names of the elements that still need closing
+            std::vector<bool> XS_HasChildElements;                          // does the open element have element children
+            std::vector<std::pair<std::string, std::string> > XS_Attributes; // attributes of the start tag still being made
+            bool XS_StartTagOpen;                                           // the last start tag has not been closed yet
+            bool XS_LastWasText;                                            // the open element has text content
+
+            void closeStartTag(bool empty);
+            void newLine(size_t level);
+            void escape(const std::string& str, bool inAttribute);
+
+        public:
+
+            //constructor/destructor
+            streamwriter();
+            ~streamwriter();
+
+            //
+            // Generic get
+            //
+            // the same names as the XMLCh * accessors in crispr::xml::base
+            inline const char * attr_Accession(void) { return "accession"; }
+            inline const char * attr_Cid(void) { return "cid"; }
+            inline const char * attr_Confcnt(void) { return "confcnt"; }
+            inline const char * attr_Cov(void) { return "cov"; }
+            inline const char * attr_Directjoin(void) { return "directjoin"; }
+            inline const char * attr_Drconf(void) { return "drconf"; }
+            inline const char * attr_Drid(void) { return "drid"; }
+            inline const char * attr_Drseq(void) { return "drseq"; }
+            inline const char * attr_Flid(void) { return "flid"; }
+            inline const char * attr_Gid(void) { return "gid"; }
+            inline const char * attr_Seq(void) { return "seq"; }
+            inline const char * attr_Soid(void) { return "soid"; }
+            inline const char * attr_Spid(void) { return "spid"; }
+            inline const char * attr_Totcnt(void) { return "totcnt"; }
+            inline const char * attr_Type(void) { return "type"; }
+            inline const char * attr_Url(void) { return "url"; }
+            inline const char * attr_Version(void) { return "version"; }
+
+            inline const char * tag_Assembly(void) { return "assembly"; }
+            inline const char * tag_Bf(void) { return "bf"; }
+            inline const char * tag_Bflankers(void) { return "bflankers"; }
+            inline const char * tag_Bs(void) { return "bs"; }
+            inline const char * tag_Bspacers(void) { return "bspacers"; }
+            inline const char * tag_Command(void) { return "command"; }
+            inline const char * tag_Consensus(void) { return "consensus"; }
+            inline const char * tag_Contig(void) { return "contig"; }
+            inline const char * tag_Crispr(void) { return "crispr"; }
+            inline const char * tag_Cspacer(void) { return "cspacer"; }
+            inline const char * tag_Data(void) { return "data"; }
+            inline const char * tag_Dr(void) { return "dr"; }
+            inline const char * tag_Drs(void) { return "drs"; }
+            inline const char * tag_Epos(void) { return "epos"; }
+            inline const char * tag_Ff(void) { return "ff"; }
+            inline const char * tag_Fflankers(void) { return "fflankers"; }
+            inline const char * tag_File(void) { return "file"; }
+            inline const char * tag_Flanker(void) { return "flanker"; }
+            inline const char * tag_Flankers(void) { return "flankers"; }
+            inline const char * tag_Fs(void) { return "fs"; }
+            inline const char * tag_Fspacers(void) { return "fspacers"; }
+            inline const char * tag_Group(void) { return "group"; }
+            inline const char * tag_Metadata(void) { return "metadata"; }
+            inline const char * tag_Name(void) { return "name"; }
+            inline const char * tag_Notes(void) { return "notes"; }
+            inline const char * tag_Program(void) { return "program"; }
+            inline const char * tag_Source(void) { return "source"; }
+            inline const char * tag_Sources(void) { return "sources"; }
+            inline const char * tag_Spacer(void) { return "spacer"; }
+            inline const char * tag_Spacers(void) { return "spacers"; }
+            inline const char * tag_Spos(void) { return "spos"; }
+            inline const char * tag_Version(void) { return "version"; }
+
+            /** Open a crispr file and write the root element
+             *  @param outFileName The file to write to
+             *  @param rootElement Name for the root element
+             *  @param versionNumber version for the crispr file to have
+             *  @return false if the file could not be opened
+             */
+            bool createDocument(std::string outFileName, const char * rootElement, const char * versionNumber);
+
+            /** Write the root element to a stream that is owned by the caller
+             *  @param out The stream to write to
+             *  @param rootElement Name for the root element
+             *  @param versionNumber version for the crispr file to have
+             */
+            void createDocument(std::ostream * out, const char * rootElement, const char * versionNumber);
+
+            /** Close every open element and the file
+             *  @return false if anything failed to write
+             */
+            bool finishDocument(void);
+
+            //
+            // Elements
+            //
+            /** Start a new element as a child of the open element.
+             *  The element stays open until endElement() is called
+             *  @param tag The name of the element
+             */
+            void startElement(const char * tag);
+
+            /** Add an attribute to the element that was just started.
+             *  Must be called before any children are added
+             *  @param attr The name of the attribute
+             *  @param value The value of the attribute
+             */
+            void addAttribute(const char * attr, const std::string& value);
+
+            /** Add text content to the open element
+             *  @param text The text to add
+             */
+            void addText(const std::string& text);
+
+            /** Close the open element
+             */
+            void endElement(void);
+
+            /** Add an element with a text child to the open element
+             *  @param tag The name of the element
+             *  @param text The text inside of the element
+             */
+            void addTextElement(const char * tag, const std::string& text);
+
+            //
+            // The same pieces as crispr::xml::writer, but without a parentNode:
+            // everything goes into the element that is currently open
+            //
+            /** start a 'group' in the root element. Close with endElement()
+             *  @param gID The unique group identifier
+             *  @param drConsensus The direct repeat concensus sequence for this group
+             */
+            void addGroup(const std::string& gID, const std::string& drConsensus);
+
+            /** add a direct repeat 'dr' tag to the 'drs' tag
+             *  @param drid The unique DR id for this group
+             *  @param seq The sequence of the direct repeat in its lowest lexicographical form
+             */
+            void addDirectRepeat(const std::string& drid, const std::string& seq);
+
+            /** start a 'spacer' tag in 'spacers'. Close with endElement()
+             *  @param seq sequence of the spacer
+             *  @param spid the unique spacer identifier for this group
+             *  @param cov The coverage of the spacer
+             */
+            void addSpacer(const std::string& seq, const std::string& spid, const std::string& cov);
+
+            /** start a 'flanker' tag in 'flankers'. Close with endElement()
+             *  @param seq sequence of the flanker
+             *  @param flid the unique flanker identifier for this group
+             */
+            void addFlanker(const std::string& seq, const std::string& flid);
+
+            /** add a 'source' tag to the 'sources' of a group
+             *  @param accession The header of the read
+             *  @param soid The unique source identifier
+             */
+            void addSource(const std::string& accession, const std::string& soid);
+
+            /** add a 'source' tag to a 'spacer' or 'flanker'
+             *  @param soid The identifier of a source in the 'sources' tag
+             */
+            void addSpacerSource(const std::string& soid);
+
+            /** start a 'contig' in 'assembly'. Close with endElement()
+             *  @param cid a unique contig id for this group
+             */
+            void addContig(const std::string& cid);
+
+            /** start a 'cspacer' in a 'contig'. Close with endElement()
+             *  @param spid the identifier of the spacer
+             */
+            void addSpacerToContig(const std::string& spid);
+
+            /** add a 'bs' or 'fs' tag to 'bspacers' or 'fspacers'
+             *  @param tag either tag_Bs() or tag_Fs()
+             *  @param spid the identifier of the joined spacer
+             *  @param drid the identifier of the direct repeat between them
+             *  @param drconf confidence of the direct repeat
+             */
+            void addSpacer(const char * tag, const std::string& spid, const std::string& drid, const std::string& drconf);
+
+            /** add a 'bf' or 'ff' tag to 'bflankers' or 'fflankers'
+             *  @param tag either tag_Bf() or tag_Ff()
+             *  @param flid the identifier of the joined flanker
+             *  @param drconf confidence of the direct repeat
+             *  @param directjoin is the flanker joined without a direct repeat
+             */
+            void addFlanker(const char * tag, const std::string& flid, const std::string& drconf, const std::string& directjoin);
+
+            /** add a 'file' tag to 'metadata'
+             *  @param type The type of reference file.  Must be one of image|sequence|log|data
+             *  @param url path to the file
+             */
+            void addFileToMetadata(const std::string& type, const std::string& url);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,118 @@
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "Aligner.h"
+#include "ReadHolder.h"
+#include "StringCheck.h"
+#include "SeqUtils.h"
+
+#define TEST_ALIGNER_LENGTH 1200
+
+static std::string alignerSequence(unsigned int& seed, int length) {
+    const char * bases = "ACGT";
+    std::string sequence;
+    for (int i = 0; i < length; i++) {
+        seed = seed * 1103515245 + 12345;
+        sequence += bases[(seed >> 16) & 3];
+    }
+    return sequence;
+}
+
+static unsigned int alignerRandom(unsigned int& seed, unsigned int range) {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % range;
+}
+
+// a group of DR variants, each with a few reads holding two copies of it
+static void makeGroup(unsigned int seed, StringCheck& stringCheck, ReadMap& reads, DR_Cluster& group) {
+    std::string master = alignerSequence(seed, 30);
+    for (int v = 0; v < 60; v++) {
+        std::string variant = master;
+        if (v > 0) {
+            int errors = alignerRandom(seed, 3);
+            for (int e = 0; e < errors; e++) {
+                variant[alignerRandom(seed, variant.length())] = "ACGT"[alignerRandom(seed, 4)];
+            }
+            variant = variant.substr(alignerRandom(seed, 3));
+            variant = variant.substr(0, variant.length() - alignerRandom(seed, 3));
+            if (alignerRandom(seed, 3) == 0) {
+                variant = reverseComplement(variant);
+            }
+        }
+        if (stringCheck.getToken(variant) != 0) {
+            continue;
+        }
+        StringToken token = stringCheck.addString(variant);
+        group.push_back(token);
+        ReadList * list = new ReadList();
+        for (int r = 0; r < 3; r++) {
+            std::string left = alignerSequence(seed, 20);
+            std::string spacer = alignerSequence(seed, 32);
+            std::string read = left + variant + spacer + variant + alignerSequence(seed, 20);
+            ReadHolder * holder = new ReadHolder(read, "read");
+            int first = static_cast<int>(left.length());
+            int second = first + static_cast<int>(variant.length() + spacer.length());
+            holder->startStopsAdd(first, first + static_cast<int>(variant.length()) - 1);
+            holder->startStopsAdd(second, second + static_cast<int>(variant.length()) - 1);
+            list->push_back(holder);
+        }
+        reads[token] = list;
+    }
+}
+
+static void deleteGroup(ReadMap& reads) {
+    ReadMapIterator iter;
+    for (iter = reads.begin(); iter != reads.end(); ++iter) {
+        if (iter->second != NULL) {
+            ReadListIterator read_iter;
+            for (read_iter = iter->second->begin(); read_iter != iter->second->end(); ++read_iter) {
+                delete *read_iter;
+            }
+            delete iter->second;
+        }
+    }
+    reads.clear();
+}
+
+TEST_CASE("aligning a group of slaves in one call", "[Aligner]") {
+    int threads[] = {1, 4};
+    for (int t = 0; t < 2; t++) {
+        StringCheck serial_check, batch_check;
+        ReadMap serial_reads, batch_reads;
+        DR_Cluster serial_group, batch_group;
+        makeGroup(99, serial_check, serial_reads, serial_group);
+        makeGroup(99, batch_check, batch_reads, batch_group);
+        REQUIRE(serial_group == batch_group);
+
+        Aligner serial_aligner(TEST_ALIGNER_LENGTH, &serial_reads, &serial_check);
+        serial_aligner.setMasterDR(serial_group[0]);
+        DR_ClusterIterator dr_iter;
+        for (dr_iter = serial_group.begin(); dr_iter != serial_group.end(); dr_iter++) {
+            if (serial_aligner.getMasterDrToken() != *dr_iter) {
+                serial_aligner.alignSlave(*dr_iter);
+            }
+        }
+
+        Aligner batch_aligner(TEST_ALIGNER_LENGTH, &batch_reads, &batch_check);
+        batch_aligner.setMasterDR(batch_group[0]);
+        batch_aligner.alignSlaves(batch_group, threads[t]);
+
+        // reversed slaves get a new token in the same place
+        REQUIRE(serial_group == batch_group);
+        int aligned = 0;
+        for (dr_iter = serial_group.begin(); dr_iter != serial_group.end(); dr_iter++) {
+            REQUIRE(serial_aligner.offset(*dr_iter) == batch_aligner.offset(*dr_iter));
+            if (serial_aligner.offset(*dr_iter) != -1) {
+                aligned++;
+            }
+        }
+        REQUIRE(aligned > 1);
+        for (int i = 0; i < TEST_ALIGNER_LENGTH; i++) {
+            REQUIRE(serial_aligner.depthAt(i) == batch_aligner.depthAt(i));
+            REQUIRE(serial_aligner.coverageAt(i, 'G') == batch_aligner.coverageAt(i, 'G'));
+        }
+        deleteGroup(serial_reads);
+        deleteGroup(batch_reads);
+    }
+}
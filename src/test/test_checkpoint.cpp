@@ -0,0 +1,176 @@
+#include <string>
+#include <cstdio>
+#include <unistd.h>
+
+#include "catch.hpp"
+#include "Checkpoint.h"
+#include "ReadHolder.h"
+#include "Exception.h"
+
+static std::string tempFile(void) {
+    char path[] = "/tmp/crass_checkpointXXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd != -1);
+    close(fd);
+    remove(path);
+    return path;
+}
+
+static void deleteReads(ReadMap& reads, ReadHolderPool& pool) {
+    ReadMapIterator reads_iter;
+    for (reads_iter = reads.begin(); reads_iter != reads.end(); ++reads_iter) {
+        ReadListIterator list_iter;
+        for (list_iter = reads_iter->second->begin(); list_iter != reads_iter->second->end(); ++list_iter) {
+            pool.destroy(*list_iter);
+        }
+        delete reads_iter->second;
+    }
+    reads.clear();
+}
+
+static void deleteClusters(DR_Cluster_Map& clusters) {
+    DR_Cluster_MapIterator cluster_iter;
+    for (cluster_iter = clusters.begin(); cluster_iter != clusters.end(); ++cluster_iter) {
+        delete cluster_iter->second;
+    }
+    clusters.clear();
+}
+
+TEST_CASE("saving and loading checkpoints", "[Checkpoint]") {
+    std::string path = tempFile();
+
+    // the state of a WorkHorse part way through
+    StringCheck strings;
+    StringToken dr1 = strings.addString("GTTTCAATCCACGCGCCCACGCGGGGCGCGAC");
+    StringToken dr2 = strings.addString("GTCGCACTCTTCATGGGTGCGTGGATTGAAAT");
+    strings.addString("GTTTCAATCCACGCGCCCACGCGGGGCGCGAC");
+
+    ReadHolderPool pool;
+    ReadMap reads;
+    reads[dr1] = new ReadList();
+    reads[dr2] = new ReadList();
+    ReadHolder * fasta = pool.construct("GTTTCAATCCACGCGCCCACGCGGGGCGCGACTTAGNNCGATCGATCGAGCTAGCTAGCATCGACTAG", "read_1");
+    fasta->startStopsAdd(0, 31);
+    fasta->setDRLowLexi(true);
+    fasta->setRepeatLength(32);
+    fasta->pack();
+    reads[dr1]->push_back(fasta);
+    ReadHolder * fastq = pool.construct("ACGTGTCGCACTCTTCATGGGTGCGTGGATTGAAAT", "read_2");
+    fastq->setComment("a comment");
+    fastq->setQual("IIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIIII");
+    fastq->startStopsAdd(4, 35);
+    fastq->setDRLowLexi(false);
+    fastq->setRepeatLength(32);
+    reads[dr2]->push_back(fastq);
+
+    DR_Cluster_Map clusters;
+    clusters[1] = new DR_Cluster();
+    clusters[1]->push_back(dr1);
+    clusters[1]->push_back(dr2);
+    clusters[2] = NULL;
+
+    std::map<int, std::string> true_drs;
+    true_drs[1] = "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC";
+
+    {
+        Checkpoint checkpoint;
+        checkpoint.create(path, CP_CLUSTERS, "reads.fq\nDR 23-47");
+        checkpoint.writeInt(150);
+        checkpoint.writeStrings(strings);
+        checkpoint.writeReads(reads);
+        checkpoint.writeClusters(clusters);
+        checkpoint.writeTrueDRs(true_drs);
+        // nothing there until it is finished
+        REQUIRE(access(path.c_str(), F_OK) != 0);
+        checkpoint.commit();
+    }
+    REQUIRE(access(path.c_str(), F_OK) == 0);
+    REQUIRE(access((path + ".tmp").c_str(), F_OK) != 0);
+
+    SECTION("everything comes back the same") {
+        Checkpoint checkpoint;
+        REQUIRE(checkpoint.open(path, "reads.fq\nDR 23-47"));
+        REQUIRE(checkpoint.stage() == CP_CLUSTERS);
+        REQUIRE(checkpoint.readInt() == 150);
+
+        StringCheck loaded_strings;
+        checkpoint.readStrings(loaded_strings);
+        REQUIRE(loaded_strings.mNextFreeToken == strings.mNextFreeToken);
+        for (StringToken token = 2; token <= strings.mNextFreeToken; token++) {
+            REQUIRE(loaded_strings.getString(token) == strings.getString(token));
+        }
+        REQUIRE(loaded_strings.getToken("GTTTCAATCCACGCGCCCACGCGGGGCGCGAC") == strings.getToken("GTTTCAATCCACGCGCCCACGCGGGGCGCGAC"));
+
+        ReadHolderPool loaded_pool;
+        ReadMap loaded_reads;
+        checkpoint.readReads(loaded_reads, loaded_pool);
+        REQUIRE(loaded_reads.size() == 2);
+        REQUIRE(loaded_pool.size() == 2);
+        ReadHolder * loaded_fasta = loaded_reads[dr1]->at(0);
+        REQUIRE(loaded_fasta->isPacked());
+        REQUIRE(loaded_fasta->getSeq() == fasta->getSeq());
+        REQUIRE(loaded_fasta->getHeader() == "read_1");
+        REQUIRE(loaded_fasta->getIsFasta());
+        REQUIRE(loaded_fasta->getLowLexi());
+        REQUIRE(loaded_fasta->getStartStopList() == fasta->getStartStopList());
+        REQUIRE(loaded_fasta->getRepeatLength() == 32);
+        ReadHolder * loaded_fastq = loaded_reads[dr2]->at(0);
+        REQUIRE_FALSE(loaded_fastq->isPacked());
+        REQUIRE(loaded_fastq->getSeq() == fastq->getSeq());
+        REQUIRE_FALSE(loaded_fastq->getIsFasta());
+        REQUIRE_FALSE(loaded_fastq->getLowLexi());
+        REQUIRE(loaded_fastq->getComment() == fastq->getComment());
+        REQUIRE(loaded_fastq->getQual() == fastq->getQual());
+        REQUIRE(loaded_fastq->getStartStopList() == fastq->getStartStopList());
+
+        DR_Cluster_Map loaded_clusters;
+        checkpoint.readClusters(loaded_clusters);
+        REQUIRE(loaded_clusters.size() == 2);
+        REQUIRE(*(loaded_clusters[1]) == *(clusters[1]));
+        REQUIRE(loaded_clusters[2] == NULL);
+
+        std::map<int, std::string> loaded_true_drs;
+        checkpoint.readTrueDRs(loaded_true_drs);
+        REQUIRE(loaded_true_drs == true_drs);
+
+        deleteReads(loaded_reads, loaded_pool);
+        deleteClusters(loaded_clusters);
+    }
+    SECTION("a checkpoint made from something else isn't used") {
+        Checkpoint checkpoint;
+        REQUIRE_THROWS_AS(checkpoint.open(path, "reads.fq\nDR 20-47"), crispr::exception);
+    }
+    SECTION("a damaged checkpoint isn't used") {
+        FILE * file = fopen(path.c_str(), "r+b");
+        fseek(file, 60, SEEK_SET);
+        int c = fgetc(file);
+        fseek(file, 60, SEEK_SET);
+        fputc(c ^ 1, file);
+        fclose(file);
+        Checkpoint checkpoint;
+        REQUIRE_THROWS_AS(checkpoint.open(path, "reads.fq\nDR 23-47"), crispr::exception);
+    }
+    SECTION("a truncated checkpoint isn't used") {
+        truncate(path.c_str(), 100);
+        Checkpoint checkpoint;
+        REQUIRE_THROWS_AS(checkpoint.open(path, "reads.fq\nDR 23-47"), crispr::exception);
+    }
+    SECTION("there may not be a checkpoint") {
+        remove(path.c_str());
+        Checkpoint checkpoint;
+        REQUIRE_FALSE(checkpoint.open(path, "reads.fq\nDR 23-47"));
+    }
+    SECTION("a checkpoint that isn't finished is thrown away") {
+        std::string unfinished = path + ".unfinished";
+        {
+            Checkpoint checkpoint;
+            checkpoint.create(unfinished, CP_SEARCH, "reads.fq");
+            checkpoint.writeStrings(strings);
+        }
+        REQUIRE(access(unfinished.c_str(), F_OK) != 0);
+        REQUIRE(access((unfinished + ".tmp").c_str(), F_OK) != 0);
+    }
+    deleteReads(reads, pool);
+    deleteClusters(clusters);
+    remove(path.c_str());
+}
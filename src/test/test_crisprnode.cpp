@@ -0,0 +1,66 @@
+#include <vector>
+
+#include "catch.hpp"
+#include "CrisprNode.h"
+
+TEST_CASE("edges between crispr nodes", "[CrisprNode]") {
+    CrisprNode a(2), b(3), c(4);
+
+    SECTION("are only added once") {
+        REQUIRE(a.addEdge(&b, CN_EDGE_FORWARD));
+        REQUIRE_FALSE(a.addEdge(&b, CN_EDGE_FORWARD));
+        REQUIRE(a.addEdge(&b, CN_EDGE_JUMPING_F));
+        REQUIRE(a.getRank(CN_EDGE_FORWARD) == 1);
+        REQUIRE(a.getRank(CN_EDGE_JUMPING_F) == 1);
+        REQUIRE(a.getEdges(CN_EDGE_FORWARD)->size() == 1);
+        REQUIRE(a.getEdges(CN_EDGE_BACKWARD)->empty());
+    }
+    SECTION("are detached and reattached with their nodes") {
+        a.addEdge(&b, CN_EDGE_FORWARD);
+        b.addEdge(&a, CN_EDGE_BACKWARD);
+        b.addEdge(&c, CN_EDGE_JUMPING_F);
+        c.addEdge(&b, CN_EDGE_JUMPING_B);
+
+        b.detachNode();
+        REQUIRE_FALSE(b.isAttached());
+        // a and c lost their only edge so they go too
+        REQUIRE(a.getTotalRank() == 0);
+        REQUIRE_FALSE(a.isAttached());
+        REQUIRE(c.getTotalRank() == 0);
+        REQUIRE_FALSE(c.isAttached());
+        REQUIRE(b.getEdges(CN_EDGE_BACKWARD)->find(&a)->second == false);
+        REQUIRE(b.getEdges(CN_EDGE_JUMPING_F)->find(&c)->second == false);
+        // the ranks of the detached node itself are left alone
+        REQUIRE(b.getTotalRank() == 2);
+
+        a.reattachNode();
+        c.reattachNode();
+        b.reattachNode();
+        REQUIRE(b.getEdges(CN_EDGE_BACKWARD)->find(&a)->second);
+        REQUIRE(b.getEdges(CN_EDGE_JUMPING_F)->find(&c)->second);
+        REQUIRE(a.getTotalRank() == 1);
+        REQUIRE(c.getTotalRank() == 1);
+    }
+    SECTION("spill off the node when there are lots of them") {
+        std::vector<CrisprNode *> others;
+        for (int i = 0; i < 10; i++) {
+            others.push_back(new CrisprNode(10 + i));
+            REQUIRE(a.addEdge(others.back(), CN_EDGE_JUMPING_B));
+        }
+        REQUIRE(a.getRank(CN_EDGE_JUMPING_B) == 10);
+        edgeList * el = a.getEdges(CN_EDGE_JUMPING_B);
+        REQUIRE(el->size() == 10);
+        for (int i = 0; i < 10; i++) {
+            REQUIRE(el->find(others[i]) == el->begin() + i);
+            REQUIRE(el->find(others[i])->second);
+        }
+        REQUIRE(el->find(&b) == el->end());
+        edgeList copy = *el;
+        REQUIRE(copy.size() == 10);
+        REQUIRE(copy.begin() != el->begin());
+        REQUIRE(copy.begin()[9].first == others[9]);
+        for (int i = 0; i < 10; i++) {
+            delete others[i];
+        }
+    }
+}
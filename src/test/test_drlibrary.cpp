@@ -0,0 +1,172 @@
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+#include "catch.hpp"
+#include "DRLibrary.h"
+#include "ReadHolder.h"
+#include "SeqUtils.h"
+#include "Exception.h"
+
+static std::string tempFile(void) {
+    char path[] = "/tmp/crass_drlibraryXXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd != -1);
+    close(fd);
+    remove(path);
+    return path;
+}
+
+static Vecstr knownRepeats(void) {
+    Vecstr patterns;
+    patterns.push_back("GTTTCAATCCACGCGCCCACGCGGGGCGCGAC");
+    patterns.push_back("GTCGCACTCTTCATGGGTGCGTGGATTGAAAT");
+    patterns.push_back("GTTTCAATCCACGCGCCCACGCGGGGCGCGAC");
+    return patterns;
+}
+
+//                                            1         2         3         4         5         6
+//                                  0123456789012345678901234567890123456789012345678901234567890123456789
+static const char * knownRead    = "ACGTACGTTTGTCGCACTCTTCATGGGTGCGTGGATTGAAATCCGATCGATCGATCGAC";
+static const char * unknownRead  = "ACGTACGTTTGATCGATCGGGCTAGCTAGCGATCGACTAGCATCGACTAGCGACTAGCA";
+
+TEST_CASE("finding known repeats", "[DRLibrary]") {
+    DRLibrary library;
+    unsigned int start, end;
+    REQUIRE_FALSE(library.find(knownRead, strlen(knownRead), start, end));
+
+    REQUIRE(library.add(knownRepeats()));
+    REQUIRE(library.size() == 2);
+    REQUIRE_FALSE(library.add(knownRepeats()));
+    REQUIRE(library.find(knownRead, strlen(knownRead), start, end));
+    REQUIRE(start == 10);
+    REQUIRE(end == 41);
+    REQUIRE_FALSE(library.find(unknownRead, strlen(unknownRead), start, end));
+}
+
+TEST_CASE("known repeats from a fasta file", "[DRLibrary]") {
+    std::string path = tempFile();
+    FILE * file = fopen(path.c_str(), "wb");
+    fputs(">type_I-E\nGTTTCAATCCACGCGCCCAC\ngcggggcgcgac\n>type_I-F\nGTCGCACTCTTCATGGGTGCGTGGATTGAAAT\n>duplicate\nGTTTCAATCCACGCGCCCACGCGGGGCGCGAC\n", file);
+    fclose(file);
+
+    DRLibrary library;
+    library.addFasta(path);
+    remove(path.c_str());
+    // each repeat and its reverse complement
+    REQUIRE(library.size() == 4);
+
+    SECTION("every copy of the repeat is found") {
+        //           0         1         2         3         4         5         6         7         8         9         10
+        //           01234567890123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789
+        std::string read = "ACGTGTTTCAATCCACGCGCCCACGCGGGGCGCGACCGATCGATCGACTAGCATCGACTAGCGGTTTCAATCCACGCGCCCACGCGGGGCGCGACTTAGCTAG";
+        StartStopList start_stops;
+        REQUIRE(library.findAll(read.data(), read.length(), start_stops));
+        REQUIRE(start_stops.size() == 4);
+        REQUIRE(start_stops[0] == 4);
+        REQUIRE(start_stops[1] == 35);
+        REQUIRE(start_stops[2] == 63);
+        REQUIRE(start_stops[3] == 94);
+    }
+    SECTION("on either strand") {
+        std::string read = reverseComplement("ACGTGTTTCAATCCACGCGCCCACGCGGGGCGCGACCGATCGATCGACTAGCATCGACTAGCGGTTTCAATCCACGCGCCCACGCGGGGCGCGACTTAGCTAG");
+        StartStopList start_stops;
+        REQUIRE(library.findAll(read.data(), read.length(), start_stops));
+        REQUIRE(start_stops.size() == 4);
+        REQUIRE(start_stops[0] == 8);
+        REQUIRE(start_stops[1] == 39);
+    }
+    SECTION("only copies of the first repeat found") {
+        std::string read = "GTCGCACTCTTCATGGGTGCGTGGATTGAAATCCGATCGATCGACTAGCATCGAGTTTCAATCCACGCGCCCACGCGGGGCGCGAC";
+        StartStopList start_stops;
+        REQUIRE(library.findAll(read.data(), read.length(), start_stops));
+        REQUIRE(start_stops.size() == 2);
+        REQUIRE(start_stops[0] == 0);
+        REQUIRE(start_stops[1] == 31);
+    }
+    SECTION("reads without a known repeat") {
+        StartStopList start_stops;
+        REQUIRE_FALSE(library.findAll(unknownRead, strlen(unknownRead), start_stops));
+        REQUIRE(start_stops.empty());
+    }
+}
+
+TEST_CASE("known repeats from a file that can't be read", "[DRLibrary]") {
+    DRLibrary library;
+    REQUIRE_THROWS_AS(library.addFasta("/tmp/crass_drlibrary_does_not_exist"), crispr::exception);
+}
+
+TEST_CASE("saving and opening a library", "[DRLibrary]") {
+    std::string path = tempFile();
+
+    SECTION("there may not be a library") {
+        DRLibrary library;
+        REQUIRE_FALSE(library.open(path));
+        REQUIRE(library.size() == 0);
+    }
+    SECTION("the patterns and the automaton come back the same") {
+        {
+            DRLibrary library;
+            library.add(knownRepeats());
+            library.save(path);
+        }
+        REQUIRE(access((path + ".tmp").c_str(), F_OK) != 0);
+        DRLibrary library;
+        REQUIRE(library.open(path));
+        REQUIRE(library.size() == 2);
+        REQUIRE(library.patterns()[0] == "GTCGCACTCTTCATGGGTGCGTGGATTGAAAT");
+        REQUIRE(library.patterns()[1] == "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC");
+        unsigned int start, end;
+        REQUIRE(library.find(knownRead, strlen(knownRead), start, end));
+        REQUIRE(start == 10);
+        REQUIRE(end == 41);
+        REQUIRE_FALSE(library.find(unknownRead, strlen(unknownRead), start, end));
+
+        // a later run adds to it
+        Vecstr more;
+        more.push_back("GATCGGGCTAGCTAGCGATCG");
+        REQUIRE(library.add(more));
+        library.save(path);
+        library.close();
+        REQUIRE(library.open(path));
+        REQUIRE(library.size() == 3);
+        REQUIRE(library.find(unknownRead, strlen(unknownRead), start, end));
+        REQUIRE(start == 14);
+        REQUIRE(end == 34);
+    }
+    SECTION("an empty library") {
+        {
+            DRLibrary library;
+            library.save(path);
+        }
+        DRLibrary library;
+        REQUIRE(library.open(path));
+        REQUIRE(library.size() == 0);
+        unsigned int start, end;
+        REQUIRE_FALSE(library.find(knownRead, strlen(knownRead), start, end));
+    }
+    SECTION("a file that isn't a library") {
+        FILE * file = fopen(path.c_str(), "wb");
+        fputs(">read_1\nACGTACGTACGTACGTACGTACGTACGTACGTACGT\n", file);
+        fclose(file);
+        DRLibrary library;
+        REQUIRE_THROWS_AS(library.open(path), crispr::exception);
+    }
+    SECTION("a damaged library") {
+        {
+            DRLibrary library;
+            library.add(knownRepeats());
+            library.save(path);
+        }
+        FILE * file = fopen(path.c_str(), "r+b");
+        fseek(file, 100, SEEK_SET);
+        int c = fgetc(file);
+        fseek(file, 100, SEEK_SET);
+        fputc(c ^ 1, file);
+        fclose(file);
+        DRLibrary library;
+        REQUIRE_THROWS_AS(library.open(path), crispr::exception);
+    }
+    remove(path.c_str());
+}
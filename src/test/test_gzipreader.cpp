@@ -0,0 +1,173 @@
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "catch.hpp"
+#include "GzipReader.h"
+#include "kseq.h"
+#include "Exception.h"
+
+static std::string makeReads(int numReads) {
+    std::string reads;
+    const char bases[] = "ACGT";
+    unsigned int state = 17;
+    for (int i = 0; i < numReads; i++) {
+        char header[32];
+        sprintf(header, "@read_%d\n", i);
+        reads += header;
+        std::string seq;
+        for (int j = 0; j < 100; j++) {
+            state = state * 1103515245 + 12345;
+            seq += bases[(state >> 16) & 3];
+        }
+        reads += seq + "\n+\n" + std::string(seq.length(), 'I') + "\n";
+    }
+    return reads;
+}
+
+static std::string tempFile(void) {
+    char path[] = "/tmp/crass_gzipXXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd != -1);
+    close(fd);
+    return path;
+}
+
+static void writePlain(const std::string& path, const std::string& data) {
+    FILE * out = fopen(path.c_str(), "wb");
+    fwrite(data.data(), 1, data.length(), out);
+    fclose(out);
+}
+
+static void writeGzip(const std::string& path, const std::string& data, const char * mode) {
+    gzFile out = gzopen(path.c_str(), mode);
+    gzwrite(out, data.data(), static_cast<unsigned>(data.length()));
+    gzclose(out);
+}
+
+static void putLittleEndian(std::string& out, unsigned int value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+}
+
+static std::string bgzfBlock(const char * data, size_t length) {
+    std::vector<unsigned char> deflated(compressBound(length) + 64);
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    deflateInit2(&stream, 1, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+    stream.avail_in = static_cast<uInt>(length);
+    stream.next_out = &deflated[0];
+    stream.avail_out = static_cast<uInt>(deflated.size());
+    deflate(&stream, Z_FINISH);
+    size_t deflated_length = deflated.size() - stream.avail_out;
+    deflateEnd(&stream);
+
+    const char header[] = {31, static_cast<char>(139), 8, 4, 0, 0, 0, 0, 0, static_cast<char>(255), 6, 0, 'B', 'C', 2, 0};
+    std::string block(header, sizeof(header));
+    putLittleEndian(block, static_cast<unsigned int>(18 + deflated_length + 8 - 1), 2);
+    block.append(reinterpret_cast<char *>(&deflated[0]), deflated_length);
+    putLittleEndian(block, crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef *>(data), static_cast<uInt>(length)), 4);
+    putLittleEndian(block, static_cast<unsigned int>(length), 4);
+    return block;
+}
+
+static std::string makeBgzf(const std::string& data) {
+    std::string bgzf;
+    for (size_t i = 0; i < data.length(); i += 65280) {
+        bgzf += bgzfBlock(data.data() + i, std::min(static_cast<size_t>(65280), data.length() - i));
+    }
+    // the empty block bgzip finishes with
+    return bgzf + bgzfBlock("", 0);
+}
+
+static std::string readAll(const std::string& path, int numThreads, GzipReader::Format& format) {
+    GzipReader reader(numThreads);
+    REQUIRE(reader.open(path.c_str()));
+    format = reader.format();
+    std::string data;
+    char buffer[4093];
+    int length;
+    while ((length = reader.read(buffer, sizeof(buffer))) > 0) {
+        data.append(buffer, length);
+    }
+    return data;
+}
+
+TEST_CASE("reading plain and compressed input", "[GzipReader]") {
+    // larger than the ring of decoded buffers
+    std::string reads = makeReads(60000);
+    std::string path = tempFile();
+    GzipReader::Format format;
+
+    SECTION("uncompressed") {
+        writePlain(path, reads);
+        REQUIRE(readAll(path, 1, format) == reads);
+        REQUIRE(format == GzipReader::Plain);
+    }
+    SECTION("one gzip member") {
+        writeGzip(path, reads, "wb1");
+        REQUIRE(readAll(path, 1, format) == reads);
+        REQUIRE(format == GzipReader::Gzip);
+    }
+    SECTION("concatenated gzip members") {
+        writeGzip(path, reads.substr(0, 5000001), "wb1");
+        writeGzip(path, reads.substr(5000001), "ab1");
+        REQUIRE(readAll(path, 2, format) == reads);
+        REQUIRE(format == GzipReader::Gzip);
+    }
+    SECTION("BGZF on one or more threads") {
+        writePlain(path, makeBgzf(reads));
+        REQUIRE(readAll(path, 1, format) == reads);
+        REQUIRE(format == GzipReader::Bgzf);
+        REQUIRE(readAll(path, 4, format) == reads);
+    }
+    SECTION("kseq reads every record") {
+        writePlain(path, makeBgzf(reads));
+        GzipReader reader(3);
+        REQUIRE(reader.open(path.c_str()));
+        kseq_t * seq = kseq_init(&reader);
+        int count = 0;
+        while (kseq_read(seq) >= 0) {
+            REQUIRE(seq->seq.l == 100);
+            count++;
+        }
+        kseq_destroy(seq);
+        REQUIRE(count == 60000);
+    }
+    SECTION("closing before the end") {
+        writeGzip(path, reads, "wb1");
+        GzipReader reader(2);
+        REQUIRE(reader.open(path.c_str()));
+        char buffer[100];
+        REQUIRE(reader.read(buffer, sizeof(buffer)) == 100);
+        reader.close();
+        REQUIRE(reader.read(buffer, sizeof(buffer)) == 0);
+    }
+    SECTION("empty file") {
+        writePlain(path, "");
+        REQUIRE(readAll(path, 1, format).empty());
+    }
+    SECTION("truncated gzip is an error") {
+        writeGzip(path, reads, "wb1");
+        truncate(path.c_str(), 100000);
+        REQUIRE_THROWS_AS(readAll(path, 1, format), crispr::exception);
+    }
+    SECTION("a corrupt BGZF block is an error") {
+        std::string bgzf = makeBgzf(reads);
+        // flip a bit in the stored checksum of the first block
+        size_t first_block = (static_cast<unsigned char>(bgzf[16]) | (static_cast<unsigned char>(bgzf[17]) << 8)) + 1;
+        bgzf[first_block - 8] ^= 1;
+        writePlain(path, bgzf);
+        REQUIRE_THROWS_AS(readAll(path, 4, format), crispr::exception);
+    }
+    SECTION("missing files can't be opened") {
+        GzipReader reader;
+        REQUIRE_FALSE(reader.open("/tmp/crass_gzip_does_not_exist"));
+    }
+    remove(path.c_str());
+}
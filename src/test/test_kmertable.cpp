@@ -0,0 +1,88 @@
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "KmerTable.h"
+#include "SeqUtils.h"
+
+TEST_CASE("packing laurenized kmers", "[KmerTable]") {
+    std::string sequence = "GTTTTAGAGCTATGCTGTTTTGAATGGTCCCAAAAC";
+
+    SECTION("packed kmers are the laurenized strings") {
+        std::vector<unsigned int> kmers;
+        std::vector<std::string> odd_kmers;
+        packLaurenizedKmers(sequence, 11, kmers, odd_kmers);
+        REQUIRE(kmers.size() == sequence.length() - 10);
+        REQUIRE(odd_kmers.empty());
+        for (size_t i = 0; i < kmers.size(); i++) {
+            std::string kmer = laurenize(sequence.substr(i, 11));
+            unsigned int code = 0;
+            for (size_t j = 0; j < kmer.length(); j++) {
+                code = (code << 2) | static_cast<unsigned int>(std::string("ACGT").find(kmer[j]));
+            }
+            REQUIRE(kmers[i] == code);
+        }
+    }
+    SECTION("a kmer and its reverse complement pack the same") {
+        std::vector<unsigned int> forward, reverse;
+        std::vector<std::string> odd_kmers;
+        packLaurenizedKmers(sequence, 11, forward, odd_kmers);
+        packLaurenizedKmers(reverseComplement(sequence), 11, reverse, odd_kmers);
+        REQUIRE(forward.size() == reverse.size());
+        for (size_t i = 0; i < forward.size(); i++) {
+            REQUIRE(forward[i] == reverse[reverse.size() - 1 - i]);
+        }
+    }
+    SECTION("kmers with other bases are kept as strings") {
+        std::string odd = sequence;
+        odd[15] = 'N';
+        std::vector<unsigned int> kmers;
+        std::vector<std::string> odd_kmers;
+        packLaurenizedKmers(odd, 11, kmers, odd_kmers);
+        REQUIRE(odd_kmers.size() == 11);
+        REQUIRE(kmers[4] != KT_EMPTY_SLOT);
+        REQUIRE(kmers[5] == KT_EMPTY_SLOT);
+        REQUIRE(kmers[15] == KT_EMPTY_SLOT);
+        REQUIRE(kmers[16] != KT_EMPTY_SLOT);
+        REQUIRE(odd_kmers[0] == laurenize(odd.substr(5, 11)));
+    }
+    SECTION("U complements to A so it can still pack") {
+        std::vector<unsigned int> kmers;
+        std::vector<std::string> odd_kmers;
+        packLaurenizedKmers("UUUUUUUUUUU", 11, kmers, odd_kmers);
+        REQUIRE(kmers.size() == 1);
+        REQUIRE(kmers[0] == 0);
+        REQUIRE(odd_kmers.empty());
+    }
+    SECTION("too short for a kmer") {
+        std::vector<unsigned int> kmers;
+        std::vector<std::string> odd_kmers;
+        packLaurenizedKmers("ACGT", 11, kmers, odd_kmers);
+        REQUIRE(kmers.empty());
+    }
+}
+
+TEST_CASE("counting kmers in the flat hash", "[KmerTable]") {
+    KmerTable table(4);
+
+    SECTION("values start at zero and the table grows") {
+        for (unsigned int i = 0; i < 5000; i++) {
+            table[i * 7]++;
+            table[i * 7] += 2;
+        }
+        REQUIRE(table.size() == 5000);
+        for (unsigned int i = 0; i < 5000; i++) {
+            REQUIRE(table.find(i * 7) != NULL);
+            REQUIRE(*(table.find(i * 7)) == 3);
+        }
+        REQUIRE(table.find(1) == NULL);
+    }
+    SECTION("odd kmers are kept apart from the packed ones") {
+        table[0] = 5;
+        table[std::string("NNNNNNNNNNN")] = 2;
+        REQUIRE(table.size() == 2);
+        REQUIRE(*(table.find(0)) == 5);
+        REQUIRE(*(table.find(std::string("NNNNNNNNNNN"))) == 2);
+        REQUIRE(table.find(std::string("AAAAAAAAAAA")) == NULL);
+    }
+}
@@ -1,8 +1,21 @@
 #include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <iterator>
+#include <zlib.h>
 
 #include "catch.hpp"
 #include "libcrispr.h"
 #include "ReadHolder.h"
+#include "LoggerSimp.h"
+#include "DRLibrary.h"
+#include "Exception.h"
 
 // 0                                                                                                   1                         
 // 0         1         2         3         4         5         6         7         8         9         0         1         2     
@@ -371,3 +384,707 @@ TEST_CASE("check extending repeat with 300bp read", "[libcrispr]") {
     }
 }
 
+static void searchOptions(options& opts, int numThreads) {
+    opts.logLevel = 0;
+    opts.lowDRsize = CRASS_DEF_MIN_DR_SIZE;
+    opts.highDRsize = CRASS_DEF_MAX_DR_SIZE;
+    opts.lowSpacerSize = CRASS_DEF_MIN_SPACER_SIZE;
+    opts.highSpacerSize = CRASS_DEF_MAX_SPACER_SIZE;
+    opts.searchWindowLength = CRASS_DEF_OPTIMAL_SEARCH_WINDOW_LENGTH;
+    opts.minNumRepeats = CRASS_DEF_DEFAULT_MIN_NUM_REPEATS;
+    opts.numThreads = numThreads;
+    opts.searchEngine = CRT_ENGINE;
+    opts.subsample = CRASS_DEF_SUBSAMPLE;
+}
+
+static std::string randomSequence(unsigned int& seed, int length) {
+    const char * bases = "ACGT";
+    std::string sequence;
+    for (int i = 0; i < length; i++) {
+        seed = seed * 1103515245 + 12345;
+        sequence += bases[(seed >> 16) & 3];
+    }
+    return sequence;
+}
+
+static void writeSearchFile(const char * path, int numReads) {
+    // crispr reads from two DR types, in both orientations, and reads
+    // with a single DR scattered through random ones
+    unsigned int seed = 42;
+    std::string crispr1 = "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC";
+    std::string crispr2 = "GTCGCACTCTTCATGGGTGCGTGGATTGAAAT";
+    for (int i = 0; i < 4; i++) {
+        crispr1 += randomSequence(seed, 34) + "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC";
+        crispr2 += randomSequence(seed, 30) + "GTCGCACTCTTCATGGGTGCGTGGATTGAAAT";
+    }
+    std::ofstream out(path);
+    for (int i = 0; i < numReads; i++) {
+        out << ">read_" << i << "\n";
+        if (i % 7 == 0) {
+            out << crispr1 << "\n";
+        } else if (i % 7 == 3) {
+            out << reverseComplement(crispr1) << "\n";
+        } else if (i % 11 == 5) {
+            out << crispr2 << "\n";
+        } else if (i % 13 == 6) {
+            out << randomSequence(seed, 40) << "GTCGCACTCTTCATGGGTGCGTGGATTGAAAT" << randomSequence(seed, 60) << "\n";
+        } else if (i % 17 == 8) {
+            out << randomSequence(seed, 30) << "NNnacgt" << "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC" << randomSequence(seed, 61) << "\n";
+        } else {
+            out << randomSequence(seed, 150) << "\n";
+        }
+    }
+}
+
+static void deleteReads(ReadMap& reads, ReadHolderPool& pool) {
+    ReadMap::iterator reads_iter;
+    for (reads_iter = reads.begin(); reads_iter != reads.end(); ++reads_iter) {
+        ReadList::iterator list_iter;
+        for (list_iter = reads_iter->second->begin(); list_iter != reads_iter->second->end(); ++list_iter) {
+            pool.destroy(*list_iter);
+        }
+        delete reads_iter->second;
+    }
+    reads.clear();
+    REQUIRE(pool.size() == 0);
+}
+
+static void compareAndDeleteReads(ReadMap& serialReads, ReadHolderPool& serialPool, ReadMap& threadedReads, ReadHolderPool& threadedPool) {
+    REQUIRE(serialReads.size() == threadedReads.size());
+    ReadMap::iterator serial_iter = serialReads.begin();
+    ReadMap::iterator threaded_iter = threadedReads.begin();
+    for (; serial_iter != serialReads.end(); ++serial_iter, ++threaded_iter) {
+        REQUIRE(serial_iter->first == threaded_iter->first);
+        REQUIRE(serial_iter->second->size() == threaded_iter->second->size());
+        for (size_t i = 0; i < serial_iter->second->size(); i++) {
+            ReadHolder * a = serial_iter->second->at(i);
+            ReadHolder * b = threaded_iter->second->at(i);
+            REQUIRE(a->getHeader() == b->getHeader());
+            REQUIRE(a->getSeq() == b->getSeq());
+            REQUIRE(a->getStartStopList() == b->getStartStopList());
+        }
+    }
+    deleteReads(serialReads, serialPool);
+    deleteReads(threadedReads, threadedPool);
+}
+
+static void compareStringChecks(StringCheck& serialCheck, StringCheck& threadedCheck) {
+    REQUIRE(serialCheck.mNextFreeToken == threadedCheck.mNextFreeToken);
+    for (StringToken token = 2; token <= serialCheck.mNextFreeToken; token++) {
+        REQUIRE(serialCheck.getString(token) == threadedCheck.getString(token));
+    }
+}
+
+TEST_CASE("threaded search gives the same results as a single thread", "[libcrispr]") {
+    intialiseGlobalLogger("", 0);
+    char path[] = "/tmp/crass_searchXXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd != -1);
+    close(fd);
+    // more than one batch worth of reads
+    writeSearchFile(path, 3 * CRASS_DEF_READ_BATCH_SIZE + 17);
+
+    time_t start_time;
+    time(&start_time);
+
+    options serial_opts;
+    searchOptions(serial_opts, 1);
+    ReadMap serial_reads;
+    ReadHolderPool serial_pool;
+    StringCheck serial_check;
+    lookupTable serial_patterns, serial_found;
+    int serial_len = searchFile(path, serial_opts, &serial_reads, &serial_pool, &serial_check, serial_patterns, serial_found, start_time, NULL, NULL, NULL);
+
+    options threaded_opts;
+    searchOptions(threaded_opts, 4);
+    ReadMap threaded_reads;
+    ReadHolderPool threaded_pool(true);
+    StringCheck threaded_check;
+    lookupTable threaded_patterns, threaded_found;
+    int threaded_len = searchFile(path, threaded_opts, &threaded_reads, &threaded_pool, &threaded_check, threaded_patterns, threaded_found, start_time, NULL, NULL, NULL);
+
+    REQUIRE(serial_reads.size() == 2);
+    REQUIRE(serial_len == threaded_len);
+    REQUIRE(serial_patterns == threaded_patterns);
+    REQUIRE(serial_found == threaded_found);
+    compareStringChecks(serial_check, threaded_check);
+
+    SECTION("when searching for the repeats") {
+        compareAndDeleteReads(serial_reads, serial_pool, threaded_reads, threaded_pool);
+    }
+    SECTION("when recruiting singletons") {
+        std::vector<std::string> patterns;
+        lookupTable::iterator pattern_iter;
+        for (pattern_iter = serial_patterns.begin(); pattern_iter != serial_patterns.end(); ++pattern_iter) {
+            patterns.push_back(pattern_iter->first);
+        }
+        size_t found_in_search = 0;
+        ReadMap::iterator reads_iter;
+        for (reads_iter = serial_reads.begin(); reads_iter != serial_reads.end(); ++reads_iter) {
+            found_in_search += reads_iter->second->size();
+        }
+        findSingletons(path, serial_opts, &patterns, serial_found, &serial_reads, &serial_pool, &serial_check, start_time);
+        size_t found_in_both = 0;
+        for (reads_iter = serial_reads.begin(); reads_iter != serial_reads.end(); ++reads_iter) {
+            found_in_both += reads_iter->second->size();
+        }
+        REQUIRE(found_in_both > found_in_search);
+        findSingletons(path, threaded_opts, &patterns, threaded_found, &threaded_reads, &threaded_pool, &threaded_check, start_time);
+        compareStringChecks(serial_check, threaded_check);
+        compareAndDeleteReads(serial_reads, serial_pool, threaded_reads, threaded_pool);
+    }
+    SECTION("when recruiting singletons from the reads spilled during the search") {
+        std::vector<std::string> patterns;
+        lookupTable::iterator pattern_iter;
+        for (pattern_iter = serial_patterns.begin(); pattern_iter != serial_patterns.end(); ++pattern_iter) {
+            patterns.push_back(pattern_iter->first);
+        }
+        findSingletons(path, serial_opts, &patterns, serial_found, &serial_reads, &serial_pool, &serial_check, start_time);
+
+        // the threaded reads are thrown away and searched again with a spill file
+        deleteReads(threaded_reads, threaded_pool);
+        StringCheck spill_check;
+        lookupTable spill_patterns, spill_found;
+        std::string spill_path = std::string(path) + ".spill";
+        ReadSpill spill;
+        spill.open(spill_path);
+        searchFile(path, threaded_opts, &threaded_reads, &threaded_pool, &spill_check, spill_patterns, spill_found, start_time, &spill, NULL, NULL);
+        REQUIRE(spill.numReads() + spill_found.size() == 3 * CRASS_DEF_READ_BATCH_SIZE + 17);
+        findSingletons(&spill, serial_opts, &patterns, spill_found, &threaded_reads, &threaded_pool, &spill_check, start_time);
+        spill.close();
+        REQUIRE(access(spill_path.c_str(), F_OK) != 0);
+        compareStringChecks(serial_check, spill_check);
+        compareAndDeleteReads(serial_reads, serial_pool, threaded_reads, threaded_pool);
+    }
+    SECTION("when the spill file can't be read back") {
+        std::vector<std::string> patterns;
+        lookupTable::iterator pattern_iter;
+        for (pattern_iter = serial_patterns.begin(); pattern_iter != serial_patterns.end(); ++pattern_iter) {
+            patterns.push_back(pattern_iter->first);
+        }
+        deleteReads(threaded_reads, threaded_pool);
+        StringCheck spill_check;
+        lookupTable spill_patterns, spill_found;
+        std::string spill_path = std::string(path) + ".spill";
+        ReadSpill spill;
+        spill.open(spill_path);
+        searchFile(path, threaded_opts, &threaded_reads, &threaded_pool, &spill_check, spill_patterns, spill_found, start_time, &spill, NULL, NULL);
+
+        // cut the last read short, the reader throws while the workers are busy
+        spill.rewind();
+        REQUIRE(truncate(spill_path.c_str(), static_cast<off_t>(spill.bytesWritten() - 5)) == 0);
+        REQUIRE_THROWS_AS(findSingletons(&spill, threaded_opts, &patterns, spill_found, &threaded_reads, &threaded_pool, &spill_check, start_time), crispr::exception);
+        spill.close();
+        deleteReads(serial_reads, serial_pool);
+
+        // the readholders of the batches that were never merged are still in the pool
+        ReadMap::iterator reads_iter;
+        for (reads_iter = threaded_reads.begin(); reads_iter != threaded_reads.end(); ++reads_iter) {
+            delete reads_iter->second;
+        }
+        threaded_reads.clear();
+        threaded_pool.clear();
+        REQUIRE(threaded_pool.size() == 0);
+    }
+    remove(path);
+}
+
+static std::set<std::string> readHeaders(ReadMap& reads) {
+    std::set<std::string> headers;
+    ReadMap::iterator reads_iter;
+    for (reads_iter = reads.begin(); reads_iter != reads.end(); ++reads_iter) {
+        ReadList::iterator list_iter;
+        for (list_iter = reads_iter->second->begin(); list_iter != reads_iter->second->end(); ++list_iter) {
+            headers.insert((*list_iter)->getHeader());
+        }
+    }
+    return headers;
+}
+
+TEST_CASE("a library of known repeats recruits reads during the search", "[libcrispr]") {
+    intialiseGlobalLogger("", 0);
+    char path[] = "/tmp/crass_searchXXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd != -1);
+    close(fd);
+    writeSearchFile(path, 3 * CRASS_DEF_READ_BATCH_SIZE + 17);
+
+    time_t start_time;
+    time(&start_time);
+
+    // the usual two passes
+    options serial_opts;
+    searchOptions(serial_opts, 1);
+    ReadMap serial_reads;
+    ReadHolderPool serial_pool;
+    StringCheck serial_check;
+    lookupTable serial_patterns, serial_found;
+    searchFile(path, serial_opts, &serial_reads, &serial_pool, &serial_check, serial_patterns, serial_found, start_time, NULL, NULL, NULL);
+    std::vector<std::string> patterns;
+    lookupTable::iterator pattern_iter;
+    for (pattern_iter = serial_patterns.begin(); pattern_iter != serial_patterns.end(); ++pattern_iter) {
+        patterns.push_back(pattern_iter->first);
+    }
+    size_t found_in_search = serial_found.size();
+    findSingletons(path, serial_opts, &patterns, serial_found, &serial_reads, &serial_pool, &serial_check, start_time);
+
+    // the same reads in one pass when the repeats are already known
+    DRLibrary library;
+    library.add(patterns);
+    ReadMap library_reads;
+    ReadHolderPool library_pool;
+    StringCheck library_check;
+    lookupTable library_patterns, library_found;
+    searchFile(path, serial_opts, &library_reads, &library_pool, &library_check, library_patterns, library_found, start_time, NULL, &library, NULL);
+    REQUIRE(library_found.size() > found_in_search);
+    REQUIRE(readHeaders(library_reads) == readHeaders(serial_reads));
+
+    SECTION("with one thread") {
+        deleteReads(library_reads, library_pool);
+    }
+    SECTION("with many threads") {
+        options threaded_opts;
+        searchOptions(threaded_opts, 4);
+        ReadMap threaded_reads;
+        ReadHolderPool threaded_pool(true);
+        StringCheck threaded_check;
+        lookupTable threaded_patterns, threaded_found;
+        searchFile(path, threaded_opts, &threaded_reads, &threaded_pool, &threaded_check, threaded_patterns, threaded_found, start_time, NULL, &library, NULL);
+        REQUIRE(threaded_found == library_found);
+        compareStringChecks(library_check, threaded_check);
+        compareAndDeleteReads(library_reads, library_pool, threaded_reads, threaded_pool);
+    }
+    deleteReads(serial_reads, serial_pool);
+    remove(path);
+}
+
+TEST_CASE("reads with a known repeat skip the search", "[libcrispr]") {
+    intialiseGlobalLogger("", 0);
+    char path[] = "/tmp/crass_searchXXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd != -1);
+    close(fd);
+    writeSearchFile(path, 3 * CRASS_DEF_READ_BATCH_SIZE + 17);
+    std::string fasta_path = std::string(path) + ".fa";
+    std::ofstream fasta(fasta_path.c_str());
+    fasta << ">crispr1\nGTTTCAATCCACGCGCCCACGCGGGGCGCGAC\n>crispr2\nGTCGCACTCTTCATGGGTGCGTGGATTGAAAT\n";
+    fasta.close();
+    DRLibrary known_repeats;
+    known_repeats.addFasta(fasta_path);
+    remove(fasta_path.c_str());
+
+    time_t start_time;
+    time(&start_time);
+
+    options serial_opts;
+    searchOptions(serial_opts, 1);
+    ReadMap search_reads;
+    ReadHolderPool search_pool;
+    StringCheck search_check;
+    lookupTable search_patterns, search_found;
+    searchFile(path, serial_opts, &search_reads, &search_pool, &search_check, search_patterns, search_found, start_time, NULL, NULL, NULL);
+
+    ReadMap serial_reads;
+    ReadHolderPool serial_pool;
+    StringCheck serial_check;
+    lookupTable serial_patterns, serial_found;
+    searchFile(path, serial_opts, &serial_reads, &serial_pool, &serial_check, serial_patterns, serial_found, start_time, NULL, NULL, &known_repeats);
+
+    // the same crispr reads with every copy of the repeat, the reads
+    // with a single repeat are still left for the second pass
+    std::set<std::string> search_headers = readHeaders(search_reads);
+    REQUIRE(readHeaders(serial_reads) == search_headers);
+    ReadMap::iterator reads_iter;
+    for (reads_iter = serial_reads.begin(); reads_iter != serial_reads.end(); ++reads_iter) {
+        ReadList::iterator list_iter;
+        for (list_iter = reads_iter->second->begin(); list_iter != reads_iter->second->end(); ++list_iter) {
+            REQUIRE((*list_iter)->getStartStopList().size() == 10);
+        }
+    }
+    deleteReads(search_reads, search_pool);
+
+    SECTION("with one thread") {
+        deleteReads(serial_reads, serial_pool);
+    }
+    SECTION("with the kmer engine, which looks at every read") {
+        deleteReads(serial_reads, serial_pool);
+        options kmer_opts;
+        searchOptions(kmer_opts, 1);
+        kmer_opts.searchEngine = KMER_ENGINE;
+        ReadMap kmer_reads, kmer_seeded_reads;
+        ReadHolderPool kmer_pool, kmer_seeded_pool;
+        StringCheck kmer_check, kmer_seeded_check;
+        lookupTable kmer_patterns, kmer_found, kmer_seeded_patterns, kmer_seeded_found;
+        searchFile(path, kmer_opts, &kmer_reads, &kmer_pool, &kmer_check, kmer_patterns, kmer_found, start_time, NULL, NULL, NULL);
+        searchFile(path, kmer_opts, &kmer_seeded_reads, &kmer_seeded_pool, &kmer_seeded_check, kmer_seeded_patterns, kmer_seeded_found, start_time, NULL, NULL, &known_repeats);
+        REQUIRE(readHeaders(kmer_seeded_reads) == readHeaders(kmer_reads));
+        deleteReads(kmer_reads, kmer_pool);
+        deleteReads(kmer_seeded_reads, kmer_seeded_pool);
+    }
+    SECTION("with many threads") {
+        options threaded_opts;
+        searchOptions(threaded_opts, 4);
+        ReadMap threaded_reads;
+        ReadHolderPool threaded_pool(true);
+        StringCheck threaded_check;
+        lookupTable threaded_patterns, threaded_found;
+        searchFile(path, threaded_opts, &threaded_reads, &threaded_pool, &threaded_check, threaded_patterns, threaded_found, start_time, NULL, NULL, &known_repeats);
+        REQUIRE(threaded_found == serial_found);
+        compareStringChecks(serial_check, threaded_check);
+        compareAndDeleteReads(serial_reads, serial_pool, threaded_reads, threaded_pool);
+    }
+    remove(path);
+}
+
+static std::vector<std::string> foundPatterns(lookupTable& patternsHash) {
+    std::vector<std::string> patterns;
+    lookupTable::iterator pattern_iter;
+    for (pattern_iter = patternsHash.begin(); pattern_iter != patternsHash.end(); ++pattern_iter) {
+        patterns.push_back(pattern_iter->first);
+    }
+    return patterns;
+}
+
+TEST_CASE("searching a subsample of the reads", "[libcrispr]") {
+    intialiseGlobalLogger("", 0);
+    char path[] = "/tmp/crass_searchXXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd != -1);
+    close(fd);
+    int num_reads = 3 * CRASS_DEF_READ_BATCH_SIZE + 17;
+    writeSearchFile(path, num_reads);
+
+    time_t start_time;
+    time(&start_time);
+
+    // every read searched then the singletons recruited
+    options full_opts;
+    searchOptions(full_opts, 1);
+    ReadMap full_reads;
+    ReadHolderPool full_pool;
+    StringCheck full_check;
+    lookupTable full_patterns, full_found;
+    searchFile(path, full_opts, &full_reads, &full_pool, &full_check, full_patterns, full_found, start_time, NULL, NULL, NULL);
+    std::set<std::string> searched_headers = readHeaders(full_reads);
+    std::vector<std::string> patterns = foundPatterns(full_patterns);
+    findSingletons(path, full_opts, &patterns, full_found, &full_reads, &full_pool, &full_check, start_time);
+
+    SECTION("a sample bigger than the file searches every read") {
+        options opts;
+        searchOptions(opts, 1);
+        opts.subsample = num_reads;
+        ReadMap reads;
+        ReadHolderPool pool;
+        StringCheck check;
+        lookupTable found_patterns, found;
+        searchFile(path, opts, &reads, &pool, &check, found_patterns, found, start_time, NULL, NULL, NULL);
+        REQUIRE(readHeaders(reads) == searched_headers);
+        deleteReads(reads, pool);
+    }
+    SECTION("a number of reads from the start of the file") {
+        options opts;
+        searchOptions(opts, 1);
+        opts.subsample = 100;
+        ReadMap reads;
+        ReadHolderPool pool;
+        StringCheck check;
+        lookupTable found_patterns, found;
+        searchFile(path, opts, &reads, &pool, &check, found_patterns, found, start_time, NULL, NULL, NULL);
+        std::set<std::string> headers = readHeaders(reads);
+        REQUIRE_FALSE(headers.empty());
+        std::set<std::string>::iterator header_iter;
+        for (header_iter = headers.begin(); header_iter != headers.end(); ++header_iter) {
+            REQUIRE(atoi(header_iter->c_str() + 5) < 100);
+        }
+        deleteReads(reads, pool);
+    }
+    SECTION("a fraction of the reads") {
+        options serial_opts;
+        searchOptions(serial_opts, 1);
+        serial_opts.subsample = 0.25;
+        ReadMap serial_reads;
+        ReadHolderPool serial_pool;
+        StringCheck serial_check;
+        lookupTable serial_patterns, serial_found;
+        searchFile(path, serial_opts, &serial_reads, &serial_pool, &serial_check, serial_patterns, serial_found, start_time, NULL, NULL, NULL);
+        std::set<std::string> sample_headers = readHeaders(serial_reads);
+        REQUIRE(sample_headers.size() > searched_headers.size() / 5);
+        REQUIRE(sample_headers.size() < searched_headers.size() / 3);
+        REQUIRE(std::includes(searched_headers.begin(), searched_headers.end(), sample_headers.begin(), sample_headers.end()));
+
+        options threaded_opts;
+        searchOptions(threaded_opts, 4);
+        threaded_opts.subsample = 0.25;
+        ReadMap threaded_reads;
+        ReadHolderPool threaded_pool(true);
+        StringCheck threaded_check;
+        lookupTable threaded_patterns, threaded_found;
+        searchFile(path, threaded_opts, &threaded_reads, &threaded_pool, &threaded_check, threaded_patterns, threaded_found, start_time, NULL, NULL, NULL);
+        REQUIRE(threaded_found == serial_found);
+        compareStringChecks(serial_check, threaded_check);
+
+        // the rest of the crispr reads are recruited with every whole
+        // copy of their repeat, much as if they had been searched
+        std::vector<std::string> sample_patterns = foundPatterns(serial_patterns);
+        findSingletons(path, serial_opts, &sample_patterns, serial_found, &serial_reads, &serial_pool, &serial_check, start_time);
+        REQUIRE(readHeaders(serial_reads) == readHeaders(full_reads));
+        ReadMap::iterator reads_iter;
+        for (reads_iter = serial_reads.begin(); reads_iter != serial_reads.end(); ++reads_iter) {
+            ReadList::iterator list_iter;
+            for (list_iter = reads_iter->second->begin(); list_iter != reads_iter->second->end(); ++list_iter) {
+                // a repeat found with a base of the spacer on it can't
+                // match the last copy, that is left to updateStartStops
+                if (searched_headers.find((*list_iter)->getHeader()) != searched_headers.end()) {
+                    REQUIRE((*list_iter)->getStartStopList().size() >= 8);
+                } else {
+                    REQUIRE((*list_iter)->getStartStopList().size() == 2);
+                }
+            }
+        }
+        findSingletons(path, threaded_opts, &sample_patterns, threaded_found, &threaded_reads, &threaded_pool, &threaded_check, start_time);
+        compareStringChecks(serial_check, threaded_check);
+        compareAndDeleteReads(serial_reads, serial_pool, threaded_reads, threaded_pool);
+    }
+    deleteReads(full_reads, full_pool);
+    remove(path);
+}
+
+TEST_CASE("the reads looked at are counted", "[libcrispr]") {
+    intialiseGlobalLogger("", 0);
+    char path[] = "/tmp/crass_searchXXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd != -1);
+    close(fd);
+    int num_reads = 2 * CRASS_DEF_READ_BATCH_SIZE + 5;
+    writeSearchFile(path, num_reads);
+
+    time_t start_time;
+    time(&start_time);
+    for (int num_threads = 1; num_threads <= 4; num_threads += 3) {
+        options opts;
+        searchOptions(opts, num_threads);
+        // only some are searched but every read is looked at
+        opts.subsample = 100;
+        ReadMap reads;
+        ReadHolderPool pool(num_threads > 1);
+        StringCheck check;
+        lookupTable found_patterns, found;
+
+        unsigned long searched = readsSearched();
+        unsigned long scanned = readsScannedForSingletons();
+        searchFile(path, opts, &reads, &pool, &check, found_patterns, found, start_time, NULL, NULL, NULL);
+        REQUIRE(readsSearched() - searched == static_cast<unsigned long>(num_reads));
+        REQUIRE(readsScannedForSingletons() == scanned);
+
+        std::vector<std::string> patterns = foundPatterns(found_patterns);
+        findSingletons(path, opts, &patterns, found, &reads, &pool, &check, start_time);
+        REQUIRE(readsScannedForSingletons() - scanned == static_cast<unsigned long>(num_reads));
+        REQUIRE(readsSearched() - searched == static_cast<unsigned long>(num_reads));
+        deleteReads(reads, pool);
+    }
+    remove(path);
+}
+
+TEST_CASE("the kmer search engine finds the same reads as the CRT search", "[libcrispr]") {
+    intialiseGlobalLogger("", 0);
+
+    SECTION("when searching single reads") {
+        // random reads, some from a two letter alphabet so that there are
+        // lots of repeated kmers, some with N and lowercase bases
+        unsigned int seed = 7;
+        const char * alphabets[] = {"ACGT", "AT", "GC", "ACGTN", "ACGTa"};
+        for (unsigned int window = CRASS_DEF_MIN_SEARCH_WINDOW_LENGTH; window <= CRASS_DEF_MAX_SEARCH_WINDOW_LENGTH; window++) {
+            options crt_opts;
+            searchOptions(crt_opts, 1);
+            crt_opts.searchWindowLength = window;
+            options kmer_opts = crt_opts;
+            kmer_opts.searchEngine = KMER_ENGINE;
+            KmerRepeatFinder kmer_finder;
+            for (int i = 0; i < 2000; i++) {
+                const char * alphabet = alphabets[i % 5];
+                size_t alphabet_size = std::string(alphabet).length();
+                std::string sequence;
+                for (int k = 0; k < 100 + (i % 200); k++) {
+                    seed = seed * 1103515245 + 12345;
+                    sequence += alphabet[((seed >> 16) & 0xff) % alphabet_size];
+                }
+                ReadHolder crt_read(sequence, "read");
+                ReadHolder kmer_read(sequence, "read");
+                bool crt_found = searchCore(crt_read, crt_opts);
+                bool kmer_found = searchCore(kmer_read, kmer_opts, kmer_finder);
+                REQUIRE(crt_found == kmer_found);
+                REQUIRE(crt_read.getStartStopList() == kmer_read.getStartStopList());
+            }
+        }
+    }
+    SECTION("when searching a file") {
+        char path[] = "/tmp/crass_searchXXXXXX";
+        int fd = mkstemp(path);
+        REQUIRE(fd != -1);
+        close(fd);
+        writeSearchFile(path, 2000);
+
+        time_t start_time;
+        time(&start_time);
+
+        options crt_opts;
+        searchOptions(crt_opts, 1);
+        ReadMap crt_reads;
+        ReadHolderPool crt_pool;
+        StringCheck crt_check;
+        lookupTable crt_patterns, crt_found;
+        searchFile(path, crt_opts, &crt_reads, &crt_pool, &crt_check, crt_patterns, crt_found, start_time, NULL, NULL, NULL);
+
+        options kmer_opts;
+        searchOptions(kmer_opts, 1);
+        kmer_opts.searchEngine = KMER_ENGINE;
+        ReadMap kmer_reads;
+        ReadHolderPool kmer_pool;
+        StringCheck kmer_check;
+        lookupTable kmer_patterns, kmer_found;
+        searchFile(path, kmer_opts, &kmer_reads, &kmer_pool, &kmer_check, kmer_patterns, kmer_found, start_time, NULL, NULL, NULL);
+
+        REQUIRE(crt_reads.size() == 2);
+        REQUIRE(crt_patterns == kmer_patterns);
+        REQUIRE(crt_found == kmer_found);
+        compareAndDeleteReads(crt_reads, crt_pool, kmer_reads, kmer_pool);
+        remove(path);
+    }
+}
+
+TEST_CASE("reads are only skipped when the search can't find a repeat in them", "[libcrispr]") {
+    intialiseGlobalLogger("", 0);
+
+    SECTION("when searching single reads") {
+        unsigned int seed = 11;
+        const char * alphabets[] = {"ACGT", "AT", "GC", "ACGTN"};
+        for (unsigned int window = CRASS_DEF_MIN_SEARCH_WINDOW_LENGTH; window <= CRASS_DEF_MAX_SEARCH_WINDOW_LENGTH; window++) {
+            options opts;
+            searchOptions(opts, 1);
+            opts.searchWindowLength = window;
+            for (int i = 0; i < 2000; i++) {
+                const char * alphabet = alphabets[i % 4];
+                size_t alphabet_size = std::string(alphabet).length();
+                std::string sequence;
+                for (int k = 0; k < 20 + (i % 280); k++) {
+                    seed = seed * 1103515245 + 12345;
+                    sequence += alphabet[((seed >> 16) & 0xff) % alphabet_size];
+                }
+                ReadHolder read(sequence, "read");
+                if (searchCore(read, opts)) {
+                    REQUIRE(hasRepeatedWindow(sequence.data(), static_cast<unsigned int>(sequence.length()), opts));
+                }
+            }
+        }
+    }
+    SECTION("when searching a file that can be mapped or a gzipped one") {
+        char path[] = "/tmp/crass_searchXXXXXX";
+        int fd = mkstemp(path);
+        REQUIRE(fd != -1);
+        close(fd);
+        writeSearchFile(path, 2 * CRASS_DEF_READ_BATCH_SIZE + 5);
+        std::string gz_path = std::string(path) + ".gz";
+        std::ifstream in(path);
+        std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        gzFile out = gzopen(gz_path.c_str(), "wb1");
+        gzwrite(out, contents.data(), static_cast<unsigned>(contents.length()));
+        gzclose(out);
+
+        time_t start_time;
+        time(&start_time);
+        for (int num_threads = 1; num_threads <= 4; num_threads += 3) {
+            options opts;
+            searchOptions(opts, num_threads);
+            ReadMap mapped_reads, gz_reads;
+            ReadHolderPool mapped_pool(num_threads > 1), gz_pool(num_threads > 1);
+            StringCheck mapped_check, gz_check;
+            lookupTable mapped_patterns, mapped_found, gz_patterns, gz_found;
+            int mapped_len = searchFile(path, opts, &mapped_reads, &mapped_pool, &mapped_check, mapped_patterns, mapped_found, start_time, NULL, NULL, NULL);
+            int gz_len = searchFile(gz_path.c_str(), opts, &gz_reads, &gz_pool, &gz_check, gz_patterns, gz_found, start_time, NULL, NULL, NULL);
+            REQUIRE(mapped_reads.size() == 2);
+            REQUIRE(mapped_len == gz_len);
+            REQUIRE(mapped_patterns == gz_patterns);
+            REQUIRE(mapped_found == gz_found);
+            compareStringChecks(mapped_check, gz_check);
+            compareAndDeleteReads(mapped_reads, mapped_pool, gz_reads, gz_pool);
+        }
+        remove(gz_path.c_str());
+        remove(path);
+    }
+}
+
+static bool lengthAssending(const std::string& a, const std::string& b) {
+    return a.length() < b.length();
+}
+
+// compare every pair, the way removeRedundantRepeats used to work
+static void pairwiseRedundantRepeats(std::vector<std::string>& repeats) {
+    std::sort(repeats.begin(), repeats.end(), lengthAssending);
+    for (size_t i = 0; i < repeats.size(); i++) {
+        if (repeats[i].empty()) {
+            continue;
+        }
+        for (size_t j = i + 1; j < repeats.size(); j++) {
+            if (! repeats[j].empty() && 
+                (repeats[j].find(repeats[i]) != std::string::npos || 
+                 repeats[j].find(reverseComplement(repeats[i])) != std::string::npos)) {
+                repeats[j].clear();
+            }
+        }
+    }
+    repeats.erase(std::remove(repeats.begin(), repeats.end(), std::string()), repeats.end());
+}
+
+TEST_CASE("removing redundant repeats", "[libcrispr]") {
+    SECTION("longer repeats containing a shorter one are removed") {
+        std::vector<std::string> repeats;
+        repeats.push_back("AAGTTTCCGTCCCCTTTCGGGGAATCATTTAGAA");
+        repeats.push_back("GTTTCCGTCCCCTTTCGGGGAATCATTTAG");
+        repeats.push_back(reverseComplement("CGTTTCCGTCCCCTTTCGGGGAATCATTTAGA"));
+        repeats.push_back("GTTTCCGTCCCCTTTCGGGGAATCATTTAG");
+        repeats.push_back("GTTGAACCTTAACATGAGATGTATTTAAAT");
+        removeRedundantRepeats(repeats);
+        REQUIRE(repeats.size() == 2);
+        REQUIRE(std::find(repeats.begin(), repeats.end(), "GTTTCCGTCCCCTTTCGGGGAATCATTTAG") != repeats.end());
+        REQUIRE(std::find(repeats.begin(), repeats.end(), "GTTGAACCTTAACATGAGATGTATTTAAAT") != repeats.end());
+    }
+    SECTION("the same repeats are kept as comparing every pair") {
+        unsigned int seed = 11;
+        for (int round = 0; round < 20; round++) {
+            std::vector<std::string> bases;
+            for (int i = 0; i < 5; i++) {
+                bases.push_back(randomSequence(seed, 40));
+            }
+            std::vector<std::string> repeats;
+            for (int i = 0; i < 300; i++) {
+                seed = seed * 1103515245 + 12345;
+                std::string repeat = bases[(seed >> 16) % bases.size()];
+                seed = seed * 1103515245 + 12345;
+                int start = (seed >> 16) % 8;
+                seed = seed * 1103515245 + 12345;
+                int length = 20 + (seed >> 16) % 20;
+                repeat = repeat.substr(start, length);
+                seed = seed * 1103515245 + 12345;
+                if ((seed >> 16) % 4 == 0) {
+                    repeat = reverseComplement(repeat);
+                }
+                seed = seed * 1103515245 + 12345;
+                if ((seed >> 16) % 5 == 0) {
+                    repeat[(seed >> 8) % repeat.length()] = "NACGTU"[(seed >> 20) % 6];
+                }
+                repeats.push_back(repeat);
+            }
+            std::vector<std::string> expected = repeats;
+            pairwiseRedundantRepeats(expected);
+            removeRedundantRepeats(repeats);
+            std::sort(expected.begin(), expected.end());
+            std::sort(repeats.begin(), repeats.end());
+            REQUIRE(repeats == expected);
+        }
+    }
+    SECTION("an empty group") {
+        std::vector<std::string> repeats;
+        removeRedundantRepeats(repeats);
+        REQUIRE(repeats.empty());
+    }
+}
@@ -0,0 +1,101 @@
+#include <string>
+#include <cstdio>
+#include <unistd.h>
+
+#include "catch.hpp"
+#include "MappedReader.h"
+#include "GzipReader.h"
+#include "kseq.h"
+
+static std::string tempFile(void) {
+    char path[] = "/tmp/crass_mappedXXXXXX";
+    int fd = mkstemp(path);
+    REQUIRE(fd != -1);
+    close(fd);
+    return path;
+}
+
+static void writePlain(const std::string& path, const std::string& data) {
+    FILE * out = fopen(path.c_str(), "wb");
+    fwrite(data.data(), 1, data.length(), out);
+    fclose(out);
+}
+
+static std::string viewString(const char * str, size_t length) {
+    return (str == NULL) ? std::string("<none>") : std::string(str, length);
+}
+
+// every read the mapped reader gives back must be the one kseq reads
+static int compareWithKseq(const std::string& path) {
+    GzipReader reader;
+    REQUIRE(reader.open(path.c_str()));
+    kseq_t * seq = kseq_init(&reader);
+    MappedReader mapped;
+    REQUIRE(mapped.open(path.c_str()));
+    ReadView expected, read;
+    int count = 0;
+    while (kseq_read(seq) >= 0) {
+        expected.assign(seq);
+        REQUIRE(mapped.next(read));
+        REQUIRE(viewString(read.mHeader, read.mHeaderLength) == viewString(expected.mHeader, expected.mHeaderLength));
+        REQUIRE(viewString(read.mComment, read.mCommentLength) == viewString(expected.mComment, expected.mCommentLength));
+        REQUIRE(viewString(read.mSeq, read.mSeqLength) == viewString(expected.mSeq, expected.mSeqLength));
+        REQUIRE(viewString(read.mQual, read.mQualLength) == viewString(expected.mQual, expected.mQualLength));
+        count++;
+    }
+    REQUIRE_FALSE(mapped.next(read));
+    kseq_destroy(seq);
+    return count;
+}
+
+TEST_CASE("reading a mapped sequence file", "[MappedReader]") {
+    std::string path = tempFile();
+
+    SECTION("fastq") {
+        writePlain(path, "@read_1 a comment\nACGTACGT\n+\nIIIIIIII\n@read_2\nTTTT\n+read_2\n!!!!\n");
+        REQUIRE(compareWithKseq(path) == 2);
+        MappedReader mapped;
+        REQUIRE(mapped.open(path.c_str()));
+        ReadView read;
+        REQUIRE(mapped.next(read));
+        // nothing is copied out of the file
+        REQUIRE(mapped.isMapped(read));
+    }
+    SECTION("fasta on one line") {
+        writePlain(path, ">read_1\nACGTACGT\n>read_2 comment\nTTTT");
+        REQUIRE(compareWithKseq(path) == 2);
+    }
+    SECTION("fasta on many lines") {
+        writePlain(path, ">read_1\nACGT\nACGT\n\nAC\n>read_2\nTT TT\n");
+        REQUIRE(compareWithKseq(path) == 2);
+        MappedReader mapped;
+        REQUIRE(mapped.open(path.c_str()));
+        ReadView read;
+        REQUIRE(mapped.next(read));
+        REQUIRE(viewString(read.mSeq, read.mSeqLength) == "ACGTACGTAC");
+        REQUIRE_FALSE(mapped.isMapped(read));
+    }
+    SECTION("windows line endings") {
+        writePlain(path, "@read_1\r\nACGT\r\n+\r\nIIII\r\n@read_2\r\nGGCC\r\n+\r\nIIII\r\n");
+        REQUIRE(compareWithKseq(path) == 2);
+    }
+    SECTION("quality split over lines") {
+        writePlain(path, "@read_1\nACGTACGT\n+\nIIII\nIIII\n@read_2\nAC\n+\nII\n");
+        REQUIRE(compareWithKseq(path) == 2);
+    }
+    SECTION("empty file") {
+        writePlain(path, "");
+        MappedReader mapped;
+        REQUIRE(mapped.open(path.c_str()));
+        ReadView read;
+        REQUIRE_FALSE(mapped.next(read));
+    }
+    SECTION("gzipped files and stdin are left to the GzipReader") {
+        writePlain(path, std::string("\x1f\x8b\x08\x00", 4));
+        MappedReader mapped;
+        REQUIRE_FALSE(mapped.open(path.c_str()));
+        REQUIRE_FALSE(mapped.open("-"));
+        REQUIRE_FALSE(mapped.open("/tmp/crass_mapped_does_not_exist"));
+    }
+    remove(path.c_str());
+}
@@ -0,0 +1,105 @@
+#include <string>
+#include <sstream>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+#include "catch.hpp"
+#include "Metrics.h"
+#include "Exception.h"
+
+TEST_CASE("counting what a run found", "[Metrics]") {
+    Metrics metrics;
+    REQUIRE(metrics.counter("reads") == 0);
+
+    metrics.setCounter("reads", 10);
+    metrics.addCounter("groups", 2);
+    metrics.addCounter("reads", 5);
+    metrics.setCounter("groups", 3);
+    REQUIRE(metrics.counter("reads") == 15);
+    REQUIRE(metrics.counter("groups") == 3);
+
+    // kept in the order they were first set
+    REQUIRE(metrics.counters().size() == 2);
+    REQUIRE(metrics.counters()[0].first == "reads");
+    REQUIRE(metrics.counters()[1].first == "groups");
+}
+
+TEST_CASE("timing the phases of a run", "[Metrics]") {
+    Metrics metrics;
+    {
+        ScopedPhase phase(metrics, "first");
+        usleep(20000);
+    }
+    {
+        ScopedPhase phase(metrics, "second");
+    }
+    REQUIRE(metrics.phases().size() == 2);
+    REQUIRE(metrics.phases()[0].name == "first");
+    REQUIRE(metrics.phases()[0].seconds >= 0.015);
+    REQUIRE(metrics.phases()[1].name == "second");
+    REQUIRE(metrics.totalSeconds() == Approx(metrics.phases()[0].seconds + metrics.phases()[1].seconds));
+    REQUIRE(metrics.phases()[0].peakRSS > 0);
+    REQUIRE(metrics.peakRSS() >= metrics.phases()[1].peakRSS);
+}
+
+TEST_CASE("the peak memory of each phase", "[Metrics]") {
+    Metrics metrics;
+    {
+        ScopedPhase phase(metrics, "big");
+        std::vector<char> block(64 * 1024 * 1024);
+        memset(&block[0], 1, block.size());
+    }
+    {
+        ScopedPhase phase(metrics, "small");
+    }
+    REQUIRE(metrics.phases()[0].peakRSS >= 64 * 1024);
+    REQUIRE(metrics.peakRSS() == metrics.phases()[0].peakRSS);
+    if (metrics.perPhasePeak()) {
+        // the block was freed before the second phase started
+        REQUIRE(metrics.phases()[1].peakRSS < metrics.phases()[0].peakRSS - 32 * 1024);
+    }
+}
+
+TEST_CASE("writing the metrics as JSON", "[Metrics]") {
+    Metrics metrics;
+    metrics.addPhase("parseSeqFiles", 1.5);
+    metrics.addPhase("outputResults", 0.25);
+    metrics.setCounter("readsScanned", 200000);
+    metrics.setCounter("groups", 4);
+
+    std::stringstream json;
+    json.precision(2);
+    json<<1.23456;
+    metrics.writeJson(json);
+    std::string report = json.str();
+    REQUIRE(report.find("\"phases\": [") != std::string::npos);
+    REQUIRE(report.find("{\"name\": \"parseSeqFiles\", \"seconds\": 1.500, \"peakRSSKB\": ") != std::string::npos);
+    REQUIRE(report.find("\"totalSeconds\": 1.750,") != std::string::npos);
+    REQUIRE(report.find("\"readsScanned\": 200000,\n") != std::string::npos);
+    REQUIRE(report.find("\"groups\": 4\n") != std::string::npos);
+
+    // the stream is left as it was
+    json.str("");
+    json<<1.23456;
+    REQUIRE(json.str() == "1.2");
+
+    SECTION("to a file") {
+        char path[] = "/tmp/crass_metricsXXXXXX";
+        int fd = mkstemp(path);
+        REQUIRE(fd != -1);
+        close(fd);
+        metrics.writeJson(std::string(path));
+        FILE * file = fopen(path, "rb");
+        REQUIRE(file != NULL);
+        char buffer[4096];
+        size_t length = fread(buffer, 1, sizeof(buffer), file);
+        fclose(file);
+        remove(path);
+        REQUIRE(std::string(buffer, length) == report.substr(3));
+    }
+    SECTION("to a file that can't be written") {
+        REQUIRE_THROWS_AS(metrics.writeJson(std::string("/tmp/crass_metrics_no_such_dir/metrics.json")), crispr::exception);
+    }
+}
@@ -0,0 +1,67 @@
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "ObjectPool.h"
+
+// counts how many are alive so that we can see the destructors run
+class PoolCounted {
+public:
+    PoolCounted(int value) : mValue(value), mName(100, 'x') { sAlive++; }
+    PoolCounted(int value, const std::string& name, int extra) : mValue(value + extra), mName(name) { sAlive++; }
+    ~PoolCounted() { sAlive--; }
+    int mValue;
+    std::string mName;
+    static int sAlive;
+};
+int PoolCounted::sAlive = 0;
+
+TEST_CASE("objects made in a pool", "[ObjectPool]") {
+    PoolCounted::sAlive = 0;
+
+    SECTION("are carved out of chunks and destroyed by clear") {
+        ObjectPool<PoolCounted> pool(false, 16);
+        std::vector<PoolCounted *> objects;
+        for (int i = 0; i < 100; i++) {
+            objects.push_back(pool.construct(i));
+        }
+        REQUIRE(pool.size() == 100);
+        REQUIRE(pool.numChunks() == 7);
+        REQUIRE(PoolCounted::sAlive == 100);
+        for (int i = 0; i < 100; i++) {
+            REQUIRE(objects[i]->mValue == i);
+        }
+        pool.clear();
+        REQUIRE(pool.size() == 0);
+        REQUIRE(pool.numChunks() == 0);
+        REQUIRE(PoolCounted::sAlive == 0);
+    }
+    SECTION("give their slot back when destroyed") {
+        ObjectPool<PoolCounted> pool(false, 4);
+        PoolCounted * a = pool.construct(1);
+        PoolCounted * b = pool.construct(2, std::string("two"), 1);
+        REQUIRE(b->mValue == 3);
+        REQUIRE(b->mName == "two");
+        pool.destroy(a);
+        REQUIRE(PoolCounted::sAlive == 1);
+        PoolCounted * c = pool.construct(3);
+        REQUIRE(c == a);
+        REQUIRE(pool.size() == 2);
+        REQUIRE(pool.numChunks() == 1);
+        pool.destroy(NULL);
+        REQUIRE(pool.size() == 2);
+    }
+    SECTION("are destroyed with the pool, but only once") {
+        {
+            ObjectPool<PoolCounted> pool(true, 8);
+            for (int i = 0; i < 20; i++) {
+                PoolCounted * p = pool.construct(i);
+                if (i % 3 == 0) {
+                    pool.destroy(p);
+                }
+            }
+            REQUIRE(PoolCounted::sAlive == 13);
+        }
+        REQUIRE(PoolCounted::sAlive == 0);
+    }
+}
@@ -0,0 +1,142 @@
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+#include "catch.hpp"
+#include "PatternMatcher.h"
+
+TEST_CASE("Boyer-Moore search with a precomputed table", "[PatternMatcher]") {
+    std::string text = "GGTAGACATTCCTTACACCATGGTAGACCTTCCTAACACCATGGTAGACC";
+    std::string pattern = "CACCATGG";
+
+    SECTION("gives the same offset as the string version") {
+        BmpTable bmp_last;
+        PatternMatcher::computeBmpLast(pattern.data(), pattern.length(), bmp_last);
+        int position = PatternMatcher::bmpSearch(text.data(), text.length(), pattern.data(), pattern.length(), bmp_last);
+        REQUIRE(position == 15);
+        REQUIRE(position == PatternMatcher::bmpSearch(text, pattern));
+    }
+
+    SECTION("the table can be reused on a view into a longer string") {
+        BmpTable bmp_last;
+        PatternMatcher::computeBmpLast(pattern.data(), pattern.length(), bmp_last);
+        // skip the first match, the second one starts at 36
+        int position = PatternMatcher::bmpSearch(text.data() + 20, text.length() - 20, pattern.data(), pattern.length(), bmp_last);
+        REQUIRE(position == 16);
+        // the end of the view cuts the second match off
+        position = PatternMatcher::bmpSearch(text.data() + 20, 20, pattern.data(), pattern.length(), bmp_last);
+        REQUIRE(position == -1);
+    }
+
+    SECTION("the pattern can be a view too") {
+        BmpTable bmp_last;
+        const char * window = text.data() + 15;
+        PatternMatcher::computeBmpLast(window, 8, bmp_last);
+        int position = PatternMatcher::bmpSearch(text.data() + 23, text.length() - 23, window, 8, bmp_last);
+        REQUIRE(position == 13);
+    }
+
+    SECTION("empty and oversized patterns are not found") {
+        BmpTable bmp_last;
+        PatternMatcher::computeBmpLast(pattern.data(), 0, bmp_last);
+        REQUIRE(PatternMatcher::bmpSearch(text.data(), text.length(), pattern.data(), 0, bmp_last) == -1);
+        PatternMatcher::computeBmpLast(text.data(), text.length(), bmp_last);
+        REQUIRE(PatternMatcher::bmpSearch(pattern.data(), pattern.length(), text.data(), text.length(), bmp_last) == -1);
+    }
+}
+
+// the matrix version that the bit-parallel code replaced
+static int matrixDistance(const std::string& source, const std::string& target) {
+    int n = (int)source.length();
+    int m = (int)target.length();
+    if (n == 0) return m;
+    if (m == 0) return n;
+    std::vector< std::vector<int> > matrix(n + 1, std::vector<int>(m + 1));
+    for (int i = 0; i <= n; i++) matrix[i][0] = i;
+    for (int j = 0; j <= m; j++) matrix[0][j] = j;
+    for (int i = 1; i <= n; i++) {
+        for (int j = 1; j <= m; j++) {
+            int cost = (source[i-1] == target[j-1]) ? 0 : 1;
+            int cell = std::min(matrix[i-1][j] + 1, std::min(matrix[i][j-1] + 1, matrix[i-1][j-1] + cost));
+            if (i > 2 && j > 2) {
+                int trans = matrix[i-2][j-2] + 1;
+                if (source[i-2] != target[j-1]) trans++;
+                if (source[i-1] != target[j-2]) trans++;
+                if (cell > trans) cell = trans;
+            }
+            matrix[i][j] = cell;
+        }
+    }
+    return matrix[n][m];
+}
+
+static std::string randomSequence(int length, const char * alphabet, int alphabetSize) {
+    std::string seq(length, 'A');
+    for (int i = 0; i < length; i++) {
+        seq[i] = alphabet[rand() % alphabetSize];
+    }
+    return seq;
+}
+
+// copy the sequence with a few random edits and swaps so the distances are small
+static std::string mutate(const std::string& seq, int edits, const char * alphabet, int alphabetSize) {
+    std::string out = seq;
+    for (int e = 0; e < edits && out.length() > 1; e++) {
+        size_t pos = rand() % (out.length() - 1);
+        switch (rand() % 4) {
+            case 0: out[pos] = alphabet[rand() % alphabetSize]; break;
+            case 1: out.erase(pos, 1); break;
+            case 2: out.insert(pos, 1, alphabet[rand() % alphabetSize]); break;
+            default: std::swap(out[pos], out[pos + 1]); break;
+        }
+    }
+    return out;
+}
+
+TEST_CASE("bit-parallel edit distance", "[PatternMatcher]") {
+    srand(1234);
+    const char * dna = "ACGT";
+
+    SECTION("transpositions at the start of either string are not cheap") {
+        std::string a = "ACGTTA";
+        std::string b = "CAGTTA";
+        REQUIRE(PatternMatcher::levenstheinDistance(a, b) == 2);
+        std::string c = "AGCTTA";
+        REQUIRE(PatternMatcher::levenstheinDistance(a, c) == 1);
+        std::string empty;
+        REQUIRE(PatternMatcher::levenstheinDistance(a, empty) == 6);
+        REQUIRE(PatternMatcher::levenstheinDistance(empty, a) == 6);
+    }
+
+    SECTION("matches the matrix for short and long strings") {
+        for (int trial = 0; trial < 3000; trial++) {
+            int length = rand() % 200;
+            // two letters gives lots of transpositions
+            int alphabet_size = (trial % 2) ? 4 : 2;
+            std::string a = randomSequence(length, dna, alphabet_size);
+            std::string b = (trial % 3) ? mutate(a, rand() % 12, dna, alphabet_size) : randomSequence(rand() % 200, dna, alphabet_size);
+            int expected = matrixDistance(a, b);
+            REQUIRE(PatternMatcher::levenstheinDistance(a, b) == expected);
+            REQUIRE(PatternMatcher::levenstheinDistance(b, a) == expected);
+            int cutoff = rand() % 20;
+            int bounded = PatternMatcher::levenstheinDistance(a.data(), (int)a.length(), b.data(), (int)b.length(), cutoff);
+            REQUIRE(bounded == std::min(expected, cutoff + 1));
+        }
+    }
+
+    SECTION("the thresholded similarity agrees on which side of the cutoff it falls") {
+        for (int trial = 0; trial < 3000; trial++) {
+            std::string a = randomSequence(20 + rand() % 40, dna, 4);
+            std::string b = mutate(a, rand() % 15, dna, 4);
+            float exact = PatternMatcher::getStringSimilarity(a, b);
+            float bounded = PatternMatcher::getStringSimilarity(a, b, 0.82f);
+            if (exact > 0.82f) {
+                REQUIRE(bounded == exact);
+            } else {
+                REQUIRE(bounded <= 0.82f);
+                REQUIRE(bounded >= exact);
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#include <string>
+#include <sstream>
+#include <vector>
+
+#include "catch.hpp"
+#include "ReadHolder.h"
+#include "SeqUtils.h"
+
+TEST_CASE("packing the sequence of a readholder", "[ReadHolder]") {
+    std::string sequence = "CACCATGGAAGACCTTCCTAACACCATGGTAGACATTCCTTACACCATGGTAGACCTTCCTAACACCATGGTAGACCTTCCTAACACCATGGTAGACCTTCCTAACACCATGGTAGACCTTTCTAA";
+    // some bases that won't fit in two bits
+    sequence[3] = 'N';
+    sequence[64] = 'n';
+    sequence[125] = 'Y';
+    ReadHolder plain(sequence, "HWI-D00456:77:C70WLANXX:1:1101:10963:2182");
+    plain.startStopsAdd(0, 7);
+    plain.startStopsAdd(63, 70);
+    plain.startStopsAdd(105, 112);
+    ReadHolder packed = plain;
+    packed.pack();
+
+    SECTION("the getters decode on demand") {
+        REQUIRE(packed.isPacked());
+        REQUIRE(packed.getSeqLength() == plain.getSeqLength());
+        REQUIRE(packed.getSeq() == sequence);
+        for (int i = 0; i < plain.getSeqLength(); i++) {
+            REQUIRE(packed.getSeqCharAt(i) == plain.getSeqCharAt(i));
+        }
+        REQUIRE(packed.substr(60, 10) == plain.substr(60, 10));
+        REQUIRE(packed.substr(120) == plain.substr(120));
+        REQUIRE(packed.repeatStringAt(2) == plain.repeatStringAt(2));
+        REQUIRE(packed.spacerStringAt(0) == plain.spacerStringAt(0));
+        REQUIRE(packed.isPacked());
+    }
+    SECTION("cutting spacers and repeats gives the same strings") {
+        std::vector<std::string> plain_spacers, packed_spacers;
+        plain.getAllSpacerStrings(plain_spacers);
+        packed.getAllSpacerStrings(packed_spacers);
+        REQUIRE(plain_spacers == packed_spacers);
+        std::string plain_dr, packed_dr;
+        REQUIRE(plain.getFirstDR(&plain_dr) == packed.getFirstDR(&packed_dr));
+        REQUIRE(plain_dr == packed_dr);
+        REQUIRE(plain.getNextDR(&plain_dr) == packed.getNextDR(&packed_dr));
+        REQUIRE(plain_dr == packed_dr);
+    }
+    SECTION("changing the sequence keeps it packed") {
+        plain.reverseComplementSeq();
+        packed.reverseComplementSeq();
+        REQUIRE(packed.isPacked());
+        REQUIRE(packed.getSeq() == plain.getSeq());
+        REQUIRE(packed.getStartStopList() == plain.getStartStopList());
+    }
+    SECTION("unpacking gives back the original") {
+        packed.unpack();
+        REQUIRE_FALSE(packed.isPacked());
+        REQUIRE(packed.getSeq() == sequence);
+        REQUIRE(packed.getSeqRef() == sequence);
+    }
+    SECTION("out of range substrings still throw") {
+        REQUIRE_THROWS_AS(packed.substr(static_cast<int>(sequence.length()) + 1, 2), std::out_of_range);
+    }
+}
+
+TEST_CASE("writing a readholder out keeps the header and comment", "[ReadHolder]") {
+    std::string sequence = "CACCATGGAAGACCTTCCTAACACCATGGTAGACATTCCTTACACCATGGTAGACCTTCCTAA";
+    ReadHolder read(sequence, "HWI-D00456:77:C70WLANXX:1:1101:10963:2182");
+    read.setComment("1:N:0:ACAGTG");
+    REQUIRE(read.getComment() == "1:N:0:ACAGTG");
+
+    SECTION("as a fasta record") {
+        std::stringstream out;
+        out << read;
+        REQUIRE(out.str() == ">HWI-D00456:77:C70WLANXX:1:1101:10963:2182 1:N:0:ACAGTG\n" + sequence);
+    }
+    SECTION("when packed") {
+        read.pack();
+        std::stringstream out;
+        out << read;
+        REQUIRE(out.str() == ">HWI-D00456:77:C70WLANXX:1:1101:10963:2182 1:N:0:ACAGTG\n" + sequence);
+    }
+    SECTION("without a comment") {
+        read.setComment("");
+        std::stringstream out;
+        out << read;
+        REQUIRE(out.str() == ">HWI-D00456:77:C70WLANXX:1:1101:10963:2182\n" + sequence);
+    }
+}
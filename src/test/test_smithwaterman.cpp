@@ -0,0 +1,105 @@
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include "catch.hpp"
+#include "SmithWaterman.h"
+
+// the full matrix and traceback that the two row version replaced, with
+// the scores scaled to whole numbers so that ties are exact
+static void matrixAlignment(const std::string& seqA, const std::string& seqB, int aStartSearch, int aSearchLen, int * aStart, int * aEnd, int * bStart, int * bEnd) {
+    int m = (int)seqB.length();
+    std::vector< std::vector<int> > matrix(aSearchLen + 1, std::vector<int>(m + 1, 0));
+    std::vector< std::vector<int> > from_i(aSearchLen + 1, std::vector<int>(m + 1, 0));
+    std::vector< std::vector<int> > from_j(aSearchLen + 1, std::vector<int>(m + 1, 0));
+    int matrix_max = -1, i_max = 0, j_max = 0;
+    for (int i = 1; i <= aSearchLen; i++) {
+        for (int j = 1; j <= m; j++) {
+            int a = matrix[i-1][j-1] + SW_INT_SIM_SCORE(seqA[i-1 + aStartSearch], seqB[j-1]);
+            int b = matrix[i-1][j] + SW_INT_GAP;
+            int c = matrix[i][j-1] + SW_INT_GAP;
+            int index;
+            matrix[i][j] = (int)findMax(a, b, c, 0, &index);
+            int next_i[4] = {i-1, i-1, i, i};
+            int next_j[4] = {j-1, j, j-1, j};
+            from_i[i][j] = next_i[index];
+            from_j[i][j] = next_j[index];
+            if (matrix[i][j] > matrix_max) {
+                matrix_max = matrix[i][j];
+                i_max = i;
+                j_max = j;
+            }
+        }
+    }
+    int current_i = i_max, current_j = j_max;
+    int next_i = from_i[current_i][current_j], next_j = from_j[current_i][current_j];
+    while (next_j != 0 && next_i != 0 && (current_i != next_i || current_j != next_j)) {
+        current_i = next_i;
+        current_j = next_j;
+        next_i = from_i[current_i][current_j];
+        next_j = from_j[current_i][current_j];
+    }
+    current_i = std::max(current_i - 1, 0);
+    current_j = std::max(current_j - 1, 0);
+    *aStart = current_i + aStartSearch;
+    *aEnd = *aStart + i_max - current_i - 1;
+    *bStart = current_j;
+    *bEnd = j_max;
+}
+
+static std::string randomSequence(int length) {
+    std::string seq(length, 'A');
+    for (int i = 0; i < length; i++) {
+        seq[i] = "ACGT"[rand() % 4];
+    }
+    return seq;
+}
+
+TEST_CASE("smith waterman without the full matrix", "[SmithWaterman]") {
+    srand(99);
+    std::string repeat = "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC";
+
+    SECTION("finds the same alignment as the traceback") {
+        for (int trial = 0; trial < 2000; trial++) {
+            std::string read = randomSequence(40 + rand() % 120);
+            // part of the repeat at one end of the read
+            int part = 4 + rand() % 28;
+            if (trial % 2) {
+                read.replace(0, part, repeat.substr(repeat.length() - part));
+            } else {
+                read.replace(read.length() - part, part, repeat.substr(0, part));
+            }
+            std::string query = (trial % 3) ? repeat : randomSequence(1 + rand() % 100);
+            int start_search = rand() % (read.length() / 2);
+            int search_len = 1 + rand() % (read.length() - start_search);
+            int a_start, a_end, b_start, b_end;
+            int e_a_start, e_a_end, e_b_start, e_b_end;
+            REQUIRE(smithWatermanCoordinates(read.data(), start_search, search_len, query.data(), (int)query.length(), &a_start, &a_end, &b_start, &b_end));
+            matrixAlignment(read, query, start_search, search_len, &e_a_start, &e_a_end, &e_b_start, &e_b_end);
+            REQUIRE(a_start == e_a_start);
+            REQUIRE(a_end == e_a_end);
+            REQUIRE(b_start == e_b_start);
+            REQUIRE(b_end == e_b_end);
+        }
+    }
+
+    SECTION("a partial repeat at the start of a read") {
+        std::string read = repeat.substr(20) + "ACGGTCAATGCTTGACCATGAC" + repeat;
+        int part_s = 0, part_e = 0;
+        stringPair sp = smithWaterman(read, repeat, &part_s, &part_e, 0, 20, 0.85);
+        REQUIRE(part_s == 0);
+        REQUIRE(part_e == 11);
+        REQUIRE(sp.second == repeat.substr(20));
+    }
+
+    SECTION("nothing is returned when the similarity is too low") {
+        std::string read = "ACGTTGCA";
+        std::string other = "TTTTTTTTGGGGGGGG";
+        int part_s = 5, part_e = 5;
+        stringPair sp = smithWaterman(read, other, &part_s, &part_e, 0, (int)read.length(), 0.85);
+        REQUIRE(part_s == 0);
+        REQUIRE(part_e == 0);
+        REQUIRE(sp.first.empty());
+        REQUIRE(sp.second.empty());
+    }
+}
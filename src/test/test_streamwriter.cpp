@@ -0,0 +1,113 @@
+#include <string>
+#include <sstream>
+
+#include "catch.hpp"
+#include "streamwriter.h"
+#include "Exception.h"
+
+TEST_CASE("streaming a crispr file", "[streamwriter]") {
+    std::ostringstream out;
+    crispr::xml::streamwriter xml_out;
+    xml_out.createDocument(&out, "crispr", "1.1");
+
+    SECTION("an empty document is just the root element") {
+        REQUIRE(xml_out.finishDocument());
+        REQUIRE(out.str() == "<?xml version=\"1.0\" encoding=\"ISO8859-1\" standalone=\"no\" ?>\n"
+                             "<crispr version=\"1.1\"/>\n");
+    }
+    SECTION("a group is laid out like the DOM serializer") {
+        xml_out.addGroup("G1", "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC");
+        xml_out.startElement(xml_out.tag_Data());
+        xml_out.startElement(xml_out.tag_Sources());
+        xml_out.addSource("read1", "SO1");
+        xml_out.endElement();
+        xml_out.startElement(xml_out.tag_Drs());
+        xml_out.addDirectRepeat("DR1", "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC");
+        xml_out.endElement();
+        xml_out.startElement(xml_out.tag_Spacers());
+        xml_out.addSpacer("ACGTACGT", "SP1", "2");
+        xml_out.addSpacerSource("SO1");
+        xml_out.endElement();
+        xml_out.addSpacer("TTTTAAAA", "SP2", "1");
+        xml_out.endElement();
+        xml_out.endElement();
+        xml_out.endElement();
+        xml_out.startElement(xml_out.tag_Metadata());
+        xml_out.startElement(xml_out.tag_Program());
+        xml_out.addTextElement(xml_out.tag_Name(), "crass");
+        xml_out.endElement();
+        xml_out.addFileToMetadata("data", "/tmp/Spacers_1.gv");
+        xml_out.endElement();
+        xml_out.startElement(xml_out.tag_Assembly());
+        xml_out.addContig("C1");
+        xml_out.addSpacerToContig("SP1");
+        xml_out.startElement(xml_out.tag_Fspacers());
+        xml_out.addSpacer(xml_out.tag_Fs(), "SP2", "DR1", "0");
+        xml_out.endElement();
+        xml_out.endElement();
+        xml_out.endElement();
+        xml_out.endElement();
+        xml_out.endElement();
+        REQUIRE(xml_out.finishDocument());
+        REQUIRE(out.str() ==
+                "<?xml version=\"1.0\" encoding=\"ISO8859-1\" standalone=\"no\" ?>\n"
+                "<crispr version=\"1.1\">\n"
+                "\n"
+                "  <group drseq=\"GTTTCAATCCACGCGCCCACGCGGGGCGCGAC\" gid=\"G1\">\n"
+                "    <data>\n"
+                "      <sources>\n"
+                "        <source accession=\"read1\" soid=\"SO1\"/>\n"
+                "      </sources>\n"
+                "      <drs>\n"
+                "        <dr drid=\"DR1\" seq=\"GTTTCAATCCACGCGCCCACGCGGGGCGCGAC\"/>\n"
+                "      </drs>\n"
+                "      <spacers>\n"
+                "        <spacer cov=\"2\" seq=\"ACGTACGT\" spid=\"SP1\">\n"
+                "          <source soid=\"SO1\"/>\n"
+                "        </spacer>\n"
+                "        <spacer cov=\"1\" seq=\"TTTTAAAA\" spid=\"SP2\"/>\n"
+                "      </spacers>\n"
+                "    </data>\n"
+                "    <metadata>\n"
+                "      <program>\n"
+                "        <name>crass</name>\n"
+                "      </program>\n"
+                "      <file type=\"data\" url=\"/tmp/Spacers_1.gv\"/>\n"
+                "    </metadata>\n"
+                "    <assembly>\n"
+                "      <contig cid=\"C1\">\n"
+                "        <cspacer spid=\"SP1\">\n"
+                "          <fspacers>\n"
+                "            <fs drconf=\"0\" drid=\"DR1\" spid=\"SP2\"/>\n"
+                "          </fspacers>\n"
+                "        </cspacer>\n"
+                "      </contig>\n"
+                "    </assembly>\n"
+                "  </group>\n"
+                "\n"
+                "</crispr>\n");
+    }
+    SECTION("markup in values is escaped") {
+        xml_out.startElement(xml_out.tag_Metadata());
+        xml_out.addTextElement(xml_out.tag_Notes(), "a < b & c > \"d\"");
+        xml_out.addSource("read \"1\" <&>", "SO1");
+        xml_out.endElement();
+        REQUIRE(xml_out.finishDocument());
+        std::string str = out.str();
+        REQUIRE(str.find("<notes>a &lt; b &amp; c &gt; \"d\"</notes>") != std::string::npos);
+        REQUIRE(str.find("accession=\"read &quot;1&quot; &lt;&amp;&gt;\"") != std::string::npos);
+    }
+    SECTION("open elements are closed when the document is finished") {
+        xml_out.addGroup("G1", "ACGT");
+        xml_out.startElement(xml_out.tag_Assembly());
+        xml_out.addContig("C1");
+        REQUIRE(xml_out.finishDocument());
+        REQUIRE(out.str().find("<contig cid=\"C1\"/>\n    </assembly>\n  </group>\n\n</crispr>\n") != std::string::npos);
+    }
+    SECTION("attributes can't be added once an element has children") {
+        xml_out.addGroup("G1", "ACGT");
+        xml_out.startElement(xml_out.tag_Data());
+        xml_out.endElement();
+        REQUIRE_THROWS_AS(xml_out.addAttribute(xml_out.attr_Gid(), "G2"), crispr::xml_exception);
+    }
+}
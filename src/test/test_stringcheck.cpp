@@ -0,0 +1,57 @@
+#include <string>
+#include <sstream>
+
+#include "catch.hpp"
+#include "StringCheck.h"
+#include "Exception.h"
+
+TEST_CASE("interning strings in a StringCheck", "[StringCheck]") {
+    StringCheck string_check;
+
+    SECTION("tokens start at two and come back with their strings") {
+        StringToken first = string_check.addString("GTTTCAATCCACGCGCCCACGCGGGGCGCGAC");
+        StringToken second = string_check.addString("HWI-D00456:77:C70WLANXX:1:1101:10963:2182");
+        REQUIRE(first == 2);
+        REQUIRE(second == 3);
+        REQUIRE(string_check.getString(first) == "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC");
+        REQUIRE(string_check.getString(second) == "HWI-D00456:77:C70WLANXX:1:1101:10963:2182");
+        REQUIRE(string_check.getToken("GTTTCAATCCACGCGCCCACGCGGGGCGCGAC") == first);
+        REQUIRE(string_check.getToken("HWI-D00456:77:C70WLANXX:1:1101:10963:2182") == second);
+        REQUIRE(string_check.getToken("GTTTCAATCCACGCGCCCACGCGGGGCGCGA") == 0);
+        StringView view = string_check.getStringView(first);
+        REQUIRE(std::string(view.data, view.length) == "GTTTCAATCCACGCGCCCACGCGGGGCGCGAC");
+    }
+    SECTION("adding a string again gives it a new token") {
+        StringToken first = string_check.addString("ACGT");
+        StringToken second = string_check.addString("ACGT");
+        REQUIRE(first != second);
+        REQUIRE(string_check.getString(first) == "ACGT");
+        REQUIRE(string_check.getString(second) == "ACGT");
+        REQUIRE(string_check.getToken("ACGT") == second);
+    }
+    SECTION("empty strings can be stored") {
+        StringToken token = string_check.addString("");
+        REQUIRE(string_check.getString(token) == "");
+        REQUIRE(string_check.getToken("") == token);
+    }
+    SECTION("unknown tokens throw") {
+        string_check.addString("ACGT");
+        REQUIRE_THROWS_AS(string_check.getString(0), crispr::exception);
+        REQUIRE_THROWS_AS(string_check.getString(1), crispr::exception);
+        REQUIRE_THROWS_AS(string_check.getString(3), crispr::exception);
+    }
+    SECTION("every string is still found after the table grows") {
+        for (int i = 0; i < 20000; i++) {
+            std::stringstream ss;
+            ss << "read_" << i;
+            REQUIRE(string_check.addString(ss.str()) == i + 2);
+        }
+        REQUIRE(string_check.size() == 20000);
+        for (int i = 0; i < 20000; i++) {
+            std::stringstream ss;
+            ss << "read_" << i;
+            REQUIRE(string_check.getToken(ss.str()) == i + 2);
+            REQUIRE(string_check.getString(i + 2) == ss.str());
+        }
+    }
+}
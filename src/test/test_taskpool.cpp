@@ -0,0 +1,46 @@
+#include <vector>
+#include <stdexcept>
+
+#include "catch.hpp"
+#include "TaskPool.h"
+#include "Exception.h"
+
+static void countTask(size_t task, void * context)
+{
+    std::vector<int> * counts = static_cast<std::vector<int> *>(context);
+    (*counts)[task]++;
+}
+
+static void failingTask(size_t task, void * context)
+{
+    countTask(task, context);
+    if (task == 3) {
+        throw std::runtime_error("task 3 failed");
+    }
+}
+
+TEST_CASE("running tasks on a pool of threads", "[TaskPool]") {
+    SECTION("every task is run exactly once") {
+        int threads[] = {1, 2, 8};
+        for (int i = 0; i < 3; i++) {
+            std::vector<int> counts(1000, 0);
+            runTasks(counts.size(), threads[i], countTask, &counts);
+            for (size_t j = 0; j < counts.size(); j++) {
+                REQUIRE(counts[j] == 1);
+            }
+        }
+    }
+    SECTION("more threads than tasks") {
+        std::vector<int> counts(2, 0);
+        runTasks(counts.size(), 16, countTask, &counts);
+        REQUIRE(counts[0] == 1);
+        REQUIRE(counts[1] == 1);
+        runTasks(0, 16, countTask, &counts);
+        REQUIRE(counts[0] == 1);
+    }
+    SECTION("an error in a task is thrown from the calling thread") {
+        std::vector<int> counts(100, 0);
+        REQUIRE_THROWS_AS(runTasks(counts.size(), 4, failingTask, &counts), crispr::exception);
+        REQUIRE(counts[3] == 1);
+    }
+}